@@ -62,7 +62,8 @@ static void AddTableEntryPair(wxWindow *parent, wxFlexGridSizer *pTable, const w
 }
 
 RefineDefMap::RefineDefMap(wxWindow *parent) :
-    wxDialog(parent, wxID_ANY, _("Refine Bad-pixel Map"), wxDefaultPosition, wxSize(900, 400), wxCAPTION | wxCLOSE_BOX), m_profileId(-1)
+    wxDialog(parent, wxID_ANY, _("Refine Bad-pixel Map"), wxDefaultPosition, wxSize(900, 400), wxCAPTION | wxCLOSE_BOX), m_profileId(-1),
+    m_previewBuilt(false)
 {
     SetSize(wxSize(900, 400));
 
@@ -310,6 +311,7 @@ bool RefineDefMap::RebuildMasterDarks()
         if (m_darks.filteredDark.ImageData && m_darks.masterDark.ImageData)
         {
             m_builder.Init(m_darks);
+            m_previewBuilt = false;
             rslt = true;
         }
     }
@@ -339,6 +341,7 @@ void RefineDefMap::ApplyNewMap()
     pColdSlider->Enable(false);
     ShowStatus(_("Building new bad-pixel map"), false);
     m_builder.BuildDefectMap(m_defectMap, true);
+    m_previewBuilt = true;
     ShowStatus(_("Saving new bad-pixel map file"), false);
     m_defectMap.Save(m_builder.GetMapInfo());
     ShowStatus(_("Loading new bad-pixel map"), false);
@@ -407,7 +410,14 @@ void RefineDefMap::Recalc()
         pStatsGrid->SetCellValue(manualPixelLoc, "0");          // Manual pixels will always be discarded
     }
     GetBadPxCounts();
-    m_builder.BuildDefectMap(m_defectMap, false);
+    // while the slider moves only the pixels between the old and new thresholds change
+    if (m_previewBuilt)
+        m_builder.UpdateDefectMap(m_defectMap);
+    else
+    {
+        m_builder.BuildDefectMap(m_defectMap, false);
+        m_previewBuilt = true;
+    }
 }
 
 void RefineDefMap::OnHotChange(wxScrollEvent& evt)
@@ -478,6 +488,7 @@ void RefineDefMap::OnReset(wxCommandEvent& evt)
 void RefineDefMap::LoadPreview()
 {
     m_defectMap.clear();
+    m_previewBuilt = false;
 
     wxCriticalSectionLocker lck(pCamera->DarkFrameLock);
     DefectMap *curMap = pCamera->CurrentDefectMap;
@@ -49,6 +49,7 @@ class RefineDefMap : public wxDialog
 
     int m_profileId;
     DefectMap m_defectMap;
+    bool m_previewBuilt;            // m_defectMap is the builder's output, not a loaded map
     DefectMapDarks m_darks;
     DefectMapBuilder m_builder;
 
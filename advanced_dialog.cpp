@@ -556,8 +556,8 @@ void AdvancedDialog::ResetGuidingParams()
 // This function only affects UI elements in the various AD panes and is intended for use only by the various ConfigCtrl classes
 void AdvancedDialog::MakeImageScaleAdjustments()
 {
-    double origImageScale = pFrame->GetPixelScale(pCamera->GetCameraPixelSize(), pFrame->GetFocalLength(), pCamera->Binning);       // Profile values
-    double newImageScale = pFrame->GetPixelScale(GetPixelSize(), GetFocalLength(), GetBinning());                                   // Current UI ctrl values
+    double origImageScale = pFrame->GetPixelScale(pCamera->GetCameraPixelSize(), pFrame->GetFocalLength(), pCamera->EffectiveBinning());  // Profile values
+    double newImageScale = pFrame->GetPixelScale(GetPixelSize(), GetFocalLength(), GetBinning() * GetSwBinning());                      // Current UI ctrl values
     if (fabs((origImageScale - newImageScale) / newImageScale) >= 0.01)
     {
         // Scale the UI cal step size based on image scale ratio - may get refined at start of calibration if actual guiding rates are known
@@ -565,7 +565,7 @@ void AdvancedDialog::MakeImageScaleAdjustments()
         Debug.Write(wxString::Format("  fl %d => %d, px %.3fu => %.3fu, bin %d => %d\n",
                                      pFrame->GetFocalLength(), GetFocalLength(),
                                      pCamera->GetCameraPixelSize(), GetPixelSize(),
-                                     pCamera->Binning, GetBinning()));
+                                     pCamera->EffectiveBinning(), GetBinning() * GetSwBinning()));
 
         ScopeConfigDialogCtrlSet *cfgset = static_cast<ScopeConfigDialogCtrlSet *>(m_pScopeCtrlSet);
         int oldStepSize = cfgset->GetCalStepSizeCtrlValue();
@@ -594,6 +594,11 @@ int AdvancedDialog::GetBinning()
     return m_pCameraCtrlSet ? m_pCameraCtrlSet->GetBinning() : 1;
 }
 
+int AdvancedDialog::GetSwBinning()
+{
+    return m_pCameraCtrlSet ? m_pCameraCtrlSet->GetSwBinning() : 1;
+}
+
 void AdvancedDialog::SetBinning(int binning)
 {
     if (m_pCameraCtrlSet)
@@ -108,6 +108,7 @@ public:
     double GetPixelSize();
     void SetPixelSize(double val);
     int GetBinning();
+    int GetSwBinning();
     void SetBinning(int binning);
     void MakeImageScaleAdjustments();
     void ResetGuidingParams();
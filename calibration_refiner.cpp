@@ -0,0 +1,270 @@
+/*
+*  calibration_refiner.cpp
+*  PHD2 Guiding
+*
+*  Copyright (c) 2026 openphdguiding.org
+*  All rights reserved.
+*
+*  This source code is distributed under the following "BSD" license
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*    Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+*    Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the
+*     documentation and/or other materials provided with the distribution.
+*    Neither the name of openphdguiding.org nor the names of its
+*     contributors may be used to endorse or promote products derived from
+*     this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#include "phd.h"
+
+static const double PriorRelError = 0.3;       // uncertainty of the calibration rates, relative
+static const double RateRandomWalk = 0.0005;   // per sample, relative to the calibration rate
+static const double DriftPrior = 1.0;          // pixels per frame
+static const double DriftRandomWalk = 0.02;    // pixels per frame, per sample
+static const double InitialNoiseVar = 0.25;    // pixels^2
+static const double MinNoiseVar = 0.0025;      // pixels^2
+static const double NoiseAveraging = 0.05;
+static const double MinSignal = 6.0;           // expected response relative to the displacement noise
+static const double OutlierSigmas = 5.0;
+static const unsigned int MaxOutliers = 5;     // consecutive rejected responses before the estimate is considered diverged
+static const unsigned int MinSamples = 10;
+static const double MaxRelError = 0.05;        // uncertainty at which an estimate is used
+static const double MinRelChange = 0.08;       // smallest change of a response vector worth applying
+static const double MinChangeSigmas = 4.0;     // same, in standard deviations of the estimate
+static const double MaxRateRatio = 3.0;        // plausible range of the rates around the calibration
+static const double MinOrthogonality = 0.5;    // sin of the smallest plausible angle between the axes
+
+CalibrationRefiner::CalibrationRefiner()
+{
+    m_initialized = false;
+    m_samples = 0;
+    m_outliers = 0;
+    Restart();
+}
+
+void CalibrationRefiner::Reset(const CalibrationEstimate& prior)
+{
+    m_prior = prior;
+
+    // a pulse correcting a positive offset moves the star back along the calibration angle
+    m_theta[0][0] = -prior.xRate * cos(prior.xAngle);
+    m_theta[1][0] = -prior.xRate * sin(prior.xAngle);
+    m_theta[0][1] = -prior.yRate * cos(prior.yAngle);
+    m_theta[1][1] = -prior.yRate * sin(prior.yAngle);
+    m_theta[0][2] = 0.0;
+    m_theta[1][2] = 0.0;
+
+    m_maxVar[0] = PriorRelError * PriorRelError * prior.xRate * prior.xRate;
+    m_maxVar[1] = PriorRelError * PriorRelError * prior.yRate * prior.yRate;
+    m_maxVar[2] = DriftPrior * DriftPrior;
+
+    for (int i = 0; i < PARAMS; i++)
+        for (int j = 0; j < PARAMS; j++)
+            m_P[i][j] = i == j ? m_maxVar[i] : 0.0;
+
+    m_noiseVar = InitialNoiseVar;
+    m_samples = 0;
+    m_outliers = 0;
+    m_initialized = true;
+
+    Restart();
+}
+
+void CalibrationRefiner::Restart()
+{
+    m_position.Invalidate();
+    for (int i = 0; i < 2; i++)
+    {
+        m_pending[i] = 0.0;
+        m_carry[i] = 0.0;
+    }
+}
+
+void CalibrationRefiner::AddPulses(double raPulse, double decPulse)
+{
+    m_pending[0] += raPulse;
+    m_pending[1] += decPulse;
+}
+
+bool CalibrationRefiner::AddPosition(const PHD_Point& starPos, double raSeen, double decSeen)
+{
+    if (!m_initialized || !starPos.IsValid())
+    {
+        Restart();
+        return false;
+    }
+
+    // pulses that show up on this frame
+    double seen[2] = { raSeen, decSeen };
+    double pulse[2];
+    for (int i = 0; i < 2; i++)
+    {
+        pulse[i] = m_carry[i] + m_pending[i] * seen[i];
+        m_carry[i] = m_pending[i] * (1.0 - seen[i]);
+        m_pending[i] = 0.0;
+    }
+
+    bool updated = false;
+
+    if (m_position.IsValid())
+    {
+        double target[2] = { starPos.X - m_position.X, starPos.Y - m_position.Y };
+        double response[2];
+        for (int r = 0; r < 2; r++)
+            response[r] = m_theta[r][0] * pulse[0] + m_theta[r][1] * pulse[1];
+
+        if (hypot(response[0], response[1]) >= MinSignal * sqrt(m_noiseVar))
+        {
+            double phi[PARAMS] = { pulse[0], pulse[1], 1.0 };
+            updated = Update(phi, target);
+            if (updated)
+            {
+                ++m_samples;
+                m_outliers = 0;
+            }
+            else
+                ++m_outliers;
+        }
+        else
+        {
+            // take the small response as known and use the displacement for the drift
+            double phi[PARAMS] = { 0.0, 0.0, 1.0 };
+            for (int r = 0; r < 2; r++)
+                target[r] -= response[r];
+            Update(phi, target);
+        }
+    }
+
+    m_position.SetXY(starPos.X, starPos.Y);
+
+    return updated;
+}
+
+bool CalibrationRefiner::Update(const double phi[PARAMS], const double target[2])
+{
+    double Pphi[PARAMS];
+    double phiPphi = 0.0;
+    for (int i = 0; i < PARAMS; i++)
+    {
+        Pphi[i] = 0.0;
+        for (int j = 0; j < PARAMS; j++)
+            Pphi[i] += m_P[i][j] * phi[j];
+        phiPphi += phi[i] * Pphi[i];
+    }
+
+    double err[2];
+    for (int r = 0; r < 2; r++)
+    {
+        err[r] = target[r];
+        for (int i = 0; i < PARAMS; i++)
+            err[r] -= m_theta[r][i] * phi[i];
+    }
+
+    double s = phiPphi + m_noiseVar;
+    double meanSq = (err[0] * err[0] + err[1] * err[1]) / 2.0;
+
+    if (meanSq > OutlierSigmas * OutlierSigmas * s)
+        return false;
+
+    // the innovation variance is the parameter uncertainty plus the measurement noise
+    m_noiseVar += NoiseAveraging * (std::max(meanSq - phiPphi, MinNoiseVar) - m_noiseVar);
+
+    double gain[PARAMS];
+    for (int i = 0; i < PARAMS; i++)
+        gain[i] = Pphi[i] / s;
+
+    for (int r = 0; r < 2; r++)
+        for (int i = 0; i < PARAMS; i++)
+            m_theta[r][i] += gain[i] * err[r];
+
+    for (int i = 0; i < PARAMS; i++)
+        for (int j = 0; j < PARAMS; j++)
+            m_P[i][j] -= gain[i] * Pphi[j];
+
+    double walk[PARAMS] = {
+        RateRandomWalk * m_prior.xRate,
+        RateRandomWalk * m_prior.yRate,
+        DriftRandomWalk,
+    };
+    for (int i = 0; i < PARAMS; i++)
+    {
+        for (int j = 0; j < i; j++)
+            m_P[i][j] = m_P[j][i] = (m_P[i][j] + m_P[j][i]) / 2.0;
+        m_P[i][i] = std::min(m_P[i][i] + walk[i] * walk[i], m_maxVar[i]);
+    }
+
+    return true;
+}
+
+void CalibrationRefiner::GetEstimate(CalibrationEstimate *est) const
+{
+    est->xRate = hypot(m_theta[0][0], m_theta[1][0]);
+    est->xAngle = atan2(-m_theta[1][0], -m_theta[0][0]);
+    est->yRate = hypot(m_theta[0][1], m_theta[1][1]);
+    est->yAngle = atan2(-m_theta[1][1], -m_theta[0][1]);
+}
+
+double CalibrationRefiner::RelativeError(GuideAxis axis) const
+{
+    int col = axis == GUIDE_RA ? 0 : 1;
+    double rate = hypot(m_theta[0][col], m_theta[1][col]);
+    return rate > 0.0 ? sqrt(m_P[col][col]) / rate : PriorRelError;
+}
+
+double CalibrationRefiner::Confidence(GuideAxis axis) const
+{
+    if (!m_initialized)
+        return 0.0;
+    return std::max(0.0, std::min(1.0, 1.0 - RelativeError(axis) / PriorRelError));
+}
+
+bool CalibrationRefiner::IsImprovement(GuideAxis axis, double rate, double angle) const
+{
+    if (!m_initialized || m_samples < MinSamples || Diverged() || RelativeError(axis) > MaxRelError)
+        return false;
+
+    int col = axis == GUIDE_RA ? 0 : 1;
+    double dx = m_theta[0][col] + rate * cos(angle);
+    double dy = m_theta[1][col] + rate * sin(angle);
+
+    double rateEst = hypot(m_theta[0][col], m_theta[1][col]);
+
+    return hypot(dx, dy) > std::max(MinChangeSigmas * sqrt(m_P[col][col]), MinRelChange * rateEst);
+}
+
+bool CalibrationRefiner::Diverged() const
+{
+    if (!m_initialized)
+        return false;
+
+    if (m_outliers >= MaxOutliers)
+        return true;
+
+    CalibrationEstimate est;
+    GetEstimate(&est);
+
+    if (est.xRate < m_prior.xRate / MaxRateRatio || est.xRate > m_prior.xRate * MaxRateRatio ||
+        est.yRate < m_prior.yRate / MaxRateRatio || est.yRate > m_prior.yRate * MaxRateRatio)
+    {
+        return true;
+    }
+
+    return RelativeError(GUIDE_RA) <= MaxRelError && RelativeError(GUIDE_DEC) <= MaxRelError &&
+        fabs(sin(est.xAngle - est.yAngle)) < MinOrthogonality;
+}
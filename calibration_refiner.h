@@ -0,0 +1,115 @@
+/*
+*  calibration_refiner.h
+*  PHD2 Guiding
+*
+*  Copyright (c) 2026 openphdguiding.org
+*  All rights reserved.
+*
+*  This source code is distributed under the following "BSD" license
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*    Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+*    Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the
+*     documentation and/or other materials provided with the distribution.
+*    Neither the name of openphdguiding.org nor the names of its
+*     contributors may be used to endorse or promote products derived from
+*     this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#ifndef CALIBRATION_REFINER_H_INCLUDED
+#define CALIBRATION_REFINER_H_INCLUDED
+
+// Rates (pixels per unit of guide pulse) and angles (radians) of the star motion
+// produced by RA and Dec guide pulses, as in Calibration
+struct CalibrationEstimate
+{
+    double xRate;
+    double yRate;
+    double xAngle;
+    double yAngle;
+};
+
+// Refines the calibration from the guide pulses and the star response while guiding.
+//
+// A pulse on either axis moves the star by the pulse amount times a response vector
+// (the rate along the calibration angle, reversed since a pulse corrects an offset).
+// The star displacement between two guide frames is the response to the pulses sent
+// in between plus a drift. The two response vectors and the drift are tracked with
+// recursive least squares in its Kalman form, starting from the calibration with a
+// small random walk on the parameters so that the estimate can follow slow changes.
+//
+// Guide pulses are computed from the measured star position, so the response to a
+// pulse that merely corrects measurement noise is correlated with that noise and
+// would bias the rates. Only displacements where the expected response clearly
+// stands out from the noise, such as the recovery after a dither, update the
+// response vectors; the others update the drift.
+class CalibrationRefiner
+{
+    enum { PARAMS = 3 };        // RA response, Dec response, drift
+
+    CalibrationEstimate m_prior;
+    double m_theta[2][PARAMS];  // rows: camera x, camera y
+    double m_P[PARAMS][PARAMS];
+    double m_maxVar[PARAMS];    // prior variances, the limit for the parameter random walk
+    double m_noiseVar;          // variance of the displacement noise, pixels^2
+
+    PHD_Point m_position;       // star position on the previous frame
+    double m_pending[2];        // pulses sent since the last frame
+    double m_carry[2];          // part of earlier pulses not yet seen on a frame
+
+    unsigned int m_samples;     // samples that updated the response since Reset()
+    unsigned int m_outliers;    // consecutive rejected response samples
+    bool m_initialized;
+
+    bool Update(const double phi[PARAMS], const double target[2]);
+
+public:
+    CalibrationRefiner();
+
+    // start over from the given calibration
+    void Reset(const CalibrationEstimate& prior);
+    // mark the estimate out of date; the owner calls Reset() before the next use
+    void Invalidate() { m_initialized = false; }
+    bool IsInitialized() const { return m_initialized; }
+    // keep the estimate but forget the measurement history, e.g. after a dither
+    void Restart();
+
+    // record the pulses sent after the most recent offset, signed amounts in the
+    // units of the calibration rates; positive pulses correct a positive mount offset
+    void AddPulses(double raPulse, double decPulse);
+    // record the star position measured on a new frame along with the fraction of the
+    // most recent pulse on each axis that completed in time to show up on it; returns
+    // true if the response estimate was updated
+    bool AddPosition(const PHD_Point& starPos, double raSeen, double decSeen);
+
+    void GetEstimate(CalibrationEstimate *est) const;
+    const CalibrationEstimate& Prior() const { return m_prior; }
+    // one-sigma relative uncertainty of the rate (and, in radians, of the angle) of an axis
+    double RelativeError(GuideAxis axis) const;
+    // 0 (no better than the calibration) to 1 (exact)
+    double Confidence(GuideAxis axis) const;
+    // true if the estimate of an axis is confident and differs from the given values
+    // by more than its uncertainty
+    bool IsImprovement(GuideAxis axis, double rate, double angle) const;
+    // true if the estimate is no longer consistent with the measurements or has left
+    // the plausible range around the calibration
+    bool Diverged() const;
+    unsigned int SampleCount() const { return m_samples; }
+};
+
+#endif // CALIBRATION_REFINER_H_INCLUDED
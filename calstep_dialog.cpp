@@ -72,6 +72,8 @@ CalstepDialog::CalstepDialog(wxWindow *parent, int focalLength, double pixelSize
     m_iFocalLength = focalLength;
     m_fPixelSize = pixelSize;
     m_binning = binning;
+    // the binning choice is the camera's own binning; software binning scales the image further
+    m_swBinning = pFrame->pAdvancedDialog ? pFrame->pAdvancedDialog->GetSwBinning() : 1;
     m_fGuideSpeed = (float) pConfig->Profile.GetDouble ("/CalStepCalc/GuideSpeed", Scope::DEFAULT_MOUNT_GUIDE_SPEED);
     m_calibrationDistance = pConfig->Profile.GetInt("/scope/CalibrationDistance", DEFAULT_DISTANCE);
 
@@ -250,7 +252,7 @@ void CalstepDialog::OnSpinCtrlDouble(wxSpinDoubleEvent& evt)
 
 void CalstepDialog::OnReset(wxCommandEvent& evt)
 {
-    int bestDistance = GetCalibrationDistance(m_iFocalLength, m_pPixelSize->GetValue(), m_binningChoice->GetSelection() + 1);
+    int bestDistance = GetCalibrationDistance(m_iFocalLength, m_pPixelSize->GetValue(), (m_binningChoice->GetSelection() + 1) * m_swBinning);
     m_pDistance->SetValue(bestDistance);
     m_pNumSteps->SetValue(DEFAULT_STEPS);
     DoRecalc();
@@ -284,7 +286,7 @@ void CalstepDialog::DoRecalc(void)
             m_status->SetLabel(wxEmptyString);
 
             // Spin controls enforce numeric ranges
-            GetCalibrationStepSize(m_iFocalLength, m_fPixelSize, m_binning, m_fGuideSpeed, m_iNumSteps,
+            GetCalibrationStepSize(m_iFocalLength, m_fPixelSize, m_binning * m_swBinning, m_fGuideSpeed, m_iNumSteps,
                 m_dDeclination, m_calibrationDistance, &m_fImageScale, &m_iStepSize);
 
             m_bValidResult = true;
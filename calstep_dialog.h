@@ -63,6 +63,7 @@ private:
     double m_fGuideSpeed;
     int m_iNumSteps;
     int m_binning;
+    int m_swBinning;
     double m_fImageScale;
     int m_iStepSize;
     bool m_bValidResult;
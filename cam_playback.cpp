@@ -0,0 +1,605 @@
+/*
+*  cam_playback.cpp
+*  PHD2 Guiding
+*
+*  Copyright (c) 2026 openphdguiding.org
+*  All rights reserved.
+*
+*  This source code is distributed under the following "BSD" license
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*    Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+*    Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the
+*     documentation and/or other materials provided with the distribution.
+*    Neither the name of openphdguiding.org nor the names of its
+*     contributors may be used to endorse or promote products derived from
+*     this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#include "phd.h"
+
+#if defined(PLAYBACK_CAMERA)
+
+#include "cam_playback.h"
+
+#include <wx/dir.h>
+#include <deque>
+
+static const unsigned int DefaultCacheFrames = 8;
+
+// One frame of the recording: an image HDU of a FITS file, or a plane of a FITS cube
+struct PlaybackFrameRef
+{
+    wxString path;
+    int hdu;            // 1-based
+    long plane;         // 1-based, 1 for a 2-D image
+};
+
+// A decoded frame in the cache
+struct PlaybackFrame
+{
+    usImage img;
+    unsigned int index;     // position in the recording
+    wxRect area;            // area that was decoded, empty for the whole frame
+    bool error;
+};
+
+// Reads frames, keeping the FITS file open while consecutive frames come from it
+class PlaybackDecoder
+{
+    fitsfile *m_fptr;
+    wxString m_path;
+    std::vector<unsigned short> m_buf;
+
+public:
+    PlaybackDecoder() : m_fptr(nullptr) { }
+    ~PlaybackDecoder() { Close(); }
+
+    void Close();
+    // decodes just the given area of the frame when it is not empty; returns true on error
+    bool Read(const PlaybackFrameRef& ref, const wxRect& area, usImage& img);
+};
+
+void PlaybackDecoder::Close()
+{
+    if (m_fptr)
+    {
+        PHD_fits_close_file(m_fptr);
+        m_fptr = nullptr;
+    }
+    m_path.clear();
+}
+
+bool PlaybackDecoder::Read(const PlaybackFrameRef& ref, const wxRect& area, usImage& img)
+{
+    int status = 0;
+
+    if (!m_fptr || ref.path != m_path)
+    {
+        Close();
+        if (PHD_fits_open_diskfile(&m_fptr, ref.path, READONLY, &status))
+        {
+            Debug.Write(wxString::Format("Playback: cannot open %s, status %d\n", ref.path, status));
+            m_fptr = nullptr;
+            return true;
+        }
+        m_path = ref.path;
+    }
+
+    int hdutype;
+    int naxis = 0;
+    long naxes[3] = { 0, 0, 1 };
+    if (fits_movabs_hdu(m_fptr, ref.hdu, &hdutype, &status) || hdutype != IMAGE_HDU ||
+        fits_get_img_dim(m_fptr, &naxis, &status) || naxis < 2 || naxis > 3 ||
+        fits_get_img_size(m_fptr, naxis, naxes, &status))
+    {
+        Debug.Write(wxString::Format("Playback: %s HDU %d is not a usable image\n", ref.path, ref.hdu));
+        return true;
+    }
+
+    wxRect frame(0, 0, (int) naxes[0], (int) naxes[1]);
+
+    if (img.Init(frame.GetSize()))
+        return true;
+
+    wxRect rect(area);
+    if (!rect.IsEmpty())
+        rect.Intersect(frame);
+
+    if (rect.IsEmpty() || rect == frame)
+    {
+        // the whole frame, straight into the image
+        long fpixel[3] = { 1, 1, ref.plane };
+        if (fits_read_pix(m_fptr, TUSHORT, fpixel, img.NPixels, nullptr, img.ImageData, nullptr, &status))
+            return true;
+    }
+    else
+    {
+        long fpixel[3] = { rect.GetLeft() + 1, rect.GetTop() + 1, ref.plane };
+        long lpixel[3] = { rect.GetRight() + 1, rect.GetBottom() + 1, ref.plane };
+        long inc[3] = { 1, 1, 1 };
+        m_buf.resize(rect.width * rect.height);
+        if (fits_read_subset(m_fptr, TUSHORT, fpixel, lpixel, inc, nullptr, &m_buf[0], nullptr, &status))
+            return true;
+
+        img.Clear();
+        const unsigned short *src = &m_buf[0];
+        for (int y = 0; y < rect.height; y++, src += rect.width)
+            memcpy(&img.Pixel(rect.x, rect.y + y), src, rect.width * sizeof(unsigned short));
+        img.Subframe = rect;
+    }
+
+    return false;
+}
+
+class CameraPlayback;
+
+// Decodes the frames ahead of the guider into the camera's cache
+class PlaybackPrefetchThread : public wxThread
+{
+    CameraPlayback *m_cam;
+    PlaybackDecoder m_decoder;
+
+public:
+    PlaybackPrefetchThread(CameraPlayback *cam) : wxThread(wxTHREAD_JOINABLE), m_cam(cam) { }
+    ExitCode Entry() override;
+};
+
+class CameraPlayback : public GuideCamera
+{
+    friend class PlaybackPrefetchThread;
+
+    std::vector<PlaybackFrameRef> m_frames;
+    wxString m_source;
+    bool m_maxRate;             // deliver frames as fast as they are requested instead of at the exposure duration
+    bool m_loop;
+    unsigned int m_cacheFrames;
+    wxByte m_bpp;
+
+    // cache shared with the prefetch thread
+    wxMutex m_lock;
+    wxCondition m_cond;
+    std::deque<PlaybackFrame *> m_cache;    // decoded frames in playback order
+    std::vector<PlaybackFrame *> m_spare;
+    unsigned int m_nextDecode;              // index of the next frame to decode, m_frames.size() at the end
+    wxRect m_decodeArea;                    // area to decode, the subframe of the latest capture
+    bool m_stop;
+
+    PlaybackPrefetchThread *m_thread;
+    PlaybackDecoder m_decoder;              // for frames the cache could not supply
+
+    bool Scan(const wxString& source);
+    void StartPrefetch();
+    void StopPrefetch();
+    void LoadSettings();
+
+public:
+    CameraPlayback();
+    ~CameraPlayback();
+
+    bool Connect(const wxString& camId) override;
+    bool Disconnect() override;
+    void ShowPropertyDialog() override;
+    bool HasNonGuiCapture() override { return true; }
+    wxByte BitsPerPixel() override { return m_bpp; }
+    bool Capture(int duration, usImage& img, int options, const wxRect& subframe) override;
+};
+
+CameraPlayback::CameraPlayback()
+    :
+    m_maxRate(false),
+    m_loop(true),
+    m_cacheFrames(DefaultCacheFrames),
+    m_bpp(16),
+    m_cond(m_lock),
+    m_nextDecode(0),
+    m_stop(false),
+    m_thread(nullptr)
+{
+    Connected = false;
+    Name = _T("File Playback");
+    HasSubframes = true;
+    PropertyDialogType = PROPDLG_ANY;
+}
+
+CameraPlayback::~CameraPlayback()
+{
+    StopPrefetch();
+}
+
+void CameraPlayback::LoadSettings()
+{
+    m_source = pConfig->Profile.GetString("/camera/playback/Source", wxEmptyString);
+    m_maxRate = pConfig->Profile.GetBoolean("/camera/playback/MaxRate", false);
+
+    {
+        wxMutexLocker lck(m_lock);
+        m_loop = pConfig->Profile.GetBoolean("/camera/playback/Loop", true);
+        m_cacheFrames = (unsigned int) wxMax(pConfig->Profile.GetInt("/camera/playback/CacheFrames", DefaultCacheFrames), 1);
+        // resume a playback that had stopped at the end
+        if (m_loop && m_nextDecode >= m_frames.size())
+            m_nextDecode = 0;
+    }
+    m_cond.Broadcast();
+}
+
+// lists the frames of a directory of FITS files or of a single FITS file
+bool CameraPlayback::Scan(const wxString& source)
+{
+    m_frames.clear();
+
+    if (wxDirExists(source))
+    {
+        // one frame per file, so that a long recording is not opened file by file here
+        wxArrayString files;
+        wxDir::GetAllFiles(source, &files, "*.fit*", wxDIR_FILES);
+        files.Sort();
+        for (const wxString& file : files)
+            m_frames.push_back({ file, 1, 1 });
+    }
+    else
+    {
+        fitsfile *fptr;
+        int status = 0;
+        if (PHD_fits_open_diskfile(&fptr, source, READONLY, &status))
+            return true;
+
+        int nhdus = 0;
+        fits_get_num_hdus(fptr, &nhdus, &status);
+        for (int hdu = 1; hdu <= nhdus; hdu++)
+        {
+            int hdutype, naxis = 0;
+            long naxes[3] = { 0, 0, 1 };
+            status = 0;
+            if (fits_movabs_hdu(fptr, hdu, &hdutype, &status) || hdutype != IMAGE_HDU ||
+                fits_get_img_dim(fptr, &naxis, &status) || naxis < 2 || naxis > 3 ||
+                fits_get_img_size(fptr, naxis, naxes, &status))
+            {
+                continue;   // e.g. an empty primary HDU ahead of the image extensions
+            }
+            for (long plane = 1; plane <= naxes[2]; plane++)
+                m_frames.push_back({ source, hdu, plane });
+        }
+
+        PHD_fits_close_file(fptr);
+    }
+
+    if (m_frames.empty())
+        return true;
+
+    // frame size and pixel depth come from the first frame
+    usImage first;
+    if (m_decoder.Read(m_frames[0], wxRect(), first))
+        return true;
+    FullSize = first.Size;
+
+    fitsfile *fptr;
+    int status = 0;
+    int bitpix = USHORT_IMG;
+    int hdutype;
+    if (!PHD_fits_open_diskfile(&fptr, m_frames[0].path, READONLY, &status))
+    {
+        fits_movabs_hdu(fptr, m_frames[0].hdu, &hdutype, &status);
+        fits_get_img_type(fptr, &bitpix, &status);
+        PHD_fits_close_file(fptr);
+    }
+    m_bpp = bitpix == BYTE_IMG ? 8 : 16;
+
+    return false;
+}
+
+bool CameraPlayback::Connect(const wxString& camId)
+{
+    LoadSettings();
+
+    if (m_source.IsEmpty())
+    {
+        ShowPropertyDialog();
+        if (m_source.IsEmpty())
+            return true;
+    }
+
+    if (Scan(m_source))
+        return CamConnectFailed(wxString::Format(_("No FITS frames could be read from %s"), m_source));
+
+    Debug.Write(wxString::Format("Playback: %u frames from %s, size %dx%d, %d bpp\n", (unsigned int) m_frames.size(),
+                                 m_source, FullSize.GetWidth(), FullSize.GetHeight(), m_bpp));
+
+    StartPrefetch();
+
+    Connected = true;
+    return false;
+}
+
+bool CameraPlayback::Disconnect()
+{
+    StopPrefetch();
+    m_decoder.Close();
+    Connected = false;
+    return false;
+}
+
+void CameraPlayback::StartPrefetch()
+{
+    StopPrefetch();
+
+    m_nextDecode = 0;
+    m_decodeArea = wxRect();
+    m_stop = false;
+
+    m_thread = new PlaybackPrefetchThread(this);
+    if (m_thread->Run() != wxTHREAD_NO_ERROR)
+    {
+        // frames will be decoded on demand
+        Debug.Write("Playback: could not start prefetch thread\n");
+        delete m_thread;
+        m_thread = nullptr;
+    }
+}
+
+void CameraPlayback::StopPrefetch()
+{
+    if (m_thread)
+    {
+        {
+            wxMutexLocker lck(m_lock);
+            m_stop = true;
+        }
+        m_cond.Broadcast();
+        m_thread->Wait();
+        delete m_thread;
+        m_thread = nullptr;
+    }
+
+    for (PlaybackFrame *frame : m_cache)
+        delete frame;
+    m_cache.clear();
+    for (PlaybackFrame *frame : m_spare)
+        delete frame;
+    m_spare.clear();
+}
+
+wxThread::ExitCode PlaybackPrefetchThread::Entry()
+{
+    CameraPlayback *cam = m_cam;
+    unsigned int const count = cam->m_frames.size();
+
+    while (!TestDestroy())
+    {
+        PlaybackFrame *frame;
+        unsigned int index;
+        wxRect area;
+
+        {
+            wxMutexLocker lck(cam->m_lock);
+
+            while (!cam->m_stop && (cam->m_cache.size() >= cam->m_cacheFrames || cam->m_nextDecode >= count))
+                cam->m_cond.Wait();
+
+            if (cam->m_stop)
+                break;
+
+            index = cam->m_nextDecode;
+            area = cam->m_decodeArea;
+
+            if (++cam->m_nextDecode >= count && cam->m_loop)
+                cam->m_nextDecode = 0;
+
+            if (cam->m_spare.empty())
+                frame = new PlaybackFrame();
+            else
+            {
+                frame = cam->m_spare.back();
+                cam->m_spare.pop_back();
+            }
+        }
+
+        frame->index = index;
+        frame->area = area;
+        frame->error = m_decoder.Read(cam->m_frames[index], area, frame->img);
+
+        {
+            wxMutexLocker lck(cam->m_lock);
+            cam->m_cache.push_back(frame);
+        }
+        cam->m_cond.Broadcast();
+    }
+
+    return nullptr;
+}
+
+bool CameraPlayback::Capture(int duration, usImage& img, int options, const wxRect& subframeArg)
+{
+    enum { WAIT_SLICE_MS = 100 };
+
+    wxStopWatch swatch;
+
+    wxRect subframe(subframeArg);
+    if (!UseSubframes)
+        subframe = wxRect();
+
+    PlaybackFrame *frame = nullptr;
+
+    {
+        wxMutexLocker lck(m_lock);
+
+        // frames decoded from now on only need the current subframe
+        m_decodeArea = subframe;
+
+        while (m_cache.empty())
+        {
+            if (!m_thread || (m_nextDecode >= m_frames.size() && !m_loop))
+                break;
+            if (WorkerThread::InterruptRequested())
+                return true;
+            m_cond.WaitTimeout(WAIT_SLICE_MS);
+        }
+
+        if (!m_cache.empty())
+        {
+            frame = m_cache.front();
+            m_cache.pop_front();
+        }
+        else if (!m_thread && m_nextDecode < m_frames.size())
+        {
+            // no prefetch thread, decode on demand
+            frame = new PlaybackFrame();
+            frame->index = m_nextDecode;
+            frame->error = true;
+            if (++m_nextDecode >= m_frames.size() && m_loop)
+                m_nextDecode = 0;
+        }
+    }
+    m_cond.Broadcast();
+
+    if (!frame)
+    {
+        pFrame->Alert(_("End of the recording"));
+        return true;
+    }
+
+    // a frame decoded before the subframe changed may not cover the new subframe
+    bool covered = frame->area.IsEmpty() || (!subframe.IsEmpty() && frame->area.Contains(subframe));
+    if (frame->error || !covered)
+    {
+        if (m_decoder.Read(m_frames[frame->index], subframe, frame->img))
+        {
+            unsigned int index = frame->index;
+            delete frame;
+            DisconnectWithAlert(wxString::Format(_("Cannot read frame %u of the recording"), index + 1), NO_RECONNECT);
+            return true;
+        }
+    }
+
+    if (img.Init(frame->img.Size))
+    {
+        delete frame;
+        DisconnectWithAlert(CAPT_FAIL_MEMORY);
+        return true;
+    }
+    img.SwapImageData(frame->img);
+    img.Subframe = frame->img.Subframe;
+
+    {
+        wxMutexLocker lck(m_lock);
+        m_spare.push_back(frame);
+    }
+
+    if (options & CAPTURE_SUBTRACT_DARK)
+        SubtractDark(img);
+
+    // pace the playback at the exposure duration
+    if (!m_maxRate)
+    {
+        long remaining = duration - swatch.Time();
+        if (remaining > 0 && WorkerThread::MilliSleep(remaining, WorkerThread::INT_ANY))
+            return true;
+    }
+
+    return false;
+}
+
+class PlaybackSetupDialog : public wxDialog
+{
+    wxTextCtrl *m_source;
+    wxCheckBox *m_maxRate;
+    wxCheckBox *m_loop;
+    wxSpinCtrl *m_cacheFrames;
+
+public:
+    PlaybackSetupDialog(wxWindow *parent);
+};
+
+PlaybackSetupDialog::PlaybackSetupDialog(wxWindow *parent)
+    : wxDialog(parent, wxID_ANY, _("File Playback Setup"))
+{
+    wxBoxSizer *vSizer = new wxBoxSizer(wxVERTICAL);
+
+    wxBoxSizer *srcSizer = new wxBoxSizer(wxHORIZONTAL);
+    m_source = new wxTextCtrl(this, wxID_ANY, pConfig->Profile.GetString("/camera/playback/Source", wxEmptyString),
+                              wxDefaultPosition, wxSize(StringWidth(this, "M") * 40, -1));
+    m_source->SetToolTip(_("A folder of FITS files, played in name order, or a FITS file holding several frames as image extensions or as a cube"));
+    wxButton *fileBtn = new wxButton(this, wxID_ANY, _("File..."));
+    wxButton *dirBtn = new wxButton(this, wxID_ANY, _("Folder..."));
+    srcSizer->Add(new wxStaticText(this, wxID_ANY, _("Recording")), wxSizerFlags().Center().Border(wxRIGHT, 5));
+    srcSizer->Add(m_source, wxSizerFlags(1).Center());
+    srcSizer->Add(fileBtn, wxSizerFlags().Center().Border(wxLEFT, 5));
+    srcSizer->Add(dirBtn, wxSizerFlags().Center().Border(wxLEFT, 5));
+    vSizer->Add(srcSizer, wxSizerFlags().Expand().Border(wxALL, 10));
+
+    fileBtn->Bind(wxEVT_BUTTON, [this](wxCommandEvent&) {
+        wxFileDialog dlg(this, _("Choose a FITS file"), wxEmptyString, wxEmptyString,
+                         _("FITS files (*.fit;*.fits;*.fts)|*.fit;*.fits;*.fts"), wxFD_OPEN | wxFD_FILE_MUST_EXIST);
+        if (dlg.ShowModal() == wxID_OK)
+            m_source->SetValue(dlg.GetPath());
+    });
+    dirBtn->Bind(wxEVT_BUTTON, [this](wxCommandEvent&) {
+        wxDirDialog dlg(this, _("Choose a folder of FITS files"), m_source->GetValue(), wxDD_DIR_MUST_EXIST);
+        if (dlg.ShowModal() == wxID_OK)
+            m_source->SetValue(dlg.GetPath());
+    });
+
+    m_maxRate = new wxCheckBox(this, wxID_ANY, _("Play at maximum rate"));
+    m_maxRate->SetValue(pConfig->Profile.GetBoolean("/camera/playback/MaxRate", false));
+    m_maxRate->SetToolTip(_("Deliver each frame as soon as it is requested instead of after the exposure duration"));
+    vSizer->Add(m_maxRate, wxSizerFlags().Border(wxLEFT | wxRIGHT | wxBOTTOM, 10));
+
+    m_loop = new wxCheckBox(this, wxID_ANY, _("Start over at the end of the recording"));
+    m_loop->SetValue(pConfig->Profile.GetBoolean("/camera/playback/Loop", true));
+    vSizer->Add(m_loop, wxSizerFlags().Border(wxLEFT | wxRIGHT | wxBOTTOM, 10));
+
+    wxBoxSizer *cacheSizer = new wxBoxSizer(wxHORIZONTAL);
+    m_cacheFrames = pFrame->MakeSpinCtrl(this, wxID_ANY, wxEmptyString, wxDefaultPosition, wxSize(StringWidth(this, "0000") + 30, -1),
+                                         wxSP_ARROW_KEYS, 1, 100, pConfig->Profile.GetInt("/camera/playback/CacheFrames", DefaultCacheFrames));
+    m_cacheFrames->SetToolTip(_("Number of frames decoded ahead of the guider"));
+    cacheSizer->Add(new wxStaticText(this, wxID_ANY, _("Frames to read ahead")), wxSizerFlags().Center().Border(wxRIGHT, 5));
+    cacheSizer->Add(m_cacheFrames, wxSizerFlags().Center());
+    vSizer->Add(cacheSizer, wxSizerFlags().Border(wxLEFT | wxRIGHT | wxBOTTOM, 10));
+
+    vSizer->Add(CreateButtonSizer(wxOK | wxCANCEL), wxSizerFlags().Expand().Border(wxALL, 10));
+
+    Bind(wxEVT_BUTTON, [this](wxCommandEvent& evt) {
+        pConfig->Profile.SetString("/camera/playback/Source", m_source->GetValue());
+        pConfig->Profile.SetBoolean("/camera/playback/MaxRate", m_maxRate->GetValue());
+        pConfig->Profile.SetBoolean("/camera/playback/Loop", m_loop->GetValue());
+        pConfig->Profile.SetInt("/camera/playback/CacheFrames", m_cacheFrames->GetValue());
+        evt.Skip();
+    }, wxID_OK);
+
+    SetSizerAndFit(vSizer);
+}
+
+void CameraPlayback::ShowPropertyDialog()
+{
+    PlaybackSetupDialog dlg(wxGetActiveWindow());
+    if (dlg.ShowModal() != wxID_OK)
+        return;
+
+    // a new recording is used from the next connection, the other settings apply now
+    wxString source = m_source;
+    LoadSettings();
+    if (Connected)
+        m_source = source;
+}
+
+GuideCamera *PlaybackCameraFactory::MakePlaybackCamera()
+{
+    return new CameraPlayback();
+}
+
+#endif // PLAYBACK_CAMERA
@@ -717,7 +717,8 @@ bool Camera_ZWO::Capture(int duration, usImage& img, int options, const wxRect&
         binning_change = true;
     }
 
-    if (img.Init(FullSize))
+    // 8-bit frames stay 8-bit in img.ImageData8; consumers that need 16-bit pixels widen on demand
+    if (m_bpp == 8 ? img.Init8(FullSize) : img.Init(FullSize))
     {
         DisconnectWithAlert(CAPT_FAIL_MEMORY);
         return true;
@@ -795,7 +796,8 @@ bool Camera_ZWO::Capture(int duration, usImage& img, int options, const wxRect&
     int poll = wxMin(duration, 100);
 
     unsigned char *const buffer =
-        m_bpp == 16 && !useSubframe ? (unsigned char *) img.ImageData : (unsigned char *) m_buffer;
+        useSubframe ? (unsigned char *) m_buffer :
+        m_bpp == 8 ? img.ImageData8 : (unsigned char *) img.ImageData;
 
     if (m_mode == CM_VIDEO)
     {
@@ -924,9 +926,8 @@ bool Camera_ZWO::Capture(int duration, usImage& img, int options, const wxRect&
             for (int y = 0; y < subframe.height; y++)
             {
                 const unsigned char *src = buffer + (y + subframePos.y) * frame.width + subframePos.x;
-                unsigned short *dst = img.ImageData + (y + subframe.y) * FullSize.GetWidth() + subframe.x;
-                for (int x = 0; x < subframe.width; x++)
-                    *dst++ = *src++;
+                unsigned char *dst = img.ImageData8 + (y + subframe.y) * FullSize.GetWidth() + subframe.x;
+                memcpy(dst, src, subframe.width);
             }
         }
         else
@@ -942,15 +943,7 @@ bool Camera_ZWO::Capture(int duration, usImage& img, int options, const wxRect&
     }
     else
     {
-        if (m_bpp == 8)
-        {
-            for (unsigned int i = 0; i < img.NPixels; i++)
-                img.ImageData[i] = buffer[i];
-        }
-        else
-        {
-            // 16-bit mode and no subframe: data is already in img.ImageData
-        }
+        // no subframe: data is already in img.ImageData8 or img.ImageData
     }
 
     if (options & CAPTURE_SUBTRACT_DARK)
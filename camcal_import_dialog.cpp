@@ -219,10 +219,16 @@ void CamCalImportDialog::OnOk(wxCommandEvent& evt)
 
     if (m_sourceDarksProfileId != -1)
     {
-        sourceName = MyFrame::DarkLibFileName(m_sourceDarksProfileId);
-        destName = MyFrame::DarkLibFileName(m_thisProfileId);
+        // the source library is either dark frames or a dark-current model; the copy replaces
+        // whichever kind this profile had
+        bool model = wxFileExists(MyFrame::DarkModelFileName(m_sourceDarksProfileId));
+        sourceName = model ? MyFrame::DarkModelFileName(m_sourceDarksProfileId) : MyFrame::DarkLibFileName(m_sourceDarksProfileId);
+        destName = model ? MyFrame::DarkModelFileName(m_thisProfileId) : MyFrame::DarkLibFileName(m_thisProfileId);
+        wxString otherName = model ? MyFrame::DarkLibFileName(m_thisProfileId) : MyFrame::DarkModelFileName(m_thisProfileId);
         if (wxCopyFile(sourceName, destName, true))
         {
+            if (wxFileExists(otherName))
+                wxRemoveFile(otherName);
             Debug.Write(wxString::Format("Dark library imported from profile %d to profile %d\n", m_sourceDarksProfileId, m_thisProfileId));
             if (!bpmLoaded)
             {
@@ -41,9 +41,15 @@
 
 #include <wx/stdpaths.h>
 
+#include <algorithm>
+
 static const int DefaultGuideCameraGain = 95;
 static const int DefaultGuideCameraTimeoutMs = 15000;
 static const bool DefaultUseSubframes = false;
+static const bool DefaultUseStreaming = false;
+static const int DefaultStreamStackFrames = 1;
+static const int MaxStreamStackFrames = 50;
+static const bool DefaultStreamStackAlign = true;
 static const int DefaultReadDelay = 150;
 
 const double GuideCamera::UnknownPixelSize = 0.0;
@@ -70,6 +76,10 @@ wxSize UNDEFINED_FRAME_SIZE = wxSize(0, 0);
 # include "cam_LELXUSBwebcam.h"
 #endif
 
+#if defined (PLAYBACK_CAMERA)
+# include "cam_playback.h"
+#endif
+
 #if defined (QGUIDE)
 # include "cam_qguide.h"
 #endif
@@ -208,8 +218,13 @@ GuideCamera::GuideCamera()
     ShutterClosed = false;
     HasSubframes = false;
     HasCooler = false;
+    HasStreaming = false;
     FullSize = UNDEFINED_FRAME_SIZE;
     UseSubframes = pConfig->Profile.GetBoolean("/camera/UseSubframes", DefaultUseSubframes);
+    UseStreaming = pConfig->Profile.GetBoolean("/camera/UseStreaming", DefaultUseStreaming);
+    StreamStackFrames = wxMin(wxMax(pConfig->Profile.GetInt("/camera/StreamStackFrames", DefaultStreamStackFrames), 1),
+        MaxStreamStackFrames);
+    StreamStackAlign = pConfig->Profile.GetBoolean("/camera/StreamStackAlign", DefaultStreamStackAlign);
     ReadDelay = pConfig->Profile.GetInt("/camera/ReadDelay", DefaultReadDelay);
     GuideCameraGain = pConfig->Profile.GetInt("/camera/gain", DefaultGuideCameraGain);
     m_timeoutMs = pConfig->Profile.GetInt("/camera/TimeoutMs", DefaultGuideCameraTimeoutMs);
@@ -218,12 +233,26 @@ GuideCamera::GuideCamera()
     m_pixelSize = GetProfilePixelSize();
     MaxBinning = 1;
     Binning = pConfig->Profile.GetInt("/camera/binning", 1);
+    int swBinning;
+    SoftwareBinMode swBinMode;
+    SwBinningFromOpt(SwBinningOpt(pConfig->Profile.GetInt("/camera/sw_binning", 1),
+        (SoftwareBinMode) pConfig->Profile.GetInt("/camera/sw_binning_mode", SWBIN_SUM)), &swBinning, &swBinMode);
+    SwBinning = swBinning;
+    SwBinMode = swBinMode;
     CurrentDarkFrame = nullptr;
     CurrentDefectMap = nullptr;
+    CurrentDarkModel = nullptr;
+    m_darkMedianFrame = nullptr;
+    m_darkMedianExpDur = 0;
+    m_darkMedian = 0;
+    m_streamThread = nullptr;
+    m_streamExposure = 0;
+    m_streamSettingsChanged = false;
 }
 
 GuideCamera::~GuideCamera()
 {
+    StopStreaming();
     ClearDarks();
     ClearDefectMap();
 }
@@ -362,6 +391,9 @@ wxArrayString GuideCamera::GuideCameraList()
 #if defined (SIMULATOR)
     CameraList.Add(_T("Simulator"));
 #endif
+#if defined (PLAYBACK_CAMERA)
+    CameraList.Add(_T("File Playback"));
+#endif
 
 #if defined (NEB_SBIG)
     CameraList.Add(_T("Guide chip on SBIG cam in Nebulosity"));
@@ -408,6 +440,10 @@ GuideCamera *GuideCamera::Factory(const wxString& choice)
             pReturn = nullptr;
         else if (choice == _T("Simulator"))
             pReturn = GearSimulator::MakeCamSimulator();
+#if defined (PLAYBACK_CAMERA)
+        else if (choice == _T("File Playback"))
+            pReturn = PlaybackCameraFactory::MakePlaybackCamera();
+#endif
 #if defined (ATIK16)
         else if (choice.StartsWith("Atik 16 series"))
         {
@@ -693,6 +729,66 @@ bool GuideCamera::SetBinning(int binning)
     return false;
 }
 
+struct SwBinChoice
+{
+    int binning;
+    SoftwareBinMode mode;
+    const char *label;
+};
+
+static const SwBinChoice SwBinChoices[] =
+{
+    { 1, SWBIN_SUM, wxTRANSLATE("None") },
+    { 2, SWBIN_SUM, wxTRANSLATE("2x2 sum") },
+    { 2, SWBIN_AVERAGE, wxTRANSLATE("2x2 average") },
+    { 3, SWBIN_SUM, wxTRANSLATE("3x3 sum") },
+    { 3, SWBIN_AVERAGE, wxTRANSLATE("3x3 average") },
+    { 4, SWBIN_SUM, wxTRANSLATE("4x4 sum") },
+    { 4, SWBIN_AVERAGE, wxTRANSLATE("4x4 average") },
+    { 2, SWBIN_SUPERPIXEL, wxTRANSLATE("2x2 Bayer superpixel") },
+};
+
+void GuideCamera::GetSwBinningOpts(wxArrayString *opts)
+{
+    for (unsigned int i = 0; i < WXSIZEOF(SwBinChoices); i++)
+        opts->Add(wxGetTranslation(SwBinChoices[i].label));
+}
+
+void GuideCamera::SwBinningFromOpt(int idx, int *binning, SoftwareBinMode *mode)
+{
+    if (idx < 0 || idx >= (int) WXSIZEOF(SwBinChoices))
+        idx = 0;
+    *binning = SwBinChoices[idx].binning;
+    *mode = SwBinChoices[idx].mode;
+}
+
+// index of the software binning choice, or 0 (no binning) if the combination is not offered
+int GuideCamera::SwBinningOpt(int binning, SoftwareBinMode mode)
+{
+    for (unsigned int i = 0; i < WXSIZEOF(SwBinChoices); i++)
+    {
+        if (SwBinChoices[i].binning == binning && (binning == 1 || SwBinChoices[i].mode == mode))
+            return i;
+    }
+    return 0;
+}
+
+bool GuideCamera::SetSwBinning(int binning, SoftwareBinMode mode)
+{
+    int swBinning;
+    SoftwareBinMode swBinMode;
+    SwBinningFromOpt(SwBinningOpt(binning, mode), &swBinning, &swBinMode);
+
+    Debug.Write(wxString::Format("camera: set software binning = %d mode = %d\n", swBinning, swBinMode));
+
+    SwBinning = swBinning;
+    SwBinMode = swBinMode;
+    pConfig->Profile.SetInt("/camera/sw_binning", swBinning);
+    pConfig->Profile.SetInt("/camera/sw_binning_mode", swBinMode);
+
+    return false;
+}
+
 void GuideCamera::SetTimeoutMs(int ms)
 {
     static const int MIN_TIMEOUT_MS = 5000;
@@ -826,7 +922,10 @@ void CameraConfigDialogPane::LayoutControls(GuideCamera *pCamera, BrainCtrlIdMap
         pDetailsSizer->Add(GetSizerCtrl(CtrlMap, AD_szGain));
         pDetailsSizer->Add(GetSizerCtrl(CtrlMap, AD_szCameraTimeout));
         pDetailsSizer->Add(GetSizerCtrl(CtrlMap, AD_szBinning));
+        pDetailsSizer->Add(GetSizerCtrl(CtrlMap, AD_szSwBinning));
         pDetailsSizer->Add(GetSingleCtrl(CtrlMap, AD_cbUseSubFrames), wxSizerFlags().Border(wxTOP, 3));
+        pDetailsSizer->Add(GetSingleCtrl(CtrlMap, AD_cbUseStreaming), wxSizerFlags().Border(wxTOP, 3));
+        pDetailsSizer->Add(GetSizerCtrl(CtrlMap, AD_szStreamStack));
         pDetailsSizer->Add(GetSizerCtrl(CtrlMap, AD_szCooler));
         if (pCamera->HasDelayParam)
             pDetailsSizer->Add(GetSizerCtrl(CtrlMap, AD_szDelay));
@@ -865,7 +964,10 @@ CameraConfigDialogCtrlSet* GuideCamera::GetConfigDlgCtrlSet(wxWindow *pParent, G
 
 CameraConfigDialogCtrlSet::CameraConfigDialogCtrlSet(wxWindow *pParent, GuideCamera *pCamera, AdvancedDialog *pAdvancedDialog, BrainCtrlIdMap& CtrlMap)
     : ConfigDialogCtrlSet(pParent, pAdvancedDialog, CtrlMap),
-      m_pUseSubframes(nullptr)
+      m_pUseSubframes(nullptr),
+      m_pUseStreaming(nullptr),
+      m_streamStackFrames(nullptr),
+      m_streamStackAlign(nullptr)
 {
     int textWidth = StringWidth(_T("0000"));
     assert(pCamera);
@@ -875,6 +977,23 @@ CameraConfigDialogCtrlSet::CameraConfigDialogCtrlSet(wxWindow *pParent, GuideCam
     m_pUseSubframes = new wxCheckBox(GetParentWindow(AD_cbUseSubFrames), wxID_ANY, _("Use Subframes"));
     AddCtrl(CtrlMap, AD_cbUseSubFrames, m_pUseSubframes, _("Check to only download subframes (ROIs). Sub-frame size is equal to search region size."));
 
+    // Streaming
+    m_pUseStreaming = new wxCheckBox(GetParentWindow(AD_cbUseStreaming), wxID_ANY, _("Use Streaming"));
+    AddCtrl(CtrlMap, AD_cbUseStreaming, m_pUseStreaming, _("Check to capture guide frames continuously in video mode, avoiding the setup time of each exposure. Not available on all cameras."));
+
+    // Sub-exposure stacking
+    wxWindow *stackParent = GetParentWindow(AD_szStreamStack);
+    m_streamStackFrames = NewSpinnerInt(stackParent, textWidth, DefaultStreamStackFrames, 1, MaxStreamStackFrames, 1);
+    wxSizer *stackSizer = new wxBoxSizer(wxHORIZONTAL);
+    stackSizer->Add(MakeLabeledControl(AD_szStreamStack, _("Stack frames"), m_streamStackFrames,
+        _("Number of streamed sub-exposures averaged into each guide frame, 1 = no stacking. The exposure duration "
+          "is the length of one sub-exposure, so a short exposure with several frames averages out seeing without "
+          "saturating the guide star.")), wxSizerFlags().Align(wxALIGN_CENTER_VERTICAL));
+    m_streamStackAlign = new wxCheckBox(stackParent, wxID_ANY, _("Align"));
+    m_streamStackAlign->SetToolTip(_("Check to shift-align the sub-exposures on the guide star before stacking them"));
+    stackSizer->Add(m_streamStackAlign, wxSizerFlags().Align(wxALIGN_CENTER_VERTICAL).Border(wxLEFT, 10));
+    AddGroup(CtrlMap, AD_szStreamStack, stackSizer);
+
     // Pixel size
     m_pPixelSize = NewSpinnerDouble(GetParentWindow(AD_szPixelSize), textWidth, m_pCamera->GetCameraPixelSize(), 0.0, 99.9, 0.1,
         _("Guide camera un-binned pixel size in microns. Used with the guide telescope focal length to display guiding error in arc-seconds."));
@@ -907,6 +1026,16 @@ CameraConfigDialogCtrlSet::CameraConfigDialogCtrlSet(wxWindow *pParent, GuideCam
         wxSize(width + 35, -1), opts);
     AddLabeledCtrl(CtrlMap, AD_szBinning, _("Binning"), m_binning, _("Camera pixel binning"));
 
+    // Software binning
+    opts.Clear();
+    GuideCamera::GetSwBinningOpts(&opts);
+    width = StringArrayWidth(opts);
+    m_swBinning = new wxChoice(GetParentWindow(AD_szSwBinning), wxID_ANY, wxDefaultPosition,
+        wxSize(width + 35, -1), opts);
+    AddLabeledCtrl(CtrlMap, AD_szSwBinning, _("Software binning"), m_swBinning,
+        _("Pixel binning done by PHD2 after the camera's own binning, for cameras that cannot bin (or bin further) in hardware. "
+          "Use the Bayer superpixel for color cameras."));
+
     // Delay parameter
     if (m_pCamera->HasDelayParam)
     {
@@ -991,6 +1120,19 @@ void CameraConfigDialogCtrlSet::LoadValues()
         m_pUseSubframes->Enable(false);
     }
 
+    if (m_pCamera->HasStreaming)
+    {
+        m_pUseStreaming->SetValue(m_pCamera->UseStreaming);
+        m_streamStackFrames->SetValue(m_pCamera->StreamStackFrames);
+        m_streamStackAlign->SetValue(m_pCamera->StreamStackAlign);
+    }
+    else
+    {
+        m_pUseStreaming->Enable(false);
+        m_streamStackFrames->Enable(false);
+        m_streamStackAlign->Enable(false);
+    }
+
     if (m_pCamera->HasGainControl)
     {
         m_pCameraGain->SetValue(m_pCamera->GetCameraGain());
@@ -1013,6 +1155,9 @@ void CameraConfigDialogCtrlSet::LoadValues()
     else
         m_binning->Enable(false);
 
+    m_swBinning->Select(GuideCamera::SwBinningOpt(m_pCamera->SwBinning, m_pCamera->SwBinMode));
+    m_swBinning->Enable(!pFrame->pGuider || !pFrame->pGuider->IsCalibratingOrGuiding());
+
     m_timeoutVal->SetValue(m_pCamera->GetTimeoutMs() / 1000);
 
     bool saturationByADU = m_pCamera->IsSaturationByADU();
@@ -1170,6 +1315,23 @@ void CameraConfigDialogCtrlSet::UnloadValues()
         pConfig->Profile.SetBoolean("/camera/UseSubframes", m_pCamera->UseSubframes);
     }
 
+    if (m_pCamera->HasStreaming)
+    {
+        bool useStreaming = m_pUseStreaming->GetValue();
+        if (useStreaming != m_pCamera->UseStreaming)
+        {
+            // the worker thread may be capturing from the stream, so leave it to stop the
+            // stream before its next capture
+            m_pCamera->UseStreaming = useStreaming;
+            m_pCamera->m_streamSettingsChanged = true;
+        }
+        pConfig->Profile.SetBoolean("/camera/UseStreaming", m_pCamera->UseStreaming);
+        m_pCamera->StreamStackFrames = m_streamStackFrames->GetValue();
+        pConfig->Profile.SetInt("/camera/StreamStackFrames", m_pCamera->StreamStackFrames);
+        m_pCamera->StreamStackAlign = m_streamStackAlign->GetValue();
+        pConfig->Profile.SetBoolean("/camera/StreamStackAlign", m_pCamera->StreamStackAlign);
+    }
+
     if (m_pCamera->HasGainControl)
     {
         m_pCamera->SetCameraGain(m_pCameraGain->GetValue());
@@ -1177,13 +1339,18 @@ void CameraConfigDialogCtrlSet::UnloadValues()
 
     if (m_binning)
     {
-        int oldBin = m_pCamera->Binning;
-        int newBin = m_binning->GetSelection() + 1;
+        int oldBin = m_pCamera->EffectiveBinning();
+        int newBin = GetBinning() * GetSwBinning();
         if (oldBin != newBin)
             pFrame->pAdvancedDialog->MakeImageScaleAdjustments();           // Do this now to preserve old (device value) and new (UI value) for scale adjustment
         m_pCamera->SetBinning(m_binning->GetSelection() + 1);
     }
 
+    int swBinning;
+    SoftwareBinMode swBinMode;
+    GuideCamera::SwBinningFromOpt(m_swBinning->GetSelection(), &swBinning, &swBinMode);
+    m_pCamera->SetSwBinning(swBinning, swBinMode);
+
     m_pCamera->SetTimeoutMs(m_timeoutVal->GetValue() * 1000);
 
     if (m_pCamera->HasDelayParam)
@@ -1279,6 +1446,14 @@ void CameraConfigDialogCtrlSet::SetBinning(int binning)
         m_binning->Select(binning - 1);
 }
 
+int CameraConfigDialogCtrlSet::GetSwBinning()
+{
+    int swBinning;
+    SoftwareBinMode swBinMode;
+    GuideCamera::SwBinningFromOpt(m_swBinning->GetSelection(), &swBinning, &swBinMode);
+    return swBinning;
+}
+
 void GuideCamera::GetBinningOpts(int maxBin, wxArrayString *opts)
 {
     for (int i = 1; i <= maxBin; i++)
@@ -1288,10 +1463,12 @@ void GuideCamera::GetBinningOpts(int maxBin, wxArrayString *opts)
 wxString GuideCamera::GetSettingsSummary()
 {
     int darkDur;
+    bool darkModel;
 
     { // lock scope
         wxCriticalSectionLocker lck(DarkFrameLock);
         darkDur = CurrentDarkFrame ? CurrentDarkFrame->ImgExpDur : 0;
+        darkModel = CurrentDarkModel != nullptr;
     } // lock scope
 
     // return a loggable summary of current camera settings
@@ -1301,17 +1478,36 @@ wxString GuideCamera::GetSettingsSummary()
     else
         pixelSizeStr = wxString::Format(_("%0.1f um"), m_pixelSize);
 
-    return wxString::Format("Camera = %s%s%s%s, full size = %d x %d, %s, %s, pixel size = %s\n",
+    return wxString::Format("Camera = %s%s%s%s, full size = %d x %d%s%s, %s, %s, pixel size = %s\n",
                             Name,
                             HasGainControl ? wxString::Format(", gain = %d", GuideCameraGain) : "",
                             HasDelayParam ? wxString::Format(", delay = %d", ReadDelay) : "",
                             HasPortNum ? wxString::Format(", port = 0x%hx", Port) : "",
                             FullSize.GetWidth(), FullSize.GetHeight(),
-                            darkDur ? wxString::Format("have dark, dark dur = %d", darkDur) : "no dark",
+                            SwBinning > 1 ? wxString::Format(", software binning = %d (%s)", (int) SwBinning,
+                                SwBinMode == SWBIN_SUM ? "sum" : SwBinMode == SWBIN_AVERAGE ? "average" : "superpixel") : "",
+                            HasStreaming && UseStreaming && StreamStackFrames > 1 ?
+                                wxString::Format(", stacking %d streamed frames%s", StreamStackFrames, StreamStackAlign ? " aligned" : "") : "",
+                            darkModel ? wxString("have dark model") :
+                                darkDur ? wxString::Format("have dark, dark dur = %d", darkDur) : wxString("no dark"),
                             CurrentDefectMap ? "defect map in use" : "no defect map",
                             pixelSizeStr);
 }
 
+// exposure durations of all darks, both held in memory and in the dark library, in ascending order
+static void DarkExposures(const ExposureImgMap& darks, const DarkLibraryFile& darkLib, std::vector<int> *exposures)
+{
+    exposures->clear();
+    for (const auto& dark : darks)
+        exposures->push_back(dark.first);
+    for (const auto& entry : darkLib.Entries())
+    {
+        if (darks.find(entry.first) == darks.end())
+            exposures->push_back(entry.first);
+    }
+    std::sort(exposures->begin(), exposures->end());
+}
+
 void GuideCamera::AddDark(usImage *dark)
 {
     int const expdur = dark->ImgExpDur;
@@ -1329,6 +1525,12 @@ void GuideCamera::AddDark(usImage *dark)
             delete prior;
         }
 
+        // the new dark supersedes a library dark with the same exposure duration
+        if (CurrentDarkFrame && DarkLib.IsMapped(CurrentDarkFrame) && CurrentDarkFrame->ImgExpDur == expdur)
+            CurrentDarkFrame = dark;
+
+        m_darkMedianFrame = nullptr;
+
     } // lock scope
 
     Darks[expdur] = dark;
@@ -1341,13 +1543,40 @@ void GuideCamera::SelectDark(int exposureDuration)
 
     wxCriticalSectionLocker lck(DarkFrameLock);
 
-    CurrentDarkFrame = 0;
-    for (ExposureImgMap::const_iterator it = Darks.begin(); it != Darks.end(); ++it)
+    CurrentDarkFrame = nullptr;
+    m_darkMedianFrame = nullptr;
+
+    std::vector<int> exposures;
+    DarkExposures(Darks, DarkLib, &exposures);
+
+    int selected = -1;
+    for (auto exp : exposures)
     {
-        CurrentDarkFrame = it->second;
-        if (it->first >= exposureDuration)
+        selected = exp;
+        if (exp >= exposureDuration)
             break;
     }
+
+    if (selected == -1)
+        return;
+
+    // darks held in memory take precedence over library darks with the same exposure
+    ExposureImgMap::const_iterator it = Darks.find(selected);
+    if (it != Darks.end())
+        CurrentDarkFrame = it->second;
+    else
+    {
+        // only the selected library dark is mapped; the OS pages it in as it is used
+        CurrentDarkFrame = DarkLib.MapDark(selected);
+        if (!CurrentDarkFrame)
+            Debug.Write(wxString::Format("SelectDark: could not map library dark exposure = %d\n", selected));
+    }
+}
+
+void GuideCamera::GetDarkExposures(std::vector<int> *exposures)
+{
+    wxCriticalSectionLocker lck(DarkFrameLock);
+    DarkExposures(Darks, DarkLib, exposures);
 }
 
 void GuideCamera::GetDarklibProperties(int *pNumDarks, double *pMinExp, double *pMaxExp)
@@ -1356,18 +1585,17 @@ void GuideCamera::GetDarklibProperties(int *pNumDarks, double *pMinExp, double *
     double maxExp = -9999.0;
     int ct = 0;
 
-    { // lock scope
-        wxCriticalSectionLocker lck(DarkFrameLock);
+    std::vector<int> exposures;
+    GetDarkExposures(&exposures);
 
-        for (auto it = Darks.begin(); it != Darks.end(); ++it)
-        {
-            if (it->first < minExp)
-                minExp = it->first;
-            if (it->first > maxExp)
-                maxExp = it->first;
-            ++ct;
-        }
-    } // lock scope
+    for (auto exp : exposures)
+    {
+        if (exp < minExp)
+            minExp = exp;
+        if (exp > maxExp)
+            maxExp = exp;
+        ++ct;
+    }
 
     *pNumDarks = ct;
     *pMinExp = minExp;
@@ -1402,7 +1630,43 @@ void GuideCamera::ClearDarks()
         delete it->second;
         Darks.erase(it);
     }
+    DarkLib.Close();
     CurrentDarkFrame = nullptr;
+    delete CurrentDarkModel;
+    CurrentDarkModel = nullptr;
+    m_darkMedianFrame = nullptr;
+}
+
+void GuideCamera::SetDarkModel(DarkModel *model)
+{
+    ClearDarks();
+
+    wxCriticalSectionLocker lck(DarkFrameLock);
+    CurrentDarkModel = model;
+}
+
+bool GuideCamera::HaveDarks()
+{
+    wxCriticalSectionLocker lck(DarkFrameLock);
+    return CurrentDarkFrame || CurrentDarkModel;
+}
+
+bool GuideCamera::OpenDarkLibrary(const wxString& fitsFile)
+{
+    // release the current darks first since the cache file may be rebuilt
+    ClearDarks();
+
+    wxString cacheFile = DarkLibraryFile::CacheFileName(fitsFile);
+
+    if (!DarkLibraryFile::IsCurrent(cacheFile, fitsFile))
+    {
+        Debug.Write(wxString::Format("building dark library cache %s\n", cacheFile));
+        if (DarkLibraryFile::BuildFromFits(fitsFile, cacheFile))
+            return true;
+    }
+
+    wxCriticalSectionLocker lck(DarkFrameLock);
+    return DarkLib.Open(cacheFile);
 }
 
 void GuideCamera::SubtractDark(usImage& img)
@@ -1417,9 +1681,30 @@ void GuideCamera::SubtractDark(usImage& img)
     {
         RemoveDefects(img, *CurrentDefectMap);
     }
+    else if (CurrentDarkModel)
+    {
+        // the dark for this exposure is synthesized during the subtraction
+        if (CurrentDarkModel != m_darkMedianFrame || img.ImgExpDur != m_darkMedianExpDur || img.Subframe != m_darkMedianSubframe)
+        {
+            m_darkMedian = CurrentDarkModel->Median(img.ImgExpDur, img.Subframe);
+            m_darkMedianFrame = CurrentDarkModel;
+            m_darkMedianExpDur = img.ImgExpDur;
+            m_darkMedianSubframe = img.Subframe;
+        }
+        Subtract(img, *CurrentDarkModel, m_darkMedian);
+    }
     else if (CurrentDarkFrame)
     {
-        Subtract(img, *CurrentDarkFrame);
+        // the dark's median only needs to be recomputed when the dark or the subframe changes
+        if (CurrentDarkFrame != m_darkMedianFrame || CurrentDarkFrame->ImgExpDur != m_darkMedianExpDur ||
+            img.Subframe != m_darkMedianSubframe)
+        {
+            m_darkMedian = DarkMedian(*CurrentDarkFrame, img.Subframe);
+            m_darkMedianFrame = CurrentDarkFrame;
+            m_darkMedianExpDur = CurrentDarkFrame->ImgExpDur;
+            m_darkMedianSubframe = img.Subframe;
+        }
+        Subtract(img, *CurrentDarkFrame, m_darkMedian);
     }
 }
 
@@ -1464,6 +1749,7 @@ void GuideCamera::DisconnectWithAlert(CaptureFailType type)
 
 void GuideCamera::DisconnectWithAlert(const wxString& msg, ReconnectType reconnect)
 {
+    StopStreaming();
     Disconnect();
 
     // CAUTION: this function can be called from the worker thread, so
@@ -1489,13 +1775,242 @@ void GuideCamera::InitCapture()
 
 bool GuideCamera::Capture(GuideCamera *camera, int duration, usImage& img, int captureOptions, const wxRect& subframe)
 {
+    if (camera->SwBinning > 1)
+        return camera->CaptureSwBinned(duration, img, captureOptions, subframe);
+
+    return camera->CaptureNative(duration, img, captureOptions, subframe);
+}
+
+bool GuideCamera::CaptureNative(int duration, usImage& img, int captureOptions, const wxRect& subframe)
+{
+    // the streaming settings changed in the camera config dialog; the stream is restarted below
+    // if it is still used
+    if (m_streamSettingsChanged)
+    {
+        m_streamSettingsChanged = false;
+        StopStreaming();
+    }
+
+    // dark frames are always taken with individual exposures
+    if (HasStreaming && UseStreaming && !ShutterClosed)
+        return CaptureFromStream(duration, img, captureOptions, subframe);
+
     img.InitImgStartTime();
-    img.BitsPerPixel = camera->BitsPerPixel();
+    img.BitsPerPixel = BitsPerPixel();
     img.ImgExpDur = duration;
-    bool err = camera->Capture(duration, img, captureOptions, subframe);
+    img.ImgStackCnt = 1;
+    bool err = Capture(duration, img, captureOptions, subframe);
     return err;
 }
 
+bool GuideCamera::CaptureSwBinned(int duration, usImage& img, int captureOptions, const wxRect& subframe)
+{
+    int b = SwBinning;
+
+    // Darks and defect maps are taken through this same path, so they are binned too and
+    // are applied to the binned frame rather than by the driver. A superpixel replaces
+    // the driver's debayering.
+    int nativeOptions = captureOptions & ~CAPTURE_SUBTRACT_DARK;
+    if (SwBinMode == SWBIN_SUPERPIXEL)
+        nativeOptions &= ~CAPTURE_RECON;
+
+    wxRect nativeSubframe;
+    if (!subframe.IsEmpty())
+    {
+        nativeSubframe = wxRect(subframe.x * b, subframe.y * b, subframe.width * b, subframe.height * b);
+        nativeSubframe.Intersect(wxRect(FullSize));
+    }
+
+    if (CaptureNative(duration, m_swBinRaw, nativeOptions, nativeSubframe))
+        return true;
+
+    if (BinPixels(img, m_swBinRaw, b, SwBinMode != SWBIN_SUM))
+    {
+        DisconnectWithAlert(CAPT_FAIL_MEMORY);
+        return true;
+    }
+
+    if (captureOptions & CAPTURE_SUBTRACT_DARK)
+        SubtractDark(img);
+
+    return false;
+}
+
+bool GuideCamera::CaptureFromStream(int duration, usImage& img, int captureOptions, const wxRect& subframe)
+{
+    // (re)start the stream if the exposure changed or the requested subframe is not covered
+    // by the streamed area. An empty stream subframe means the full frame is being streamed.
+    bool covered = m_streamSubframe.IsEmpty() || (!subframe.IsEmpty() && m_streamSubframe.Contains(subframe));
+
+    if (!IsStreaming() || duration != m_streamExposure || !covered)
+    {
+        StopStreaming();
+        if (StartStreaming(duration, subframe))
+            return true;
+    }
+
+    return GetStreamFrame(img, captureOptions, duration + GetTimeoutMs());
+}
+
+bool GuideCamera::StartStreaming(int exposureMs, const wxRect& subframe)
+{
+    if (!HasStreaming || !Connected)
+        return true;
+
+    if (IsStreaming())
+        StopStreaming();
+
+    Debug.Write(wxString::Format("Start streaming, exposure = %d subframe = (%d,%d,%d,%d)\n", exposureMs,
+        subframe.x, subframe.y, subframe.width, subframe.height));
+
+    // buffers are allocated at full size so a change of subframe does not reallocate them
+    wxSize size = FullSize == UNDEFINED_FRAME_SIZE ? wxSize(0, 0) : FullSize;
+    if (m_streamRing.Init(size))
+    {
+        DisconnectWithAlert(CAPT_FAIL_MEMORY);
+        return true;
+    }
+
+    if (OnStartStreaming(exposureMs, subframe))
+    {
+        Debug.Write("Camera failed to start streaming\n");
+        return true;
+    }
+
+    m_streamExposure = exposureMs;
+    m_streamSubframe = subframe;
+
+    m_streamThread = new CameraStreamThread(this, &m_streamRing, exposureMs);
+    if (m_streamThread->Run() != wxTHREAD_NO_ERROR)
+    {
+        Debug.Write("Could not start camera stream thread\n");
+        delete m_streamThread;
+        m_streamThread = nullptr;
+        OnStopStreaming();
+        return true;
+    }
+
+    return false;
+}
+
+void GuideCamera::StopStreaming()
+{
+    if (!m_streamThread)
+        return;
+
+    Debug.Write(wxString::Format("Stop streaming, frames = %u dropped = %u\n", m_streamRing.PublishedFrames(),
+        m_streamRing.DroppedFrames()));
+
+    m_streamRing.Interrupt();
+
+    if (wxThread::This() == m_streamThread)
+    {
+        // called by the driver on the stream thread; the thread exits on its own once it sees
+        // the interrupt and is cleaned up by the next StopStreaming call from another thread
+        return;
+    }
+
+    m_streamThread->Wait();
+    delete m_streamThread;
+    m_streamThread = nullptr;
+
+    OnStopStreaming();
+
+    m_streamRing.Reset();
+}
+
+bool GuideCamera::GetStreamFrame(usImage& img, int captureOptions, int timeoutMs)
+{
+    if (!IsStreaming())
+        return true;
+
+    unsigned int prevDropped = m_streamRing.DroppedFrames();
+    unsigned int prevStale = m_streamRing.StaleFrames();
+
+    if (m_streamRing.TakeLatest(img, timeoutMs))
+        return true;
+
+    if (StreamStackFrames > 1 && StackStreamFrames(img, timeoutMs))
+        return true;
+
+    unsigned int dropped = m_streamRing.DroppedFrames();
+    if (dropped != prevDropped)
+        Debug.Write(wxString::Format("Stream: %u frame(s) dropped, total %u\n", dropped - prevDropped, dropped));
+    unsigned int stale = m_streamRing.StaleFrames();
+    if (stale != prevStale)
+        Debug.Write(wxString::Format("Stream: %u frame(s) exposed during a guide pulse skipped\n", stale - prevStale));
+
+    if (captureOptions & CAPTURE_SUBTRACT_DARK)
+        SubtractDark(img);
+
+    return false;
+}
+
+// stack further sub-exposures from the stream onto the one in img
+bool GuideCamera::StackStreamFrames(usImage& img, int timeoutMs)
+{
+    m_streamStacker.Begin(img, StreamStackAlign);
+
+    while (m_streamStacker.Count() < StreamStackFrames)
+    {
+        if (m_streamRing.TakeLatest(m_streamSub, timeoutMs))
+            return true;
+        if (m_streamStacker.Add(m_streamSub))
+        {
+            Debug.Write("Stream: frame size changed, stack ends early\n");
+            break;
+        }
+    }
+
+    m_streamStacker.Finish(img);
+
+    Debug.Write(wxString::Format("Stream: stacked %d x %d ms, effective exposure %d ms over %d ms, mean shift (%d,%d)\n",
+        img.ImgStackCnt, img.ImgExpDur, img.ImgStackCnt * img.ImgExpDur, img.ImgSpanDur,
+        m_streamStacker.MeanShiftX(), m_streamStacker.MeanShiftY()));
+
+    return false;
+}
+
+unsigned int GuideCamera::StreamDroppedFrames()
+{
+    return m_streamRing.DroppedFrames();
+}
+
+void GuideCamera::DiscardStreamFramesBefore(const std::chrono::steady_clock::time_point& t)
+{
+    m_streamRing.DiscardBefore(t);
+}
+
+bool GuideCamera::OnStartStreaming(int exposureMs, const wxRect& subframe)
+{
+    return true; // streaming not supported
+}
+
+bool GuideCamera::CaptureStreamFrame(usImage& img)
+{
+    return true;
+}
+
+void GuideCamera::OnStopStreaming()
+{
+}
+
+bool GuideCamera::StreamMilliSleep(int ms)
+{
+    enum { MAX_SLEEP = 50 };
+
+    wxStopWatch swatch;
+    long elapsed = 0;
+    while (elapsed < ms)
+    {
+        if (m_streamRing.IsInterrupted())
+            return true;
+        wxMilliSleep(wxMin((long) ms - elapsed, (long) MAX_SLEEP));
+        elapsed = swatch.Time();
+    }
+    return m_streamRing.IsInterrupted();
+}
+
 bool GuideCamera::ST4HasGuideOutput()
 {
     return m_hasGuideOutput;
@@ -65,6 +65,9 @@ class CameraConfigDialogCtrlSet : public ConfigDialogCtrlSet
 {
     GuideCamera *m_pCamera;
     wxCheckBox *m_pUseSubframes;
+    wxCheckBox *m_pUseStreaming;
+    wxSpinCtrl *m_streamStackFrames;
+    wxCheckBox *m_streamStackAlign;
     wxSpinCtrl *m_pCameraGain;
     wxButton *m_resetGain;
     wxSpinCtrl *m_timeoutVal;
@@ -72,6 +75,7 @@ class CameraConfigDialogCtrlSet : public ConfigDialogCtrlSet
     wxSpinCtrl *m_pDelay;
     wxSpinCtrlDouble *m_pPixelSize;
     wxChoice *m_binning;
+    wxChoice *m_swBinning;
     wxCheckBox *m_coolerOn;
     wxSpinCtrl *m_coolerSetpt;
     wxTextCtrl *m_camSaturationADU;
@@ -90,6 +94,7 @@ public:
     void SetPixelSize(double val);
     int GetBinning();
     void SetBinning(int val);
+    int GetSwBinning();
     void OnSaturationChoiceChanged(wxCommandEvent& event);
 };
 
@@ -103,6 +108,13 @@ enum CaptureOptionBits
     CAPTURE_BPM_REVIEW = CAPTURE_SUBTRACT_DARK,
 };
 
+enum SoftwareBinMode
+{
+    SWBIN_SUM,
+    SWBIN_AVERAGE,
+    SWBIN_SUPERPIXEL,       // 2x2 average of each Bayer cell of a color sensor, in place of debayering
+};
+
 class GuideCamera : public wxMessageBoxProxy, public OnboardST4
 {
     friend class CameraConfigDialogPane;
@@ -110,6 +122,26 @@ class GuideCamera : public wxMessageBoxProxy, public OnboardST4
 
     double          m_pixelSize;
 
+    CameraFrameRing m_streamRing;
+    CameraStreamThread *m_streamThread;
+    int             m_streamExposure;
+    wxRect          m_streamSubframe;
+    StreamStacker   m_streamStacker;
+    usImage         m_streamSub;        // sub-exposure being added to a stack
+    volatile bool   m_streamSettingsChanged; // set by the config dialog, the worker thread restarts the stream
+
+    const void     *m_darkMedianFrame;  // dark frame or model, exposure and subframe that m_darkMedian was computed for
+    int             m_darkMedianExpDur;
+    wxRect          m_darkMedianSubframe;
+    unsigned short  m_darkMedian;
+
+    usImage         m_swBinRaw;         // unbinned frame from the driver when binning in software
+
+    bool CaptureNative(int duration, usImage& img, int captureOptions, const wxRect& subframe);
+    bool CaptureSwBinned(int duration, usImage& img, int captureOptions, const wxRect& subframe);
+    bool CaptureFromStream(int duration, usImage& img, int captureOptions, const wxRect& subframe);
+    bool StackStreamFrames(usImage& img, int timeoutMs);
+
 protected:
     bool            m_hasGuideOutput;
     int             m_timeoutMs;
@@ -132,15 +164,23 @@ public:
     bool            HasSubframes;
     wxByte          MaxBinning;
     wxByte          Binning;
+    wxByte          SwBinning;      // software binning applied to the frames returned by the driver
+    SoftwareBinMode SwBinMode;
     short           Port;
     int             ReadDelay;
     bool            ShutterClosed;  // false=light, true=dark
     bool            UseSubframes;
     bool            HasCooler;
+    bool            HasStreaming;   // camera can deliver frames continuously (video mode)
+    bool            UseStreaming;
+    int             StreamStackFrames;  // sub-exposures stacked into each streamed guide frame, 1 = no stacking
+    bool            StreamStackAlign;   // shift-align the sub-exposures on the guide star before stacking
 
     wxCriticalSection DarkFrameLock; // dark frames can be accessed in the main thread or the camera worker thread
     usImage        *CurrentDarkFrame;
-    ExposureImgMap  Darks; // map exposure => dark frame
+    ExposureImgMap  Darks; // map exposure => dark frame held in memory (darks not yet saved to the library)
+    DarkLibraryFile DarkLib; // dark library frames, mapped from disk when selected
+    DarkModel      *CurrentDarkModel; // dark-current model used in place of dark frames
     DefectMap      *CurrentDefectMap;
 
     static wxArrayString GuideCameraList();
@@ -178,6 +218,17 @@ public:
     void GetBinningOpts(wxArrayString *opts);
     bool SetBinning(int binning);
 
+    // Software binning, for cameras whose drivers cannot bin (or bin further) in hardware.
+    // The driver captures at its own binning and the result is binned again before dark
+    // subtraction, so darks, defect maps, subframes and the image scale all refer to the
+    // binned frame. EffectiveBinning is the binning to use for the image scale.
+    static void GetSwBinningOpts(wxArrayString *opts);
+    static void SwBinningFromOpt(int idx, int *binning, SoftwareBinMode *mode);
+    static int SwBinningOpt(int binning, SoftwareBinMode mode);
+    bool SetSwBinning(int binning, SoftwareBinMode mode);
+    int EffectiveBinning() const { return Binning * SwBinning; }
+    wxSize FrameSize() const;       // size of the frames delivered by Capture
+
     virtual void    ShowPropertyDialog() { return; }
     bool            SetCameraPixelSize(double pixel_size);
     double          GetCameraPixelSize() const;
@@ -194,11 +245,16 @@ public:
     void            SetDefectMap(DefectMap *newMap);
     void            ClearDefectMap();
     void            ClearDarks();
+    void            SetDarkModel(DarkModel *model);
+    bool            HaveDarks();
+    bool            OpenDarkLibrary(const wxString& fitsFile);
+    void            GetDarkExposures(std::vector<int> *exposures);
 
     void            SubtractDark(usImage& img);
     void            GetDarklibProperties(int *pNumDarks, double *pMinExp, double *pMaxExp);
 
-    virtual const wxSize& DarkFrameSize() { return FullSize; }
+    virtual const wxSize& NativeDarkFrameSize() { return FullSize; }
+    wxSize DarkFrameSize();         // size of the dark frames, after any software binning
 
     static double GetProfilePixelSize();
 
@@ -210,10 +266,35 @@ public:
     bool SetCameraGain(int cameraGain);
     virtual int GetDefaultCameraGain();
 
+    // When img.Rois is set on entry, subframe is the windows' bounding box and only the windows
+    // need to hold valid data. A driver that can read out several windows may read just those;
+    // others read out the whole subframe, and later processing is confined to the windows.
     virtual bool Capture(int duration, usImage& img, int captureOptions, const wxRect& subframe) = 0;
 
+    // Streaming (video mode) capture. Frames are delivered continuously by a stream thread
+    // into a small ring of pre-allocated buffers, avoiding the per-exposure setup cost of
+    // Capture(). GetStreamFrame returns the most recent frame with its start time, or with
+    // StreamStackFrames > 1 the stack of that many sub-exposures, see StreamStacker.
+    bool            StartStreaming(int exposureMs, const wxRect& subframe);
+    void            StopStreaming();
+    bool            IsStreaming() const { return m_streamThread != nullptr; }
+    bool            GetStreamFrame(usImage& img, int captureOptions, int timeoutMs);
+    unsigned int    StreamDroppedFrames();
+    // called when a guide pulse ends: frames that started exposing before then show the
+    // star still moving and are skipped
+    void            DiscardStreamFramesBefore(const std::chrono::steady_clock::time_point& t);
+
+    // Driver hooks for streaming. CaptureStreamFrame is called repeatedly on the stream
+    // thread and should block until the next frame is available; returns true on error.
+    virtual bool    OnStartStreaming(int exposureMs, const wxRect& subframe);
+    virtual bool    CaptureStreamFrame(usImage& img);
+    virtual void    OnStopStreaming();
+
 protected:
 
+    // sleep on the stream thread; returns true if the stream is being stopped
+    bool StreamMilliSleep(int ms);
+
     int GetTimeoutMs() const;
     void SetTimeoutMs(int timeoutMs);
 
@@ -241,6 +322,17 @@ inline void GuideCamera::GetBinningOpts(wxArrayString *opts)
     GetBinningOpts(MaxBinning, opts);
 }
 
+inline wxSize GuideCamera::FrameSize() const
+{
+    return wxSize(FullSize.GetWidth() / SwBinning, FullSize.GetHeight() / SwBinning);
+}
+
+inline wxSize GuideCamera::DarkFrameSize()
+{
+    const wxSize& size = NativeDarkFrameSize();
+    return wxSize(size.GetWidth() / SwBinning, size.GetHeight() / SwBinning);
+}
+
 inline double GuideCamera::GetCameraPixelSize() const
 {
     return m_pixelSize;
@@ -258,7 +350,12 @@ inline bool GuideCamera::IsSaturationByADU() const
 
 inline unsigned short GuideCamera::GetSaturationADU() const
 {
-    return m_saturationByADU ? m_saturationADU : 0;
+    if (!m_saturationByADU)
+        return 0;
+    // a summed bin saturates when all of its pixels do
+    if (SwBinning > 1 && SwBinMode == SWBIN_SUM)
+        return (unsigned short) wxMin((unsigned int) m_saturationADU * SwBinning * SwBinning, 65535U);
+    return m_saturationADU;
 }
 
 inline int GuideCamera::GetCameraGain() const
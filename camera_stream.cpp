@@ -0,0 +1,486 @@
+/*
+*  camera_stream.cpp
+*  PHD2 Guiding
+*
+*  Copyright (c) 2026 openphdguiding.org
+*  All rights reserved.
+*
+*  This source code is distributed under the following "BSD" license
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*    Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+*    Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the
+*     documentation and/or other materials provided with the distribution.
+*    Neither the name of openphdguiding.org nor the names of its
+*     contributors may be used to endorse or promote products derived from
+*     this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#include "phd.h"
+
+CameraFrameRing::CameraFrameRing()
+    :
+    m_cond(m_lock),
+    m_writeIdx(-1),
+    m_readyIdx(-1),
+    m_published(0),
+    m_dropped(0),
+    m_stale(0),
+    m_interrupted(false),
+    m_error(false)
+{
+}
+
+CameraFrameRing::~CameraFrameRing()
+{
+    for (auto buf : m_bufs)
+        delete buf;
+}
+
+bool CameraFrameRing::Init(const wxSize& frameSize, unsigned int nbufs)
+{
+    wxMutexLocker lck(m_lock);
+
+    assert(m_writeIdx == -1);
+
+    // need at least one buffer for the producer and one for the pending frame
+    nbufs = wxMax(nbufs, 2U);
+
+    while (m_bufs.size() > nbufs)
+    {
+        delete m_bufs.back();
+        m_bufs.pop_back();
+    }
+    while (m_bufs.size() < nbufs)
+        m_bufs.push_back(new usImage());
+
+    for (auto buf : m_bufs)
+    {
+        if (buf->Init(frameSize))
+            return true;
+    }
+
+    m_readyIdx = -1;
+    m_published = 0;
+    m_dropped = 0;
+    m_stale = 0;
+    m_interrupted = false;
+    m_error = false;
+
+    return false;
+}
+
+void CameraFrameRing::Reset()
+{
+    wxMutexLocker lck(m_lock);
+    m_readyIdx = -1;
+    m_published = 0;
+    m_dropped = 0;
+    m_stale = 0;
+    m_interrupted = false;
+    m_error = false;
+}
+
+usImage *CameraFrameRing::BeginFrame()
+{
+    wxMutexLocker lck(m_lock);
+
+    assert(m_writeIdx == -1);
+
+    // any buffer other than the pending frame is free since the consumer
+    // takes the pending frame by swapping buffers under the lock
+    for (int i = 0; i < (int) m_bufs.size(); i++)
+    {
+        if (i != m_readyIdx)
+        {
+            m_writeIdx = i;
+            break;
+        }
+    }
+
+    return m_bufs[m_writeIdx];
+}
+
+void CameraFrameRing::EndFrame(bool publish)
+{
+    {
+        wxMutexLocker lck(m_lock);
+
+        if (publish)
+        {
+            if (m_readyIdx != -1)
+                ++m_dropped;
+            m_readyIdx = m_writeIdx;
+            ++m_published;
+        }
+        m_writeIdx = -1;
+    }
+
+    if (publish)
+        m_cond.Broadcast();
+}
+
+void CameraFrameRing::SetError()
+{
+    {
+        wxMutexLocker lck(m_lock);
+        m_error = true;
+    }
+    m_cond.Broadcast();
+}
+
+bool CameraFrameRing::TakeLatest(usImage& img, int timeoutMs)
+{
+    enum { WAIT_SLICE_MS = 100 };
+
+    wxStopWatch swatch;
+    wxMutexLocker lck(m_lock);
+
+    while (true)
+    {
+        if (m_readyIdx != -1)
+        {
+            if (m_bufs[m_readyIdx]->ImgStartSteady >= m_notBefore)
+                break;
+            // the frame was exposed before the mount finished moving
+            m_readyIdx = -1;
+            ++m_stale;
+        }
+        if (m_interrupted || m_error)
+            return true;
+        if (WorkerThread::InterruptRequested())
+            return true;
+        long remaining = timeoutMs - swatch.Time();
+        if (remaining <= 0)
+        {
+            Debug.Write("CameraFrameRing: timed-out waiting for stream frame\n");
+            return true;
+        }
+        m_cond.WaitTimeout(wxMin(remaining, (long) WAIT_SLICE_MS));
+    }
+
+    usImage *src = m_bufs[m_readyIdx];
+
+    // hand the frame data to the caller without copying: after the swap the
+    // ring buffer holds the caller's previous data, which has the same size
+    if (src->Packed8 ? img.Init8(src->Size) : img.Init(src->Size))
+        return true;
+    img.SwapImageData(*src);
+
+    img.Subframe = src->Subframe;
+    img.ImgStartTime = src->ImgStartTime;
+    img.ImgStartSteady = src->ImgStartSteady;
+    img.ImgExpDur = src->ImgExpDur;
+    img.ImgStackCnt = src->ImgStackCnt;
+    img.ImgSpanDur = src->ImgSpanDur;
+    img.BitsPerPixel = src->BitsPerPixel;
+
+    m_readyIdx = -1;
+
+    return false;
+}
+
+void CameraFrameRing::DiscardBefore(const std::chrono::steady_clock::time_point& t)
+{
+    wxMutexLocker lck(m_lock);
+    if (t > m_notBefore)
+        m_notBefore = t;
+}
+
+void CameraFrameRing::Interrupt()
+{
+    {
+        wxMutexLocker lck(m_lock);
+        m_interrupted = true;
+    }
+    m_cond.Broadcast();
+}
+
+bool CameraFrameRing::IsInterrupted()
+{
+    wxMutexLocker lck(m_lock);
+    return m_interrupted;
+}
+
+unsigned int CameraFrameRing::PublishedFrames()
+{
+    wxMutexLocker lck(m_lock);
+    return m_published;
+}
+
+unsigned int CameraFrameRing::DroppedFrames()
+{
+    wxMutexLocker lck(m_lock);
+    return m_dropped;
+}
+
+unsigned int CameraFrameRing::StaleFrames()
+{
+    wxMutexLocker lck(m_lock);
+    return m_stale;
+}
+
+// row and column sums over the area, less their means so the background does not correlate
+template<typename T>
+static void profiles(const T *data, int stride, const wxRect& area, std::vector<double>& cols, std::vector<double>& rows)
+{
+    int const w = area.GetWidth();
+    int const h = area.GetHeight();
+
+    std::vector<unsigned int> csum(w, 0);
+    rows.resize(h);
+
+    double total = 0.0;
+    for (int r = 0; r < h; r++)
+    {
+        const T *p = data + (area.GetTop() + r) * stride + area.GetLeft();
+        unsigned int rsum = 0;
+        for (int c = 0; c < w; c++)
+        {
+            csum[c] += p[c];
+            rsum += p[c];
+        }
+        rows[r] = (double) rsum;
+        total += (double) rsum;
+    }
+
+    cols.resize(w);
+    double const cmean = total / w;
+    for (int c = 0; c < w; c++)
+        cols[c] = (double) csum[c] - cmean;
+    double const rmean = total / h;
+    for (int r = 0; r < h; r++)
+        rows[r] -= rmean;
+}
+
+// shift of cur relative to ref at the peak of their cross-correlation
+static int best_shift(const std::vector<double>& ref, const std::vector<double>& cur)
+{
+    int const n = (int) ref.size();
+    int const maxShift = wxMin((int) StreamStacker::MAX_SHIFT, n / 4);
+
+    int best = 0;
+    double bestCorr = 0.0;
+    for (int d = -maxShift; d <= maxShift; d++)
+    {
+        int const lo = wxMax(0, -d);
+        int const hi = wxMin(n, n - d);
+        double corr = 0.0;
+        for (int i = lo; i < hi; i++)
+            corr += ref[i] * cur[i + d];
+        corr /= hi - lo;
+        if (d == -maxShift || corr > bestCorr)
+        {
+            bestCorr = corr;
+            best = d;
+        }
+    }
+
+    return best;
+}
+
+// add the area of a sub-exposure shifted by (dx, dy) to the sum; pixels shifted in
+// from outside the area repeat the edge pixels
+template<typename T>
+static void accumulate(unsigned int *sum, const T *data, int stride, const wxRect& area, int dx, int dy)
+{
+    int const w = area.GetWidth();
+    int const h = area.GetHeight();
+    int const c0 = wxMax(0, -dx);
+    int const c1 = wxMin(w, w - dx);
+
+    for (int r = 0; r < h; r++, sum += w)
+    {
+        int const sr = wxMin(wxMax(r + dy, 0), h - 1);
+        const T *src = data + (area.GetTop() + sr) * stride + area.GetLeft();
+
+        for (int c = 0; c < c0; c++)
+            sum[c] += src[0];
+        // the bulk of the row is a plain loop the compiler vectorizes
+        const T *s = src + dx;
+        for (int c = c0; c < c1; c++)
+            sum[c] += s[c];
+        for (int c = c1; c < w; c++)
+            sum[c] += src[w - 1];
+    }
+}
+
+static int round_div(int a, int n)
+{
+    return a >= 0 ? (a + n / 2) / n : -((-a + n / 2) / n);
+}
+
+StreamStacker::StreamStacker()
+    :
+    m_packed8(false),
+    m_align(false),
+    m_count(0),
+    m_sumDx(0),
+    m_sumDy(0)
+{
+}
+
+void StreamStacker::Begin(const usImage& first, bool align)
+{
+    m_size = first.Size;
+    m_area = first.Subframe.IsEmpty() ? wxRect(first.Size) : first.Subframe;
+    m_packed8 = first.Packed8;
+    m_align = align && m_area.GetWidth() >= 8 && m_area.GetHeight() >= 8;
+    m_count = 1;
+    m_sumDx = m_sumDy = 0;
+    m_lastStart = first.ImgStartSteady;
+
+    m_sum.assign(m_area.GetWidth() * m_area.GetHeight(), 0);
+
+    if (m_packed8)
+    {
+        accumulate(&m_sum[0], first.ImageData8, m_size.GetWidth(), m_area, 0, 0);
+        if (m_align)
+            profiles(first.ImageData8, m_size.GetWidth(), m_area, m_refCols, m_refRows);
+    }
+    else
+    {
+        accumulate(&m_sum[0], first.ImageData, m_size.GetWidth(), m_area, 0, 0);
+        if (m_align)
+            profiles(first.ImageData, m_size.GetWidth(), m_area, m_refCols, m_refRows);
+    }
+}
+
+bool StreamStacker::Add(const usImage& sub)
+{
+    wxRect area = sub.Subframe.IsEmpty() ? wxRect(sub.Size) : sub.Subframe;
+    if (sub.Size != m_size || area != m_area || sub.Packed8 != m_packed8)
+        return true;
+
+    int dx = 0, dy = 0;
+
+    if (m_align)
+    {
+        if (m_packed8)
+            profiles(sub.ImageData8, m_size.GetWidth(), m_area, m_cols, m_rows);
+        else
+            profiles(sub.ImageData, m_size.GetWidth(), m_area, m_cols, m_rows);
+        dx = best_shift(m_refCols, m_cols);
+        dy = best_shift(m_refRows, m_rows);
+    }
+
+    if (m_packed8)
+        accumulate(&m_sum[0], sub.ImageData8, m_size.GetWidth(), m_area, dx, dy);
+    else
+        accumulate(&m_sum[0], sub.ImageData, m_size.GetWidth(), m_area, dx, dy);
+
+    ++m_count;
+    m_sumDx += dx;
+    m_sumDy += dy;
+    m_lastStart = sub.ImgStartSteady;
+
+    return false;
+}
+
+int StreamStacker::MeanShiftX() const
+{
+    return m_count ? round_div(m_sumDx, m_count) : 0;
+}
+
+int StreamStacker::MeanShiftY() const
+{
+    return m_count ? round_div(m_sumDy, m_count) : 0;
+}
+
+void StreamStacker::Finish(usImage& img)
+{
+    // the stack is written as 16-bit pixels
+    img.Widen();
+
+    int const w = m_area.GetWidth();
+    int const h = m_area.GetHeight();
+    int const mx = MeanShiftX();
+    int const my = MeanShiftY();
+    unsigned int const n = m_count;
+
+    for (int r = 0; r < h; r++)
+    {
+        int const sr = wxMin(wxMax(r - my, 0), h - 1);
+        const unsigned int *src = &m_sum[sr * w];
+        unsigned short *dst = img.ImageData + (m_area.GetTop() + r) * m_size.GetWidth() + m_area.GetLeft();
+        for (int c = 0; c < w; c++)
+        {
+            int const sc = wxMin(wxMax(c - mx, 0), w - 1);
+            dst[c] = (unsigned short) ((src[sc] + n / 2) / n);
+        }
+    }
+
+    // the exposure time stays that of one sub-exposure, which is what the darks are matched
+    // on; the span covers the whole stack
+    img.ImgStackCnt = m_count;
+    img.ImgSpanDur = (int) std::chrono::duration_cast<std::chrono::milliseconds>(m_lastStart - img.ImgStartSteady).count() +
+        img.ImgExpDur;
+}
+
+CameraStreamThread::CameraStreamThread(GuideCamera *camera, CameraFrameRing *ring, int exposureMs)
+    :
+    wxThread(wxTHREAD_JOINABLE),
+    m_camera(camera),
+    m_ring(ring),
+    m_exposureMs(exposureMs)
+{
+}
+
+wxThread::ExitCode CameraStreamThread::Entry()
+{
+    enum { MAX_CONSECUTIVE_ERRORS = 5 };
+
+    Debug.Write(wxString::Format("Camera stream thread starts, exposure = %d\n", m_exposureMs));
+
+    int errors = 0;
+
+    while (!TestDestroy() && !m_ring->IsInterrupted())
+    {
+        usImage *img = m_ring->BeginFrame();
+
+        img->InitImgStartTime();
+        img->ImgExpDur = m_exposureMs;
+        img->ImgStackCnt = 1;
+        img->ImgSpanDur = 0;
+        img->BitsPerPixel = m_camera->BitsPerPixel();
+
+        bool err = m_camera->CaptureStreamFrame(*img);
+
+        m_ring->EndFrame(!err);
+
+        if (err)
+        {
+            if (m_ring->IsInterrupted())
+                break;
+
+            if (++errors >= MAX_CONSECUTIVE_ERRORS)
+            {
+                Debug.Write("Camera stream thread: too many consecutive errors, stopping stream\n");
+                m_ring->SetError();
+                break;
+            }
+        }
+        else
+            errors = 0;
+    }
+
+    Debug.Write(wxString::Format("Camera stream thread exits, frames = %u dropped = %u\n",
+        m_ring->PublishedFrames(), m_ring->DroppedFrames()));
+
+    return nullptr;
+}
@@ -0,0 +1,133 @@
+/*
+*  camera_stream.h
+*  PHD2 Guiding
+*
+*  Copyright (c) 2026 openphdguiding.org
+*  All rights reserved.
+*
+*  This source code is distributed under the following "BSD" license
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*    Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+*    Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the
+*     documentation and/or other materials provided with the distribution.
+*    Neither the name of openphdguiding.org nor the names of its
+*     contributors may be used to endorse or promote products derived from
+*     this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#ifndef CAMERA_STREAM_H_INCLUDED
+#define CAMERA_STREAM_H_INCLUDED
+
+class GuideCamera;
+
+// A small ring of pre-allocated frame buffers for streaming (video mode) capture.
+// The camera's stream thread fills one buffer at a time and publishes it; the
+// consumer always takes the most recently published frame. A published frame
+// that is replaced before the consumer takes it is counted as dropped.
+class CameraFrameRing
+{
+    wxMutex m_lock;
+    wxCondition m_cond;
+    std::vector<usImage *> m_bufs;
+    int m_writeIdx;             // buffer being filled by the producer, or -1
+    int m_readyIdx;             // most recently published frame not yet taken, or -1
+    unsigned int m_published;   // total number of frames published
+    unsigned int m_dropped;     // frames replaced before they were taken
+    unsigned int m_stale;       // frames discarded because they started before m_notBefore
+    std::chrono::steady_clock::time_point m_notBefore;
+    bool m_interrupted;
+    bool m_error;
+
+public:
+    enum { DEFAULT_BUFFERS = 3 };
+
+    CameraFrameRing();
+    ~CameraFrameRing();
+
+    bool Init(const wxSize& frameSize, unsigned int nbufs = DEFAULT_BUFFERS);
+    void Reset();
+
+    // producer side (stream thread)
+    usImage *BeginFrame();
+    void EndFrame(bool publish);
+    void SetError();
+
+    // consumer side; returns true on timeout, interrupt, or stream error
+    bool TakeLatest(usImage& img, int timeoutMs);
+    // frames that started exposing before the given time are discarded rather than taken
+    void DiscardBefore(const std::chrono::steady_clock::time_point& t);
+
+    void Interrupt();
+    bool IsInterrupted();
+    unsigned int PublishedFrames();
+    unsigned int DroppedFrames();
+    unsigned int StaleFrames();
+};
+
+// Stacks sub-exposures taken from the stream into one guide frame. Each sub-exposure can
+// be shift-aligned on the first one: the shift is the peak of the cross-correlation of
+// the row and column profiles of the frame's subframe, which is centered on the guide
+// star while guiding. The stack is the mean of the sub-exposures, shifted to their mean
+// position, so it has the pixel scale, pedestal and saturation level of a single
+// sub-exposure and the darks for the sub-exposure length apply to it.
+class StreamStacker
+{
+    std::vector<unsigned int> m_sum;    // sum of the aligned sub-exposures over m_area
+    std::vector<double> m_refCols;      // profiles of the first sub-exposure
+    std::vector<double> m_refRows;
+    std::vector<double> m_cols;         // profiles of the sub-exposure being added
+    std::vector<double> m_rows;
+    wxSize m_size;
+    wxRect m_area;
+    bool m_packed8;
+    bool m_align;
+    int m_count;
+    int m_sumDx;                        // sum of the shifts, for the mean position
+    int m_sumDy;
+    std::chrono::steady_clock::time_point m_lastStart;
+
+public:
+    enum { MAX_SHIFT = 16 };            // largest shift searched, pixels
+
+    StreamStacker();
+
+    void Begin(const usImage& first, bool align);
+    // returns true if the sub-exposure does not match the first one (the stream was restarted)
+    bool Add(const usImage& sub);
+    // replaces the pixels of the first sub-exposure with the stack
+    void Finish(usImage& img);
+
+    int Count() const { return m_count; }
+    int MeanShiftX() const;
+    int MeanShiftY() const;
+};
+
+// Background thread that pulls frames from the camera driver into a CameraFrameRing
+class CameraStreamThread : public wxThread
+{
+    GuideCamera *m_camera;
+    CameraFrameRing *m_ring;
+    int m_exposureMs;
+
+public:
+    CameraStreamThread(GuideCamera *camera, CameraFrameRing *ring, int exposureMs);
+    ExitCode Entry() override;
+};
+
+#endif // CAMERA_STREAM_H_INCLUDED
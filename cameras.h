@@ -55,6 +55,7 @@
 # define MORAVIAN_CAMERA
 # define OPENCV_CAMERA
 # define ORION_DSCI
+# define PLAYBACK_CAMERA
 # define QGUIDE
 # define QHY_CAMERA
 # define SBIG
@@ -92,6 +93,7 @@
 # ifdef HAVE_SBIG_CAMERA
 #  define SBIG
 # endif
+# define PLAYBACK_CAMERA
 # define SIMULATOR
 # ifdef HAVE_MEADE_DSI_CAMERA
 #  define MEADE_DSI_CAMERA
@@ -118,6 +120,7 @@
 #elif defined (__linux__) || defined (__FreeBSD__)
 
 # define SIMULATOR
+# define PLAYBACK_CAMERA
 # define CAM_QHY5
 # ifdef HAVE_QHY_CAMERA
 #  define QHY_CAMERA
@@ -60,6 +60,8 @@ enum BRAIN_CTRL_IDS
     AD_GLOBAL_TAB_BOUNDARY,        //-----end of global tab controls
 
     AD_cbUseSubFrames,
+    AD_cbUseStreaming,
+    AD_szStreamStack,
     AD_szNoiseReduction,
     AD_szAutoExposure,
     AD_szVariableExposureDelay,
@@ -71,6 +73,7 @@ enum BRAIN_CTRL_IDS
     AD_szDelay,
     AD_szPort,
     AD_szBinning,
+    AD_szSwBinning,
     AD_szCooler,
     AD_CAMERA_TAB_BOUNDARY,        // ------ end of camera tab controls
 
@@ -78,6 +81,7 @@ enum BRAIN_CTRL_IDS
     AD_szFocalLength,
     AD_cbAutoRestoreCal,
     AD_cbFastRecenter,
+    AD_cbPulseOverlap,
     AD_szStarTracking,
     AD_cbClearCalibration,
     AD_cbEnableGuiding,
@@ -86,6 +90,7 @@ enum BRAIN_CTRL_IDS
     AD_cbAssumeOrthogonal,
     AD_cbSlewDetection,
     AD_cbUseDecComp,
+    AD_cbRefineCalibration,
     AD_cbBeepForLostStar,
     AD_GUIDER_TAB_BOUNDARY,        // --------------- end of guiding tab controls
 
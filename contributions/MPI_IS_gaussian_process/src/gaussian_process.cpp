@@ -41,6 +41,7 @@
  * @brief     The GP class implements the Gaussian Process functionality.
  */
 
+#include <algorithm>
 #include <cstdint>
 
 #include "gaussian_process.h"
@@ -58,6 +59,81 @@ struct covariance_ordering
     Eigen::VectorXd const& covariance_;
 };
 
+namespace
+{
+    // a data point with its index, ordered by location, output and variance
+    struct indexed_point
+    {
+        double loc;
+        double out;
+        double var;
+        int index;
+
+        bool operator<(const indexed_point& other) const
+        {
+            if (loc != other.loc)
+                return loc < other.loc;
+            if (out != other.out)
+                return out < other.out;
+            return var < other.var;
+        }
+
+        bool operator==(const indexed_point& other) const
+        {
+            return loc == other.loc && out == other.out && var == other.var;
+        }
+    };
+
+    std::vector<indexed_point> sorted_points(const Eigen::VectorXd& loc, const Eigen::VectorXd& out,
+                                             const Eigen::VectorXd& var)
+    {
+        std::vector<indexed_point> points(loc.rows());
+        for (int i = 0; i < loc.rows(); ++i)
+        {
+            points[i].loc = loc[i];
+            points[i].out = out[i];
+            points[i].var = var.rows() > 0 ? var[i] : 0.0;
+            points[i].index = i;
+        }
+        std::sort(points.begin(), points.end());
+        return points;
+    }
+
+    void remove_element(Eigen::VectorXd& vector, int k)
+    {
+        int n = vector.rows();
+        vector.segment(k, n - k - 1) = vector.tail(n - k - 1).eval();
+        vector.conservativeResize(n - 1);
+    }
+
+    void remove_row_and_column(Eigen::MatrixXd& matrix, int k)
+    {
+        int n = matrix.rows();
+        matrix.block(k, 0, n - k - 1, n) = matrix.bottomRows(n - k - 1).eval();
+        matrix.block(0, k, n, n - k - 1) = matrix.rightCols(n - k - 1).eval();
+        matrix.conservativeResize(n - 1, n - 1);
+    }
+
+    // Turns the lower Cholesky factor L of A into the one of A + v*v^T.
+    void cholesky_rank_one_update(Eigen::Ref<Eigen::MatrixXd> L, Eigen::VectorXd v)
+    {
+        int n = L.rows();
+        for (int j = 0; j < n; ++j)
+        {
+            double r = std::sqrt(L(j,j) * L(j,j) + v(j) * v(j));
+            double c = r / L(j,j);
+            double s = v(j) / L(j,j);
+            L(j,j) = r;
+            int m = n - j - 1;
+            if (m > 0)
+            {
+                L.col(j).tail(m) = (L.col(j).tail(m) + s * v.tail(m)) / c;
+                v.tail(m) = c * v.tail(m) - s * L.col(j).tail(m);
+            }
+        }
+    }
+}
+
 GP::GP() : covFunc_(nullptr), // initialize pointer to null
     covFuncProj_(nullptr), // initialize pointer to null
     data_loc_(Eigen::VectorXd()),
@@ -71,7 +147,10 @@ GP::GP() : covFunc_(nullptr), // initialize pointer to null
     feature_vectors_(Eigen::MatrixXd()),
     feature_matrix_(Eigen::MatrixXd()),
     chol_feature_matrix_(Eigen::LDLT<Eigen::MatrixXd>()),
-    beta_(Eigen::VectorXd())
+    beta_(Eigen::VectorXd()),
+    use_incremental_inference_(false),
+    chol_factor_(Eigen::MatrixXd()),
+    updates_since_refactorization_(0)
 { }
 
 GP::GP(const covariance_functions::CovFunc& covFunc) :
@@ -88,7 +167,10 @@ GP::GP(const covariance_functions::CovFunc& covFunc) :
     feature_vectors_(Eigen::MatrixXd()),
     feature_matrix_(Eigen::MatrixXd()),
     chol_feature_matrix_(Eigen::LDLT<Eigen::MatrixXd>()),
-    beta_(Eigen::VectorXd())
+    beta_(Eigen::VectorXd()),
+    use_incremental_inference_(false),
+    chol_factor_(Eigen::MatrixXd()),
+    updates_since_refactorization_(0)
 { }
 
 GP::GP(const double noise_variance,
@@ -106,7 +188,10 @@ GP::GP(const double noise_variance,
     feature_vectors_(Eigen::MatrixXd()),
     feature_matrix_(Eigen::MatrixXd()),
     chol_feature_matrix_(Eigen::LDLT<Eigen::MatrixXd>()),
-    beta_(Eigen::VectorXd())
+    beta_(Eigen::VectorXd()),
+    use_incremental_inference_(false),
+    chol_factor_(Eigen::MatrixXd()),
+    updates_since_refactorization_(0)
 { }
 
 GP::~GP()
@@ -129,10 +214,16 @@ GP::GP(const GP& that) :
     feature_vectors_(that.feature_vectors_),
     feature_matrix_(that.feature_matrix_),
     chol_feature_matrix_(that.chol_feature_matrix_),
-    beta_(that.beta_)
+    beta_(that.beta_),
+    use_incremental_inference_(that.use_incremental_inference_),
+    chol_factor_(that.chol_factor_),
+    updates_since_refactorization_(that.updates_since_refactorization_)
 {
     covFunc_ = that.covFunc_->clone();
-    covFuncProj_ = that.covFuncProj_->clone();
+    if (that.covFuncProj_ != nullptr)
+    {
+        covFuncProj_ = that.covFuncProj_->clone();
+    }
 }
 
 bool GP::setCovarianceFunction(const covariance_functions::CovFunc& covFunc)
@@ -166,6 +257,10 @@ GP& GP::operator=(const GP& that)
         covFunc_ = that.covFunc_->clone();  // ... first clone ...
         delete temp;  // ... and then delete.
 
+        temp = covFuncProj_;
+        covFuncProj_ = that.covFuncProj_ != nullptr ? that.covFuncProj_->clone() : nullptr;
+        delete temp;
+
         // copy the rest
         data_loc_ = that.data_loc_;
         data_out_ = that.data_out_;
@@ -174,6 +269,14 @@ GP& GP::operator=(const GP& that)
         alpha_ = that.alpha_;
         chol_gram_matrix_ = that.chol_gram_matrix_;
         log_noise_sd_ = that.log_noise_sd_;
+        use_explicit_trend_ = that.use_explicit_trend_;
+        feature_vectors_ = that.feature_vectors_;
+        feature_matrix_ = that.feature_matrix_;
+        chol_feature_matrix_ = that.chol_feature_matrix_;
+        beta_ = that.beta_;
+        use_incremental_inference_ = that.use_incremental_inference_;
+        chol_factor_ = that.chol_factor_;
+        updates_since_refactorization_ = that.updates_since_refactorization_;
     }
     return *this;
 }
@@ -207,7 +310,7 @@ Eigen::VectorXd GP::drawSample(const Eigen::VectorXd& locations,
         mixed_covariance = covFunc_->evaluate(locations, data_loc_);
         Eigen::MatrixXd posterior_covariance;
         posterior_covariance = prior_covariance - mixed_covariance *
-                               (chol_gram_matrix_.solve(mixed_covariance.transpose()));
+                               solveGram(mixed_covariance.transpose());
         kernel_matrix = posterior_covariance + JITTER * Eigen::MatrixXd::Identity(
                             posterior_covariance.rows(), posterior_covariance.cols());
     }
@@ -241,10 +344,32 @@ void GP::infer()
     }
 
     // compute the Cholesky decomposition of the Gram matrix
-    chol_gram_matrix_ = gram_matrix_.ldlt();
+    chol_factor_ = Eigen::MatrixXd();
+    if (use_incremental_inference_)
+    {
+        // the incremental updates need the plain triangular factor
+        Eigen::LLT<Eigen::MatrixXd> chol_gram(gram_matrix_);
+        if (chol_gram.info() == Eigen::Success)
+        {
+            chol_factor_ = chol_gram.matrixL();
+            updates_since_refactorization_ = 0;
+        }
+    }
+    if (chol_factor_.rows() == 0)
+    {
+        // without a factor (numerically not positive definite, or not
+        // incremental) the pivoting LDLT is used and the next update
+        // falls back to a full inference
+        chol_gram_matrix_ = gram_matrix_.ldlt();
+    }
+
+    computeWeights();
+}
 
+void GP::computeWeights()
+{
     // pre-compute the alpha, which is the solution of the chol to the data
-    alpha_ = chol_gram_matrix_.solve(data_out_);
+    alpha_ = solveGram(data_out_);
 
     if (use_explicit_trend_)
     {
@@ -253,13 +378,132 @@ void GP::infer()
         feature_vectors_.row(0) = Eigen::MatrixXd::Ones(1,data_loc_.rows()); // instead of pow(0)
         feature_vectors_.row(1) = data_loc_.array(); // instead of pow(1)
 
-        feature_matrix_ = feature_vectors_ * chol_gram_matrix_.solve(feature_vectors_.transpose());
+        feature_matrix_ = feature_vectors_ * solveGram(feature_vectors_.transpose());
         chol_feature_matrix_ = feature_matrix_.ldlt();
 
         beta_ = chol_feature_matrix_.solve(feature_vectors_) * alpha_;
     }
 }
 
+Eigen::MatrixXd GP::solveGram(const Eigen::MatrixXd& rhs) const
+{
+    if (chol_factor_.rows() > 0)
+    {
+        Eigen::MatrixXd y = chol_factor_.triangularView<Eigen::Lower>().solve(rhs);
+        return chol_factor_.transpose().triangularView<Eigen::Upper>().solve(y);
+    }
+    return chol_gram_matrix_.solve(rhs);
+}
+
+bool GP::updateInference(const Eigen::VectorXd& data_loc,
+                         const Eigen::VectorXd& data_out,
+                         const Eigen::VectorXd& data_var)
+{
+    bool use_var = data_var.rows() > 0;
+    if (chol_factor_.rows() == 0 || chol_factor_.rows() != data_loc_.rows()
+        || use_var != (data_var_.rows() == data_loc_.rows())
+        || updates_since_refactorization_ >= REFACTORIZATION_INTERVAL)
+    {
+        return false;
+    }
+
+    // match the old and the new points by merging both sorted sets
+    std::vector<indexed_point> old_points = sorted_points(data_loc_, data_out_, use_var ? data_var_ : Eigen::VectorXd());
+    std::vector<indexed_point> new_points = sorted_points(data_loc, data_out, data_var);
+
+    std::vector<int> removed;
+    std::vector<int> added;
+    size_t i = 0, j = 0;
+    while (i < old_points.size() || j < new_points.size())
+    {
+        if (i < old_points.size() && j < new_points.size() && old_points[i] == new_points[j])
+        {
+            ++i;
+            ++j;
+        }
+        else if (j == new_points.size() || (i < old_points.size() && old_points[i] < new_points[j]))
+        {
+            removed.push_back(old_points[i++].index);
+        }
+        else
+        {
+            added.push_back(new_points[j++].index);
+        }
+    }
+
+    // a full inference is cheaper if many points changed
+    if (4 * (removed.size() + added.size()) > static_cast<size_t>(data_loc.rows()))
+    {
+        return false;
+    }
+
+    // remove from the back, so that the indices stay valid
+    std::sort(removed.begin(), removed.end());
+    for (std::vector<int>::reverse_iterator it = removed.rbegin(); it != removed.rend(); ++it)
+    {
+        int k = *it;
+        int m = chol_factor_.rows() - k - 1;
+        if (m > 0)
+        {
+            // the trailing block absorbs the column of the removed point
+            Eigen::VectorXd v = chol_factor_.col(k).tail(m);
+            cholesky_rank_one_update(chol_factor_.bottomRightCorner(m, m), v);
+        }
+        remove_row_and_column(chol_factor_, k);
+        remove_row_and_column(gram_matrix_, k);
+        remove_element(data_loc_, k);
+        remove_element(data_out_, k);
+        if (use_var)
+        {
+            remove_element(data_var_, k);
+        }
+    }
+
+    for (size_t a = 0; a < added.size(); ++a)
+    {
+        int k = added[a];
+        int n = data_loc_.rows();
+
+        Eigen::VectorXd location(1);
+        location << data_loc[k];
+        Eigen::VectorXd covariance = covFunc_->evaluate(data_loc_, location);
+        double variance = covFunc_->evaluate(location, location)(0, 0);
+        variance += use_var ? data_var[k] : std::exp(2 * log_noise_sd_) + JITTER;
+
+        // the new row of the factor follows from L * l = k
+        Eigen::VectorXd l = chol_factor_.triangularView<Eigen::Lower>().solve(covariance);
+        double d = variance - l.squaredNorm();
+        if (!(d > 0))
+        {
+            return false; // lost positive definiteness
+        }
+
+        chol_factor_.conservativeResize(n + 1, n + 1);
+        chol_factor_.row(n).head(n) = l.transpose();
+        chol_factor_.col(n).head(n).setZero();
+        chol_factor_(n, n) = std::sqrt(d);
+
+        gram_matrix_.conservativeResize(n + 1, n + 1);
+        gram_matrix_.row(n).head(n) = covariance.transpose();
+        gram_matrix_.col(n).head(n) = covariance;
+        gram_matrix_(n, n) = variance;
+
+        data_loc_.conservativeResize(n + 1);
+        data_loc_(n) = data_loc[k];
+        data_out_.conservativeResize(n + 1);
+        data_out_(n) = data_out[k];
+        if (use_var)
+        {
+            data_var_.conservativeResize(n + 1);
+            data_var_(n) = data_var[k];
+        }
+    }
+
+    ++updates_since_refactorization_;
+    computeWeights();
+    return true;
+}
+
 void GP::infer(const Eigen::VectorXd& data_loc,
                const Eigen::VectorXd& data_out,
                const Eigen::VectorXd& data_var /* = EigenVectorXd() */)
@@ -307,37 +551,49 @@ void GP::inferSD(const Eigen::VectorXd& data_loc,
 
     bool use_var = data_var.rows() > 0; // true means heteroscedastic noise
 
+    Eigen::VectorXd selected_loc;
+    Eigen::VectorXd selected_out;
+    Eigen::VectorXd selected_var;
+
     if (n < data_loc.rows()) {
-        std::vector<double> loc_arr(n);
-        std::vector<double> out_arr(n);
-        std::vector<double> var_arr(n);
+        selected_loc.resize(n);
+        selected_out.resize(n);
+        if (use_var)
+        {
+            selected_var.resize(n);
+        }
 
         for (int i = 0; i < n; ++i)
         {
-            loc_arr[i] = data_loc[index[i]];
-            out_arr[i] = data_out[index[i]];
+            selected_loc[i] = data_loc[index[i]];
+            selected_out[i] = data_out[index[i]];
             if (use_var)
             {
-                var_arr[i] = data_var[index[i]];
+                selected_var[i] = data_var[index[i]];
             }
         }
-
-        data_loc_ = Eigen::Map<Eigen::VectorXd>(loc_arr.data(),n,1);
-        data_out_ = Eigen::Map<Eigen::VectorXd>(out_arr.data(),n,1);
-        if (use_var)
-        {
-            data_var_ = Eigen::Map<Eigen::VectorXd>(var_arr.data(),n,1);
-        }
     }
     else // we can use all points and don't neet to select
     {
-        data_loc_ = data_loc;
-        data_out_ = data_out;
+        selected_loc = data_loc;
+        selected_out = data_out;
         if (use_var)
         {
-            data_var_ = data_var;
+            selected_var = data_var;
         }
     }
+
+    if (use_incremental_inference_ && updateInference(selected_loc, selected_out, selected_var))
+    {
+        return;
+    }
+
+    data_loc_.swap(selected_loc);
+    data_out_.swap(selected_out);
+    if (use_var)
+    {
+        data_var_.swap(selected_var);
+    }
     infer();
 }
 
@@ -345,6 +601,7 @@ void GP::clearData()
 {
     gram_matrix_ = Eigen::MatrixXd();
     chol_gram_matrix_ = Eigen::LDLT<Eigen::MatrixXd>();
+    chol_factor_ = Eigen::MatrixXd();
     data_loc_ = Eigen::VectorXd();
     data_out_ = Eigen::VectorXd();
 }
@@ -434,7 +691,7 @@ Eigen::VectorXd GP::predict(const Eigen::MatrixXd& prior_cov, const Eigen::Matri
     Eigen::VectorXd m = mixed_cov * alpha_;
 
     // precompute K^{-1} * mixed_cov
-    Eigen::MatrixXd gamma = chol_gram_matrix_.solve(mixed_cov.transpose());
+    Eigen::MatrixXd gamma = solveGram(mixed_cov.transpose());
 
     Eigen::MatrixXd R;
 
@@ -490,6 +747,34 @@ Eigen::VectorXd GP::getHyperParameters() const
     return hyperParameters;
 }
 
+double GP::negativeLogLikelihood() const
+{
+    assert(data_loc_.rows() > 0 && "Error: the GP is not yet initialized!");
+
+    double log_det_gram;
+    if (chol_factor_.rows() > 0)
+    {
+        log_det_gram = 2 * chol_factor_.diagonal().array().log().sum();
+    }
+    else
+    {
+        log_det_gram = chol_gram_matrix_.vectorD().array().log().sum();
+    }
+
+    double data_fit = data_out_.dot(alpha_);
+    double dimensions = static_cast<double>(data_loc_.rows());
+
+    if (use_explicit_trend_)
+    {
+        // the part of the data explained by the trend does not count against the fit
+        data_fit -= (feature_vectors_ * alpha_).dot(beta_);
+        log_det_gram += chol_feature_matrix_.vectorD().array().log().sum();
+        dimensions -= feature_vectors_.rows();
+    }
+
+    return 0.5 * (data_fit + log_det_gram + dimensions * std::log(2 * M_PI));
+}
+
 void GP::enableExplicitTrend()
 {
     use_explicit_trend_ = true;
@@ -499,3 +784,30 @@ void GP::disableExplicitTrend()
 {
     use_explicit_trend_ = false;
 }
+
+void GP::enableIncrementalInference()
+{
+    if (use_incremental_inference_)
+    {
+        return;
+    }
+    use_incremental_inference_ = true;
+    if (data_loc_.rows() > 0)
+    {
+        infer(); // build the factor for the incremental updates
+    }
+}
+
+void GP::disableIncrementalInference()
+{
+    if (!use_incremental_inference_)
+    {
+        return;
+    }
+    use_incremental_inference_ = false;
+    chol_factor_ = Eigen::MatrixXd();
+    if (data_loc_.rows() > 0)
+    {
+        infer();
+    }
+}
@@ -59,6 +59,11 @@
 // make the Cholesky decomposition stable.
 #define JITTER 1e-6
 
+// With incremental inference, the Cholesky factor of the Gram matrix is
+// computed from scratch after this many updates to limit the accumulation of
+// rounding errors.
+#define REFACTORIZATION_INTERVAL 100
+
 class GP
 {
 private:
@@ -76,6 +81,32 @@ private:
     Eigen::MatrixXd feature_matrix_;
     Eigen::LDLT<Eigen::MatrixXd> chol_feature_matrix_;
     Eigen::VectorXd beta_;
+    bool use_incremental_inference_;
+    Eigen::MatrixXd chol_factor_; // lower Cholesky factor of the Gram matrix, for incremental inference
+    int updates_since_refactorization_;
+
+    /*!
+     * Solves the linear system with the Gram matrix, using the factorization
+     * of the current inference mode.
+     */
+    Eigen::MatrixXd solveGram(const Eigen::MatrixXd& rhs) const;
+
+    /*!
+     * Computes alpha and the weights of the explicit trend from the
+     * factorized Gram matrix.
+     */
+    void computeWeights();
+
+    /*!
+     * Updates the factorized Gram matrix to a new set of data points by
+     * removing the points that are not part of it anymore and appending the
+     * new ones, with a rank-1 update for each. Returns false if a full
+     * inference is needed instead, because too many points changed, the
+     * factor is due for a refactorization or the update was not stable.
+     */
+    bool updateInference(const Eigen::VectorXd& data_loc,
+                         const Eigen::VectorXd& data_out,
+                         const Eigen::VectorXd& data_var);
 
 public:
     typedef std::pair<Eigen::VectorXd, Eigen::MatrixXd> VectorMatrixPair;
@@ -191,6 +222,14 @@ public:
      */
     Eigen::VectorXd getHyperParameters() const;
 
+    /*!
+     * Returns the negative log marginal likelihood of the stored data under
+     * the current hyperparameters. With the explicit trend, the weights of the
+     * linear basis are integrated out under a flat prior. Needs a prior
+     * inference.
+     */
+    double negativeLogLikelihood() const;
+
     /*!
      * Enables the use of a explicit linear basis function.
      */
@@ -201,6 +240,18 @@ public:
      */
     void disableExplicitTrend();
 
+    /*!
+     * Enables incremental inference for inferSD(). Data points that stay in
+     * the selected subset keep their part of the Cholesky factor, so that the
+     * update costs O(n^2) per changed point instead of O(n^3).
+     */
+    void enableIncrementalInference();
+
+    /*!
+     * Disables incremental inference, every inference starts from scratch.
+     */
+    void disableIncrementalInference();
+
 
 };
 
@@ -42,10 +42,13 @@
 #include "gaussian_process_guider.h"
 
 #include <cmath>
+#include <condition_variable>
 #include <ctime>
 #include <iostream>
 #include <iomanip>
 #include <fstream>
+#include <mutex>
+#include <thread>
 
 #define SAVE_FFT_DATA_ 0
 #define PRINT_TIMINGS_ 0
@@ -53,16 +56,269 @@
 #define CIRCULAR_BUFFER_SIZE 8192 // for the raw data storage
 #define REGULAR_BUFFER_SIZE 2048 // for the regularized data storage
 #define FFT_SIZE 4096 // for zero-padding the FFT, >= REGULAR_BUFFER_SIZE!
+#define MIN_PERIOD_LENGTH 60.0 // shortest period searched by Lomb-Scargle
+#define MAX_PERIOD_LENGTH 1500.0 // longest period considered by the period estimation
+#define LOMB_SCARGLE_OVERSAMPLING 4 // frequency resolution relative to the data span
 #define GRID_INTERVAL 5.0
 #define MAX_DITHER_STEPS 10 // for our fallback dithering
 
 #define DEFAULT_LEARNING_RATE 0.01 // for a smooth parameter adaptation
 
+#define OPTIMIZATION_ITERATIONS 20 // L-BFGS iterations per hyperparameter optimization
+#define OPTIMIZATION_MAX_STEP 0.2 // largest change of a log hyperparameter per optimization
+#define OPTIMIZATION_MAX_RANGE 2.0 // largest deviation of a log hyperparameter from the configured value
+
 #define HYSTERESIS 0.1 // for the hybrid mode
 
+namespace
+{
+    std::vector<double> get_hyperparameters(const GP& gp)
+    {
+        // since the GP class works in log space, we have to exp() the parameters first.
+        Eigen::VectorXd hyperparameters_full = gp.getHyperParameters().array().exp();
+        // remove first parameter, which is unused here
+        Eigen::VectorXd hyperparameters = hyperparameters_full.tail(NumParameters);
+
+        // converts the length-scale of the periodic covariance from standard notation to natural units
+        hyperparameters(PKLengthScale) = std::asin(hyperparameters(PKLengthScale)/4.0)*hyperparameters(PKPeriodLength)/M_PI;
+
+        // we need to map the Eigen::vector into a std::vector.
+        return std::vector<double>(hyperparameters.data(), // the first element is at the array address
+                                   hyperparameters.data() + NumParameters);
+    }
+
+    void set_hyperparameters(GP& gp, const std::vector<double>& hyperparameters)
+    {
+        Eigen::VectorXd hyperparameters_eig = Eigen::VectorXd::Map(&hyperparameters[0], hyperparameters.size());
+
+        // prevent length scales from becoming too small (makes GP unstable)
+        hyperparameters_eig(SE0KLengthScale) = std::max(hyperparameters_eig(SE0KLengthScale), 1.0);
+        hyperparameters_eig(PKLengthScale) = std::max(hyperparameters_eig(PKLengthScale), 1.0);
+        hyperparameters_eig(SE1KLengthScale) = std::max(hyperparameters_eig(SE1KLengthScale), 1.0);
+
+        // converts the length-scale of the periodic covariance from natural units to standard notation
+        hyperparameters_eig(PKLengthScale) = 4*std::sin(hyperparameters_eig(PKLengthScale)
+                *M_PI/hyperparameters_eig(PKPeriodLength));
+
+        // safeguard all parameters from being too small (log conversion)
+        hyperparameters_eig = hyperparameters_eig.array().max(1e-10);
+
+        // need to convert to GP parameters
+        Eigen::VectorXd hyperparameters_full(NumParameters + 1); // the GP has one more parameter!
+        hyperparameters_full << 1.0, hyperparameters_eig;
+
+        // the GP works in log space, therefore we need to convert
+        gp.setHyperParameters(hyperparameters_full.array().log());
+    }
+
+    void filter_period_length(GP& gp, double period_length, double learning_rate)
+    {
+        std::vector<double> hypers = get_hyperparameters(gp);
+
+        // assert for the developers...
+        assert(!math_tools::isNaN(period_length));
+
+        // ...and save the day for the users
+        if (math_tools::isNaN(period_length))
+        {
+                period_length = hypers[PKPeriodLength]; // just use the old value instead
+        }
+
+        // we just apply a simple learning rate to slow down parameter jumps
+        hypers[PKPeriodLength] = (1 - learning_rate) * hypers[PKPeriodLength] + learning_rate * period_length;
+
+        set_hyperparameters(gp, hypers); // the setter function is needed to convert parameters
+    }
+
+    // finds the maximum of the spectrum and refines it with a quadratic interpolation
+    double peak_frequency(const Eigen::ArrayXd& frequencies, const Eigen::ArrayXd& amplitudes)
+    {
+        assert(amplitudes.size() == frequencies.size());
+
+        Eigen::VectorXd::Index maxIndex;
+        amplitudes.maxCoeff(&maxIndex);
+
+        double max_frequency = frequencies(maxIndex);
+
+        // quadratic interpolation to find maximum
+        // check if we can interpolate
+        if (maxIndex < frequencies.size() - 1 && maxIndex > 0)
+        {
+            double spread = std::abs(frequencies(maxIndex - 1) - frequencies(maxIndex + 1));
+
+            Eigen::VectorXd interp_loc(3);
+            interp_loc << frequencies(maxIndex - 1), frequencies(maxIndex), frequencies(maxIndex + 1);
+            interp_loc = interp_loc.array() - max_frequency; // centering for numerical stability
+            interp_loc = interp_loc.array() / spread; // normalize for numerical stability
+
+            Eigen::VectorXd interp_dat(3);
+            interp_dat << amplitudes(maxIndex - 1), amplitudes(maxIndex), amplitudes(maxIndex + 1);
+            interp_dat = interp_dat.array() / amplitudes(maxIndex); // normalize for numerical stability
+
+            // we need to handle the case where all amplitudes are equal
+            // the linear regression would be unstable in this case
+            if (interp_dat.maxCoeff() - interp_dat.minCoeff() < 1e-10)
+            {
+                return max_frequency; // don't do the linear regression
+            }
+
+
+            // building feature matrix
+            Eigen::MatrixXd phi(3,3);
+            phi.row(0) = interp_loc.array().pow(2);
+            phi.row(1) = interp_loc.array().pow(1);
+            phi.row(2) = interp_loc.array().pow(0);
+
+            // standard equation for linear regression
+            Eigen::VectorXd w = (phi*phi.transpose()).ldlt().solve(phi*interp_dat);
+
+            // recovering the maximum from the weights relative to the frequency of the maximum
+            max_frequency = max_frequency - w(1)/(2*w(0))*spread; // note the de-normalization
+        }
+
+        return max_frequency;
+    }
+}
+
+/**
+ * The background thread refits its own copy of the GP and publishes the
+ * result as a second copy, which the guide loop takes over at its next step.
+ * Only the latest request is kept: if the guide loop is faster than the refit,
+ * intermediate data sets are skipped.
+ */
+struct GaussianProcessGuider::AsyncUpdater
+{
+    std::mutex mutex;
+    std::condition_variable wake; // new request or stop
+    std::condition_variable done; // refit finished
+
+    fit_request request;
+    bool request_pending;
+    bool busy;
+    bool stop;
+
+    GP model; // the published model
+    unsigned int model_generation;
+    bool model_ready;
+
+    std::vector<double> proposal; // optimized hyperparameters, natural units
+    unsigned int proposal_generation;
+    bool proposal_ready;
+
+    math_tools::SpectrumWorkspace workspace; // used by the background thread only
+
+    std::thread thread;
+
+    AsyncUpdater(const GP& gp, unsigned int generation) :
+        request_pending(false),
+        busy(false),
+        stop(false),
+        model(gp),
+        model_generation(generation),
+        model_ready(false),
+        proposal_generation(generation),
+        proposal_ready(false)
+    {
+        thread = std::thread(&AsyncUpdater::Run, this);
+    }
+
+    ~AsyncUpdater()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        wake.notify_one();
+        thread.join();
+    }
+
+    // copies the published model to gp, mutex must be held
+    void Adopt(GP *gp, unsigned int generation)
+    {
+        // a model fit before a reset or a change of hyperparameters is dropped
+        if (model_ready && model_generation == generation)
+        {
+            *gp = model;
+        }
+        model_ready = false;
+    }
+
+    // takes the optimized hyperparameters, if any, mutex must be held
+    bool TakeProposal(std::vector<double> *hyperparameters, unsigned int generation)
+    {
+        bool valid = proposal_ready && proposal_generation == generation;
+        if (valid)
+        {
+            hyperparameters->swap(proposal);
+        }
+        proposal_ready = false;
+        return valid;
+    }
+
+    void Run()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        GP work(model);
+        unsigned int work_generation = model_generation;
+        fit_request current;
+        double last_optimization = -std::numeric_limits<double>::infinity(); // gear time
+
+        while (true)
+        {
+            wake.wait(lock, [this] { return stop || request_pending; });
+            if (stop)
+            {
+                break;
+            }
+
+            std::swap(current, request);
+            request_pending = false;
+            busy = true;
+            lock.unlock();
+
+            // the hyperparameters are only taken from the guider if they were changed
+            // there, otherwise the period length estimated here would be reset
+            if (current.generation != work_generation)
+            {
+                work.setHyperParameters(current.hyperparameters);
+                work_generation = current.generation;
+            }
+            FitGP(work, current, &workspace);
+
+            lock.lock();
+            model = work;
+            model_generation = current.generation;
+            model_ready = true;
+
+            // the optimization runs after the model is published, so the guide loop never waits for it
+            double period_length = get_hyperparameters(work)[PKPeriodLength];
+            if (current.last_timestamp < last_optimization)
+            {
+                last_optimization = -std::numeric_limits<double>::infinity(); // the guider was reset
+            }
+            if (current.parameters.optimize_hyperparameters_
+                && current.last_timestamp >= std::max(current.parameters.min_periods_for_inference_, 1.0) * period_length
+                && current.last_timestamp - last_optimization >= period_length)
+            {
+                lock.unlock();
+                std::vector<double> hyperparameters = OptimizeHyperparameters(work, current.parameters);
+                last_optimization = current.last_timestamp;
+                lock.lock();
+
+                proposal.swap(hyperparameters);
+                proposal_generation = current.generation;
+                proposal_ready = true;
+            }
+
+            busy = false;
+            done.notify_all();
+        }
+    }
+};
+
 GaussianProcessGuider::GaussianProcessGuider(guide_parameters parameters) :
-    start_time_(std::chrono::system_clock::now()),
-    last_time_(std::chrono::system_clock::now()),
+    start_time_(std::chrono::steady_clock::now()),
+    last_time_(std::chrono::steady_clock::now()),
     control_signal_(0),
     prediction_(0),
     last_prediction_end_(0),
@@ -74,7 +330,11 @@ GaussianProcessGuider::GaussianProcessGuider(guide_parameters parameters) :
     output_covariance_function_(),
     gp_(covariance_function_),
     learning_rate_(DEFAULT_LEARNING_RATE),
-    parameters(parameters)
+    parameters(parameters),
+    model_generation_(0),
+    prior_period_length_(0.0),
+    prior_phase_offset_(0.0),
+    prior_weight_(0.0)
 {
     circular_buffer_data_.push_front(data_point()); // add first point
     circular_buffer_data_[0].control = 0; // set first control to zero
@@ -96,20 +356,22 @@ GaussianProcessGuider::~GaussianProcessGuider()
 {
 }
 
-void GaussianProcessGuider::SetTimestamp()
+void GaussianProcessGuider::SetTimestamp(std::chrono::steady_clock::time_point measurement_time)
 {
-    auto current_time = std::chrono::system_clock::now();
-    double delta_measurement_time = std::chrono::duration<double>(current_time - last_time_).count();
+    auto current_time = std::chrono::steady_clock::now();
+    if (measurement_time == std::chrono::steady_clock::time_point())
+    {
+        measurement_time = last_time_ + (current_time - last_time_) / 2; // use the midpoint as time stamp
+    }
     last_time_ = current_time;
-    get_last_point().timestamp = std::chrono::duration<double>(current_time - start_time_).count()
-        - (delta_measurement_time / 2.0) // use the midpoint as time stamp
+    get_last_point().timestamp = std::chrono::duration<double>(measurement_time - start_time_).count()
         + dither_offset_; // correct for the gear time offset from dithering
 }
 
 // adds a new measurement to the circular buffer that holds the data.
-void GaussianProcessGuider::HandleGuiding(double input, double SNR)
+void GaussianProcessGuider::HandleGuiding(double input, double SNR, std::chrono::steady_clock::time_point measurement_time)
 {
-    SetTimestamp();
+    SetTimestamp(measurement_time);
     get_last_point().measurement = input;
     get_last_point().variance = CalculateVariance(SNR);
 
@@ -120,7 +382,7 @@ void GaussianProcessGuider::HandleGuiding(double input, double SNR)
 
 void GaussianProcessGuider::HandleDarkGuiding()
 {
-    SetTimestamp();
+    SetTimestamp(std::chrono::steady_clock::time_point());
     get_last_point().measurement = 0; // we didn't actually measure
     get_last_point().variance = 1e4; // add really high noise
 }
@@ -141,33 +403,94 @@ double GaussianProcessGuider::CalculateVariance(double SNR)
 }
 
 void GaussianProcessGuider::UpdateGP(double prediction_point /*= std::numeric_limits<double>::quiet_NaN()*/)
+{
+    fit_request request;
+    FillFitRequest(&request, prediction_point);
+    FitGP(gp_, request, &spectrum_workspace_);
+}
+
+void GaussianProcessGuider::UpdateModel(double prediction_point)
+{
+    if (!async_updater_)
+    {
+        UpdateGP(prediction_point);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(async_updater_->mutex);
+
+        // predict with the model fit to the data up to the previous step...
+        async_updater_->Adopt(&gp_, model_generation_);
+
+        // ...with the hyperparameters of the last optimization for the next fits
+        std::vector<double> proposal;
+        if (async_updater_->TakeProposal(&proposal, model_generation_))
+        {
+            UseGPHyperparameters(proposal);
+        }
+
+        // ...and let the background thread include the current data
+        FillFitRequest(&async_updater_->request, prediction_point);
+        async_updater_->request_pending = true;
+    }
+    async_updater_->wake.notify_one();
+}
+
+void GaussianProcessGuider::FillFitRequest(fit_request *request, double prediction_point) const
+{
+    size_t N = get_number_of_measurements();
+
+    request->data.resize(N-1);
+    for (size_t i = 0; i < N-1; i++)
+    {
+        request->data[i] = circular_buffer_data_[i];
+    }
+    request->last_timestamp = get_last_point().timestamp;
+    request->prediction_point = prediction_point;
+    request->learning_rate = learning_rate_;
+    request->parameters = parameters;
+    request->hyperparameters = gp_.getHyperParameters();
+    request->generation = model_generation_;
+}
+
+void GaussianProcessGuider::FitGP(GP& gp, const fit_request& request, math_tools::SpectrumWorkspace *workspace)
 {
 #if PRINT_TIMINGS_
     clock_t begin = std::clock(); // this is for timing the method in a simple way
 #endif
 
-    size_t N = get_number_of_measurements();
+    size_t N = request.data.size();
+
+    if (request.parameters.incremental_inference_)
+    {
+        gp.enableIncrementalInference();
+    }
+    else
+    {
+        gp.disableIncrementalInference();
+    }
 
     // initialize the different vectors needed for the GP
-    Eigen::VectorXd timestamps(N-1);
-    Eigen::VectorXd measurements(N-1);
-    Eigen::VectorXd variances(N-1);
-    Eigen::VectorXd sum_controls(N-1);
+    Eigen::VectorXd timestamps(N);
+    Eigen::VectorXd measurements(N);
+    Eigen::VectorXd variances(N);
+    Eigen::VectorXd sum_controls(N);
 
     double sum_control = 0;
 
-    // transfer the data from the circular buffer to the Eigen::Vectors
-    for (size_t i = 0; i < N-1; i++)
+    // transfer the data from the request to the Eigen::Vectors
+    for (size_t i = 0; i < N; i++)
     {
-        sum_control += circular_buffer_data_[i].control; // sum over the control signals
-        timestamps(i) = circular_buffer_data_[i].timestamp;
-        measurements(i) = circular_buffer_data_[i].measurement;
-        variances(i) = circular_buffer_data_[i].variance;
+        sum_control += request.data[i].control; // sum over the control signals
+        timestamps(i) = request.data[i].timestamp;
+        measurements(i) = request.data[i].measurement;
+        variances(i) = request.data[i].variance;
         sum_controls(i) = sum_control; // store current accumulated control signal
     }
 
-    Eigen::VectorXd gear_error(N-1);
-    Eigen::VectorXd linear_fit(N-1);
+    Eigen::VectorXd gear_error(N);
+    Eigen::VectorXd linear_fit(N);
 
     // calculate the accumulated gear error
     gear_error = sum_controls + measurements; // for each time step, add the residual error
@@ -178,6 +501,15 @@ void GaussianProcessGuider::UpdateGP(double prediction_point /*= std::numeric_li
     begin = std::clock();
 #endif
 
+    // Lomb-Scargle estimates the period from the irregularly sampled data
+    Eigen::VectorXd raw_timestamps;
+    Eigen::VectorXd raw_gear_error;
+    if (request.parameters.lomb_scargle_period_)
+    {
+        raw_timestamps = timestamps;
+        raw_gear_error = gear_error;
+    }
+
     // regularize the measurements
     Eigen::MatrixXd result = regularize_dataset(timestamps, gear_error, variances);
 
@@ -215,12 +547,20 @@ void GaussianProcessGuider::UpdateGP(double prediction_point /*= std::numeric_li
 #endif
 
     // calculate period length if we have enough points already
-    double period_length = GetGPHyperparameters()[PKPeriodLength];
-    if (GetBoolComputePeriod() && get_last_point().timestamp > parameters.min_periods_for_period_estimation_ * period_length)
+    double period_length = get_hyperparameters(gp)[PKPeriodLength];
+    if (request.parameters.compute_period_
+        && request.last_timestamp > request.parameters.min_periods_for_period_estimation_ * period_length)
     {
-        // find periodicity parameter with FFT
-        period_length = EstimatePeriodLength(timestamps, gear_error_detrend);
-        UpdatePeriodLength(period_length);
+        if (request.parameters.lomb_scargle_period_)
+        {
+            period_length = EstimatePeriodLengthLombScargle(raw_timestamps, raw_gear_error);
+        }
+        else
+        {
+            // find periodicity parameter with FFT
+            period_length = EstimatePeriodLength(timestamps, gear_error_detrend, workspace);
+        }
+        filter_period_length(gp, period_length, request.learning_rate);
 
 #if PRINT_TIMINGS_
         end = std::clock();
@@ -233,7 +573,7 @@ void GaussianProcessGuider::UpdateGP(double prediction_point /*= std::numeric_li
 #endif
 
     // inference of the GP with the new points, maximum accuracy should be reached around current time
-    gp_.inferSD(timestamps, gear_error, parameters.points_for_approximation_, variances, prediction_point);
+    gp.inferSD(timestamps, gear_error, request.parameters.points_for_approximation_, variances, request.prediction_point);
 
 #if PRINT_TIMINGS_
     end = std::clock();
@@ -245,12 +585,70 @@ void GaussianProcessGuider::UpdateGP(double prediction_point /*= std::numeric_li
 #endif
 }
 
+std::vector<double> GaussianProcessGuider::OptimizeHyperparameters(const GP& gp, const guide_parameters& parameters)
+{
+    std::vector<double> hyperparameters = get_hyperparameters(gp);
+
+    // the configured values, in the order of the enum, are the center of the allowed range
+    const double configured[] = { parameters.SE0KLengthScale_, parameters.SE0KSignalVariance_,
+                                  parameters.PKLengthScale_, parameters.PKSignalVariance_,
+                                  parameters.SE1KLengthScale_, parameters.SE1KSignalVariance_ };
+    const int num_optimized = PKPeriodLength; // all parameters before the period length
+
+    // optimize in log space, where the bounds are relative
+    Eigen::VectorXd start(num_optimized);
+    Eigen::VectorXd lower(num_optimized);
+    Eigen::VectorXd upper(num_optimized);
+    for (int i = 0; i < num_optimized; ++i)
+    {
+        double center = std::log(std::max(configured[i], 1e-10));
+        double current = std::log(std::max(hyperparameters[i], 1e-10));
+        current = std::min(std::max(current, center - OPTIMIZATION_MAX_RANGE), center + OPTIMIZATION_MAX_RANGE);
+
+        start(i) = current;
+        lower(i) = std::max(current - OPTIMIZATION_MAX_STEP, center - OPTIMIZATION_MAX_RANGE);
+        upper(i) = std::min(current + OPTIMIZATION_MAX_STEP, center + OPTIMIZATION_MAX_RANGE);
+    }
+
+    GP trial(gp);
+    auto to_hyperparameters = [&hyperparameters, num_optimized](const Eigen::VectorXd& log_values)
+    {
+        std::vector<double> values(hyperparameters);
+        for (int i = 0; i < num_optimized; ++i)
+        {
+            values[i] = std::exp(log_values(i));
+        }
+        return values;
+    };
+    auto objective = [&trial, &to_hyperparameters](const Eigen::VectorXd& log_values)
+    {
+        set_hyperparameters(trial, to_hyperparameters(log_values)); // runs the inference
+        return trial.negativeLogLikelihood();
+    };
+
+    Eigen::VectorXd optimum = start;
+    math_tools::minimize_lbfgs(objective, &optimum, lower, upper, OPTIMIZATION_ITERATIONS);
+
+    // keep the start if the optimization failed numerically
+    double start_value = objective(start);
+    double optimum_value = objective(optimum);
+    if (math_tools::isNaN(optimum_value) || !(optimum_value < start_value))
+    {
+        optimum = start;
+    }
+
+    GPDebug->Log("PPEC hyperparameter optimization: neg. log likelihood %.2f -> %.2f",
+        start_value, std::min(start_value, optimum_value));
+
+    return to_hyperparameters(optimum);
+}
+
 double GaussianProcessGuider::PredictGearError(double prediction_location)
 {
     // in the first step of each sequence, use the current time stamp as last prediction end
     if (last_prediction_end_ < 0.0)
     {
-        last_prediction_end_ = std::chrono::duration<double>(std::chrono::system_clock::now() - start_time_).count();
+        last_prediction_end_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time_).count();
     }
 
     // prediction from the last endpoint to the prediction point
@@ -269,7 +667,8 @@ double GaussianProcessGuider::PredictGearError(double prediction_location)
     return (p1 - p0);
 }
 
-double GaussianProcessGuider::result(double input, double SNR, double time_step, double prediction_point /*= -1*/)
+double GaussianProcessGuider::result(double input, double SNR, double time_step, double prediction_point /*= -1*/,
+                                     std::chrono::steady_clock::time_point measurement_time /*= time_point()*/)
 {
     /*
      * Dithering behaves differently from pausing. During dithering, the mount
@@ -297,12 +696,16 @@ double GaussianProcessGuider::result(double input, double SNR, double time_step,
     // the starting time is set at the first call of result after startup or reset
     if (get_number_of_measurements() == 1)
     {
-        start_time_ = std::chrono::system_clock::now();
+        start_time_ = std::chrono::steady_clock::now();
         last_time_ = start_time_; // this is OK, since last_time_ only provides a minor correction
+        if (measurement_time != std::chrono::steady_clock::time_point())
+        {
+            start_time_ = measurement_time; // the first measurement defines the time origin
+        }
     }
 
     // collect data point content, except for the control signal
-    HandleGuiding(input, SNR);
+    HandleGuiding(input, SNR, measurement_time);
 
     // calculate hysteresis result, too, for hybrid control
     double last_control = 0.0;
@@ -321,15 +724,27 @@ double GaussianProcessGuider::result(double input, double SNR, double time_step,
     }
     assert(std::abs(control_signal_) == 0.0 || std::abs(input) >= parameters.min_move_);
 
+    if (prediction_point < 0.0)
+    {
+        prediction_point = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time_).count();
+    }
+
+    // a prior model from an earlier session predicts the gear error until the GP takes over
+    double prior_control = 0.0;
+    double prior_weight = PriorWeight();
+    if (prior_weight > 0.0)
+    {
+        double prior_prediction = PriorGearError(prediction_point + time_step + dither_offset_)
+            - PriorGearError(last_prediction_end_);
+        prior_control = prior_weight * parameters.prediction_gain_ * prior_prediction;
+        hysteresis_control += prior_control;
+    }
+
     // calculate GP prediction
     if (get_number_of_measurements() > 10)
     {
-        if (prediction_point < 0.0)
-        {
-            prediction_point = std::chrono::duration<double>(std::chrono::system_clock::now() - start_time_).count();
-        }
         // the point of highest precision shoud be between now and the next step
-        UpdateGP(prediction_point + 0.5 * time_step);
+        UpdateModel(prediction_point + 0.5 * time_step);
 
         // the prediction should end after one time step
         prediction_ = PredictGearError(prediction_point + time_step);
@@ -347,6 +762,7 @@ double GaussianProcessGuider::result(double input, double SNR, double time_step,
     }
     else
     {
+        control_signal_ += prior_control;
         period_length = GetGPHyperparameters()[PKPeriodLength]; // for logging
     }
 
@@ -362,9 +778,9 @@ double GaussianProcessGuider::result(double input, double SNR, double time_step,
     add_one_point(); // add new point here, since the control is for the next point in time
     HandleControls(control_signal_); // already store control signal
 
-    GPDebug->Log("PPEC rslt: input = %.2f, final = %.2f, react = %.2f, pred = %.2f, hyst = %.2f, hyst_pct = %.2f, period_length = %.2f",
+    GPDebug->Log("PPEC rslt: input = %.2f, final = %.2f, react = %.2f, pred = %.2f, hyst = %.2f, hyst_pct = %.2f, period_length = %.2f, prior = %.2f",
         input, control_signal_, parameters.control_gain_ * input, parameters.prediction_gain_ * prediction_, hysteresis_control,
-        hyst_percentage, period_length);
+        hyst_percentage, period_length, prior_control);
 
     return control_signal_;
 }
@@ -380,15 +796,31 @@ double GaussianProcessGuider::deduceResult(double time_step, double prediction_p
     {
         if (prediction_point < 0.0)
         {
-            prediction_point = std::chrono::duration<double>(std::chrono::system_clock::now() - start_time_).count();
+            prediction_point = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time_).count();
         }
         // the point of highest precision should be between now and the next step
-        UpdateGP(prediction_point + 0.5 * time_step);
+        UpdateModel(prediction_point + 0.5 * time_step);
 
         // the prediction should end after one time step
         prediction_ = PredictGearError(prediction_point + time_step);
         control_signal_ += prediction_; // control based on prediction
     }
+    else if (PriorWeight() > 0.0)
+    {
+        if (prediction_point < 0.0)
+        {
+            prediction_point = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time_).count();
+        }
+        if (last_prediction_end_ < 0.0)
+        {
+            last_prediction_end_ = get_last_point().timestamp;
+        }
+
+        // without enough data for the GP, the prior model from an earlier session predicts
+        double prediction_end = prediction_point + time_step + dither_offset_;
+        control_signal_ += PriorWeight() * (PriorGearError(prediction_end) - PriorGearError(last_prediction_end_));
+        last_prediction_end_ = prediction_end;
+    }
 
     add_one_point(); // add new point here, since the control is for the next point in time
     HandleControls(control_signal_); // already store control signal
@@ -405,10 +837,123 @@ double GaussianProcessGuider::deduceResult(double time_step, double prediction_p
     return control_signal_;
 }
 
+double GaussianProcessGuider::PriorGearError(double gear_time) const
+{
+    int num_bins = static_cast<int>(prior_bins_.size());
+
+    double phase = (gear_time + prior_phase_offset_) / prior_period_length_;
+    phase = (phase - std::floor(phase)) * num_bins;
+
+    int lower = std::min(static_cast<int>(phase), num_bins - 1);
+    int upper = (lower + 1) % num_bins; // the model is periodic
+    double fraction = phase - lower;
+
+    return (1.0 - fraction) * prior_bins_[lower] + fraction * prior_bins_[upper];
+}
+
+double GaussianProcessGuider::PriorWeight() const
+{
+    if (prior_bins_.empty() || prior_weight_ <= 0.0)
+    {
+        return 0.0;
+    }
+
+    // the same span over which the GP prediction is blended in
+    double warmup = parameters.min_periods_for_inference_ * GetGPHyperparameters()[PKPeriodLength];
+    if (warmup <= 0.0)
+    {
+        return 0.0;
+    }
+    double percentage = std::min(std::max(get_last_point().timestamp / warmup, 0.0), 1.0);
+
+    return prior_weight_ * (1.0 - percentage);
+}
+
+bool GaussianProcessGuider::GetPhaseModel(int num_bins, double *period_length, std::vector<double> *bins) const
+{
+    double period = GetGPHyperparameters()[PKPeriodLength];
+
+    // only export a model the GP is fully trusted with
+    if (num_bins < 2 || get_number_of_measurements() <= 10)
+    {
+        return true;
+    }
+    double last_timestamp = get_second_last_point().timestamp; // the last point holds the next control
+    if (last_timestamp < std::max(parameters.min_periods_for_inference_, 1.0) * period)
+    {
+        return true;
+    }
+
+    // sample the last period, the additional point at the end measures the drift
+    double begin = last_timestamp - period;
+    Eigen::VectorXd locations(num_bins + 1);
+    for (int i = 0; i < num_bins; ++i)
+    {
+        locations(i) = begin + i * period / num_bins;
+    }
+    locations(num_bins) = last_timestamp;
+
+    Eigen::VectorXd prediction = gp_.predictProjected(locations);
+
+    // the periodic part repeats after one period, the rest is drift
+    double drift = (prediction(num_bins) - prediction(0)) / period;
+    Eigen::VectorXd periodic = prediction.head(num_bins) - drift * (locations.head(num_bins).array() - begin).matrix();
+    periodic.array() -= periodic.mean();
+
+    *period_length = period;
+    bins->assign(periodic.data(), periodic.data() + num_bins);
+    return false;
+}
+
+void GaussianProcessGuider::SetPriorModel(double period_length, const std::vector<double>& bins, double phase_offset, double weight)
+{
+    if (period_length <= 0.0 || bins.size() < 2)
+    {
+        prior_bins_.clear();
+        prior_weight_ = 0.0;
+        return;
+    }
+
+    prior_bins_ = bins;
+    prior_period_length_ = period_length;
+    prior_phase_offset_ = phase_offset;
+    prior_weight_ = std::min(std::max(weight, 0.0), 1.0);
+}
+
+bool GaussianProcessGuider::SetLearnedHyperparameters(const std::vector<double>& learned)
+{
+    if (learned.size() != NumParameters)
+    {
+        return true;
+    }
+
+    std::vector<double> hyperparameters = GetGPHyperparameters();
+
+    // the same range as for the optimization, the configured values may have changed since
+    const double configured[] = { parameters.SE0KLengthScale_, parameters.SE0KSignalVariance_,
+                                  parameters.PKLengthScale_, parameters.PKSignalVariance_,
+                                  parameters.SE1KLengthScale_, parameters.SE1KSignalVariance_ };
+    for (int i = 0; i < PKPeriodLength; ++i)
+    {
+        if (!(learned[i] > 0.0) || std::isinf(learned[i])) // also rejects NaN
+        {
+            return true;
+        }
+        double center = std::log(std::max(configured[i], 1e-10));
+        double value = std::log(learned[i]);
+        value = std::min(std::max(value, center - OPTIMIZATION_MAX_RANGE), center + OPTIMIZATION_MAX_RANGE);
+        hyperparameters[i] = std::exp(value);
+    }
+
+    UseGPHyperparameters(hyperparameters);
+    return false;
+}
+
 void GaussianProcessGuider::reset()
 {
     circular_buffer_data_.clear();
     gp_.clearData();
+    ++model_generation_; // drop models that are still being fit to the old data
 
     // We need to add a first data point because the measurements are always relative to the control.
     // For the first measurement, we therefore need to add a point with zero control.
@@ -416,12 +961,15 @@ void GaussianProcessGuider::reset()
     circular_buffer_data_[0].control = 0; // set first control to zero
 
     last_prediction_end_ = -1.0; // the negative value signals we didn't predict yet
-    start_time_ = std::chrono::system_clock::now();
-    last_time_ = std::chrono::system_clock::now();
+    start_time_ = std::chrono::steady_clock::now();
+    last_time_ = std::chrono::steady_clock::now();
 
     dither_offset_ = 0.0;
     dither_steps_ = 0;
     dithering_active_ = false;
+
+    prior_bins_.clear(); // a prior must be set again after each reset
+    prior_weight_ = 0.0;
 }
 
 void GaussianProcessGuider::GuidingDithered(double amt, double rate)
@@ -469,46 +1017,59 @@ bool GaussianProcessGuider::SetBoolComputePeriod(bool active) {
     return false;
 }
 
-std::vector<double> GaussianProcessGuider::GetGPHyperparameters() const
-{
-    // since the GP class works in log space, we have to exp() the parameters first.
-    Eigen::VectorXd hyperparameters_full = gp_.getHyperParameters().array().exp();
-    // remove first parameter, which is unused here
-    Eigen::VectorXd hyperparameters = hyperparameters_full.tail(NumParameters);
-
-    // converts the length-scale of the periodic covariance from standard notation to natural units
-    hyperparameters(PKLengthScale) = std::asin(hyperparameters(PKLengthScale)/4.0)*hyperparameters(PKPeriodLength)/M_PI;
+bool GaussianProcessGuider::GetBoolLombScarglePeriod() const {
+    return parameters.lomb_scargle_period_;
+}
 
-    // we need to map the Eigen::vector into a std::vector.
-    return std::vector<double>(hyperparameters.data(), // the first element is at the array address
-                               hyperparameters.data() + NumParameters);
+bool GaussianProcessGuider::SetBoolLombScarglePeriod(bool active) {
+    parameters.lomb_scargle_period_ = active;
+    return false;
 }
 
-bool GaussianProcessGuider::SetGPHyperparameters(std::vector<double> const &hyperparameters)
-{
-    Eigen::VectorXd hyperparameters_eig = Eigen::VectorXd::Map(&hyperparameters[0], hyperparameters.size());
+bool GaussianProcessGuider::GetBoolIncrementalInference() const {
+    return parameters.incremental_inference_;
+}
 
-    // prevent length scales from becoming too small (makes GP unstable)
-    hyperparameters_eig(SE0KLengthScale) = std::max(hyperparameters_eig(SE0KLengthScale), 1.0);
-    hyperparameters_eig(PKLengthScale) = std::max(hyperparameters_eig(PKLengthScale), 1.0);
-    hyperparameters_eig(SE1KLengthScale) = std::max(hyperparameters_eig(SE1KLengthScale), 1.0);
+bool GaussianProcessGuider::SetBoolIncrementalInference(bool active) {
+    parameters.incremental_inference_ = active;
+    return false;
+}
 
-    // converts the length-scale of the periodic covariance from natural units to standard notation
-    hyperparameters_eig(PKLengthScale) = 4*std::sin(hyperparameters_eig(PKLengthScale)
-            *M_PI/hyperparameters_eig(PKPeriodLength));
+bool GaussianProcessGuider::GetBoolOptimizeHyperparameters() const {
+    return parameters.optimize_hyperparameters_;
+}
 
-    // safeguard all parameters from being too small (log conversion)
-    hyperparameters_eig = hyperparameters_eig.array().max(1e-10);
+bool GaussianProcessGuider::SetBoolOptimizeHyperparameters(bool active) {
+    parameters.optimize_hyperparameters_ = active;
+    return false;
+}
 
-    // need to convert to GP parameters
-    Eigen::VectorXd hyperparameters_full(NumParameters + 1); // the GP has one more parameter!
-    hyperparameters_full << 1.0, hyperparameters_eig;
+std::vector<double> GaussianProcessGuider::GetGPHyperparameters() const
+{
+    return get_hyperparameters(gp_);
+}
 
-    // the GP works in log space, therefore we need to convert
-    gp_.setHyperParameters(hyperparameters_full.array().log());
+bool GaussianProcessGuider::SetGPHyperparameters(std::vector<double> const &hyperparameters)
+{
+    // remember the configured values, the hyperparameter optimization stays around them
+    parameters.SE0KLengthScale_ = hyperparameters[SE0KLengthScale];
+    parameters.SE0KSignalVariance_ = hyperparameters[SE0KSignalVariance];
+    parameters.PKLengthScale_ = hyperparameters[PKLengthScale];
+    parameters.PKSignalVariance_ = hyperparameters[PKSignalVariance];
+    parameters.SE1KLengthScale_ = hyperparameters[SE1KLengthScale];
+    parameters.SE1KSignalVariance_ = hyperparameters[SE1KSignalVariance];
+    parameters.PKPeriodLength_ = hyperparameters[PKPeriodLength];
+
+    UseGPHyperparameters(hyperparameters);
     return false;
 }
 
+void GaussianProcessGuider::UseGPHyperparameters(const std::vector<double>& hyperparameters)
+{
+    set_hyperparameters(gp_, hyperparameters);
+    ++model_generation_; // the background thread has to pick up the new values
+}
+
 double GaussianProcessGuider::GetMinMove() const {
     return parameters.min_move_;
 }
@@ -554,24 +1115,54 @@ bool GaussianProcessGuider::SetPredictionGain(double prediction_gain) {
     return false;
 }
 
+bool GaussianProcessGuider::GetAsyncUpdates() const {
+    return async_updater_ != nullptr;
+}
+
+bool GaussianProcessGuider::SetAsyncUpdates(bool active) {
+    if (active && !async_updater_)
+    {
+        async_updater_.reset(new AsyncUpdater(gp_, model_generation_));
+    }
+    else if (!active)
+    {
+        async_updater_.reset(); // joins the background thread
+    }
+    return false;
+}
+
+void GaussianProcessGuider::WaitForModelUpdate()
+{
+    if (!async_updater_)
+    {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(async_updater_->mutex);
+    AsyncUpdater *updater = async_updater_.get();
+    updater->done.wait(lock, [updater] { return !updater->request_pending && !updater->busy; });
+    updater->Adopt(&gp_, model_generation_);
+}
+
 void GaussianProcessGuider::inject_data_point(double timestamp, double input, double SNR, double control) {
     // collect data point content, except for the control signal
-    HandleGuiding(input, SNR);
+    HandleGuiding(input, SNR, std::chrono::steady_clock::time_point());
     last_prediction_end_ = timestamp;
     get_last_point().timestamp = timestamp; // overrides the usual HandleTimestamps();
 
-    start_time_ = std::chrono::system_clock::now() - std::chrono::seconds((int) timestamp);
+    start_time_ = std::chrono::steady_clock::now() - std::chrono::seconds((int) timestamp);
 
     add_one_point(); // add new point here, since the control is for the next point in time
     HandleControls(control); // already store control signal
 }
 
-double GaussianProcessGuider::EstimatePeriodLength(const Eigen::VectorXd& time, const Eigen::VectorXd& data) {
+double GaussianProcessGuider::EstimatePeriodLength(const Eigen::VectorXd& time, const Eigen::VectorXd& data,
+                                                   math_tools::SpectrumWorkspace *workspace) {
     // compute Hamming window to reduce spectral leakage
-    Eigen::VectorXd windowed_data = data.array() * math_tools::hamming_window(data.rows()).array();
+    Eigen::VectorXd windowed_data = data.array() * workspace->hamming_window(data.rows()).array();
 
     // compute the spectrum
-    std::pair<Eigen::VectorXd, Eigen::VectorXd> result = math_tools::compute_spectrum(windowed_data, FFT_SIZE);
+    std::pair<Eigen::VectorXd, Eigen::VectorXd> result = workspace->compute_spectrum(windowed_data, FFT_SIZE);
 
     Eigen::ArrayXd amplitudes = result.first;
     Eigen::ArrayXd frequencies = result.second;
@@ -581,50 +1172,9 @@ double GaussianProcessGuider::EstimatePeriodLength(const Eigen::VectorXd& time,
     frequencies /= dt; // correct for the average time step width
 
     Eigen::ArrayXd periods = 1/frequencies.array();
-    amplitudes = (periods > 1500.0).select(0,amplitudes); // set amplitudes to zero for too large periods
-
-    assert(amplitudes.size() == frequencies.size());
-
-    Eigen::VectorXd::Index maxIndex;
-    amplitudes.maxCoeff(&maxIndex);
-
-    double max_frequency = frequencies(maxIndex);
-
-    // quadratic interpolation to find maximum
-    // check if we can interpolate
-    if (maxIndex < frequencies.size() - 1 && maxIndex > 0)
-    {
-        double spread = std::abs(frequencies(maxIndex - 1) - frequencies(maxIndex + 1));
-
-        Eigen::VectorXd interp_loc(3);
-        interp_loc << frequencies(maxIndex - 1), frequencies(maxIndex), frequencies(maxIndex + 1);
-        interp_loc = interp_loc.array() - max_frequency; // centering for numerical stability
-        interp_loc = interp_loc.array() / spread; // normalize for numerical stability
-
-        Eigen::VectorXd interp_dat(3);
-        interp_dat << amplitudes(maxIndex - 1), amplitudes(maxIndex), amplitudes(maxIndex + 1);
-        interp_dat = interp_dat.array() / amplitudes(maxIndex); // normalize for numerical stability
-
-        // we need to handle the case where all amplitudes are equal
-        // the linear regression would be unstable in this case
-        if (interp_dat.maxCoeff() - interp_dat.minCoeff() < 1e-10)
-        {
-            return 1 / max_frequency; // don't do the linear regression
-        }
-
-
-        // building feature matrix
-        Eigen::MatrixXd phi(3,3);
-        phi.row(0) = interp_loc.array().pow(2);
-        phi.row(1) = interp_loc.array().pow(1);
-        phi.row(2) = interp_loc.array().pow(0);
+    amplitudes = (periods > MAX_PERIOD_LENGTH).select(0,amplitudes); // set amplitudes to zero for too large periods
 
-        // standard equation for linear regression
-        Eigen::VectorXd w = (phi*phi.transpose()).ldlt().solve(phi*interp_dat);
-
-        // recovering the maximum from the weights relative to the frequency of the maximum
-        max_frequency = max_frequency - w(1)/(2*w(0))*spread; // note the de-normalization
-    }
+    double max_frequency = peak_frequency(frequencies, amplitudes);
 
 #if SAVE_FFT_DATA_
     {
@@ -647,29 +1197,42 @@ double GaussianProcessGuider::EstimatePeriodLength(const Eigen::VectorXd& time,
     return period_length;
 }
 
+double GaussianProcessGuider::EstimatePeriodLengthLombScargle(const Eigen::VectorXd& time, const Eigen::VectorXd& data) {
+    // linear least squares regression for offset and drift to de-trend the data
+    Eigen::MatrixXd feature_matrix(2, time.rows());
+    feature_matrix.row(0) = Eigen::MatrixXd::Ones(1, time.rows());
+    feature_matrix.row(1) = time.array();
+    Eigen::VectorXd weights = (feature_matrix*feature_matrix.transpose()
+    + 1e-3*Eigen::Matrix<double, 2, 2>::Identity()).ldlt().solve(feature_matrix*data);
+    Eigen::VectorXd data_detrend = data - feature_matrix.transpose()*weights;
+
+    // the frequency resolution follows the span of the data
+    double span = time(time.rows()-1) - time(0);
+    double min_frequency = 1 / MAX_PERIOD_LENGTH;
+    double max_frequency = 1 / MIN_PERIOD_LENGTH;
+    double frequency_step = 1 / (LOMB_SCARGLE_OVERSAMPLING * span);
+    int num_frequencies = static_cast<int>(std::ceil((max_frequency - min_frequency) / frequency_step)) + 1;
+
+    // shift the time origin into the data for better conditioned phases
+    Eigen::VectorXd centered_time = time.array() - 0.5 * (time(0) + time(time.rows()-1));
+    Eigen::ArrayXd amplitudes = math_tools::lomb_scargle(centered_time, data_detrend,
+        min_frequency, frequency_step, num_frequencies);
+    Eigen::ArrayXd frequencies = Eigen::ArrayXd::LinSpaced(num_frequencies, 0, num_frequencies - 1) * frequency_step
+        + min_frequency;
+
+    return 1 / peak_frequency(frequencies, amplitudes);
+}
+
 void GaussianProcessGuider::UpdatePeriodLength(double period_length)
 {
-    std::vector<double> hypers = GetGPHyperparameters();
-
-    // assert for the developers...
-    assert(!math_tools::isNaN(period_length));
-
-    // ...and save the day for the users
-    if (math_tools::isNaN(period_length))
-    {
-            period_length = hypers[PKPeriodLength]; // just use the old value instead
-    }
-
-    // we just apply a simple learning rate to slow down parameter jumps
-    hypers[PKPeriodLength] = (1 - learning_rate_) * hypers[PKPeriodLength] + learning_rate_ * period_length;
-
-    SetGPHyperparameters(hypers); // the setter function is needed to convert parameters
+    filter_period_length(gp_, period_length, learning_rate_);
+    ++model_generation_;
 }
 
 Eigen::MatrixXd GaussianProcessGuider::regularize_dataset(const Eigen::VectorXd& timestamps,
     const Eigen::VectorXd& gear_error, const Eigen::VectorXd& variances)
 {
-    size_t N = get_number_of_measurements();
+    size_t N = timestamps.size();
     double grid_interval = GRID_INTERVAL;
     double last_cell_end = -grid_interval;
     double last_timestamp = -grid_interval;
@@ -683,7 +1246,7 @@ Eigen::MatrixXd GaussianProcessGuider::regularize_dataset(const Eigen::VectorXd&
     Eigen::VectorXd reg_gear_error(grid_size);
     Eigen::VectorXd reg_variances(grid_size);
     int j = 0;
-    for (size_t i = 0; i < N-1; ++i)
+    for (size_t i = 0; i < N; ++i)
     {
         if (timestamps(i) < last_cell_end + grid_interval)
         {
@@ -48,6 +48,8 @@
 #include "math_tools.h"
 
 #include <chrono>
+#include <memory>
+#include <vector>
 
 enum Hyperparameters
 {
@@ -95,6 +97,9 @@ public:
         int points_for_approximation_;
 
         bool compute_period_;
+        bool lomb_scargle_period_;
+        bool incremental_inference_;
+        bool optimize_hyperparameters_;
 
         double SE0KLengthScale_;
         double SE0KSignalVariance_;
@@ -112,6 +117,9 @@ public:
             min_periods_for_period_estimation_(0.0),
             points_for_approximation_(0),
             compute_period_(false),
+            lomb_scargle_period_(false),
+            incremental_inference_(true),
+            optimize_hyperparameters_(false),
             SE0KLengthScale_(0.0),
             SE0KSignalVariance_(0.0),
             PKLengthScale_(0.0),
@@ -126,8 +134,8 @@ public:
 
 private:
 
-    std::chrono::system_clock::time_point start_time_; // reference time
-    std::chrono::system_clock::time_point last_time_;
+    std::chrono::steady_clock::time_point start_time_; // reference time
+    std::chrono::steady_clock::time_point last_time_;
 
     double control_signal_;
     double prediction_;
@@ -145,6 +153,11 @@ private:
     covariance_functions::PeriodicSquareExponential output_covariance_function_; // for prediction
     GP gp_;
 
+    /**
+     * Keeps the FFT plan and buffers for the period estimation between updates.
+     */
+    math_tools::SpectrumWorkspace spectrum_workspace_;
+
     /**
      * Learning rate for smooth parameter adaptation.
      */
@@ -156,14 +169,53 @@ private:
     guide_parameters parameters;
 
     /**
-     * Stores the current time and creates a timestamp for the GP.
+     * A copy of everything a refit of the GP needs, so that the refit does not
+     * depend on the state of the guider and can run on a background thread.
+     */
+    struct fit_request
+    {
+        std::vector<data_point> data; // oldest first
+        double last_timestamp;
+        double prediction_point;
+        double learning_rate;
+        guide_parameters parameters;
+        Eigen::VectorXd hyperparameters; // in the log space of the GP
+        unsigned int generation;
+    };
+
+    /**
+     * Refits the GP on a background thread when asynchronous updates are
+     * active, nullptr otherwise.
+     */
+    struct AsyncUpdater;
+    std::unique_ptr<AsyncUpdater> async_updater_;
+
+    /**
+     * Counts the resets and hyperparameter changes. A model refit in the
+     * background is only used if no such change happened in the meantime.
+     */
+    unsigned int model_generation_;
+
+    /**
+     * A phase-folded gear error model from an earlier session, see
+     * SetPriorModel. The bins are empty if there is no such model.
+     */
+    std::vector<double> prior_bins_;
+    double prior_period_length_;
+    double prior_phase_offset_;
+    double prior_weight_;
+
+    /**
+     * Creates a timestamp for the GP. If the measurement time is not known
+     * (default-constructed time point), the midpoint between the previous and
+     * the current call is used.
      */
-    void SetTimestamp();
+    void SetTimestamp(std::chrono::steady_clock::time_point measurement_time);
 
     /**
      * Stores the measurement, SNR and resets last_prediction_end_.
      */
-    void HandleGuiding(double input, double SNR);
+    void HandleGuiding(double input, double SNR, std::chrono::steady_clock::time_point measurement_time);
 
     /**
      * Stores a zero as blind "measurement" with high variance.
@@ -184,7 +236,48 @@ private:
     /**
      * Estimates the main period length for a given dataset.
      */
-    double EstimatePeriodLength(const Eigen::VectorXd& time, const Eigen::VectorXd& data);
+    static double EstimatePeriodLength(const Eigen::VectorXd& time, const Eigen::VectorXd& data,
+                                       math_tools::SpectrumWorkspace *workspace);
+
+    /**
+     * Estimates the main period length with a Lomb-Scargle periodogram over
+     * the plausible band of worm periods. Works on irregularly sampled data,
+     * which does not need to be regularized.
+     */
+    static double EstimatePeriodLengthLombScargle(const Eigen::VectorXd& time, const Eigen::VectorXd& data);
+
+    /**
+     * Copies the current data and parameters into a fit request.
+     */
+    void FillFitRequest(fit_request *request, double prediction_point) const;
+
+    /**
+     * Regularizes and detrends the data of the request, estimates the period
+     * length if requested and runs the inference on the given GP.
+     */
+    static void FitGP(GP& gp, const fit_request& request, math_tools::SpectrumWorkspace *workspace);
+
+    /**
+     * Maximizes the marginal likelihood of the data subset held by the fitted
+     * GP over the length scales and signal variances with L-BFGS, keeping
+     * the period length. Each call moves the parameters by a bounded step and
+     * stays in a range around the configured values. Returns all
+     * hyperparameters in natural units.
+     */
+    static std::vector<double> OptimizeHyperparameters(const GP& gp, const guide_parameters& parameters);
+
+    /**
+     * Sets the hyperparameters of the GP and makes the background thread
+     * pick them up.
+     */
+    void UseGPHyperparameters(const std::vector<double>& hyperparameters);
+
+    /**
+     * Updates the GP for the next prediction, either directly or, with
+     * asynchronous updates, by using the latest model from the background
+     * thread and handing the new data over to it.
+     */
+    void UpdateModel(double prediction_point);
 
     /**
      * Calculates the difference in gear error for the time between the last
@@ -193,7 +286,18 @@ private:
      */
     double PredictGearError(double prediction_location);
 
+    /**
+     * Evaluates the prior model at the given gear time by linear
+     * interpolation between the phase bins.
+     */
+    double PriorGearError(double gear_time) const;
 
+    /**
+     * Returns the weight of the prior model for the current data. The weight
+     * decays linearly to zero while the GP collects the data it needs for
+     * inference, i.e., while the GP prediction is blended in.
+     */
+    double PriorWeight() const;
 
 public:
     double GetControlGain() const;
@@ -214,12 +318,80 @@ public:
     bool GetBoolComputePeriod() const;
     bool SetBoolComputePeriod(bool active);
 
+    /**
+     * Estimates the period length with Lomb-Scargle on the raw measurements
+     * instead of the FFT of the regularized data.
+     */
+    bool GetBoolLombScarglePeriod() const;
+    bool SetBoolLombScarglePeriod(bool active);
+
+    /**
+     * With incremental inference, the GP keeps the factorization of the data
+     * points that stay in the approximation and only updates it for the
+     * points that enter or leave. Changes of the hyperparameters still need a
+     * full inference.
+     */
+    bool GetBoolIncrementalInference() const;
+    bool SetBoolIncrementalInference(bool active);
+
+    /**
+     * Optimizes the length scales and signal variances on the background
+     * thread once per period and applies the result at the next step. Only
+     * active with asynchronous updates. The values set with
+     * SetGPHyperparameters are the center of the allowed range.
+     */
+    bool GetBoolOptimizeHyperparameters() const;
+    bool SetBoolOptimizeHyperparameters(bool active);
+
     std::vector<double> GetGPHyperparameters() const;
     bool SetGPHyperparameters(const std::vector<double>& hyperparameters);
 
     double GetPredictionGain() const;
     bool SetPredictionGain(double);
 
+    /**
+     * With asynchronous updates, the GP is refit on a background thread and
+     * result() only evaluates the most recent model, which lags the data by
+     * about one step. This keeps the run time of result() independent of the
+     * amount of data collected.
+     */
+    bool GetAsyncUpdates() const;
+    bool SetAsyncUpdates(bool active);
+
+    /**
+     * Waits until the background thread has refit the GP to the latest data
+     * and uses the new model. Useful for testing.
+     */
+    void WaitForModelUpdate();
+
+    /**
+     * Exports the periodic part of the learned gear error, folded over one
+     * period and sampled at num_bins equally spaced phases. Bin k holds the
+     * gear error at k / num_bins of a period after the most recent
+     * measurement; the model has zero mean and no drift. Returns true if
+     * there is not enough data for a reliable model.
+     */
+    bool GetPhaseModel(int num_bins, double *period_length, std::vector<double> *bins) const;
+
+    /**
+     * Sets a phase model from an earlier session as a prior for the gear
+     * error. The gear time t of this session corresponds to phase
+     * (t + phase_offset) / period_length of the model. The prior is used for
+     * the prediction until the GP has collected enough data, with a weight
+     * that starts at the given weight and decays with the fresh data. A reset
+     * removes the prior.
+     */
+    void SetPriorModel(double period_length, const std::vector<double>& bins, double phase_offset, double weight);
+
+    /**
+     * Starts the hyperparameter optimization from the length scales and
+     * signal variances learned in an earlier session, limited to the range
+     * around the configured values. The period length is kept. Unlike
+     * SetGPHyperparameters, the configured values stay unchanged. Returns
+     * true if the hyperparameters are invalid.
+     */
+    bool SetLearnedHyperparameters(const std::vector<double>& hyperparameters);
+
     GaussianProcessGuider(guide_parameters parameters);
     ~GaussianProcessGuider();
 
@@ -228,8 +400,13 @@ public:
      * stored, 2. the GP is updated with the new data point, 3. the prediction
      * is calculated to compensate the gear error and 4. the controller is
      * calculated, consisting of feedback and prediction parts.
+     *
+     * The measurement_time is the (steady clock) time at which the input was
+     * measured, usually the midpoint of the exposure. If it is not given, the
+     * measurement time is inferred from the time between calls.
      */
-    double result(double input, double SNR, double time_step, double prediction_point = -1.0);
+    double result(double input, double SNR, double time_step, double prediction_point = -1.0,
+                  std::chrono::steady_clock::time_point measurement_time = std::chrono::steady_clock::time_point());
 
     /**
      * This method provides predictive control if no measurement could be made.
@@ -304,7 +481,7 @@ public:
     /**
      * Takes timestamps, measurements and SNRs and returns them regularized in a matrix.
      */
-    Eigen::MatrixXd regularize_dataset(const Eigen::VectorXd& timestamps, const Eigen::VectorXd& gear_error, const Eigen::VectorXd& variances);
+    static Eigen::MatrixXd regularize_dataset(const Eigen::VectorXd& timestamps, const Eigen::VectorXd& gear_error, const Eigen::VectorXd& variances);
 
     /**
      * Saves the GP data to a csv file for external analysis. Expensive!
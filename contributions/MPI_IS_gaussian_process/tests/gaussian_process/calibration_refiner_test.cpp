@@ -0,0 +1,311 @@
+/*
+*  calibration_refiner_test.cpp
+*  PHD2 Guiding
+*
+*  Copyright (c) 2026 openphdguiding.org
+*  All rights reserved.
+*
+*  This source code is distributed under the following "BSD" license
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*    Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+*    Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the
+*     documentation and/or other materials provided with the distribution.
+*    Neither the name of openphdguiding.org nor the names of its
+*     contributors may be used to endorse or promote products derived from
+*     this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+/*
+ * Tests the PHD2 calibration refiner in a simulated guiding loop. A mount with
+ * known response vectors is guided, with dithers, using a calibration the
+ * refiner may change the way Mount does: the refiner has to bring a calibration
+ * that is off close to the mount, leave a correct calibration alone, and
+ * restore the calibration it started from when it diverges.
+ */
+
+// calibration_refiner.cpp needs only PHD_Point and GuideAxis from phd.h
+#define PHD_H_INCLUDED
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <assert.h>
+#include <math.h>
+#include <random>
+
+// PHD_Point can keep a start time for its rate computations, which the refiner does not use
+typedef long long wxLongLong_t;
+struct wxLongLong
+{
+    wxLongLong_t GetValue() const { return 0; }
+};
+static wxLongLong wxGetUTCTimeMillis()
+{
+    return wxLongLong();
+}
+
+enum GuideAxis
+{
+    GUIDE_RA,
+    GUIDE_X = GUIDE_RA,
+    GUIDE_DEC,
+    GUIDE_Y = GUIDE_DEC,
+};
+
+#include "point.h"
+#include "calibration_refiner.h"
+#include "calibration_refiner.cpp"
+
+static double Radians(double degrees)
+{
+    return degrees * M_PI / 180.0;
+}
+
+static double NormAngle(double angle)
+{
+    return remainder(angle, 2.0 * M_PI);
+}
+
+// Relative length of the difference between the response vectors of two calibrations
+static double ResponseError(const CalibrationEstimate& cal, const CalibrationEstimate& truth, GuideAxis axis)
+{
+    double rate = axis == GUIDE_RA ? cal.xRate : cal.yRate;
+    double angle = axis == GUIDE_RA ? cal.xAngle : cal.yAngle;
+    double trueRate = axis == GUIDE_RA ? truth.xRate : truth.yRate;
+    double trueAngle = axis == GUIDE_RA ? truth.xAngle : truth.yAngle;
+    return hypot(rate * cos(angle) - trueRate * cos(trueAngle), rate * sin(angle) - trueRate * sin(trueAngle)) / trueRate;
+}
+
+/*
+ * One guide frame every step: the star drifts and is measured with noise, the
+ * refiner is fed like Mount::MoveOffset feeds it, its results are applied like
+ * Mount::ApplyCalibrationRefinement does, and a proportional correction is
+ * computed with the current calibration and carried out with the true response.
+ */
+class GuidingLoop
+{
+    std::mt19937 generator;
+    std::normal_distribution<double> noise;
+    std::uniform_real_distribution<double> ditherDist;
+    PHD_Point star;
+    PHD_Point lock;
+    double prevMove[2];
+
+public:
+    CalibrationEstimate truth;      // response of the mount
+    CalibrationEstimate cal;        // calibration used for guiding
+    CalibrationRefiner refiner;
+    unsigned int frames;
+    unsigned int applied;           // refined calibrations taken over
+    unsigned int diverged;
+
+    GuidingLoop(const CalibrationEstimate& mount, const CalibrationEstimate& calibration, unsigned int seed)
+        : generator(seed), noise(0.0, 0.3), ditherDist(-5.0, 5.0), star(0.0, 0.0), lock(0.0, 0.0),
+          truth(mount), cal(calibration), frames(0), applied(0), diverged(0)
+    {
+        prevMove[0] = prevMove[1] = 0.0;
+        refiner.Reset(cal);
+    }
+
+    void Step()
+    {
+        // drift in RA and Dec
+        star.X += 0.1 * cos(truth.xAngle) + 0.05 * cos(truth.yAngle);
+        star.Y += 0.1 * sin(truth.xAngle) + 0.05 * sin(truth.yAngle);
+
+        if (frames > 0 && frames % 30 == 0)
+        {
+            lock.X += ditherDist(generator);
+            lock.Y += ditherDist(generator);
+            prevMove[0] = prevMove[1] = 0.0;
+        }
+        ++frames;
+
+        PHD_Point measured(star.X + noise(generator), star.Y + noise(generator));
+
+        bool updated = refiner.AddPosition(measured, 1.0, 1.0);
+        if (refiner.Diverged())
+        {
+            cal = refiner.Prior();
+            refiner.Reset(cal);
+            ++diverged;
+        }
+        else if (updated)
+        {
+            CalibrationEstimate est;
+            refiner.GetEstimate(&est);
+            bool refineRA = refiner.IsImprovement(GUIDE_RA, cal.xRate, cal.xAngle);
+            bool refineDec = refiner.IsImprovement(GUIDE_DEC, cal.yRate, cal.yAngle);
+            if (refineRA)
+            {
+                cal.xRate = est.xRate;
+                cal.xAngle = est.xAngle;
+            }
+            if (refineDec)
+            {
+                cal.yRate = est.yRate;
+                cal.yAngle = est.yAngle;
+            }
+            if (refineRA || refineDec)
+                ++applied;
+        }
+
+        // camera to mount coordinates, as in Mount::TransformCameraCoordinatesToMountCoordinates
+        PHD_Point offset = measured - lock;
+        double hyp = hypot(offset.X, offset.Y);
+        double theta = atan2(offset.Y, offset.X);
+        double yAngleError = NormAngle(cal.xAngle - cal.yAngle + M_PI / 2.0);
+        double mountOfs[2] = { cos(theta - cal.xAngle) * hyp, sin(theta - (cal.xAngle + yAngleError)) * hyp };
+        double rates[2] = { cal.xRate, cal.yRate };
+
+        double pulse[2];
+        for (int i = 0; i < 2; i++)
+        {
+            double move = 0.7 * (0.9 * mountOfs[i] + 0.1 * prevMove[i]);
+            prevMove[i] = move;
+            if (fabs(move) < 0.15)
+                move = 0.0;
+            pulse[i] = round(std::max(-2500.0, std::min(2500.0, move / rates[i])));
+        }
+        refiner.AddPulses(pulse[0], pulse[1]);
+
+        // a positive pulse moves the star back along the calibration angle
+        star.X -= pulse[0] * truth.xRate * cos(truth.xAngle) + pulse[1] * truth.yRate * cos(truth.yAngle);
+        star.Y -= pulse[0] * truth.xRate * sin(truth.xAngle) + pulse[1] * truth.yRate * sin(truth.yAngle);
+    }
+
+    void Run(unsigned int count)
+    {
+        for (unsigned int i = 0; i < count; i++)
+            Step();
+    }
+};
+
+class CalibrationRefinerTest : public ::testing::Test
+{
+protected:
+    CalibrationEstimate mount;
+    CalibrationEstimate offCalibration;     // 25% and 7 degrees off in RA, 20% and 6 degrees in Dec
+
+    CalibrationRefinerTest()
+    {
+        mount.xRate = 0.006;
+        mount.yRate = 0.005;
+        mount.xAngle = Radians(30.0);
+        mount.yAngle = Radians(120.0);
+
+        offCalibration.xRate = 0.0075;
+        offCalibration.yRate = 0.006;
+        offCalibration.xAngle = Radians(37.0);
+        offCalibration.yAngle = Radians(126.0);
+    }
+};
+
+TEST_F(CalibrationRefinerTest, rate_and_angle_errors_converge)
+{
+    for (unsigned int seed = 1; seed <= 5; seed++)
+    {
+        GuidingLoop loop(mount, offCalibration, seed);
+        double raError = ResponseError(loop.cal, mount, GUIDE_RA);
+        double decError = ResponseError(loop.cal, mount, GUIDE_DEC);
+        EXPECT_GT(raError, 0.25);
+        EXPECT_GT(decError, 0.2);
+
+        // dithering every minute for about three hours
+        loop.Run(6000);
+
+        EXPECT_GE(loop.applied, 1u) << "seed " << seed;
+        EXPECT_EQ(loop.diverged, 0u) << "seed " << seed;
+        EXPECT_LT(ResponseError(loop.cal, mount, GUIDE_RA), 0.5 * raError) << "seed " << seed;
+        EXPECT_LT(ResponseError(loop.cal, mount, GUIDE_DEC), 0.5 * decError) << "seed " << seed;
+        EXPECT_NEAR(loop.cal.xRate, mount.xRate, 0.15 * mount.xRate) << "seed " << seed;
+        EXPECT_NEAR(loop.cal.yRate, mount.yRate, 0.15 * mount.yRate) << "seed " << seed;
+        EXPECT_NEAR(NormAngle(loop.cal.xAngle - mount.xAngle), 0.0, Radians(5.0)) << "seed " << seed;
+        EXPECT_NEAR(NormAngle(loop.cal.yAngle - mount.yAngle), 0.0, Radians(5.0)) << "seed " << seed;
+        EXPECT_GT(loop.refiner.Confidence(GUIDE_RA), 0.8) << "seed " << seed;
+        EXPECT_GT(loop.refiner.Confidence(GUIDE_DEC), 0.8) << "seed " << seed;
+    }
+}
+
+TEST_F(CalibrationRefinerTest, correct_calibration_stays_unchanged)
+{
+    for (unsigned int seed = 1; seed <= 5; seed++)
+    {
+        GuidingLoop loop(mount, mount, seed);
+        loop.Run(6000);
+
+        EXPECT_EQ(loop.applied, 0u) << "seed " << seed;
+        EXPECT_EQ(loop.diverged, 0u) << "seed " << seed;
+        EXPECT_EQ(loop.cal.xRate, mount.xRate);
+        EXPECT_EQ(loop.cal.yRate, mount.yRate);
+        EXPECT_EQ(loop.cal.xAngle, mount.xAngle);
+        EXPECT_EQ(loop.cal.yAngle, mount.yAngle);
+
+        // the refiner did learn the response, it just found nothing to change
+        EXPECT_GT(loop.refiner.Confidence(GUIDE_RA), 0.8) << "seed " << seed;
+        EXPECT_GT(loop.refiner.Confidence(GUIDE_DEC), 0.8) << "seed " << seed;
+        EXPECT_LT(loop.refiner.RelativeError(GUIDE_RA), 0.05);
+    }
+}
+
+TEST_F(CalibrationRefinerTest, reverts_to_prior_when_diverging)
+{
+    GuidingLoop loop(mount, offCalibration, 1);
+    while (loop.applied == 0 && loop.frames < 6000)
+        loop.Step();
+    ASSERT_GE(loop.applied, 1u);
+    EXPECT_TRUE(loop.cal.xRate != offCalibration.xRate || loop.cal.yRate != offCalibration.yRate);
+
+    // the Dec response reverses, e.g. after a meridian flip the mount did not report
+    loop.truth.yAngle += M_PI;
+    unsigned int flipped = loop.frames;
+    while (loop.diverged == 0 && loop.frames < flipped + 300)
+        loop.Step();
+    ASSERT_EQ(loop.diverged, 1u);
+
+    // the calibration the refinement started from is restored, not the refined one
+    EXPECT_EQ(loop.cal.xRate, offCalibration.xRate);
+    EXPECT_EQ(loop.cal.yRate, offCalibration.yRate);
+    EXPECT_EQ(loop.cal.xAngle, offCalibration.xAngle);
+    EXPECT_EQ(loop.cal.yAngle, offCalibration.yAngle);
+    EXPECT_EQ(loop.refiner.SampleCount(), 0u);
+    EXPECT_FALSE(loop.refiner.Diverged());
+
+    // an estimate that leaves the plausible range diverges as well
+    CalibrationRefiner refiner;
+    refiner.Reset(mount);
+    PHD_Point pos(100.0, 100.0);
+    refiner.AddPosition(pos, 1.0, 1.0);
+    for (int i = 0; i < 20 && !refiner.Diverged(); i++)
+    {
+        // the star moves five times as far as the calibration predicts
+        refiner.AddPulses(1000.0, 0.0);
+        pos.X -= 5.0 * 1000.0 * mount.xRate * cos(mount.xAngle);
+        pos.Y -= 5.0 * 1000.0 * mount.xRate * sin(mount.xAngle);
+        refiner.AddPosition(pos, 1.0, 1.0);
+    }
+    EXPECT_TRUE(refiner.Diverged());
+    EXPECT_EQ(refiner.Prior().xRate, mount.xRate);
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -220,6 +220,70 @@ TEST_F(GPTest, infer_prediction_clear_test)
     EXPECT_NEAR(prediction(1), 0, 1e-6);
 }
 
+TEST_F(GPTest, negative_log_likelihood_test)
+{
+    Eigen::VectorXd data_loc = Eigen::VectorXd::LinSpaced(20, 0, 10);
+    Eigen::VectorXd data_out = (data_loc.array() * 0.7).sin() + 0.1 * data_loc.array() + 0.5;
+    Eigen::VectorXd data_var = 0.01 * Eigen::VectorXd::Ones(20);
+
+    Eigen::MatrixXd gram = covariance_function_.evaluate(data_loc, data_loc);
+    gram += data_var.asDiagonal();
+    Eigen::MatrixXd gram_inv = gram.inverse();
+    double log_det_gram = std::log(gram.determinant());
+
+    // without the trend, this is the plain Gaussian likelihood
+    double expected = 0.5 * (data_out.dot(gram_inv * data_out) + log_det_gram + 20 * std::log(2 * M_PI));
+    gp_.infer(data_loc, data_out, data_var);
+    EXPECT_NEAR(gp_.negativeLogLikelihood(), expected, 1e-8);
+
+    gp_.enableIncrementalInference();
+    EXPECT_NEAR(gp_.negativeLogLikelihood(), expected, 1e-8);
+
+    // the weights of the trend are integrated out
+    Eigen::MatrixXd features(2, 20);
+    features.row(0) = Eigen::RowVectorXd::Ones(20);
+    features.row(1) = data_loc.transpose();
+    Eigen::MatrixXd feature_matrix = features * gram_inv * features.transpose();
+    Eigen::MatrixXd correction = gram_inv * features.transpose() * feature_matrix.inverse() * features * gram_inv;
+    expected = 0.5 * (data_out.dot((gram_inv - correction) * data_out) + log_det_gram
+        + std::log(feature_matrix.determinant()) + 18 * std::log(2 * M_PI));
+
+    gp_.enableExplicitTrend();
+    gp_.infer();
+    EXPECT_NEAR(gp_.negativeLogLikelihood(), expected, 1e-8);
+
+    gp_.disableIncrementalInference();
+    EXPECT_NEAR(gp_.negativeLogLikelihood(), expected, 1e-8);
+}
+
+TEST_F(GPTest, incremental_inference_singular_gram_test)
+{
+    // repeated locations without noise make the Gram matrix singular, the
+    // plain Cholesky factorization fails and the inference falls back to LDLT
+    Eigen::VectorXd data_loc(4);
+    data_loc << 1, 1, 2, 2;
+    Eigen::VectorXd data_out(4);
+    data_out << 1, 1, 2, 2;
+    Eigen::VectorXd data_var = Eigen::VectorXd::Zero(4);
+
+    gp_.enableIncrementalInference();
+    gp_.inferSD(data_loc, data_out, 4, data_var);
+
+    Eigen::VectorXd prediction_location(2);
+    prediction_location << 1, 2;
+    Eigen::VectorXd prediction = gp_.predict(prediction_location);
+
+    EXPECT_NEAR(prediction(0), 1, 1e-4);
+    EXPECT_NEAR(prediction(1), 2, 1e-4);
+
+    // the next update has no factor to build on and infers from scratch
+    data_var << 0.01, 0.01, 0.01, 0.01;
+    gp_.inferSD(data_loc, data_out, 4, data_var);
+    prediction = gp_.predict(prediction_location);
+    EXPECT_NEAR(prediction(0), 1, 0.1);
+    EXPECT_NEAR(prediction(1), 2, 0.1);
+}
+
 TEST_F(GPTest, squareDistanceTest)
 {
     Eigen::MatrixXd a(4, 3);
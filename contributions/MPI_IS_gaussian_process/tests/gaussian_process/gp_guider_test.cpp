@@ -139,6 +139,22 @@ TEST_F(GPGTest, simple_result_test)
     GPG->save_gp_data();
 }
 
+TEST_F(GPGTest, measurement_time_test)
+{
+    auto t0 = std::chrono::steady_clock::now() - std::chrono::seconds(10);
+
+    // the first measurement defines the time origin
+    GPG->result(1.0, 2.0, 3.0, -1.0, t0);
+    EXPECT_NEAR(GPG->get_second_last_point().timestamp, 0.0, 1e-6);
+
+    // later measurements are stamped with the given time, not the time of the call
+    GPG->result(1.0, 2.0, 3.0, -1.0, t0 + std::chrono::milliseconds(2500));
+    EXPECT_NEAR(GPG->get_second_last_point().timestamp, 2.5, 1e-6);
+
+    GPG->result(1.0, 2.0, 3.0, -1.0, t0 + std::chrono::milliseconds(5000));
+    EXPECT_NEAR(GPG->get_second_last_point().timestamp, 5.0, 1e-6);
+}
+
 TEST_F(GPGTest, period_identification_test)
 {
     // first: prepare a nice GP with a sine wave
@@ -217,6 +233,93 @@ TEST_F(GPGTest, gp_prediction_test)
     GPG->save_gp_data();
 }
 
+TEST_F(GPGTest, async_update_test)
+{
+    double period_length = 300;
+    double max_time = 5*period_length;
+    int resolution = 600;
+    double prediction_length = 3.0;
+    Eigen::VectorXd locations(2);
+    Eigen::VectorXd predictions(2);
+    Eigen::VectorXd timestamps = Eigen::VectorXd::LinSpaced(resolution + 1, 0, max_time);
+    Eigen::VectorXd measurements = 50*(timestamps.array()*2*M_PI/period_length).sin();
+    Eigen::VectorXd controls = 0*measurements;
+    Eigen::VectorXd SNRs = 100*Eigen::VectorXd::Ones(resolution + 1);
+
+    locations << max_time, max_time + prediction_length;
+    predictions = 50*(locations.array()*2*M_PI/period_length).sin();
+
+    GPG->SetAsyncUpdates(true);
+    EXPECT_TRUE(GPG->GetAsyncUpdates());
+
+    for (int i = 0; i < timestamps.size(); ++i)
+    {
+        GPG->inject_data_point(timestamps[i], measurements[i], SNRs[i], controls[i]);
+    }
+
+    // no model was published yet, so this is a pure P-controller
+    EXPECT_NEAR(GPG->result(0.25, 2.0, prediction_length, max_time), 0.25*0.8, 1e-6);
+
+    // the next step uses the model fit in the background
+    GPG->WaitForModelUpdate();
+    EXPECT_NEAR(GPG->result(0.25, 2.0, prediction_length, max_time), 0.25*0.8+predictions[1]-predictions[0], 2e-1);
+
+    // a model fit to the data from before a reset must not be used afterwards
+    GPG->reset();
+    for (int i = 0; i < timestamps.size(); ++i)
+    {
+        GPG->inject_data_point(timestamps[i], measurements[i], SNRs[i], controls[i]);
+    }
+    GPG->WaitForModelUpdate();
+    EXPECT_NEAR(GPG->result(0.25, 2.0, prediction_length, max_time), 0.25*0.8, 1e-6);
+
+    GPG->SetAsyncUpdates(false);
+    EXPECT_FALSE(GPG->GetAsyncUpdates());
+
+    GPG->save_gp_data();
+}
+
+TEST_F(GPGTest, hyperparameter_optimization_test)
+{
+    double period_length = 300;
+    double max_time = 5*period_length;
+    int resolution = 600;
+    double prediction_length = 3.0;
+    Eigen::VectorXd timestamps = Eigen::VectorXd::LinSpaced(resolution + 1, 0, max_time);
+    Eigen::VectorXd measurements = 50*(timestamps.array()*2*M_PI/period_length).sin()
+        + 0.5*math_tools::generate_normal_random_matrix(resolution + 1, 1).array();
+    Eigen::VectorXd controls = 0*measurements;
+    Eigen::VectorXd SNRs = 100*Eigen::VectorXd::Ones(resolution + 1);
+
+    GPG->SetAsyncUpdates(true);
+    GPG->SetBoolOptimizeHyperparameters(true);
+    EXPECT_TRUE(GPG->GetBoolOptimizeHyperparameters());
+
+    std::vector<double> initial = GPG->GetGPHyperparameters();
+
+    for (int i = 0; i < timestamps.size(); ++i)
+    {
+        GPG->inject_data_point(timestamps[i], measurements[i], SNRs[i], controls[i]);
+    }
+    GPG->result(0.25, 2.0, prediction_length, max_time);
+
+    // the optimization runs after the fit, its result is used in the next step
+    GPG->WaitForModelUpdate();
+    GPG->result(0.25, 2.0, prediction_length, max_time);
+
+    std::vector<double> optimized = GPG->GetGPHyperparameters();
+    double change = 0;
+    for (int i = 0; i < PKPeriodLength; ++i)
+    {
+        double step = std::abs(std::log(optimized[i] / initial[i]));
+        EXPECT_LE(step, 0.2 + 1e-6); // bounded step per optimization
+        change += step;
+    }
+    EXPECT_GT(change, 0.01);
+
+    GPG->SetAsyncUpdates(false);
+}
+
 TEST_F(GPGTest, parameters_test)
 {
     EXPECT_NEAR(GPG->GetControlGain(), DefaultControlGain, 1e-6);
@@ -516,6 +619,114 @@ TEST_F(GPGTest, data_regularization_test)
     GPG->save_gp_data();
 }
 
+TEST_F(GPGTest, lomb_scargle_period_test)
+{
+    double period_length = 317;
+    double max_time = 5000;
+    int resolution = 2000;
+
+    // irregular time stamps with a gap, as after a cloud
+    Eigen::VectorXd timestamps(resolution);
+    timestamps << Eigen::VectorXd::LinSpaced(resolution/2, 0, max_time/3),
+        Eigen::VectorXd::LinSpaced(resolution/2, max_time/2, max_time);
+    timestamps += 0.5*math_tools::generate_normal_random_matrix(resolution, 1);
+
+    Eigen::VectorXd measurements = 50*(timestamps.array()*2*M_PI/period_length).sin();
+    Eigen::VectorXd controls = 0*measurements;
+    Eigen::VectorXd SNRs = 100*Eigen::VectorXd::Ones(resolution);
+
+    GPG->SetBoolLombScarglePeriod(true);
+    EXPECT_TRUE(GPG->GetBoolLombScarglePeriod());
+
+    // feed data to the GPGuider
+    for (int i = 0; i < timestamps.size(); ++i)
+    {
+        GPG->inject_data_point(timestamps[i], measurements[i], SNRs[i], controls[i]);
+    }
+    GPG->result(0.15, 2.0, 3.0);
+
+    EXPECT_NEAR(GPG->GetGPHyperparameters()[PKPeriodLength], period_length, 1);
+
+    GPG->save_gp_data();
+}
+
+TEST_F(GPGTest, phase_model_warm_start_test)
+{
+    double period_length = 300;
+    double max_time = 5*period_length;
+    int resolution = 600;
+    int num_bins = 64;
+    double prediction_length = 3.0;
+    Eigen::VectorXd timestamps = Eigen::VectorXd::LinSpaced(resolution + 1, 0, max_time);
+    Eigen::VectorXd measurements = 50*(timestamps.array()*2*M_PI/period_length).sin();
+    Eigen::VectorXd controls = 0*measurements;
+    Eigen::VectorXd SNRs = 100*Eigen::VectorXd::Ones(resolution + 1);
+
+    double model_period_length;
+    std::vector<double> bins;
+
+    // no model without data
+    EXPECT_TRUE(GPG->GetPhaseModel(num_bins, &model_period_length, &bins));
+
+    for (int i = 0; i < timestamps.size(); ++i)
+    {
+        GPG->inject_data_point(timestamps[i], measurements[i], SNRs[i], controls[i]);
+    }
+    GPG->result(0.15, 2.0, prediction_length, max_time);
+
+    // the bins start at the last measurement, which is in phase with the sine
+    ASSERT_FALSE(GPG->GetPhaseModel(num_bins, &model_period_length, &bins));
+    ASSERT_EQ(bins.size(), num_bins);
+    EXPECT_NEAR(model_period_length, period_length, 1);
+    for (int i = 0; i < num_bins; ++i)
+    {
+        EXPECT_NEAR(bins[i], 50*std::sin(2*M_PI*i/num_bins), 2.0);
+    }
+
+    // a new session that starts half a period later in the worm cycle
+    double phase_offset = 0.5*period_length;
+    GPG->reset();
+    GPG->SetPriorModel(model_period_length, bins, phase_offset, 1.0);
+
+    // without any data, the control follows the prior model
+    double expected = 50*std::sin(2*M_PI*(prediction_length + phase_offset)/period_length)
+        - 50*std::sin(2*M_PI*phase_offset/period_length);
+    EXPECT_NEAR(GPG->result(0.0, 2.0, prediction_length, 0.0), expected, 0.3);
+
+    // a reset removes the prior
+    GPG->reset();
+    EXPECT_NEAR(GPG->result(0.0, 2.0, prediction_length, 0.0), 0.0, 1e-10);
+}
+
+TEST_F(GPGTest, learned_hyperparameters_test)
+{
+    std::vector<double> configured = GPG->GetGPHyperparameters();
+
+    std::vector<double> learned(configured);
+    learned[SE0KLengthScale] *= 2.0;
+    learned[PKSignalVariance] *= 0.5;
+    learned[SE1KLengthScale] *= 100.0; // beyond the range of the optimization
+    learned[PKPeriodLength] = 2*configured[PKPeriodLength];
+    EXPECT_FALSE(GPG->SetLearnedHyperparameters(learned));
+
+    // the period length is kept, the others are limited to the range around the configured values
+    std::vector<double> restored = GPG->GetGPHyperparameters();
+    EXPECT_NEAR(restored[SE0KLengthScale], 2.0*configured[SE0KLengthScale], 1e-6);
+    EXPECT_NEAR(restored[PKSignalVariance], 0.5*configured[PKSignalVariance], 1e-6);
+    EXPECT_NEAR(restored[SE1KLengthScale], std::exp(2.0)*configured[SE1KLengthScale], 1e-6);
+    EXPECT_NEAR(restored[PKPeriodLength], configured[PKPeriodLength], 1e-6);
+
+    // invalid values leave the hyperparameters unchanged
+    learned[SE0KSignalVariance] = -1.0;
+    EXPECT_TRUE(GPG->SetLearnedHyperparameters(learned));
+    EXPECT_TRUE(GPG->SetLearnedHyperparameters(std::vector<double>(2, 1.0)));
+    std::vector<double> unchanged = GPG->GetGPHyperparameters();
+    for (int i = 0; i < NumParameters; ++i)
+    {
+        EXPECT_NEAR(unchanged[i], restored[i], 1e-9);
+    }
+}
+
 /**
  * This "test" is used to log the identified period length to file. This functionality
  * can be useful for debugging and for assessing the value of the period interpolation,
@@ -40,6 +40,8 @@
 #include <iostream>
 #include "gaussian_process_guider.h"
 #include "guide_performance_tools.h"
+#include "guide_replay_tools.h"
+#include "zfilterfactory.h"
 
 #include <fstream>
 #include <thread>
@@ -65,6 +67,7 @@ public:
 
     static const bool   DefaultComputePeriod;
 
+    GaussianProcessGuider::guide_parameters parameters;
     GaussianProcessGuider* GPG;
     GAHysteresis GAH;
     std::string filename;
@@ -72,7 +75,6 @@ public:
 
     GuidePerformanceTest(): GPG(0), improvement(0.0)
     {
-        GaussianProcessGuider::guide_parameters parameters;
         parameters.control_gain_ = DefaultControlGain;
         parameters.min_periods_for_inference_ = DefaultPeriodLengthsInference;
         parameters.min_move_ = DefaultMinMove;
@@ -179,6 +181,212 @@ TEST_F(GuidePerformanceTest, performance_dataset08)
     EXPECT_GT(improvement, 0);
 }
 
+TEST_F(GuidePerformanceTest, incremental_inference_equivalence)
+{
+    Eigen::ArrayXXd data = read_data_from_file("performance_dataset04.txt");
+    double exposure = get_exposure_from_file("performance_dataset04.txt");
+
+    Eigen::ArrayXd times = data.row(0);
+    Eigen::ArrayXd measurements = data.row(1);
+    Eigen::ArrayXd SNRs = data.row(3);
+
+    // with fixed hyperparameters, the factorization is only updated incrementally
+    parameters.compute_period_ = false;
+    parameters.incremental_inference_ = true;
+    GaussianProcessGuider incremental(parameters);
+    parameters.incremental_inference_ = false;
+    GaussianProcessGuider full(parameters);
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::duration incremental_time(0);
+    std::chrono::steady_clock::duration full_time(0);
+    double max_difference = 0.0;
+
+    for (int i = 0; i < times.size(); ++i)
+    {
+        double time = times(i) - times(0);
+        auto measurement_time = t0 + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(time));
+
+        auto begin = std::chrono::steady_clock::now();
+        double incremental_control = incremental.result(measurements(i), SNRs(i), exposure, time, measurement_time);
+        auto middle = std::chrono::steady_clock::now();
+        double full_control = full.result(measurements(i), SNRs(i), exposure, time, measurement_time);
+        auto end = std::chrono::steady_clock::now();
+
+        incremental_time += middle - begin;
+        full_time += end - middle;
+        max_difference = std::max(max_difference, std::abs(incremental_control - full_control));
+    }
+
+    std::cout << "Maximal difference of incremental and full inference: " << max_difference << std::endl;
+    std::cout << "Time incremental: " << std::chrono::duration<double>(incremental_time).count()
+              << " s, full: " << std::chrono::duration<double>(full_time).count() << " s" << std::endl;
+    EXPECT_LT(max_difference, 1e-6);
+}
+
+TEST_F(GuidePerformanceTest, replay_matches_hysteresis_simulator)
+{
+    Eigen::ArrayXXd data = read_data_from_file("performance_dataset01.txt");
+
+    Eigen::ArrayXd measurements = data.row(1);
+    Eigen::ArrayXd controls = data.row(2);
+
+    // the simulator of calculate_improvement()
+    double state = measurements(0);
+    double sum_squares = 0.0;
+    for (int i = 0; i < measurements.size() - 1; ++i)
+    {
+        state = state + (measurements(i+1) - (measurements(i) - controls(i))) - GAH.result(state);
+        sum_squares += state * state;
+    }
+    double rms = std::sqrt(sum_squares / (measurements.size() - 1));
+
+    ReplayTrack track;
+    ASSERT_FALSE(read_replay_track("performance_dataset01.txt", 0, &track));
+    ASSERT_EQ(track.measurements.size(), static_cast<size_t>(measurements.size()));
+    EXPECT_NEAR(track.exposure, get_exposure_from_file("performance_dataset01.txt"), 1e-9);
+
+    std::unique_ptr<ReplayAlgorithm> hysteresis(create_replay_algorithm("hysteresis"));
+    ReplayResult result = replay_track(track, hysteresis.get());
+    EXPECT_NEAR(result.rms, rms, 1e-9);
+}
+
+TEST_F(GuidePerformanceTest, replay_all_algorithms)
+{
+    ReplayTrack track;
+    ASSERT_FALSE(read_replay_track("performance_dataset07.txt", 1, &track));
+
+    std::vector<std::string> names = replay_algorithm_names();
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        std::unique_ptr<ReplayAlgorithm> algorithm(create_replay_algorithm(names[i]));
+        ASSERT_TRUE(algorithm.get() != 0);
+        EXPECT_EQ(algorithm->GetName(), names[i]);
+
+        // the parameters are validated like in the PHD2 algorithms
+        EXPECT_FALSE(algorithm->SetParam("minMove", -1.0));
+
+        ReplayResult result = replay_track(track, algorithm.get());
+        EXPECT_EQ(result.steps, static_cast<int>(track.times.size()) - 1);
+        EXPECT_TRUE(std::isfinite(result.rms)) << names[i];
+        EXPECT_LE(result.rms, result.peak) << names[i];
+        EXPECT_LE(result.pulses, result.steps) << names[i];
+        EXPECT_LT(result.rms, 1.0) << names[i];
+
+        // a second replay starts from a clean state
+        ReplayResult repeated = replay_track(track, algorithm.get());
+        EXPECT_NEAR(repeated.rms, result.rms, 1e-9) << names[i];
+    }
+
+    EXPECT_TRUE(create_replay_algorithm("unknown") == 0);
+}
+
+TEST_F(GuidePerformanceTest, kalman_beats_hysteresis)
+{
+    // both algorithms with their defaults, on the total RMS of both axes
+    std::unique_ptr<ReplayAlgorithm> hysteresis(create_replay_algorithm("hysteresis"));
+    std::unique_ptr<ReplayAlgorithm> kalman(create_replay_algorithm("kalman"));
+
+    for (int i = 1; i <= 8; ++i)
+    {
+        std::string filename = "performance_dataset0" + std::to_string(i) + ".txt";
+        double hysteresis_ms = 0.0;
+        double kalman_ms = 0.0;
+
+        for (int axis = 0; axis < 2; ++axis)
+        {
+            ReplayTrack track;
+            ASSERT_FALSE(read_replay_track(filename, axis, &track)) << filename;
+
+            ReplayResult result = replay_track(track, hysteresis.get());
+            hysteresis_ms += result.rms * result.rms;
+            result = replay_track(track, kalman.get());
+            kalman_ms += result.rms * result.rms;
+        }
+
+        std::cout << filename << ": total RMS hysteresis " << std::sqrt(hysteresis_ms)
+                  << ", Kalman " << std::sqrt(kalman_ms) << std::endl;
+        EXPECT_LE(std::sqrt(kalman_ms), std::sqrt(hysteresis_ms)) << filename;
+    }
+}
+
+TEST_F(GuidePerformanceTest, lowpass2_equal_sample_times)
+{
+    std::unique_ptr<ReplayAlgorithm> timed(create_replay_algorithm("lowpass2"));
+    std::unique_ptr<ReplayAlgorithm> untimed(create_replay_algorithm("lowpass2"));
+
+    // a slow drift, sampled once per second by the first and always at the same time by the
+    // second, which has to fall back to fitting against the frame index
+    for (int i = 0; i < 12; ++i)
+    {
+        ReplayFrame frame = {};
+        frame.input = 0.3 + 0.01 * i;
+        frame.exposure = 1.0;
+        frame.SNR = 20.0;
+
+        frame.sample_time = i;
+        frame.pulse_time = frame.sample_time + 0.5;
+        double expected = timed->result(frame);
+
+        frame.sample_time = 5.0;
+        frame.pulse_time = 5.5;
+        double move = untimed->result(frame);
+
+        ASSERT_TRUE(std::isfinite(move)) << "frame " << i;
+        EXPECT_NEAR(move, expected, 1e-9) << "frame " << i;
+    }
+
+    // pairs of frames with the same time, like a replayed frame or a coarse clock
+    timed->reset();
+    for (int i = 0; i < 12; ++i)
+    {
+        ReplayFrame frame = {};
+        frame.input = 0.3 + 0.01 * i;
+        frame.sample_time = 2.0 * (i / 2);
+        frame.pulse_time = frame.sample_time + 0.5;
+        double move = timed->result(frame);
+
+        ASSERT_TRUE(std::isfinite(move)) << "frame " << i;
+        EXPECT_LE(std::abs(move), frame.input) << "frame " << i;
+    }
+}
+
+TEST_F(GuidePerformanceTest, zfilter_sections_match_design)
+{
+    FILTER_DESIGN designs[] = { BESSEL, BUTTERWORTH };
+    double corners[] = { 4.0, 8.0, 40.0 };
+
+    for (int d = 0; d < 2; ++d)
+    {
+        for (int order = 1; order <= ZFilterFactory::MaxOrder; ++order)
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                ZFilterFactory factory(designs[d], order, corners[c]);
+                EXPECT_EQ(factory.sections.size(), static_cast<size_t>((order + 1) / 2));
+                EXPECT_LT(factory.sectionerror(256), 1e-9) << factory.getname() << "-" << order;
+
+                // unity gain at DC, settled after a long constant input
+                ZFilterCascade cascade;
+                cascade.Init(factory.sections);
+                double output = 0.0;
+                for (int i = 0; i < 4000; ++i)
+                {
+                    output = cascade.Step(1.0);
+                }
+                EXPECT_NEAR(output, 1.0, 1e-9) << factory.getname() << "-" << order;
+
+                cascade.Reset();
+                EXPECT_NEAR(cascade.Step(0.0), 0.0, 1e-15);
+            }
+        }
+    }
+
+    // the Bessel pole table ends at MaxOrder
+    EXPECT_ANY_THROW(ZFilterFactory(BESSEL, ZFilterFactory::MaxOrder + 1, 8.0));
+}
+
 int main(int argc, char** argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
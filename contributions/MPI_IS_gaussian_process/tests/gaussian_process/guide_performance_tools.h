@@ -32,6 +32,9 @@
 /* Created by Edgar Klenske <edgar.klenske@tuebingen.mpg.de>
  */
 
+#ifndef GUIDE_PERFORMANCE_TOOLS_H
+#define GUIDE_PERFORMANCE_TOOLS_H
+
 #include "gaussian_process_guider.h"
 
 #include <iterator>
@@ -247,3 +250,5 @@ inline double calculate_improvement(std::string filename, GAHysteresis GAH, Gaus
 
     return 1 - gp_guider_rms / hysteresis_rms;
 }
+
+#endif // GUIDE_PERFORMANCE_TOOLS_H
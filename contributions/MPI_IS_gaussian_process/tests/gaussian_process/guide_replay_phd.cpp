@@ -0,0 +1,140 @@
+/*
+*  guide_replay_phd.cpp
+*  PHD2 Guiding
+*
+*  Copyright (c) 2026 openphdguiding.org
+*  All rights reserved.
+*
+*  This source code is distributed under the following "BSD" license
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*    Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+*    Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the
+*     documentation and/or other materials provided with the distribution.
+*    Neither the name of openphdguiding.org nor the names of its
+*     contributors may be used to endorse or promote products derived from
+*     this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+/*
+ * Wraps the PHD2 guide algorithms, built against guide_replay_phd.h, for the
+ * offline replay in guide_replay_tools.h, and defines the globals the
+ * algorithm sources use.
+ */
+
+#include "guide_replay_phd.h"
+#include "guide_replay_tools.h"
+
+#include <memory>
+
+DebugLog Debug;
+static PhdConfig s_config;
+PhdConfig *pConfig = &s_config;
+MyFrame *pFrame = nullptr;
+GuideCamera *pCamera = nullptr;
+
+Scope *TheScope()
+{
+    return nullptr;
+}
+
+/*
+ * A guide algorithm on the time of the recording: the correction of a frame
+ * is sent at its pulse time.
+ */
+template<class ALGORITHM>
+class ReplayClockAlgorithm : public ALGORITHM
+{
+    const std::chrono::steady_clock::time_point *m_now;
+
+public:
+    ReplayClockAlgorithm(Mount *pMount, const std::chrono::steady_clock::time_point *now)
+        : ALGORITHM(pMount, GUIDE_X), m_now(now)
+    {
+    }
+
+protected:
+    std::chrono::steady_clock::time_point Now() const override { return *m_now; }
+};
+
+class ReplayPhdAlgorithm : public ReplayAlgorithm
+{
+    std::string m_name;
+    Mount m_mount;
+    std::chrono::steady_clock::time_point m_now;
+    std::unique_ptr<GuideAlgorithm> m_algorithm;
+
+public:
+    template<class ALGORITHM>
+    static ReplayPhdAlgorithm *Create(const std::string& name)
+    {
+        ReplayPhdAlgorithm *replay = new ReplayPhdAlgorithm(name);
+        replay->m_algorithm.reset(new ReplayClockAlgorithm<ALGORITHM>(&replay->m_mount, &replay->m_now));
+        return replay;
+    }
+
+    std::string GetName() const override { return m_name; }
+
+    void GetParamNames(std::vector<std::string>& names) const override
+    {
+        wxArrayString paramNames;
+        m_algorithm->GetParamNames(paramNames);
+        names.assign(paramNames.begin(), paramNames.end());
+    }
+
+    bool SetParam(const std::string& name, double val) override
+    {
+        return m_algorithm->SetParam(name, val);
+    }
+
+    void reset() override
+    {
+        m_algorithm->reset();
+    }
+
+    double result(const ReplayFrame& frame) override
+    {
+        m_now = replay_time_point(frame.pulse_time);
+        double move = m_algorithm->result(frame.input, replay_time_point(frame.sample_time));
+        // the simulated mount carries out every move in full
+        m_algorithm->GuideMoveApplied(move);
+        return move;
+    }
+
+private:
+    explicit ReplayPhdAlgorithm(const std::string& name) : m_name(name) { }
+};
+
+ReplayAlgorithm *create_phd_replay_algorithm(const std::string& name)
+{
+    if (name == "identity")
+        return ReplayPhdAlgorithm::Create<GuideAlgorithmIdentity>(name);
+    if (name == "hysteresis")
+        return ReplayPhdAlgorithm::Create<GuideAlgorithmHysteresis>(name);
+    if (name == "lowpass")
+        return ReplayPhdAlgorithm::Create<GuideAlgorithmLowpass>(name);
+    if (name == "lowpass2")
+        return ReplayPhdAlgorithm::Create<GuideAlgorithmLowpass2>(name);
+    if (name == "resistswitch")
+        return ReplayPhdAlgorithm::Create<GuideAlgorithmResistSwitch>(name);
+    if (name == "zfilter")
+        return ReplayPhdAlgorithm::Create<GuideAlgorithmZFilter>(name);
+    if (name == "kalman")
+        return ReplayPhdAlgorithm::Create<GuideAlgorithmKalman>(name);
+    return nullptr;
+}
@@ -0,0 +1,281 @@
+/*
+*  guide_replay_phd.h
+*  PHD2 Guiding
+*
+*  Copyright (c) 2026 openphdguiding.org
+*  All rights reserved.
+*
+*  This source code is distributed under the following "BSD" license
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*    Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+*    Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the
+*     documentation and/or other materials provided with the distribution.
+*    Neither the name of openphdguiding.org nor the names of its
+*     contributors may be used to endorse or promote products derived from
+*     this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+/*
+ * Stands in for phd.h when the PHD2 guide algorithms are compiled for the
+ * offline replay in guide_replay_tools.h. The build includes this header
+ * ahead of each algorithm source, so that their own #include "phd.h" finds
+ * PHD_H_INCLUDED already defined. It declares only the part of wxWidgets and
+ * of PHD2 that these sources use: a wxString on top of std::string, a profile
+ * that always returns the defaults, a mount that only has a name, and inert
+ * controls for the configuration panes, which the replay never creates. A
+ * source that starts using anything else fails to compile here, at the new
+ * call.
+ */
+
+#ifndef GUIDE_REPLAY_PHD_H
+#define GUIDE_REPLAY_PHD_H
+
+#define PHD_H_INCLUDED
+
+#include <assert.h>
+#include <math.h>
+#include <chrono>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+class wxString : public std::string
+{
+    template<typename T>
+    static T FormatArg(T arg) { return arg; }
+    static const char *FormatArg(const std::string& arg) { return arg.c_str(); }
+
+public:
+    wxString() { }
+    wxString(const char *s) : std::string(s) { }
+    wxString(const std::string& s) : std::string(s) { }
+
+    template<typename... Args>
+    static wxString Format(const wxString& format, Args... args)
+    {
+        char buf[1024];
+        snprintf(buf, sizeof(buf), format.c_str(), FormatArg(args)...);
+        return wxString(buf);
+    }
+};
+
+typedef std::vector<wxString> wxArrayString;
+
+class ArrayOfDbl : public std::vector<double>
+{
+public:
+    size_t GetCount() const { return size(); }
+    void Add(double val) { push_back(val); }
+    void RemoveAt(size_t index) { erase(begin() + index); }
+    void Empty() { clear(); }
+};
+
+#define wxEmptyString wxString()
+#define _(s) wxString(s)
+#define _T(s) s
+#define WXUNUSED(x)
+#define POSSIBLY_UNUSED(x) (void)(x)
+#define ERROR_INFO(s) wxString(s)
+#define THROW_INFO(s) wxString(s)
+
+template<typename T> inline T wxMin(T a, T b) { return a < b ? a : b; }
+template<typename T> inline T wxMax(T a, T b) { return a > b ? a : b; }
+
+enum
+{
+    wxID_ANY = -1,
+    wxSP_ARROW_KEYS,
+    wxALIGN_RIGHT,
+    wxEVT_COMMAND_SPINCTRL_UPDATED,
+    wxEVT_COMMAND_SPINCTRLDOUBLE_UPDATED,
+};
+
+struct wxPoint
+{
+    wxPoint(int, int) { }
+};
+
+struct wxSize
+{
+    wxSize(int, int) { }
+};
+
+static const wxPoint wxDefaultPosition(-1, -1);
+
+class wxSpinEvent { };
+class wxSpinDoubleEvent { };
+
+// the controls of the configuration panes, none of them is ever created
+class wxWindow
+{
+public:
+    virtual ~wxWindow() { }
+    void Enable(bool = true) { }
+    void SetToolTip(const wxString&) { }
+    template<typename... Args> void Bind(Args...) { }
+};
+
+class wxControl : public wxWindow { };
+
+class wxSpinCtrl : public wxControl
+{
+public:
+    int GetValue() const { return 0; }
+    void SetValue(int) { }
+};
+
+class wxSpinCtrlDouble : public wxControl
+{
+public:
+    double GetValue() const { return 0.0; }
+    void SetValue(double) { }
+    void SetDigits(unsigned int) { }
+};
+
+class wxStaticText : public wxControl
+{
+public:
+    template<typename... Args> wxStaticText(Args...) { }
+};
+
+class wxCheckBox : public wxControl
+{
+public:
+    template<typename... Args> wxCheckBox(Args...) { }
+    bool GetValue() const { return false; }
+    void SetValue(bool) { }
+};
+
+class ConfigDialogPane
+{
+public:
+    ConfigDialogPane(const wxString&, wxWindow *) { }
+    virtual ~ConfigDialogPane() { }
+    virtual void LoadValues() = 0;
+    virtual void UnloadValues() = 0;
+    virtual void OnImageScaleChange() { }
+    virtual void EnableDecControls(bool) { }
+
+protected:
+    template<typename... Args> void DoAdd(Args...) { }
+    int StringWidth(const wxString&) { return 0; }
+};
+
+class GraphControlPane : public wxWindow
+{
+public:
+    GraphControlPane(wxWindow *, const wxString&) { }
+    virtual void EnableDecControls(bool) { }
+
+protected:
+    template<typename... Args> void DoAdd(Args...) { }
+    int StringWidth(const wxString&) { return 0; }
+};
+
+class DebugLog
+{
+public:
+    void Write(const wxString&) { }
+};
+
+// every setting has its default value, nothing is stored
+class PhdProfile
+{
+public:
+    double GetDouble(const wxString&, double defaultValue) const { return defaultValue; }
+    int GetInt(const wxString&, int defaultValue) const { return defaultValue; }
+    bool GetBoolean(const wxString&, bool defaultValue) const { return defaultValue; }
+    void SetDouble(const wxString&, double) { }
+    void SetInt(const wxString&, int) { }
+    void SetBoolean(const wxString&, bool) { }
+    void DeleteGroup(const wxString&) { }
+};
+
+class PhdConfig
+{
+public:
+    PhdProfile Profile;
+};
+
+class AdvancedDialog
+{
+public:
+    int GetFocalLength() const { return 0; }
+    double GetPixelSize() const { return 0.0; }
+    int GetBinning() const { return 1; }
+};
+
+class MyFrame
+{
+public:
+    AdvancedDialog *pAdvancedDialog;
+
+    MyFrame() : pAdvancedDialog(nullptr) { }
+    static double GetPixelScale(double pixelSizeMicrons, int focalLengthMm, int binning)
+    {
+        return 206.265 * pixelSizeMicrons * (double) binning / (double) focalLengthMm;
+    }
+    int GetFocalLength() const { return 0; }
+    template<typename... Args> wxSpinCtrl *MakeSpinCtrl(Args...) { return nullptr; }
+    template<typename... Args> wxSpinCtrlDouble *MakeSpinCtrlDouble(Args...) { return nullptr; }
+    template<typename... Args> void NotifyGuidingParam(Args...) { }
+};
+
+class GuideCamera
+{
+public:
+    double GetCameraPixelSize() const { return 0.0; }
+    int EffectiveBinning() const { return 1; }
+};
+
+enum DEC_GUIDE_MODE
+{
+    DEC_NONE = 0,
+    DEC_AUTO,
+    DEC_NORTH,
+    DEC_SOUTH
+};
+
+class Scope
+{
+public:
+    DEC_GUIDE_MODE GetDecGuideMode() const { return DEC_AUTO; }
+};
+
+class Mount
+{
+public:
+    wxString GetMountClassName() const { return "replay"; }
+};
+
+extern DebugLog Debug;
+extern PhdConfig *pConfig;
+extern MyFrame *pFrame;
+extern GuideCamera *pCamera;
+
+extern Scope *TheScope();
+
+// the GP guider is replayed without GuideAlgorithmGaussianProcess, which needs the whole mount
+#define GUIDE_GAUSSIAN_PROCESS
+
+#include "guiding_stats.h"
+#include "zfilterfactory.h"
+#include "guide_algorithms.h"
+
+#endif // GUIDE_REPLAY_PHD_H
@@ -0,0 +1,387 @@
+/*
+*  guide_replay_tools.h
+*  PHD2 Guiding
+*
+*  Copyright (c) 2026 openphdguiding.org
+*  All rights reserved.
+*
+*  This source code is distributed under the following "BSD" license
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*    Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+*    Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the
+*     documentation and/or other materials provided with the distribution.
+*    Neither the name of openphdguiding.org nor the names of its
+*     contributors may be used to endorse or promote products derived from
+*     this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+/*
+ * Headless replay of recorded guiding data through the PHD2 guide algorithms.
+ *
+ * The GuideAlgorithm classes are built from the PHD2 sources against
+ * guide_replay_phd.h, which stands in for wxWidgets, the mount and the
+ * profile, and are wrapped by create_replay_algorithm(). The GP guider is
+ * used directly, without GuideAlgorithmGaussianProcess.
+ */
+
+#ifndef GUIDE_REPLAY_TOOLS_H
+#define GUIDE_REPLAY_TOOLS_H
+
+#include "gaussian_process_guider.h"
+#include "guide_performance_tools.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+ * One axis of recorded guiding data. The measurements are the star
+ * displacements seen by the guider and the controls are the corrections that
+ * were issued in response (zero for a raw, unguided displacement track).
+ */
+struct ReplayTrack
+{
+    std::string name;
+    double exposure;                    // seconds
+    std::vector<double> times;          // seconds, time at which the frame was received
+    std::vector<double> measurements;   // pixels
+    std::vector<double> controls;       // pixels
+    std::vector<double> SNRs;
+
+    ReplayTrack() : exposure(0.0) { }
+};
+
+/*
+ * The information a guide algorithm gets for one frame.
+ */
+struct ReplayFrame
+{
+    double input;       // pixels, displacement to correct
+    double sample_time; // seconds, midpoint of the exposure
+    double pulse_time;  // seconds, time at which the correction is sent
+    double exposure;    // seconds
+    double SNR;
+};
+
+struct ReplayResult
+{
+    int steps;
+    double rms;         // pixels, RMS of the simulated residual displacement
+    double peak;        // pixels, largest absolute simulated residual
+    int pulses;         // number of non-zero corrections
+    double us_per_step; // microseconds spent in result() per frame
+
+    ReplayResult() : steps(0), rms(0.0), peak(0.0), pulses(0), us_per_step(0.0) { }
+};
+
+/*
+ * Common interface of the replayed guide algorithms. SetParam() returns true
+ * if the parameter was accepted, like GuideAlgorithm::SetParam().
+ */
+class ReplayAlgorithm
+{
+public:
+    virtual ~ReplayAlgorithm() { }
+    virtual std::string GetName() const = 0;
+    virtual void GetParamNames(std::vector<std::string>& names) const = 0;
+    virtual bool SetParam(const std::string& name, double val) = 0;
+    virtual void reset() = 0;
+    virtual double result(const ReplayFrame& frame) = 0;
+};
+
+/*
+ * The steady clock time of a point of the recording. The time is offset from
+ * the epoch, since a default-constructed time point means "not set" to the
+ * guide algorithms.
+ */
+inline std::chrono::steady_clock::time_point replay_time_point(double seconds)
+{
+    return std::chrono::steady_clock::time_point() + std::chrono::hours(1)
+        + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+}
+
+/*
+ * Returns a new instance of the named PHD2 guide algorithm, or a null pointer
+ * if there is none by that name. Defined in guide_replay_phd.cpp.
+ */
+ReplayAlgorithm *create_phd_replay_algorithm(const std::string& name);
+
+/*
+ * The GP guider with the defaults of GuideAlgorithmGaussianProcess. The guider
+ * runs on the virtual time of the recording: each measurement is time-stamped
+ * with its exposure midpoint and the prediction starts at the pulse time.
+ */
+class ReplayGaussianProcess : public ReplayAlgorithm
+{
+    GaussianProcessGuider::guide_parameters m_parameters;
+    std::unique_ptr<GaussianProcessGuider> m_guider;
+    double m_startTime;
+    bool m_started;
+
+public:
+    ReplayGaussianProcess() : m_startTime(0.0), m_started(false)
+    {
+        m_parameters.control_gain_ = 0.6;
+        m_parameters.min_periods_for_inference_ = 2.0;
+        m_parameters.min_move_ = 0.2;
+        m_parameters.SE0KLengthScale_ = 700.0;
+        m_parameters.SE0KSignalVariance_ = 20.0;
+        m_parameters.PKLengthScale_ = 10.0;
+        m_parameters.PKPeriodLength_ = 200.0;
+        m_parameters.PKSignalVariance_ = 20.0;
+        m_parameters.SE1KLengthScale_ = 25.0;
+        m_parameters.SE1KSignalVariance_ = 10.0;
+        m_parameters.min_periods_for_period_estimation_ = 2.0;
+        m_parameters.points_for_approximation_ = 100;
+        m_parameters.prediction_gain_ = 0.5;
+        m_parameters.compute_period_ = true;
+    }
+
+    std::string GetName() const { return "gp"; }
+
+    void GetParamNames(std::vector<std::string>& names) const
+    {
+        names.push_back("minMove");
+        names.push_back("predictiveWeight");
+        names.push_back("reactiveWeight");
+        names.push_back("periodLength");
+    }
+
+    bool SetParam(const std::string& name, double val)
+    {
+        if (name == "minMove" && val >= 0.0)
+            m_parameters.min_move_ = val;
+        else if (name == "predictiveWeight" && val >= 0.0 && val <= 1.0)
+            m_parameters.prediction_gain_ = val;
+        else if (name == "reactiveWeight" && val >= 0.0)
+            m_parameters.control_gain_ = val;
+        else if (name == "periodLength" && val >= 1.0)
+            m_parameters.PKPeriodLength_ = val;
+        else
+            return false;
+        return true;
+    }
+
+    void reset()
+    {
+        m_guider.reset(new GaussianProcessGuider(m_parameters));
+        m_started = false;
+    }
+
+    double result(const ReplayFrame& frame)
+    {
+        if (!m_started)
+        {
+            m_startTime = frame.sample_time;
+            m_started = true;
+        }
+        return m_guider->result(frame.input, frame.SNR, frame.exposure, frame.pulse_time - m_startTime,
+                                replay_time_point(frame.sample_time));
+    }
+};
+
+inline std::vector<std::string> replay_algorithm_names()
+{
+    std::vector<std::string> names;
+    names.push_back("identity");
+    names.push_back("hysteresis");
+    names.push_back("lowpass");
+    names.push_back("lowpass2");
+    names.push_back("resistswitch");
+    names.push_back("zfilter");
+    names.push_back("kalman");
+    names.push_back("gp");
+    return names;
+}
+
+/*
+ * Returns a new instance of the named algorithm, or a null pointer if the
+ * name is unknown.
+ */
+inline ReplayAlgorithm *create_replay_algorithm(const std::string& name)
+{
+    if (name == "gp")
+        return new ReplayGaussianProcess();
+    return create_phd_replay_algorithm(name);
+}
+
+/*
+ * Reads one axis (0 = RA/X, 1 = Dec/Y) of either a PHD2 guide log or a raw
+ * displacement track. A raw track has one frame per line with the time in
+ * seconds followed by the RA and optionally the Dec displacement in pixels;
+ * lines that do not start with a number are ignored. Returns true on error.
+ */
+inline bool read_replay_track(const std::string& filename, int axis, ReplayTrack *track)
+{
+    std::ifstream file(filename);
+    if (!file)
+        return true;
+
+    track->name = filename;
+    track->times.clear();
+    track->measurements.clear();
+    track->controls.clear();
+    track->SNRs.clear();
+    track->exposure = 0.0;
+
+    bool guide_log = false;
+    double dither = 0.0;
+    double time_offset = 0.0;
+    double last_time = 0.0;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (!line.empty() && line[line.size() - 1] == '\r')
+            line.erase(line.size() - 1);
+
+        std::stringstream lineStream(line);
+        CSVRow row;
+        lineStream >> row;
+        if (row.size() == 0 || row[0].empty())
+            continue;
+
+        if (row[0].compare(0, 5, "Frame") == 0)
+        {
+            guide_log = true;
+            continue;
+        }
+        if (row[0].compare(0, 11, "Exposure = ") == 0)
+        {
+            track->exposure = std::atof(row[0].c_str() + 11) / 1000.0;
+            continue;
+        }
+        if (row[0].compare(0, 16, "INFO: DITHER by ") == 0)
+        {
+            // the dither moves the lock position, which the replay treats as a correction
+            if (axis == 0)
+                dither = std::atof(row[0].c_str() + 16);
+            else if (row.size() > 1)
+                dither = std::atof(row[1].c_str());
+            continue;
+        }
+
+        double time, measurement, control, SNR;
+        if (guide_log)
+        {
+            // ignore special lines, as read_data_from_file() does
+            if (row.size() < 18 || row[5 + axis].empty() || !std::isdigit(static_cast<unsigned char>(row[0][0])))
+                continue;
+            time = std::atof(row[1].c_str());
+            measurement = std::atof(row[5 + axis].c_str());
+            control = std::atof(row[7 + axis].c_str()) + dither;
+            SNR = std::atof(row[16].c_str());
+            dither = 0.0;
+        }
+        else
+        {
+            char first = row[0][0];
+            if (!std::isdigit(static_cast<unsigned char>(first)) && first != '-' && first != '+' && first != '.')
+                continue;
+            if (row.size() < static_cast<size_t>(2 + axis))
+                continue;
+            time = std::atof(row[0].c_str());
+            measurement = std::atof(row[1 + axis].c_str());
+            control = 0.0;
+            SNR = 100.0;
+        }
+
+        // a log with several guiding sections restarts the time for each of them
+        if (!track->times.empty() && time + time_offset < last_time)
+        {
+            time_offset = last_time - time + std::max(track->exposure, 1.0);
+        }
+        last_time = time + time_offset;
+
+        track->times.push_back(last_time);
+        track->measurements.push_back(measurement);
+        track->controls.push_back(control);
+        track->SNRs.push_back(SNR);
+    }
+
+    if (track->times.size() < 2)
+        return true;
+
+    // without an exposure setting, assume back-to-back exposures
+    if (track->exposure <= 0.0)
+    {
+        std::vector<double> intervals;
+        for (size_t i = 1; i < track->times.size(); ++i)
+            intervals.push_back(track->times[i] - track->times[i - 1]);
+        std::nth_element(intervals.begin(), intervals.begin() + intervals.size() / 2, intervals.end());
+        track->exposure = intervals[intervals.size() / 2];
+    }
+
+    return false;
+}
+
+/*
+ * Replays a track through an algorithm with the telescope simulator of
+ * calculate_improvement(): the recorded corrections are added back to get the
+ * uncorrected motion, and the corrections of the algorithm are applied instead.
+ * The algorithm is reset first.
+ */
+inline ReplayResult replay_track(const ReplayTrack& track, ReplayAlgorithm *algorithm)
+{
+    ReplayResult result;
+    algorithm->reset();
+
+    size_t N = track.times.size();
+    if (N < 2)
+        return result;
+
+    double state = track.measurements[0];
+    double sum_squares = 0.0;
+    std::chrono::steady_clock::duration elapsed(0);
+
+    for (size_t i = 0; i + 1 < N; ++i)
+    {
+        ReplayFrame frame;
+        frame.input = state;
+        frame.sample_time = track.times[i] - 0.5 * track.exposure;
+        frame.pulse_time = track.times[i];
+        frame.exposure = track.exposure;
+        frame.SNR = track.SNRs[i];
+
+        auto t0 = std::chrono::steady_clock::now();
+        double control = algorithm->result(frame);
+        elapsed += std::chrono::steady_clock::now() - t0;
+
+        if (control != 0.0)
+            ++result.pulses;
+
+        // this is a simple telescope "simulator"
+        state = state + (track.measurements[i + 1] - (track.measurements[i] - track.controls[i])) - control;
+
+        sum_squares += state * state;
+        result.peak = std::max(result.peak, std::abs(state));
+    }
+
+    result.steps = static_cast<int>(N - 1);
+    result.rms = std::sqrt(sum_squares / result.steps);
+    result.us_per_step = std::chrono::duration<double, std::micro>(elapsed).count() / result.steps;
+
+    return result;
+}
+
+#endif // GUIDE_REPLAY_TOOLS_H
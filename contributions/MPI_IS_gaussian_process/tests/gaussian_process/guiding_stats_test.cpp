@@ -0,0 +1,380 @@
+/*
+*  guiding_stats_test.cpp
+*  PHD2 Guiding
+*
+*  Copyright (c) 2026 openphdguiding.org
+*  All rights reserved.
+*
+*  This source code is distributed under the following "BSD" license
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*    Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+*    Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the
+*     documentation and/or other materials provided with the distribution.
+*    Neither the name of openphdguiding.org nor the names of its
+*     contributors may be used to endorse or promote products derived from
+*     this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+/*
+ * Tests the PHD2 guiding statistics: the incrementally maintained AxisStats and
+ * WindowedAxisStats are checked against a recomputation from all the entries,
+ * LinearFitStats against the AxisStats fit, and SpectrumEstimator on white
+ * noise and on a sine of known period and amplitude.
+ */
+
+#include <gtest/gtest.h>
+#include "guiding_stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <random>
+#include <vector>
+
+// The dataset of an AxisStats, with every statistic recomputed from scratch
+class BruteForceAxisStats
+{
+    struct Entry
+    {
+        double time;
+        double pos;
+        bool guided;
+        bool reversal;
+        bool hasDelta;  // AxisStats only tracks the delta of an entry added to two or more entries
+    };
+
+    std::deque<Entry> entries;
+    double prevMove;
+
+    static double Median(std::vector<double> values)
+    {
+        std::sort(values.begin(), values.end());
+        size_t ctr = values.size() / 2;
+        return values.size() % 2 == 1 ? values[ctr] : (values[ctr] + values[ctr - 1]) / 2.0;
+    }
+
+public:
+    BruteForceAxisStats() : prevMove(0.0) { }
+
+    void Add(double time, double pos, double guideAmt)
+    {
+        Entry entry;
+        entry.time = time;
+        entry.pos = pos;
+        entry.guided = guideAmt != 0.0;
+        entry.reversal = guideAmt * prevMove < 0.0;
+        entry.hasDelta = entries.size() > 1;
+        if (entry.guided)
+            prevMove = guideAmt;
+        entries.push_back(entry);
+    }
+
+    void RemoveOldest() { entries.pop_front(); }
+    void Clear() { entries.clear(); prevMove = 0.0; }
+    size_t Count() const { return entries.size(); }
+
+    void ExpectMatches(const AxisStats& stats) const
+    {
+        size_t n = entries.size();
+        ASSERT_EQ(stats.GetCount(), n);
+        if (n == 0)
+            return;
+
+        std::vector<double> pos;
+        double sum = 0.0;
+        double maxDelta = 0.0;
+        unsigned int moves = 0;
+        unsigned int reversals = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            pos.push_back(entries[i].pos);
+            sum += entries[i].pos;
+            if (i > 0 && entries[i].hasDelta)
+                maxDelta = std::max(maxDelta, std::fabs(entries[i].pos - entries[i - 1].pos));
+            moves += entries[i].guided;
+            reversals += entries[i].reversal;
+        }
+        double mean = sum / n;
+        double squares = 0.0;
+        for (size_t i = 0; i < n; ++i)
+            squares += (pos[i] - mean) * (pos[i] - mean);
+
+        double median = Median(pos);
+        std::vector<double> deviations;
+        for (size_t i = 0; i < n; ++i)
+            deviations.push_back(std::fabs(pos[i] - median));
+
+        EXPECT_NEAR(stats.GetSum(), sum, 1e-9);
+        EXPECT_NEAR(stats.GetMean(), mean, 1e-9);
+        EXPECT_EQ(stats.GetMinDisplacement(), *std::min_element(pos.begin(), pos.end()));
+        EXPECT_EQ(stats.GetMaxDisplacement(), *std::max_element(pos.begin(), pos.end()));
+        EXPECT_NEAR(stats.GetMedian(), median, 1e-12);
+        EXPECT_NEAR(stats.GetMAD(), Median(deviations), 1e-12);
+        EXPECT_EQ(stats.GetMaxDelta(), maxDelta);
+        EXPECT_EQ(stats.GetMoveCount(), moves);
+        EXPECT_EQ(stats.GetReversalCount(), reversals);
+        EXPECT_EQ(stats.GetLastEntry().StarPos, entries.back().pos);
+        EXPECT_EQ(stats.GetEntry(0).DeltaTime, entries.front().time);
+
+        if (n < 2)
+            return;
+
+        EXPECT_NEAR(stats.GetVariance(), squares / (n - 1), 1e-9);
+        EXPECT_NEAR(stats.GetSigma(), std::sqrt(squares / (n - 1)), 1e-9);
+        EXPECT_NEAR(stats.GetPopulationSigma(), std::sqrt(squares / n), 1e-9);
+
+        // least squares fit of the positions over time
+        double meanTime = 0.0;
+        for (size_t i = 0; i < n; ++i)
+            meanTime += entries[i].time;
+        meanTime /= n;
+        double sxx = 0.0, sxy = 0.0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            sxx += (entries[i].time - meanTime) * (entries[i].time - meanTime);
+            sxy += (entries[i].time - meanTime) * (entries[i].pos - mean);
+        }
+        double slope = sxy / sxx;
+        double intercept = mean - slope * meanTime;
+        double rSquared = sxy * sxy / (sxx * squares);
+
+        // the sigma of the residuals is computed from the entries on request, only the sums are incremental
+        double fitSlope, fitIntercept;
+        double fitRSquared = stats.GetLinearFitResults(&fitSlope, &fitIntercept);
+        EXPECT_NEAR(fitSlope, slope, 1e-9);
+        EXPECT_NEAR(fitIntercept, intercept, 1e-6);
+        EXPECT_NEAR(fitRSquared, rSquared, 1e-7);
+    }
+};
+
+class GuidingStatsTest : public ::testing::Test
+{
+protected:
+    std::mt19937 generator;
+    double time;
+
+    GuidingStatsTest() : generator(4711), time(1000.0) { }
+
+    // a drifting, noisy star position with an occasional guide pulse in either direction
+    void NextEntry(double *when, double *pos, double *guideAmt)
+    {
+        std::normal_distribution<double> noise(0.0, 0.5);
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        time += 1.0 + uniform(generator);
+        *when = time;
+        *pos = 0.002 * time - 2.0 + noise(generator);
+        double draw = uniform(generator);
+        *guideAmt = draw < 0.4 ? 0.0 : draw < 0.7 ? -100.0 * draw : 100.0 * draw;
+    }
+};
+
+TEST_F(GuidingStatsTest, axis_stats_match_brute_force)
+{
+    AxisStats stats;
+    BruteForceAxisStats reference;
+
+    for (int i = 0; i < 300; ++i)
+    {
+        double when, pos, guideAmt;
+        NextEntry(&when, &pos, &guideAmt);
+        stats.AddGuideInfo(when, pos, guideAmt);
+        reference.Add(when, pos, guideAmt);
+        reference.ExpectMatches(stats);
+    }
+
+    stats.ClearAll();
+    reference.Clear();
+    reference.ExpectMatches(stats);
+
+    for (int i = 0; i < 20; ++i)
+    {
+        double when, pos, guideAmt;
+        NextEntry(&when, &pos, &guideAmt);
+        stats.AddGuideInfo(when, pos, guideAmt);
+        reference.Add(when, pos, guideAmt);
+        reference.ExpectMatches(stats);
+    }
+}
+
+TEST_F(GuidingStatsTest, auto_windowed_stats_match_brute_force)
+{
+    const int window = 25;
+    WindowedAxisStats stats(window);
+    BruteForceAxisStats reference;
+
+    // long enough for the running sums to be recomputed many times
+    for (int i = 0; i < 1000; ++i)
+    {
+        double when, pos, guideAmt;
+        NextEntry(&when, &pos, &guideAmt);
+        stats.AddGuideInfo(when, pos, guideAmt);
+        reference.Add(when, pos, guideAmt);
+        if (reference.Count() > static_cast<size_t>(window))
+            reference.RemoveOldest();
+        reference.ExpectMatches(stats);
+    }
+
+    // shrinking the window drops the oldest entries
+    EXPECT_TRUE(stats.ChangeWindowSize(10));
+    while (reference.Count() > 10)
+        reference.RemoveOldest();
+    reference.ExpectMatches(stats);
+
+    for (int i = 0; i < 30; ++i)
+    {
+        double when, pos, guideAmt;
+        NextEntry(&when, &pos, &guideAmt);
+        stats.AddGuideInfo(when, pos, guideAmt);
+        reference.Add(when, pos, guideAmt);
+        if (reference.Count() > 10)
+            reference.RemoveOldest();
+        reference.ExpectMatches(stats);
+    }
+}
+
+TEST_F(GuidingStatsTest, client_windowed_stats_match_brute_force)
+{
+    WindowedAxisStats stats(0);
+    BruteForceAxisStats reference;
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    // the client grows and shrinks the window, down to a single entry
+    for (int i = 0; i < 1000; ++i)
+    {
+        double target = 20.0 + 18.0 * std::sin(i / 40.0);
+        if (reference.Count() > 0 && (reference.Count() > target || uniform(generator) < 0.2))
+        {
+            stats.RemoveOldestEntry();
+            reference.RemoveOldest();
+        }
+        else
+        {
+            double when, pos, guideAmt;
+            NextEntry(&when, &pos, &guideAmt);
+            stats.AddGuideInfo(when, pos, guideAmt);
+            reference.Add(when, pos, guideAmt);
+        }
+        reference.ExpectMatches(stats);
+    }
+
+    // without auto-windowing, the dataset is never trimmed
+    EXPECT_TRUE(stats.ChangeWindowSize(0));
+    EXPECT_EQ(stats.GetCount(), reference.Count());
+}
+
+TEST_F(GuidingStatsTest, linear_fit_stats_match_axis_stats)
+{
+    LinearFitStats fit;
+    AxisStats stats;
+
+    double slope, intercept;
+    EXPECT_EQ(fit.GetLinearFitResults(&slope, &intercept), 0.0);
+    EXPECT_EQ(slope, 0.0);
+
+    for (int i = 0; i < 2000; ++i)
+    {
+        double when, pos, guideAmt;
+        NextEntry(&when, &pos, &guideAmt);
+        fit.AddValues(when, pos);
+        stats.AddGuideInfo(when, pos, guideAmt);
+        if (i == 0)
+            continue;
+
+        double expectedSlope, expectedIntercept;
+        double expectedRSquared = stats.GetLinearFitResults(&expectedSlope, &expectedIntercept);
+        double rSquared = fit.GetLinearFitResults(&slope, &intercept);
+        EXPECT_NEAR(slope, expectedSlope, 1e-9);
+        EXPECT_NEAR(intercept, expectedIntercept, 1e-6);
+        EXPECT_NEAR(rSquared, expectedRSquared, 1e-7);
+    }
+    EXPECT_EQ(fit.GetCount(), stats.GetCount());
+    EXPECT_NEAR(slope, 0.002, 2e-4);
+
+    fit.ClearAll();
+    EXPECT_EQ(fit.GetCount(), 0u);
+    EXPECT_EQ(fit.GetLinearFitResults(&slope, &intercept), 0.0);
+}
+
+TEST_F(GuidingStatsTest, spectrum_of_white_noise_has_no_peak)
+{
+    const unsigned int segment = 256;
+    std::normal_distribution<double> noise(0.0, 1.0);
+
+    // no false peak in any provisional or averaged estimate of many independent runs
+    int estimates = 0;
+    for (int run = 0; run < 300; ++run)
+    {
+        SpectrumEstimator spectrum(segment);
+        for (unsigned int i = 0; i < 6 * segment; ++i)
+        {
+            if (!spectrum.AddValue(noise(generator)))
+                continue;
+            ++estimates;
+            double frequency, amplitude;
+            EXPECT_FALSE(spectrum.FindPeak(2, segment / 2, &frequency, &amplitude))
+                << "run " << run << ", sample " << i << ", period " << 1.0 / frequency;
+        }
+        EXPECT_EQ(spectrum.GetSegmentCount(), 11u);
+        // the density of white noise is flat at twice the variance per cycle-per-sample (one-sided)
+        EXPECT_NEAR(spectrum.GetNoiseFloor(1), 2.0, 0.5);
+        EXPECT_NEAR(spectrum.GetBandVariance(0, segment / 2), 1.0, 0.15);
+    }
+    EXPECT_GT(estimates, 1000);
+}
+
+TEST_F(GuidingStatsTest, spectrum_finds_sine_period_and_amplitude)
+{
+    const unsigned int segment = 512;
+    const double period = 37.3;     // samples, deliberately between bins
+    const double amplitude = 0.6;
+    std::normal_distribution<double> noise(0.0, 1.0);
+
+    SpectrumEstimator spectrum(segment);
+    EXPECT_FALSE(spectrum.HasEstimate());
+    for (unsigned int i = 0; i < 4 * segment; ++i)
+        spectrum.AddValue(amplitude * std::sin(2.0 * M_PI * i / period) + 0.01 * i + noise(generator));
+    ASSERT_TRUE(spectrum.HasEstimate());
+
+    double frequency, foundAmplitude;
+    ASSERT_TRUE(spectrum.FindPeak(2, segment / 2, &frequency, &foundAmplitude));
+    EXPECT_NEAR(1.0 / frequency, period, 0.01 * period);
+    EXPECT_NEAR(foundAmplitude, amplitude, 0.15 * amplitude);
+
+    // the sine is slow enough to correct, the noise above it is not
+    unsigned int corner = spectrum.GetCornerBin(2.0);
+    EXPECT_GT(corner, segment / period);
+    EXPECT_LT(corner, segment / 4);
+
+    // a strong periodic error shows up in a provisional estimate, before the first full segment
+    spectrum.ClearAll();
+    EXPECT_FALSE(spectrum.HasEstimate());
+    EXPECT_EQ(spectrum.GetCount(), 0u);
+    for (unsigned int i = 0; i < segment / 4; ++i)
+        spectrum.AddValue(4.0 * amplitude * std::sin(2.0 * M_PI * i / period) + noise(generator));
+    EXPECT_EQ(spectrum.GetSegmentCount(), 0u);
+    ASSERT_TRUE(spectrum.FindPeak(2, segment / 2, &frequency, &foundAmplitude));
+    EXPECT_NEAR(1.0 / frequency, period, 0.05 * period);
+    EXPECT_NEAR(foundAmplitude, 4.0 * amplitude, 0.15 * 4.0 * amplitude);
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -183,6 +183,81 @@ TEST(MathToolsTest, SpectrumTest)
     }
 }
 
+TEST(MathToolsTest, SpectrumWorkspaceTest)
+{
+    math_tools::SpectrumWorkspace workspace;
+
+    // the workspace gives the same spectrum as the plain function, also when reused
+    for (int n = 100; n <= 300; n += 100)
+    {
+        Eigen::VectorXd y = math_tools::generate_normal_random_matrix(n, 1);
+
+        std::pair<Eigen::VectorXd, Eigen::VectorXd> expected = math_tools::compute_spectrum(y, 1024);
+        std::pair<Eigen::VectorXd, Eigen::VectorXd> result = workspace.compute_spectrum(y, 1024);
+
+        ASSERT_EQ(result.first.rows(), expected.first.rows());
+        for (int i = 0; i < expected.first.rows(); ++i)
+        {
+            EXPECT_NEAR(result.first(i), expected.first(i), 1e-9);
+            EXPECT_NEAR(result.second(i), expected.second(i), 1e-12);
+        }
+
+        Eigen::VectorXd window = math_tools::hamming_window(n);
+        EXPECT_NEAR((workspace.hamming_window(n) - window).norm(), 0, 1e-12);
+    }
+}
+
+TEST(MathToolsTest, LombScargleTest)
+{
+    // irregularly sampled sine wave with a gap
+    Eigen::VectorXd times(600);
+    times << Eigen::VectorXd::LinSpaced(300, 0, 1000), Eigen::VectorXd::LinSpaced(300, 1800, 3000);
+    times += 0.5 * math_tools::generate_uniform_random_matrix_0_1(600, 1);
+    Eigen::VectorXd data = 5 * (times.array() * 2 * M_PI / 250.0).sin();
+
+    double min_frequency = 1.0 / 1000.0;
+    double frequency_step = 1e-5;
+    int num_frequencies = 1000;
+    Eigen::VectorXd power = math_tools::lomb_scargle(times, data, min_frequency, frequency_step, num_frequencies);
+
+    Eigen::VectorXd::Index max_index;
+    power.maxCoeff(&max_index);
+    EXPECT_NEAR(min_frequency + max_index * frequency_step, 1.0 / 250.0, frequency_step);
+
+    // the power of a perfect fit is half the sum of squares of the data
+    EXPECT_NEAR(power(max_index), 0.5 * data.squaredNorm(), 0.05 * data.squaredNorm());
+}
+
+TEST(MathToolsTest, MinimizeLbfgsTest)
+{
+    // the Rosenbrock function has its minimum at (1, 1) in a curved valley
+    auto rosenbrock = [](const Eigen::VectorXd& x)
+    {
+        return std::pow(1 - x(0), 2) + 100 * std::pow(x(1) - x(0) * x(0), 2);
+    };
+
+    Eigen::VectorXd x(2);
+    x << -1.2, 1.0;
+    Eigen::VectorXd lower = -2 * Eigen::VectorXd::Ones(2);
+    Eigen::VectorXd upper = 2 * Eigen::VectorXd::Ones(2);
+    math_tools::minimize_lbfgs(rosenbrock, &x, lower, upper, 200);
+
+    EXPECT_NEAR(x(0), 1.0, 1e-3);
+    EXPECT_NEAR(x(1), 1.0, 1e-3);
+
+    // with the minimum outside of the box, the result is on the bound
+    auto paraboloid = [](const Eigen::VectorXd& x)
+    {
+        return std::pow(x(0) - 3, 2) + std::pow(x(1) + 0.5, 2);
+    };
+
+    x << 0.0, 0.0;
+    math_tools::minimize_lbfgs(paraboloid, &x, lower, Eigen::VectorXd::Ones(2), 50);
+
+    EXPECT_NEAR(x(0), 1.0, 1e-6);
+    EXPECT_NEAR(x(1), -0.5, 1e-4);
+}
+
 TEST(MathToolsTest, HammingTest)
 {
     Eigen::VectorXd expected_window(8);
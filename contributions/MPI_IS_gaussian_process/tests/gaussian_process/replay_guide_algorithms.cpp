@@ -0,0 +1,330 @@
+/*
+*  replay_guide_algorithms.cpp
+*  PHD2 Guiding
+*
+*  Copyright (c) 2026 openphdguiding.org
+*  All rights reserved.
+*
+*  This source code is distributed under the following "BSD" license
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*    Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+*    Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the
+*     documentation and/or other materials provided with the distribution.
+*    Neither the name of openphdguiding.org nor the names of its
+*     contributors may be used to endorse or promote products derived from
+*     this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+/*
+ * Replays recorded PHD2 guide logs and raw displacement tracks through the
+ * guide algorithms and reports the simulated guiding performance, optionally
+ * sweeping algorithm parameters in parallel.
+ *
+ * usage: GuideReplay [options] file...
+ *   --algorithm NAME      replay this algorithm (repeatable, default: all)
+ *   --axis ra|dec|both    axis of the recording to replay (default: ra)
+ *   --param NAME=VALUE    set a parameter of the algorithms that have it
+ *   --sweep NAME=A:B:STEP sweep a parameter from A to B (repeatable, the
+ *                         sweeps are combined into a grid)
+ *   --threads N           number of worker threads (default: all cores)
+ *
+ * The results are written as CSV to stdout, one line per file, axis,
+ * algorithm and parameter set.
+ */
+
+#include "guide_replay_tools.h"
+
+#include <atomic>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+
+struct ReplayParameter
+{
+    std::string name;
+    std::vector<double> values;
+};
+
+struct ReplayJob
+{
+    size_t track;
+    std::string algorithm;
+    std::vector<std::pair<std::string, double> > params;
+    ReplayResult result;
+    bool error;
+};
+
+static void usage()
+{
+    std::cerr << "usage: GuideReplay [--algorithm NAME]... [--axis ra|dec|both] [--param NAME=VALUE]...\n"
+                 "                   [--sweep NAME=START:STOP:STEP]... [--threads N] file...\n"
+                 "algorithms:";
+    std::vector<std::string> names = replay_algorithm_names();
+    for (size_t i = 0; i < names.size(); ++i)
+        std::cerr << " " << names[i];
+    std::cerr << std::endl;
+}
+
+// parses NAME=VALUE or NAME=START:STOP:STEP, returns true on error
+static bool parse_parameter(const std::string& arg, bool sweep, ReplayParameter *param)
+{
+    size_t eq = arg.find('=');
+    if (eq == std::string::npos || eq == 0)
+        return true;
+
+    param->name = arg.substr(0, eq);
+    param->values.clear();
+
+    std::string value = arg.substr(eq + 1);
+    if (!sweep)
+    {
+        char *end;
+        double val = std::strtod(value.c_str(), &end);
+        if (end == value.c_str() || *end != '\0')
+            return true;
+        param->values.push_back(val);
+        return false;
+    }
+
+    double start, stop, step;
+    if (std::sscanf(value.c_str(), "%lf:%lf:%lf", &start, &stop, &step) != 3 || step <= 0.0 || stop < start)
+        return true;
+
+    // allow for rounding so that the end point is included
+    int count = static_cast<int>(std::floor((stop - start) / step + 1e-9)) + 1;
+    for (int i = 0; i < count; ++i)
+        param->values.push_back(start + i * step);
+
+    return false;
+}
+
+// adds the jobs for all combinations of the parameter values the algorithm knows
+static void add_jobs(size_t track, const std::string& algorithm, const std::vector<ReplayParameter>& params,
+                     std::vector<ReplayJob> *jobs)
+{
+    std::unique_ptr<ReplayAlgorithm> instance(create_replay_algorithm(algorithm));
+    std::vector<std::string> names;
+    instance->GetParamNames(names);
+
+    std::vector<const ReplayParameter *> applicable;
+    for (size_t i = 0; i < params.size(); ++i)
+    {
+        if (std::find(names.begin(), names.end(), params[i].name) != names.end())
+            applicable.push_back(&params[i]);
+    }
+
+    std::vector<size_t> index(applicable.size(), 0);
+    while (true)
+    {
+        ReplayJob job;
+        job.track = track;
+        job.algorithm = algorithm;
+        job.error = false;
+        for (size_t i = 0; i < applicable.size(); ++i)
+            job.params.push_back(std::make_pair(applicable[i]->name, applicable[i]->values[index[i]]));
+        jobs->push_back(job);
+
+        // advance the grid index like an odometer
+        size_t k = 0;
+        while (k < index.size() && ++index[k] == applicable[k]->values.size())
+        {
+            index[k] = 0;
+            ++k;
+        }
+        if (k == index.size())
+            break;
+    }
+}
+
+static void run_job(const std::vector<ReplayTrack>& tracks, ReplayJob *job)
+{
+    std::unique_ptr<ReplayAlgorithm> algorithm(create_replay_algorithm(job->algorithm));
+    for (size_t i = 0; i < job->params.size(); ++i)
+    {
+        if (!algorithm->SetParam(job->params[i].first, job->params[i].second))
+        {
+            job->error = true;
+            return;
+        }
+    }
+    job->result = replay_track(tracks[job->track], algorithm.get());
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> algorithms;
+    std::vector<ReplayParameter> params;
+    std::vector<std::string> files;
+    std::vector<int> axes(1, 0);
+    unsigned int num_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::vector<std::string> known = replay_algorithm_names();
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+
+        if (arg == "--algorithm" && has_value)
+        {
+            std::string name = argv[++i];
+            if (std::find(known.begin(), known.end(), name) == known.end())
+            {
+                std::cerr << "unknown algorithm: " << name << std::endl;
+                usage();
+                return 1;
+            }
+            algorithms.push_back(name);
+        }
+        else if (arg == "--axis" && has_value)
+        {
+            std::string axis = argv[++i];
+            axes.clear();
+            if (axis == "ra" || axis == "both")
+                axes.push_back(0);
+            if (axis == "dec" || axis == "both")
+                axes.push_back(1);
+            if (axes.empty())
+            {
+                usage();
+                return 1;
+            }
+        }
+        else if ((arg == "--param" || arg == "--sweep") && has_value)
+        {
+            ReplayParameter param;
+            if (parse_parameter(argv[++i], arg == "--sweep", &param))
+            {
+                std::cerr << "invalid parameter: " << argv[i] << std::endl;
+                usage();
+                return 1;
+            }
+            params.push_back(param);
+        }
+        else if (arg == "--threads" && has_value)
+        {
+            num_threads = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (arg.compare(0, 2, "--") == 0)
+        {
+            usage();
+            return 1;
+        }
+        else
+        {
+            files.push_back(arg);
+        }
+    }
+
+    if (files.empty())
+    {
+        usage();
+        return 1;
+    }
+    if (algorithms.empty())
+        algorithms = known;
+
+    // every parameter has to be known to at least one of the algorithms
+    for (size_t i = 0; i < params.size(); ++i)
+    {
+        bool used = false;
+        for (size_t j = 0; j < algorithms.size() && !used; ++j)
+        {
+            std::unique_ptr<ReplayAlgorithm> instance(create_replay_algorithm(algorithms[j]));
+            std::vector<std::string> names;
+            instance->GetParamNames(names);
+            used = std::find(names.begin(), names.end(), params[i].name) != names.end();
+        }
+        if (!used)
+        {
+            std::cerr << "no selected algorithm has the parameter " << params[i].name << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<ReplayTrack> tracks;
+    std::vector<int> track_axes;
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        for (size_t j = 0; j < axes.size(); ++j)
+        {
+            ReplayTrack track;
+            if (read_replay_track(files[i], axes[j], &track))
+            {
+                std::cerr << "cannot read guiding data from " << files[i] << std::endl;
+                return 1;
+            }
+            tracks.push_back(track);
+            track_axes.push_back(axes[j]);
+        }
+    }
+
+    std::vector<ReplayJob> jobs;
+    for (size_t t = 0; t < tracks.size(); ++t)
+    {
+        for (size_t a = 0; a < algorithms.size(); ++a)
+            add_jobs(t, algorithms[a], params, &jobs);
+    }
+
+    // the jobs are independent, each worker takes the next one until all are done
+    std::atomic<size_t> next_job(0);
+    auto worker = [&]()
+    {
+        size_t k;
+        while ((k = next_job++) < jobs.size())
+            run_job(tracks, &jobs[k]);
+    };
+
+    std::vector<std::thread> threads;
+    num_threads = std::min<unsigned int>(num_threads, static_cast<unsigned int>(jobs.size()));
+    for (unsigned int i = 0; i < num_threads; ++i)
+        threads.push_back(std::thread(worker));
+    for (size_t i = 0; i < threads.size(); ++i)
+        threads[i].join();
+
+    std::cout << "file,axis,algorithm,parameters,steps,rms,peak,pulses,us_per_step" << std::endl;
+    for (size_t k = 0; k < jobs.size(); ++k)
+    {
+        const ReplayJob& job = jobs[k];
+        const ReplayTrack& track = tracks[job.track];
+
+        std::string param_list;
+        for (size_t i = 0; i < job.params.size(); ++i)
+        {
+            char buf[64];
+            std::snprintf(buf, sizeof(buf), "%s%s=%g", i ? ";" : "", job.params[i].first.c_str(), job.params[i].second);
+            param_list += buf;
+        }
+
+        std::cout << track.name << "," << (track_axes[job.track] == 0 ? "ra" : "dec") << "," << job.algorithm << ","
+                  << param_list << ",";
+        if (job.error)
+        {
+            std::cout << "invalid parameter value" << std::endl;
+            continue;
+        }
+
+        char buf[128];
+        std::snprintf(buf, sizeof(buf), "%d,%.4f,%.4f,%d,%.1f", job.result.steps, job.result.rms, job.result.peak,
+                      job.result.pulses, job.result.us_per_step);
+        std::cout << buf << std::endl;
+    }
+
+    return 0;
+}
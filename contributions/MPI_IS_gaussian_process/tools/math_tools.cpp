@@ -42,6 +42,8 @@
  */
 
 #include "math_tools.h"
+#include <algorithm>
+#include <deque>
 #include <stdexcept>
 #include <cmath>
 #include <cstdint>
@@ -174,7 +176,18 @@ namespace math_tools
 
     std::pair<Eigen::VectorXd, Eigen::VectorXd> compute_spectrum(Eigen::VectorXd& data, int N)
     {
+        SpectrumWorkspace workspace;
+        return workspace.compute_spectrum(data, N);
+    }
 
+    SpectrumWorkspace::SpectrumWorkspace()
+    {
+        // the input is real, we only need the non-redundant half of the spectrum
+        fft_.SetFlag(Eigen::FFT<double>::HalfSpectrum);
+    }
+
+    std::pair<Eigen::VectorXd, Eigen::VectorXd> SpectrumWorkspace::compute_spectrum(const Eigen::VectorXd& data, int N)
+    {
         int N_data = data.rows();
 
         if (N < N_data)
@@ -183,31 +196,227 @@ namespace math_tools
         }
         N = static_cast<int>(std::pow(2, std::ceil(std::log(N) / std::log(2)))); // map to nearest power of 2
 
-        Eigen::VectorXd padded_data = Eigen::VectorXd::Zero(N);
-        padded_data.head(N_data) = data;
-
-        Eigen::FFT<double> fft;
-
-        // initialize the double vector from Eigen vector. This works by initializing
-        // with two pointers: 1) the first element of the data, 2) the last element of the data
-        std::vector<double> vec_data(padded_data.data(), padded_data.data() + padded_data.rows() * padded_data.cols());
-        std::vector<std::complex<double> > vec_result;
-        fft.fwd(vec_result, vec_data); // this is the forward-FFT, from time domain to Fourier domain
-
-        // map back to Eigen vector with the address of the first element and the size
-        Eigen::VectorXcd result = Eigen::Map<Eigen::VectorXcd>(&vec_result[0], vec_result.size());
+        // the FFT object keeps the plan for each size, the buffers keep their capacity
+        input_.assign(N, 0.0);
+        std::copy(data.data(), data.data() + N_data, input_.begin());
+        fft_.fwd(output_, input_); // this is the forward-FFT, from time domain to Fourier domain
 
         // the low_index is the lowest useful frequency, depending on the number of actual datapoints
         int low_index = static_cast<int>(std::ceil(static_cast<double>(N) / static_cast<double>(N_data)));
 
         // prepare amplitudes and frequencies, don't return frequencies introduced by padding
-        Eigen::VectorXd spectrum = result.segment(low_index, N / 2 - low_index + 1).array().abs().pow(2);
+        Eigen::VectorXd spectrum(N / 2 - low_index + 1);
+        for (int i = 0; i < spectrum.rows(); ++i)
+        {
+            spectrum(i) = std::norm(output_[low_index + i]);
+        }
         Eigen::VectorXd frequencies = Eigen::VectorXd::LinSpaced(N / 2 - low_index + 1, low_index, N / 2);
         frequencies /= N;
 
         return std::make_pair(spectrum, frequencies);
     }
 
+    const Eigen::VectorXd& SpectrumWorkspace::hamming_window(int N)
+    {
+        if (window_.rows() != N)
+        {
+            window_ = math_tools::hamming_window(N);
+        }
+        return window_;
+    }
+
+    Eigen::VectorXd lomb_scargle(const Eigen::VectorXd& times, const Eigen::VectorXd& data,
+                                 double min_frequency, double frequency_step, int num_frequencies)
+    {
+        // sums for the least-squares fit of a*cos + b*sin at each frequency
+        Eigen::ArrayXd yc = Eigen::ArrayXd::Zero(num_frequencies);
+        Eigen::ArrayXd ys = Eigen::ArrayXd::Zero(num_frequencies);
+        Eigen::ArrayXd cc = Eigen::ArrayXd::Zero(num_frequencies);
+        Eigen::ArrayXd ss = Eigen::ArrayXd::Zero(num_frequencies);
+        Eigen::ArrayXd cs = Eigen::ArrayXd::Zero(num_frequencies);
+
+        for (int i = 0; i < times.rows(); ++i)
+        {
+            double y = data(i);
+            double phase = 2 * M_PI * min_frequency * times(i);
+            double step = 2 * M_PI * frequency_step * times(i);
+            double c = std::cos(phase);
+            double s = std::sin(phase);
+            double step_c = std::cos(step);
+            double step_s = std::sin(step);
+
+            for (int k = 0; k < num_frequencies; ++k)
+            {
+                yc(k) += y * c;
+                ys(k) += y * s;
+                cc(k) += c * c;
+                ss(k) += s * s;
+                cs(k) += c * s;
+
+                double next_c = c * step_c - s * step_s;
+                s = s * step_c + c * step_s;
+                c = next_c;
+            }
+        }
+
+        // power of the fitted sinusoid, solving the 2x2 normal equations
+        Eigen::ArrayXd determinant = cc * ss - cs * cs;
+        Eigen::ArrayXd power = (ss * yc * yc - 2 * cs * yc * ys + cc * ys * ys) / (2 * determinant);
+        return (determinant > 0).select(power, 0.0);
+    }
+
+    namespace
+    {
+        // central differences, one-sided at the bounds
+        Eigen::VectorXd numerical_gradient(const std::function<double(const Eigen::VectorXd&)>& function,
+                                           const Eigen::VectorXd& x, const Eigen::VectorXd& lower,
+                                           const Eigen::VectorXd& upper)
+        {
+            Eigen::VectorXd gradient(x.size());
+            for (int i = 0; i < x.size(); ++i)
+            {
+                double step = 1e-5 * std::max(1.0, std::abs(x(i)));
+                Eigen::VectorXd forward = x;
+                Eigen::VectorXd backward = x;
+                forward(i) = std::min(x(i) + step, upper(i));
+                backward(i) = std::max(x(i) - step, lower(i));
+
+                double width = forward(i) - backward(i);
+                gradient(i) = width > 0 ? (function(forward) - function(backward)) / width : 0.0;
+            }
+            return gradient;
+        }
+
+        // removes the components that point out of the box at an active bound
+        void project_direction(Eigen::VectorXd& direction, const Eigen::VectorXd& x,
+                               const Eigen::VectorXd& lower, const Eigen::VectorXd& upper)
+        {
+            for (int i = 0; i < x.size(); ++i)
+            {
+                if ((x(i) <= lower(i) && direction(i) < 0) || (x(i) >= upper(i) && direction(i) > 0))
+                {
+                    direction(i) = 0;
+                }
+            }
+        }
+    }
+
+    int minimize_lbfgs(const std::function<double(const Eigen::VectorXd&)>& function, Eigen::VectorXd *x,
+                       const Eigen::VectorXd& lower, const Eigen::VectorXd& upper,
+                       int max_iterations, int history /*= 5*/)
+    {
+        const double sufficient_decrease = 1e-4; // Armijo condition of the line search
+        const double tolerance = 1e-6;
+        const int max_halvings = 30;
+
+        *x = x->cwiseMax(lower).cwiseMin(upper);
+        double value = function(*x);
+        Eigen::VectorXd gradient = numerical_gradient(function, *x, lower, upper);
+
+        std::deque<Eigen::VectorXd> s_history; // steps
+        std::deque<Eigen::VectorXd> y_history; // gradient changes
+
+        int iteration = 0;
+        while (iteration < max_iterations)
+        {
+            ++iteration;
+
+            // two-loop recursion for the quasi-Newton direction
+            Eigen::VectorXd direction = -gradient;
+            int m = static_cast<int>(s_history.size());
+            std::vector<double> alphas(m);
+            for (int i = m - 1; i >= 0; --i)
+            {
+                alphas[i] = s_history[i].dot(direction) / y_history[i].dot(s_history[i]);
+                direction -= alphas[i] * y_history[i];
+            }
+            if (m > 0)
+            {
+                direction *= s_history.back().dot(y_history.back()) / y_history.back().squaredNorm();
+            }
+            for (int i = 0; i < m; ++i)
+            {
+                double beta = y_history[i].dot(direction) / y_history[i].dot(s_history[i]);
+                direction += (alphas[i] - beta) * s_history[i];
+            }
+            project_direction(direction, *x, lower, upper);
+
+            // fall back to steepest descent if the curvature information misleads
+            if (gradient.dot(direction) >= 0)
+            {
+                s_history.clear();
+                y_history.clear();
+                direction = -gradient;
+                project_direction(direction, *x, lower, upper);
+                if (gradient.dot(direction) >= 0)
+                {
+                    break; // stationary within the box
+                }
+            }
+
+            // backtracking line search along the projected path
+            double step = 1.0;
+            Eigen::VectorXd candidate = (*x + direction).cwiseMax(lower).cwiseMin(upper);
+            double candidate_value = function(candidate);
+            bool accepted = candidate_value <= value + sufficient_decrease * gradient.dot(candidate - *x);
+            int halvings = 0;
+            while (!accepted && halvings < max_halvings)
+            {
+                ++halvings;
+                step *= 0.5;
+                candidate = (*x + step * direction).cwiseMax(lower).cwiseMin(upper);
+                candidate_value = function(candidate);
+                accepted = candidate_value <= value + sufficient_decrease * gradient.dot(candidate - *x);
+            }
+            if (!accepted)
+            {
+                break;
+            }
+
+            // a full step can be too short on a flat slope, which leaves no curvature information
+            for (int i = 0; i < max_halvings && halvings == 0; ++i)
+            {
+                step *= 2;
+                Eigen::VectorXd longer = (*x + step * direction).cwiseMax(lower).cwiseMin(upper);
+                double longer_value = function(longer);
+                if (!(longer_value < candidate_value) || longer == candidate)
+                {
+                    break;
+                }
+                candidate = longer;
+                candidate_value = longer_value;
+            }
+
+            Eigen::VectorXd new_gradient = numerical_gradient(function, candidate, lower, upper);
+            Eigen::VectorXd s = candidate - *x;
+            Eigen::VectorXd y = new_gradient - gradient;
+            double decrease = value - candidate_value;
+
+            *x = candidate;
+            value = candidate_value;
+            gradient = new_gradient;
+
+            // only keep pairs with positive curvature, the update stays positive definite
+            if (s.dot(y) > 1e-12)
+            {
+                s_history.push_back(s);
+                y_history.push_back(y);
+                if (static_cast<int>(s_history.size()) > history)
+                {
+                    s_history.pop_front();
+                    y_history.pop_front();
+                }
+            }
+
+            if (s.lpNorm<Eigen::Infinity>() < tolerance || decrease < tolerance * (1.0 + std::abs(value)))
+            {
+                break;
+            }
+        }
+
+        return iteration;
+    }
+
     Eigen::VectorXd hamming_window(int N)
     {
         double alpha = 0.54;
@@ -53,6 +53,7 @@
 #include <stdexcept>
 #include <cstdint>
 #include <cmath>
+#include <functional>
 
 // M_PI not part of the standard
 #ifndef M_PI
@@ -146,6 +147,56 @@ namespace math_tools
      */
     std::pair< Eigen::VectorXd, Eigen::VectorXd > compute_spectrum(Eigen::VectorXd& data, int N = 0);
 
+    /*!
+     * Keeps the FFT plan, the buffers and the window between spectrum
+     * computations. Setting up the transform costs more than the transform
+     * itself, so repeated spectra of similar size should share a workspace.
+     */
+    class SpectrumWorkspace
+    {
+    public:
+        SpectrumWorkspace();
+
+        /*!
+         * Same as compute_spectrum(), without the setup costs.
+         */
+        std::pair< Eigen::VectorXd, Eigen::VectorXd > compute_spectrum(const Eigen::VectorXd& data, int N = 0);
+
+        /*!
+         * Returns the Hamming window of size N, computed only if N changed.
+         */
+        const Eigen::VectorXd& hamming_window(int N);
+
+    private:
+        Eigen::FFT<double> fft_;
+        std::vector<double> input_;
+        std::vector<std::complex<double> > output_;
+        Eigen::VectorXd window_;
+    };
+
+    /*!
+     * Calculates the Lomb-Scargle periodogram of irregularly sampled data for
+     * the frequencies min_frequency + k * frequency_step, k < num_frequencies.
+     *
+     * The power at each frequency is that of the least-squares fit of a
+     * sinusoid to the data, which should be free of an offset. Sine and cosine
+     * are advanced from one frequency to the next by a rotation, so the inner
+     * loop has no trigonometric calls.
+     */
+    Eigen::VectorXd lomb_scargle(const Eigen::VectorXd& times, const Eigen::VectorXd& data,
+                                 double min_frequency, double frequency_step, int num_frequencies);
+
+    /*!
+     * Minimizes a function within the box [lower, upper] with the limited
+     * memory BFGS method, starting at x and storing the result there. The
+     * gradient is computed with central differences, so the function should
+     * be cheap and smooth. The search stops after max_iterations or when the
+     * steps become negligible. Returns the number of iterations.
+     */
+    int minimize_lbfgs(const std::function<double(const Eigen::VectorXd&)>& function, Eigen::VectorXd *x,
+                       const Eigen::VectorXd& lower, const Eigen::VectorXd& upper,
+                       int max_iterations, int history = 5);
+
     /*!
      * Computes a Hamming window (used to reduce spectral leakage of subsequent DFT).
      */
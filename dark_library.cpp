@@ -0,0 +1,760 @@
+/*
+*  dark_library.cpp
+*  PHD2 Guiding
+*
+*  Copyright (c) 2026 openphdguiding.org
+*  All rights reserved.
+*
+*  This source code is distributed under the following "BSD" license
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*    Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+*    Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the
+*     documentation and/or other materials provided with the distribution.
+*    Neither the name of openphdguiding.org nor the names of its
+*     contributors may be used to endorse or promote products derived from
+*     this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#include "phd.h"
+
+#include <algorithm>
+#include <memory>
+
+#ifndef __WINDOWS__
+# include <errno.h>
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <unistd.h>
+#endif
+
+static const char DARK_CACHE_MAGIC[8] = { 'P', 'H', 'D', '2', 'D', 'R', 'K', 0 };
+enum { DARK_CACHE_VERSION = 1 };
+
+// on-disk layout (native byte order, the cache is never shared between machines):
+//   header, entry table, then each frame's pixels starting on a DATA_ALIGNMENT boundary
+struct DarkCacheHeader
+{
+    char magic[8];
+    wxUint32 version;
+    wxUint32 count;
+    wxUint32 width;
+    wxUint32 height;
+    wxInt64 fitsSize;       // size and modification time (ms) of the FITS file the cache was built from
+    wxInt64 fitsTime;
+};
+
+struct DarkCacheEntry
+{
+    wxInt64 offset;
+    wxInt32 expDur;
+    wxUint16 minADU;
+    wxUint16 maxADU;
+    wxUint16 medianADU;
+    wxUint16 reserved[3];
+};
+
+static wxFileOffset AlignUp(wxFileOffset ofs)
+{
+    return (ofs + DarkLibraryFile::DATA_ALIGNMENT - 1) / DarkLibraryFile::DATA_ALIGNMENT * DarkLibraryFile::DATA_ALIGNMENT;
+}
+
+static void GetFitsFileStamp(const wxString& fitsFile, wxInt64 *size, wxInt64 *time)
+{
+    wxFileName fn(fitsFile);
+    *size = (wxInt64) fn.GetSize().GetValue();
+    *time = fn.GetModificationTime().GetValue().GetValue();
+}
+
+static bool ReadHeader(wxFFile& file, DarkCacheHeader *hdr)
+{
+    if (file.Read(hdr, sizeof(*hdr)) != sizeof(*hdr))
+        return true;
+    if (memcmp(hdr->magic, DARK_CACHE_MAGIC, sizeof(hdr->magic)) != 0 || hdr->version != DARK_CACHE_VERSION)
+        return true;
+    return false;
+}
+
+MappedFileView::MappedFileView()
+    :
+#ifdef __WINDOWS__
+    m_file(INVALID_HANDLE_VALUE),
+    m_mapping(nullptr),
+#else
+    m_fd(-1),
+#endif
+    m_view(nullptr),
+    m_viewLen(0)
+{
+}
+
+MappedFileView::~MappedFileView()
+{
+    Close();
+}
+
+#ifdef __WINDOWS__
+
+bool MappedFileView::Open(const wxString& path)
+{
+    Close();
+
+    m_file = ::CreateFileW(path.wc_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                           FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE)
+    {
+        Debug.Write(wxString::Format("MappedFileView: CreateFile failed for %s, err = %lu\n", path, ::GetLastError()));
+        return true;
+    }
+
+    m_mapping = ::CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m_mapping)
+    {
+        Debug.Write(wxString::Format("MappedFileView: CreateFileMapping failed for %s, err = %lu\n", path, ::GetLastError()));
+        Close();
+        return true;
+    }
+
+    return false;
+}
+
+void MappedFileView::Close()
+{
+    Unmap();
+    if (m_mapping)
+    {
+        ::CloseHandle(m_mapping);
+        m_mapping = nullptr;
+    }
+    if (m_file != INVALID_HANDLE_VALUE)
+    {
+        ::CloseHandle(m_file);
+        m_file = INVALID_HANDLE_VALUE;
+    }
+}
+
+bool MappedFileView::IsOpen() const
+{
+    return m_mapping != nullptr;
+}
+
+const void *MappedFileView::Map(wxFileOffset offset, size_t len)
+{
+    Unmap();
+
+    if (!m_mapping)
+        return nullptr;
+
+    wxUint64 ofs = (wxUint64) offset;
+    m_view = ::MapViewOfFile(m_mapping, FILE_MAP_READ, (DWORD)(ofs >> 32), (DWORD)(ofs & 0xffffffff), len);
+    if (!m_view)
+    {
+        Debug.Write(wxString::Format("MappedFileView: MapViewOfFile failed, err = %lu\n", ::GetLastError()));
+        return nullptr;
+    }
+    m_viewLen = len;
+
+    return m_view;
+}
+
+void MappedFileView::Unmap()
+{
+    if (m_view)
+    {
+        ::UnmapViewOfFile(m_view);
+        m_view = nullptr;
+        m_viewLen = 0;
+    }
+}
+
+#else // __WINDOWS__
+
+bool MappedFileView::Open(const wxString& path)
+{
+    Close();
+
+    m_fd = ::open(path.fn_str(), O_RDONLY);
+    if (m_fd == -1)
+    {
+        Debug.Write(wxString::Format("MappedFileView: open failed for %s, errno = %d\n", path, errno));
+        return true;
+    }
+
+    return false;
+}
+
+void MappedFileView::Close()
+{
+    Unmap();
+    if (m_fd != -1)
+    {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+bool MappedFileView::IsOpen() const
+{
+    return m_fd != -1;
+}
+
+const void *MappedFileView::Map(wxFileOffset offset, size_t len)
+{
+    Unmap();
+
+    if (m_fd == -1)
+        return nullptr;
+
+    void *p = ::mmap(nullptr, len, PROT_READ, MAP_SHARED, m_fd, (off_t) offset);
+    if (p == MAP_FAILED)
+    {
+        Debug.Write(wxString::Format("MappedFileView: mmap failed, errno = %d\n", errno));
+        return nullptr;
+    }
+    m_view = p;
+    m_viewLen = len;
+
+    return m_view;
+}
+
+void MappedFileView::Unmap()
+{
+    if (m_view)
+    {
+        ::munmap(m_view, m_viewLen);
+        m_view = nullptr;
+        m_viewLen = 0;
+    }
+}
+
+#endif // __WINDOWS__
+
+DarkLibraryFile::DarkLibraryFile()
+    :
+    m_mappedExpDur(-1)
+{
+}
+
+DarkLibraryFile::~DarkLibraryFile()
+{
+    Close();
+}
+
+wxString DarkLibraryFile::CacheFileName(const wxString& fitsFile)
+{
+    wxFileName fn(fitsFile);
+    fn.SetExt("darkcache");
+    return fn.GetFullPath();
+}
+
+bool DarkLibraryFile::IsCurrent(const wxString& cacheFile, const wxString& fitsFile)
+{
+    if (!wxFileExists(cacheFile) || !wxFileExists(fitsFile))
+        return false;
+
+    wxFFile file(cacheFile, "rb");
+    DarkCacheHeader hdr;
+    if (!file.IsOpened() || ReadHeader(file, &hdr))
+        return false;
+
+    wxInt64 fitsSize, fitsTime;
+    GetFitsFileStamp(fitsFile, &fitsSize, &fitsTime);
+
+    return hdr.fitsSize == fitsSize && hdr.fitsTime == fitsTime;
+}
+
+bool DarkLibraryFile::BuildFromFits(const wxString& fitsFile, const wxString& cacheFile)
+{
+    bool bError = false;
+    fitsfile *fptr = nullptr;
+    int status = 0;  // CFITSIO status value MUST be initialized to zero!
+    wxString tmpFile = cacheFile + ".tmp";
+
+    try
+    {
+        if (PHD_fits_open_diskfile(&fptr, fitsFile, READONLY, &status))
+        {
+            fptr = nullptr;
+            throw ERROR_INFO("DarkLib cache: error opening FITS file");
+        }
+
+        int nhdus = 0;
+        fits_get_num_hdus(fptr, &nhdus, &status);
+        if (status || nhdus < 1)
+            throw ERROR_INFO("DarkLib cache: no frames in FITS file");
+
+        wxFFile out(tmpFile, "wb");
+        if (!out.IsOpened())
+            throw ERROR_INFO("DarkLib cache: cannot create cache file");
+
+        DarkCacheHeader hdr;
+        memset(&hdr, 0, sizeof(hdr));
+        memcpy(hdr.magic, DARK_CACHE_MAGIC, sizeof(hdr.magic));
+        hdr.version = DARK_CACHE_VERSION;
+        GetFitsFileStamp(fitsFile, &hdr.fitsSize, &hdr.fitsTime);
+
+        std::vector<DarkCacheEntry> entries;
+        wxFileOffset dataOffset = AlignUp(sizeof(hdr) + nhdus * sizeof(DarkCacheEntry));
+
+        // only one frame is resident at a time
+        usImage img;
+
+        for (int hdu = 1; hdu <= nhdus; hdu++)
+        {
+            if (hdu > 1 && fits_movrel_hdu(fptr, +1, nullptr, &status))
+                throw ERROR_INFO("DarkLib cache: error moving to next HDU");
+
+            int hdutype;
+            fits_get_hdu_type(fptr, &hdutype, &status);
+            int naxis = 0;
+            fits_get_img_dim(fptr, &naxis, &status);
+            if (status || hdutype != IMAGE_HDU || naxis != 2)
+                throw ERROR_INFO("DarkLib cache: unsupported FITS HDU");
+
+            long fsize[2];
+            fits_get_img_size(fptr, 2, fsize, &status);
+            if (hdu == 1)
+            {
+                hdr.width = (wxUint32) fsize[0];
+                hdr.height = (wxUint32) fsize[1];
+            }
+            else if (fsize[0] != (long) hdr.width || fsize[1] != (long) hdr.height)
+                throw ERROR_INFO("DarkLib cache: incompatible frame sizes in dark library");
+
+            if (img.Init((int) fsize[0], (int) fsize[1]))
+                throw ERROR_INFO("DarkLib cache: memory allocation failure");
+
+            long fpixel[] = { 1, 1, 1 };
+            if (fits_read_pix(fptr, TUSHORT, fpixel, fsize[0] * fsize[1], nullptr, img.ImageData, nullptr, &status))
+                throw ERROR_INFO("DarkLib cache: error reading FITS data");
+
+            char keyname[] = "EXPOSURE";
+            float exposure;
+            if (fits_read_key(fptr, TFLOAT, keyname, &exposure, nullptr, &status))
+            {
+                exposure = (float) pFrame->RequestedExposureDuration() / 1000.0;
+                Debug.Write(wxString::Format("missing EXPOSURE value, assume %.3f\n", exposure));
+                status = 0;
+            }
+
+            img.CalcStats();
+
+            DarkCacheEntry entry;
+            memset(&entry, 0, sizeof(entry));
+            entry.offset = dataOffset;
+            entry.expDur = ROUNDF(exposure * 1000.0);
+            entry.minADU = img.MinADU;
+            entry.maxADU = img.MaxADU;
+            entry.medianADU = img.MedianADU;
+            entries.push_back(entry);
+
+            size_t nbytes = img.NPixels * sizeof(unsigned short);
+            if (!out.Seek(dataOffset) || out.Write(img.ImageData, nbytes) != nbytes)
+                throw ERROR_INFO("DarkLib cache: error writing frame data");
+
+            dataOffset = AlignUp(dataOffset + nbytes);
+        }
+
+        hdr.count = (wxUint32) entries.size();
+
+        if (!out.Seek(0) ||
+            out.Write(&hdr, sizeof(hdr)) != sizeof(hdr) ||
+            out.Write(&entries[0], entries.size() * sizeof(DarkCacheEntry)) != entries.size() * sizeof(DarkCacheEntry) ||
+            !out.Close())
+        {
+            throw ERROR_INFO("DarkLib cache: error writing header");
+        }
+
+        PHD_fits_close_file(fptr);
+        fptr = nullptr;
+
+        if (!wxRenameFile(tmpFile, cacheFile, true))
+            throw ERROR_INFO("DarkLib cache: error renaming cache file");
+
+        Debug.Write(wxString::Format("DarkLib cache: built %s with %u frames\n", cacheFile, hdr.count));
+    }
+    catch (const wxString& Msg)
+    {
+        POSSIBLY_UNUSED(Msg);
+        if (fptr)
+            PHD_fits_close_file(fptr);
+        if (wxFileExists(tmpFile))
+            wxRemoveFile(tmpFile);
+        bError = true;
+    }
+
+    return bError;
+}
+
+bool DarkLibraryFile::Open(const wxString& cacheFile)
+{
+    Close();
+
+    bool bError = false;
+
+    try
+    {
+        wxFFile file(cacheFile, "rb");
+        if (!file.IsOpened())
+            throw ERROR_INFO("DarkLib cache: cannot open cache file");
+
+        DarkCacheHeader hdr;
+        if (ReadHeader(file, &hdr))
+            throw ERROR_INFO("DarkLib cache: invalid header");
+
+        wxFileOffset fileLen = file.Length();
+        size_t frameBytes = (size_t) hdr.width * hdr.height * sizeof(unsigned short);
+        if (hdr.count == 0 || frameBytes == 0 || hdr.count * sizeof(DarkCacheEntry) > (size_t) fileLen)
+            throw ERROR_INFO("DarkLib cache: invalid header");
+
+        std::vector<DarkCacheEntry> entries(hdr.count);
+        if (file.Read(&entries[0], hdr.count * sizeof(DarkCacheEntry)) != hdr.count * sizeof(DarkCacheEntry))
+            throw ERROR_INFO("DarkLib cache: error reading entries");
+
+        for (const auto& e : entries)
+        {
+            if (e.offset % DATA_ALIGNMENT != 0 || e.offset + (wxFileOffset) frameBytes > fileLen)
+                throw ERROR_INFO("DarkLib cache: invalid entry");
+
+            Entry& entry = m_entries[e.expDur];
+            entry.expDur = e.expDur;
+            entry.minADU = e.minADU;
+            entry.maxADU = e.maxADU;
+            entry.medianADU = e.medianADU;
+            entry.offset = e.offset;
+        }
+
+        if (m_file.Open(cacheFile))
+            throw ERROR_INFO("DarkLib cache: cannot map cache file");
+
+        m_path = cacheFile;
+        m_frameSize = wxSize(hdr.width, hdr.height);
+
+        Debug.Write(wxString::Format("DarkLib cache: opened %s, %u frames %dx%d\n", cacheFile, hdr.count,
+                                     m_frameSize.x, m_frameSize.y));
+    }
+    catch (const wxString& Msg)
+    {
+        POSSIBLY_UNUSED(Msg);
+        m_entries.clear();
+        bError = true;
+    }
+
+    return bError;
+}
+
+void DarkLibraryFile::UnmapDark()
+{
+    // the image data belongs to the mapping, not to the usImage
+    m_mapped.ImageData = nullptr;
+    m_mapped.NPixels = 0;
+    m_mappedExpDur = -1;
+    m_file.Unmap();
+}
+
+void DarkLibraryFile::Close()
+{
+    UnmapDark();
+    m_file.Close();
+    m_entries.clear();
+    m_frameSize = wxSize();
+    m_path.clear();
+}
+
+usImage *DarkLibraryFile::MapDark(int expDur)
+{
+    if (expDur == m_mappedExpDur)
+        return &m_mapped;
+
+    EntryMap::const_iterator it = m_entries.find(expDur);
+    if (it == m_entries.end())
+        return nullptr;
+
+    UnmapDark();
+
+    const Entry& entry = it->second;
+    unsigned int npixels = m_frameSize.GetWidth() * m_frameSize.GetHeight();
+    const void *data = m_file.Map(entry.offset, npixels * sizeof(unsigned short));
+    if (!data)
+        return nullptr;
+
+    // the view is read-only; dark frames are never modified once they are in the library
+    m_mapped.ImageData = static_cast<unsigned short *>(const_cast<void *>(data));
+    m_mapped.Size = m_frameSize;
+    m_mapped.NPixels = npixels;
+    m_mapped.Subframe = wxRect(0, 0, 0, 0);
+    m_mapped.MinADU = entry.minADU;
+    m_mapped.MaxADU = entry.maxADU;
+    m_mapped.MedianADU = entry.medianADU;
+    m_mapped.ImgExpDur = entry.expDur;
+    m_mappedExpDur = expDur;
+
+    Debug.Write(wxString::Format("DarkLib cache: mapped dark exposure = %d, med = %u\n", expDur, entry.medianADU));
+
+    return &m_mapped;
+}
+
+bool DarkLibraryFile::ReadDark(int expDur, usImage& img) const
+{
+    EntryMap::const_iterator it = m_entries.find(expDur);
+    if (it == m_entries.end())
+        return true;
+
+    const Entry& entry = it->second;
+
+    if (img.Init(m_frameSize))
+        return true;
+
+    wxFFile file(m_path, "rb");
+    size_t nbytes = img.NPixels * sizeof(unsigned short);
+    if (!file.IsOpened() || !file.Seek(entry.offset) || file.Read(img.ImageData, nbytes) != nbytes)
+        return true;
+
+    img.MinADU = entry.minADU;
+    img.MaxADU = entry.maxADU;
+    img.MedianADU = entry.medianADU;
+    img.ImgExpDur = entry.expDur;
+
+    return false;
+}
+
+DarkModel::DarkModel()
+    :
+    MinExpDur(0),
+    MaxExpDur(0)
+{
+}
+
+bool DarkModel::Fit(const std::vector<const usImage *>& darks)
+{
+    if (darks.size() < 2)
+        return true;
+
+    const wxSize& size = darks[0]->Size;
+    unsigned int const npixels = darks[0]->NPixels;
+
+    double tmean = 0.0;
+    for (auto dark : darks)
+    {
+        if (dark->Size != size || !dark->ImageData)
+            return true;
+        tmean += dark->ImgExpDur;
+    }
+    tmean /= darks.size();
+
+    double stt = 0.0;
+    for (auto dark : darks)
+        stt += (dark->ImgExpDur - tmean) * (dark->ImgExpDur - tmean);
+    if (stt <= 0.0)
+        return true;
+
+    // with the exposure times fixed, the per-pixel least-squares slope and mean are
+    // fixed linear combinations of the frames
+    std::vector<float> ymean(npixels, 0.f);
+    Slope.assign(npixels, 0.f);
+
+    for (auto dark : darks)
+    {
+        float const w = (float)((dark->ImgExpDur - tmean) / stt);
+        float const m = (float)(1.0 / darks.size());
+        const unsigned short *src = dark->ImageData;
+        float *ps = &Slope[0];
+        float *pm = &ymean[0];
+        for (unsigned int i = 0; i < npixels; i++)
+        {
+            ps[i] += w * src[i];
+            pm[i] += m * src[i];
+        }
+    }
+
+    Offset.resize(npixels);
+    float const tm = (float) tmean;
+    for (unsigned int i = 0; i < npixels; i++)
+    {
+        float offset = ymean[i] - Slope[i] * tm;
+        offset = std::min(std::max(offset, 0.f), 65535.f);
+        Offset[i] = (unsigned short)(offset + 0.5f);
+    }
+
+    Size = size;
+    MinExpDur = MaxExpDur = darks[0]->ImgExpDur;
+    for (auto dark : darks)
+    {
+        MinExpDur = wxMin(MinExpDur, dark->ImgExpDur);
+        MaxExpDur = wxMax(MaxExpDur, dark->ImgExpDur);
+    }
+
+    Debug.Write(wxString::Format("DarkModel: fitted %u pixels to %u darks, exposures %d..%d\n",
+                                 npixels, (unsigned int) darks.size(), MinExpDur, MaxExpDur));
+
+    return false;
+}
+
+unsigned short DarkModel::Median(int expDur, const wxRect& subframe) const
+{
+    wxRect rect(subframe.IsEmpty() ? wxRect(Size) : subframe);
+    if (Offset.empty() || !wxRect(Size).Contains(rect))
+        return 0;
+
+    std::vector<unsigned short> tmp(rect.GetWidth() * rect.GetHeight());
+    unsigned short *dst = &tmp[0];
+    float const t = (float) expDur;
+
+    for (int y = rect.GetTop(); y <= rect.GetBottom(); y++)
+    {
+        unsigned int const idx = y * Size.GetWidth() + rect.GetLeft();
+        const unsigned short *po = &Offset[idx];
+        const float *ps = &Slope[idx];
+        for (int x = 0; x < rect.GetWidth(); x++)
+        {
+            float val = (float) po[x] + ps[x] * t;
+            val = std::min(std::max(val, 0.f), 65535.f);
+            *dst++ = (unsigned short)(val + 0.5f);
+        }
+    }
+
+    std::nth_element(tmp.begin(), tmp.begin() + tmp.size() / 2, tmp.end());
+    return tmp[tmp.size() / 2];
+}
+
+bool DarkModel::Save(const wxString& fname, const wxString& note) const
+{
+    bool bError = false;
+
+    try
+    {
+        fitsfile *fptr;  // FITS file pointer
+        int status = 0;  // CFITSIO status value MUST be initialized to zero!
+
+        PHD_fits_create_file(&fptr, fname, true, &status);
+        if (status)
+            throw ERROR_INFO("fits_create_file failed");
+
+        long fsize[] = {
+            (long) Size.GetWidth(),
+            (long) Size.GetHeight(),
+        };
+        long fpixel[3] = { 1, 1, 1 };
+
+        // HDU 1: offset (ADU)
+        if (!status) fits_create_img(fptr, USHORT_IMG, 2, fsize, &status);
+
+        char *keyname = const_cast<char *>("DARKMODL");
+        char *comment = const_cast<char *>("Offset of linear dark model, ADU");
+        char *value = const_cast<char *>("OFFSET");
+        if (!status) fits_write_key(fptr, TSTRING, keyname, value, comment, &status);
+
+        int minExp = MinExpDur;
+        int maxExp = MaxExpDur;
+        if (!status) fits_write_key(fptr, TINT, const_cast<char *>("MINEXP"), &minExp, const_cast<char *>("Shortest fitted exposure, ms"), &status);
+        if (!status) fits_write_key(fptr, TINT, const_cast<char *>("MAXEXP"), &maxExp, const_cast<char *>("Longest fitted exposure, ms"), &status);
+
+        if (!note.IsEmpty())
+        {
+            char *USERNOTE = const_cast<char *>("USERNOTE");
+            if (!status) fits_write_key(fptr, TSTRING, USERNOTE, note.char_str(), nullptr, &status);
+        }
+
+        if (!status) fits_write_pix(fptr, TUSHORT, fpixel, (LONGLONG) Offset.size(), const_cast<unsigned short *>(&Offset[0]), &status);
+
+        // HDU 2: slope (ADU per ms)
+        if (!status) fits_create_img(fptr, FLOAT_IMG, 2, fsize, &status);
+
+        comment = const_cast<char *>("Dark current of linear dark model, ADU/ms");
+        value = const_cast<char *>("SLOPE");
+        if (!status) fits_write_key(fptr, TSTRING, keyname, value, comment, &status);
+
+        if (!status) fits_write_pix(fptr, TFLOAT, fpixel, (LONGLONG) Slope.size(), const_cast<float *>(&Slope[0]), &status);
+
+        PHD_fits_close_file(fptr);
+        bError = status ? true : false;
+    }
+    catch (const wxString& Msg)
+    {
+        POSSIBLY_UNUSED(Msg);
+        bError = true;
+    }
+
+    return bError;
+}
+
+DarkModel *DarkModel::Load(const wxString& fname)
+{
+    fitsfile *fptr = nullptr;
+    int status = 0;  // CFITSIO status value MUST be initialized to zero!
+    std::unique_ptr<DarkModel> model(new DarkModel());
+
+    try
+    {
+        if (PHD_fits_open_diskfile(&fptr, fname, READONLY, &status))
+        {
+            fptr = nullptr;
+            throw ERROR_INFO("DarkModel: error opening file");
+        }
+
+        for (int hdu = 1; hdu <= 2; hdu++)
+        {
+            if (hdu > 1 && fits_movrel_hdu(fptr, +1, nullptr, &status))
+                throw ERROR_INFO("DarkModel: missing slope HDU");
+
+            int naxis = 0;
+            fits_get_img_dim(fptr, &naxis, &status);
+            long fsize[2];
+            fits_get_img_size(fptr, 2, fsize, &status);
+            if (status || naxis != 2)
+                throw ERROR_INFO("DarkModel: unsupported image");
+
+            if (hdu == 1)
+            {
+                model->Size = wxSize((int) fsize[0], (int) fsize[1]);
+                model->Offset.resize(fsize[0] * fsize[1]);
+                model->Slope.resize(fsize[0] * fsize[1]);
+            }
+            else if (fsize[0] != model->Size.GetWidth() || fsize[1] != model->Size.GetHeight())
+                throw ERROR_INFO("DarkModel: inconsistent frame sizes");
+
+            long fpixel[] = { 1, 1, 1 };
+            if (hdu == 1)
+            {
+                fits_read_pix(fptr, TUSHORT, fpixel, fsize[0] * fsize[1], nullptr, &model->Offset[0], nullptr, &status);
+
+                fits_read_key(fptr, TINT, const_cast<char *>("MINEXP"), &model->MinExpDur, nullptr, &status);
+                fits_read_key(fptr, TINT, const_cast<char *>("MAXEXP"), &model->MaxExpDur, nullptr, &status);
+            }
+            else
+                fits_read_pix(fptr, TFLOAT, fpixel, fsize[0] * fsize[1], nullptr, &model->Slope[0], nullptr, &status);
+
+            if (status)
+                throw ERROR_INFO("DarkModel: error reading data");
+        }
+
+        PHD_fits_close_file(fptr);
+
+        Debug.Write(wxString::Format("DarkModel: loaded %s, %dx%d exposures %d..%d\n", fname,
+                                     model->Size.x, model->Size.y, model->MinExpDur, model->MaxExpDur));
+    }
+    catch (const wxString& Msg)
+    {
+        POSSIBLY_UNUSED(Msg);
+        if (fptr)
+            PHD_fits_close_file(fptr);
+        model.reset();
+    }
+
+    return model.release();
+}
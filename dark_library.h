@@ -0,0 +1,146 @@
+/*
+*  dark_library.h
+*  PHD2 Guiding
+*
+*  Copyright (c) 2026 openphdguiding.org
+*  All rights reserved.
+*
+*  This source code is distributed under the following "BSD" license
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*    Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+*    Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the
+*     documentation and/or other materials provided with the distribution.
+*    Neither the name of openphdguiding.org nor the names of its
+*     contributors may be used to endorse or promote products derived from
+*     this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#ifndef DARK_LIBRARY_H_INCLUDED
+#define DARK_LIBRARY_H_INCLUDED
+
+// Read-only memory mapping of a file. One view (window) of the file is mapped at a time.
+class MappedFileView
+{
+#ifdef __WINDOWS__
+    HANDLE m_file;
+    HANDLE m_mapping;
+#else
+    int m_fd;
+#endif
+    void *m_view;
+    size_t m_viewLen;
+
+public:
+    MappedFileView();
+    ~MappedFileView();
+
+    bool Open(const wxString& path);
+    void Close();
+    bool IsOpen() const;
+
+    // map len bytes starting at offset, replacing any previous view. The offset must be
+    // a multiple of DarkLibraryFile::DATA_ALIGNMENT. Returns nullptr on error.
+    const void *Map(wxFileOffset offset, size_t len);
+    void Unmap();
+};
+
+// The dark library stored as uncompressed frames in a cache file next to the FITS dark
+// library. The file header holds the geometry and pre-computed statistics of every
+// frame, so opening the library reads only the header. The pixel data of a dark is
+// mapped into memory when the dark is selected and paged in by the OS as it is used.
+//
+// The FITS file remains the library of record; the cache is rebuilt whenever it does
+// not match the FITS file's size and modification time.
+class DarkLibraryFile
+{
+public:
+    // frame data starts on a boundary suitable for mapping on all platforms (the Windows
+    // allocation granularity is a multiple of the page size everywhere else)
+    enum { DATA_ALIGNMENT = 64 * 1024 };
+
+    struct Entry
+    {
+        int expDur;
+        unsigned short minADU;
+        unsigned short maxADU;
+        unsigned short medianADU;
+        wxFileOffset offset;
+    };
+    typedef std::map<int, Entry> EntryMap; // map exposure => frame
+
+private:
+    wxString m_path;
+    wxSize m_frameSize;
+    EntryMap m_entries;
+    MappedFileView m_file;
+    usImage m_mapped;           // the mapped dark; ImageData points into the file view
+    int m_mappedExpDur;
+
+    void UnmapDark();
+
+public:
+    DarkLibraryFile();
+    ~DarkLibraryFile();
+
+    static wxString CacheFileName(const wxString& fitsFile);
+    static bool IsCurrent(const wxString& cacheFile, const wxString& fitsFile);
+    // convert the FITS dark library, one frame at a time; returns true on error
+    static bool BuildFromFits(const wxString& fitsFile, const wxString& cacheFile);
+
+    bool Open(const wxString& cacheFile);
+    void Close();
+    bool IsOpen() const { return m_file.IsOpen(); }
+
+    const wxSize& FrameSize() const { return m_frameSize; }
+    const EntryMap& Entries() const { return m_entries; }
+
+    // map the dark with the given exposure, unmapping the previously mapped dark.
+    // The returned image remains valid until the next call to MapDark() or Close().
+    usImage *MapDark(int expDur);
+    bool IsMapped(const usImage *img) const { return img == &m_mapped && m_mappedExpDur != -1; }
+
+    // read a copy of a dark without disturbing the mapped dark; returns true on error
+    bool ReadDark(int expDur, usImage& img) const;
+};
+
+// Per-pixel linear model of the dark signal, dark(t) = offset + slope * t, fitted to a
+// master bias and two master darks. It stands in for a dark library of frames: the dark
+// for the exposure of each light frame is synthesized while it is being subtracted.
+class DarkModel
+{
+public:
+    wxSize Size;
+    std::vector<unsigned short> Offset;     // ADU
+    std::vector<float> Slope;               // ADU per millisecond
+    int MinExpDur;                          // exposure range the model was fitted to
+    int MaxExpDur;
+
+    DarkModel();
+
+    // least-squares fit to master darks of at least two distinct exposures; returns true on error
+    bool Fit(const std::vector<const usImage *>& darks);
+
+    // synthesized dark's median ADU for the given exposure within a subframe (or the full frame)
+    unsigned short Median(int expDur, const wxRect& subframe) const;
+
+    bool Save(const wxString& fname, const wxString& note) const;
+    static DarkModel *Load(const wxString& fname);
+};
+
+#endif // DARK_LIBRARY_H_INCLUDED
@@ -38,9 +38,13 @@
 #include "wx/valnum.h"
 
 #include <algorithm>
+#include <deque>
+#include <memory>
 #include <sstream>
 
 static const int DefDarkCount = 5;
+static const bool DefBuildDarkModel = false;
+static const bool DefSigmaClip = false;
 static const int DefDMExpTime = 15;
 static const int DefDMCount = 25;
 
@@ -93,6 +97,7 @@ DarksDialog::DarksDialog(wxWindow *parent, bool darkLib) :
     wxDialog(parent, wxID_ANY, _("Build Dark Library"), wxDefaultPosition, wxDefaultSize, wxCAPTION | wxCLOSE_BOX)
 {
     buildDarkLib = darkLib;
+    m_canModifyDarkLib = false;
     if (!buildDarkLib)
         this->SetTitle(_("Acquire Master Dark Frames for Bad Pixel Map Calculation"));
     GetExposureDurationStrings(&m_expStrings);
@@ -134,9 +139,20 @@ DarksDialog::DarksDialog(wxWindow *parent, bool darkLib) :
         m_rbNewDarkLib = new wxRadioButton(this, wxID_ANY, _("Create entirely new dark library"));
         m_rbNewDarkLib->SetToolTip(_("Darks created now will be used to build a completely new dark library - old dark frames will be discarded. You "
             " MUST use this option if you've seen alert messages about incompatible frame sizes or mismatches with the current camera."));
+        m_cbDarkModel = new wxCheckBox(this, wxID_ANY, _("Build a dark-current model instead of darks for every exposure time"));
+        m_cbDarkModel->SetToolTip(_("Take a master bias and master darks at the min and max exposure times only, and compute the dark "
+            "for any exposure time from a per-pixel dark-current model. This is much faster than taking darks at every exposure time."));
+        m_cbDarkModel->SetValue(pConfig->Profile.GetBoolean("/camera/darks_build_model", DefBuildDarkModel));
+        m_cbDarkModel->Bind(wxEVT_CHECKBOX, &DarksDialog::OnDarkModelChecked, this);
         if (pFrame->DarkLibExists(pConfig->GetCurrentProfileId(), false))
         {
-            if (pFrame->LoadDarkHandler(true))
+            if (pFrame->LoadDarkHandler(true) && pCamera->CurrentDarkModel)
+            {
+                pInfo->SetLabel(wxString::Format(_("Existing dark library is a dark-current model fitted to exposure times from %g s to %g s"),
+                    pCamera->CurrentDarkModel->MinExpDur / 1000., pCamera->CurrentDarkModel->MaxExpDur / 1000.));
+                m_rbNewDarkLib->SetValue(true);
+            }
+            else if (pCamera->HaveDarks())
             {
                 double min_v, max_v;
                 int num;
@@ -144,6 +160,7 @@ DarksDialog::DarksDialog(wxWindow *parent, bool darkLib) :
                 pInfo->SetLabel(wxString::Format(_("Existing dark library covers %d exposure times in the range of %g s to %g s"),
                     num, min_v / 1000., max_v / 1000.));
                 m_rbModifyDarkLib->SetValue(true);
+                m_canModifyDarkLib = true;
             }
             else
             {
@@ -163,7 +180,9 @@ DarksDialog::DarksDialog(wxWindow *parent, bool darkLib) :
         hSizer->Add(m_rbNewDarkLib, wxSizerFlags().Border(wxALL, 10));
         pBuildOptions->Add(pInfo, wxSizerFlags().Border(wxALL, 10).Border(wxLEFT, 25));
         pBuildOptions->Add(hSizer, wxSizerFlags().Border(wxALL, 10));
+        pBuildOptions->Add(m_cbDarkModel, wxSizerFlags().Border(wxALL, 10));
         pvSizer->Add(pBuildOptions, wxSizerFlags().Expand());
+        UpdateBuildOptions();
     }
     else
     {
@@ -180,6 +199,12 @@ DarksDialog::DarksDialog(wxWindow *parent, bool darkLib) :
         pvSizer->Add(pDMapGroup, wxSizerFlags().Border(wxALL, 10));
     }
 
+    m_cbSigmaClip = new wxCheckBox(this, wxID_ANY, _("Reject outliers when combining frames"));
+    m_cbSigmaClip->SetToolTip(_("Combine the dark frames with a sigma-clipped mean so that cosmic-ray hits and other transient "
+        "outliers in individual frames don't end up in the master dark. Needs at least 5 frames."));
+    m_cbSigmaClip->SetValue(pConfig->Profile.GetBoolean("/camera/darks_sigma_clip", DefSigmaClip));
+    pvSizer->Add(m_cbSigmaClip, wxSizerFlags().Border(wxALL, 10));
+
     // Controls for notes and status
     wxBoxSizer *phSizer = new wxBoxSizer(wxHORIZONTAL);
     wxStaticText *pNoteLabel = new wxStaticText(this, wxID_ANY,  _("Notes: "), wxPoint(-1, -1), wxSize(-1, -1));
@@ -256,7 +281,30 @@ void DarksDialog::OnStart(wxCommandEvent& evt)
 
     bool err = false;
 
-    if (buildDarkLib)
+    if (buildDarkLib && m_cbDarkModel->GetValue())
+    {
+        int darkFrameCount = m_pDarkCount->GetValue();
+        std::vector<int> exposureDurations(pFrame->GetExposureDurations());
+        std::sort(exposureDurations.begin(), exposureDurations.end());
+
+        err = BuildDarkModel(exposureDurations[0], exposureDurations[m_pDarkMinExpTime->GetSelection()],
+                             exposureDurations[m_pDarkMaxExpTime->GetSelection()], darkFrameCount);
+
+        if (m_cancelling || err)
+        {
+            ShowStatus(m_cancelling ? _("Operation cancelled - no changes have been made") : _("Operation failed - no changes have been made"), false);
+            if (pFrame->DarkLibExists(pConfig->GetCurrentProfileId(), false))
+                pFrame->LoadDarkHandler(true);
+        }
+        else
+        {
+            pFrame->LoadDarkHandler(true);
+            wrapupMsg = _("dark-current model built");
+            Debug.AddLine("Dark library - dark-current model created.");
+            ShowStatus(wrapupMsg, false);
+        }
+    }
+    else if (buildDarkLib)
     {
         int darkFrameCount = m_pDarkCount->GetValue();
         int minExpInx = m_pDarkMinExpTime->GetSelection();
@@ -388,6 +436,20 @@ void DarksDialog::OnStop(wxCommandEvent& evt)
         wxDialog::Close();
 }
 
+void DarksDialog::OnDarkModelChecked(wxCommandEvent& evt)
+{
+    UpdateBuildOptions();
+}
+
+void DarksDialog::UpdateBuildOptions()
+{
+    // a dark-current model always replaces the whole library
+    bool model = m_cbDarkModel->GetValue();
+    m_rbModifyDarkLib->Enable(m_canModifyDarkLib && !model);
+    if (model || !m_canModifyDarkLib)
+        m_rbNewDarkLib->SetValue(true);
+}
+
 void DarksDialog::OnReset(wxCommandEvent& evt)
 {
     if (buildDarkLib)
@@ -395,6 +457,8 @@ void DarksDialog::OnReset(wxCommandEvent& evt)
         m_pDarkMinExpTime->SetValue(MinExposureDefault());
         m_pDarkMaxExpTime->SetValue(MaxExposureDefault());
         m_pDarkCount->SetValue(DefDarkCount);
+        m_cbDarkModel->SetValue(DefBuildDarkModel);
+        UpdateBuildOptions();
     }
     else
     {
@@ -402,6 +466,7 @@ void DarksDialog::OnReset(wxCommandEvent& evt)
         m_pNumDefExposures->SetValue(DefDMCount);
         m_pNotes->SetValue("");
     }
+    m_cbSigmaClip->SetValue(DefSigmaClip);
 }
 
 void DarksDialog::ShowStatus(const wxString msg, bool appending)
@@ -424,12 +489,14 @@ void DarksDialog::SaveProfileInfo()
         pConfig->Profile.SetString("/camera/darks_min_exptime", m_pDarkMinExpTime->GetValue());
         pConfig->Profile.SetString("/camera/darks_max_exptime", m_pDarkMaxExpTime->GetValue());
         pConfig->Profile.SetInt("/camera/darks_num_frames", m_pDarkCount->GetValue());
+        pConfig->Profile.SetBoolean("/camera/darks_build_model", m_cbDarkModel->GetValue());
     }
     else
     {
         pConfig->Profile.SetInt("/camera/dmap_exptime", m_pDefectExpTime->GetValue());
         pConfig->Profile.SetInt("/camera/dmap_num_frames", m_pNumDefExposures->GetValue());
     }
+    pConfig->Profile.SetBoolean("/camera/darks_sigma_clip", m_cbSigmaClip->GetValue());
     pConfig->Profile.SetString("/camera/darks_note", m_pNotes->GetValue());
 }
 
@@ -481,15 +548,247 @@ struct Histogram
     }
 };
 
+// Stacks dark frames on a background thread, so that each frame is accumulated while the
+// next one is being exposed. Frames are combined by their mean, or by a sigma-clipped mean
+// that uses per-pixel running statistics to reject transient outliers like cosmic-ray hits.
+class DarkStacker : public wxThread
+{
+public:
+    enum CombineMethod
+    {
+        COMBINE_MEAN,
+        COMBINE_SIGMA_CLIP,
+    };
+
+private:
+    enum { MIN_CLIP_FRAMES = 5 };   // fewer frames than this are always averaged
+    static constexpr double CLIP_SIGMA = 3.0;
+
+    CombineMethod m_method;
+    wxMutex m_lock;
+    wxCondition m_cond;
+    std::deque<usImage *> m_queue;
+    unsigned int m_stacked;         // frames taken off the queue
+    unsigned int m_accumulated;     // frames that went into the stack
+    bool m_stopping;
+
+    // per-pixel running statistics
+    unsigned int m_npixels;
+    std::vector<wxUint32> m_sum;
+    std::vector<wxUint64> m_sumsq;
+    std::vector<unsigned short> m_min;
+    std::vector<unsigned short> m_max;
+
+    ExitCode Entry() override;
+    bool Accumulate(usImage& frame);
+
+public:
+    DarkStacker(CombineMethod method);
+    ~DarkStacker();
+
+    // queue a frame for stacking; the frame must not be touched until WaitStacked() shows it is done
+    void Add(usImage *frame);
+    // wait until count frames have been stacked
+    void WaitStacked(unsigned int count);
+    void Stop();
+    bool Combine(usImage& master);
+    unsigned int Accumulated() const { return m_accumulated; }  // valid once stopped
+};
+
+DarkStacker::DarkStacker(CombineMethod method)
+    :
+    wxThread(wxTHREAD_JOINABLE),
+    m_method(method),
+    m_cond(m_lock),
+    m_stacked(0),
+    m_accumulated(0),
+    m_stopping(false),
+    m_npixels(0)
+{
+}
+
+DarkStacker::~DarkStacker()
+{
+    Stop();
+}
+
+void DarkStacker::Add(usImage *frame)
+{
+    wxMutexLocker lck(m_lock);
+    m_queue.push_back(frame);
+    m_cond.Broadcast();
+}
+
+void DarkStacker::WaitStacked(unsigned int count)
+{
+    wxMutexLocker lck(m_lock);
+    while (m_stacked < count)
+        m_cond.Wait();
+}
+
+void DarkStacker::Stop()
+{
+    if (!IsAlive())
+        return;
+
+    {
+        wxMutexLocker lck(m_lock);
+        m_stopping = true;
+        m_cond.Broadcast();
+    }
+
+    Wait();
+}
+
+wxThread::ExitCode DarkStacker::Entry()
+{
+    while (true)
+    {
+        usImage *frame;
+
+        {
+            wxMutexLocker lck(m_lock);
+            while (m_queue.empty() && !m_stopping)
+                m_cond.Wait();
+            if (m_queue.empty())
+                break;
+            frame = m_queue.front();
+        }
+
+        bool accumulated = Accumulate(*frame);
+
+        {
+            wxMutexLocker lck(m_lock);
+            m_queue.pop_front();
+            ++m_stacked;
+            if (accumulated)
+                ++m_accumulated;
+            m_cond.Broadcast();
+        }
+    }
+
+    return nullptr;
+}
+
+// returns true if the frame was added to the stack
+bool DarkStacker::Accumulate(usImage& frame)
+{
+    frame.CalcStats();
+
+    Debug.Write(wxString::Format("dark frame stats: bpp %u min %u max %u med %u filtmin %u filtmax %u\n",
+                                 frame.BitsPerPixel, frame.MinADU, frame.MaxADU,
+                                 frame.MedianADU, frame.FiltMin, frame.FiltMax));
+
+    Histogram h(frame);
+    h.Dump();
+
+    if (m_sum.empty())
+    {
+        m_npixels = frame.NPixels;
+        m_sum.assign(m_npixels, 0);
+        if (m_method == COMBINE_SIGMA_CLIP)
+        {
+            m_sumsq.assign(m_npixels, 0);
+            m_min.assign(m_npixels, 65535);
+            m_max.assign(m_npixels, 0);
+        }
+    }
+
+    if (frame.NPixels != m_npixels)
+    {
+        Debug.Write(wxString::Format("dark frame skipped, %u pixels instead of %u\n", frame.NPixels, m_npixels));
+        return false;
+    }
+
+    // simple loops over contiguous arrays that the compiler vectorizes
+    const unsigned short *src = frame.ImageData;
+    wxUint32 *sum = &m_sum[0];
+    for (unsigned int i = 0; i < m_npixels; i++)
+        sum[i] += src[i];
+
+    if (m_method == COMBINE_SIGMA_CLIP)
+    {
+        wxUint64 *sumsq = &m_sumsq[0];
+        unsigned short *pmin = &m_min[0];
+        unsigned short *pmax = &m_max[0];
+        for (unsigned int i = 0; i < m_npixels; i++)
+        {
+            wxUint32 const v = src[i];
+            sumsq[i] += (wxUint64)(v * v);
+            pmin[i] = std::min(pmin[i], src[i]);
+            pmax[i] = std::max(pmax[i], src[i]);
+        }
+    }
+
+    return true;
+}
+
+bool DarkStacker::Combine(usImage& master)
+{
+    unsigned int const n = m_accumulated;
+    if (n == 0 || master.NPixels != m_npixels)
+        return true;
+
+    unsigned short *dst = master.ImageData;
+
+    if (m_method != COMBINE_SIGMA_CLIP || n < MIN_CLIP_FRAMES)
+    {
+        for (unsigned int i = 0; i < m_npixels; i++)
+            dst[i] = (unsigned short)(m_sum[i] / n);
+        return false;
+    }
+
+    // The sample extremes are the only values that can be outliers worth rejecting in a short
+    // stack. Test each against the mean and sigma of the remaining n-2 samples, which the
+    // outlier itself cannot inflate.
+    unsigned int rejected = 0;
+    for (unsigned int i = 0; i < m_npixels; i++)
+    {
+        double const lo = m_min[i];
+        double const hi = m_max[i];
+        double const s = (double) m_sum[i] - lo - hi;
+        double const ss = (double) m_sumsq[i] - lo * lo - hi * hi;
+        double const mean = s / (n - 2);
+        double const var = ss / (n - 2) - mean * mean;
+        // floor sigma at 1 ADU so quantized, noiseless pixels are not clipped
+        double const limit = CLIP_SIGMA * std::max(sqrt(std::max(var, 0.0)), 1.0);
+
+        double tot = m_sum[i];
+        unsigned int cnt = n;
+        if (hi > mean + limit)
+        {
+            tot -= hi;
+            --cnt;
+        }
+        if (lo < mean - limit)
+        {
+            tot -= lo;
+            --cnt;
+        }
+        rejected += n - cnt;
+
+        dst[i] = (unsigned short)(tot / cnt + 0.5);
+    }
+
+    Debug.Write(wxString::Format("sigma-clipped combine of %u frames rejected %u samples\n", n, rejected));
+
+    return false;
+}
+
 bool DarksDialog::CreateMasterDarkFrame(usImage& darkFrame, int expTime, int frameCount)
 {
     bool err = false;
 
     pCamera->InitCapture();
-    darkFrame.ImgExpDur = expTime;
-    darkFrame.ImgStackCnt = frameCount;
 
-    unsigned int *avgimg = 0;
+    // capture alternates between two buffers: while one is being exposed, the stacker
+    // works on the other
+    usImage frames[2];
+    DarkStacker stacker(m_cbSigmaClip->GetValue() ? DarkStacker::COMBINE_SIGMA_CLIP : DarkStacker::COMBINE_MEAN);
+    if (stacker.Run() != wxTHREAD_NO_ERROR)
+        return true;
+
+    int captured = 0;
 
     for (int j = 1; j <= frameCount; j++)
     {
@@ -498,8 +797,12 @@ bool DarksDialog::CreateMasterDarkFrame(usImage& darkFrame, int expTime, int fra
             break;
         ShowStatus(wxString::Format(_("Taking dark frame %d/%d"), j, frameCount), true);
 
+        // the buffer is free once the frame captured into it two frames ago has been stacked
+        usImage& frame = frames[j % 2];
+        stacker.WaitStacked(wxMax(j - 2, 0));
+
         Debug.Write(wxString::Format("Capture dark frame %d/%d exp=%d\n", j, frameCount, expTime));
-        err = GuideCamera::Capture(pCamera, expTime, darkFrame, CAPTURE_DARK);
+        err = GuideCamera::Capture(pCamera, expTime, frame, CAPTURE_DARK);
         if (err)
         {
             ShowStatus(wxString::Format(_("%.1f s dark FAILED"), (double)expTime / 1000.0), true);
@@ -507,46 +810,114 @@ bool DarksDialog::CreateMasterDarkFrame(usImage& darkFrame, int expTime, int fra
             break;
         }
 
+        frame.Widen(); // the stacker reads 16-bit pixels
+        stacker.Add(&frame);
+        ++captured;
+
         m_pProgress->SetValue(m_pProgress->GetValue() + expTime);
         wxYield();
+    }
 
-        darkFrame.CalcStats();
-
-        Debug.Write(wxString::Format("dark frame stats: bpp %u min %u max %u med %u filtmin %u filtmax %u\n",
-                                     darkFrame.BitsPerPixel, darkFrame.MinADU, darkFrame.MaxADU,
-                                     darkFrame.MedianADU, darkFrame.FiltMin, darkFrame.FiltMax));
-
-        Histogram h(darkFrame);
-        h.Dump();
-        wxYield();
+    stacker.WaitStacked(captured);
+    stacker.Stop();
 
-        if (!avgimg)
+    if (!m_cancelling && !err)
+    {
+        ShowStatus(_("Dark frames complete"), true);
+        const usImage& last = frames[frameCount % 2];
+        if (darkFrame.Init(last.Size))
+            err = true;
+        else
         {
-            avgimg = new unsigned int[darkFrame.NPixels];
-            memset(avgimg, 0, darkFrame.NPixels * sizeof(*avgimg));
+            darkFrame.Subframe = last.Subframe;
+            darkFrame.ImgStartTime = last.ImgStartTime;
+            darkFrame.ImgStartSteady = last.ImgStartSteady;
+            darkFrame.BitsPerPixel = last.BitsPerPixel;
+            darkFrame.Pedestal = last.Pedestal;
+            darkFrame.FrameNum = last.FrameNum;
+            err = stacker.Combine(darkFrame);
+            if (!err)
+                darkFrame.CalcStats();
         }
+    }
+
+    darkFrame.ImgExpDur = expTime;
+    darkFrame.ImgStackCnt = stacker.Accumulated();
 
-        unsigned int *iptr = avgimg;
-        const unsigned short *usptr = darkFrame.ImageData;
-        for (unsigned int i = 0; i < darkFrame.NPixels; i++)
-            *iptr++ += *usptr++;
+    m_pProgress->SetValue(m_pProgress->GetValue() + expTime);
+    wxYield();
+
+    return err;
+}
+
+bool DarksDialog::BuildDarkModel(int biasExpTime, int minExpTime, int maxExpTime, int frameCount)
+{
+    // The shortest exposure stands in for the bias frame since not all cameras support
+    // zero-length exposures. The model is fitted to the bias and the darks at the two
+    // ends of the exposure range.
+    std::vector<int> expTimes;
+    expTimes.push_back(biasExpTime);
+    expTimes.push_back(minExpTime);
+    expTimes.push_back(maxExpTime);
+    std::sort(expTimes.begin(), expTimes.end());
+    expTimes.erase(std::unique(expTimes.begin(), expTimes.end()), expTimes.end());
+
+    if (expTimes.size() < 2)
+    {
+        wxMessageBox(_("The dark-current model needs a max exposure time longer than the shortest exposure time"));
+        return true;
     }
 
-    if (!m_cancelling && !err)
+    int tot_dur = 0;
+    for (auto exp : expTimes)
+        tot_dur += exp * frameCount;
+    m_pProgress->SetRange(tot_dur);
+
+    std::vector<std::unique_ptr<usImage>> masters;
+    for (auto exp : expTimes)
     {
-        ShowStatus(_("Dark frames complete"), true);
-        const unsigned int *iptr = avgimg;
-        unsigned short *usptr = darkFrame.ImageData;
-        for (unsigned int i = 0; i < darkFrame.NPixels; i++)
-            *usptr++ = (unsigned short)(*iptr++ / frameCount);
+        if (exp >= 1000)
+            ShowStatus(wxString::Format(_("Building master dark at %.1f sec:"), (double) exp / 1000.0), false);
+        else
+            ShowStatus(wxString::Format(_("Building master dark at %d mSec:"), exp), false);
+
+        masters.emplace_back(new usImage());
+        bool err = CreateMasterDarkFrame(*masters.back(), exp, frameCount);
+        wxYield();
+        if (m_cancelling || err)
+            return err;
     }
 
-    m_pProgress->SetValue(m_pProgress->GetValue() + expTime);
-    wxYield();
+    ShowStatus(_("Computing dark-current model"), false);
 
-    delete[] avgimg;
+    std::vector<const usImage *> darks;
+    for (const auto& master : masters)
+        darks.push_back(master.get());
 
-    return err;
+    DarkModel model;
+    if (model.Fit(darks))
+    {
+        ShowStatus(_("Could not compute the dark-current model"), false);
+        return true;
+    }
+
+    wxString modelFile = MyFrame::DarkModelFileName(pConfig->GetCurrentProfileId());
+    if (model.Save(modelFile, m_pNotes->GetValue()))
+    {
+        pFrame->Alert(wxString::Format(_("Error saving dark model FITS file %s"), modelFile));
+        return true;
+    }
+
+    // the model replaces any library of dark frames
+    pCamera->ClearDarks();
+    wxString libFile = MyFrame::DarkLibFileName(pConfig->GetCurrentProfileId());
+    wxString cacheFile = DarkLibraryFile::CacheFileName(libFile);
+    if (wxFileExists(libFile))
+        wxRemoveFile(libFile);
+    if (wxFileExists(cacheFile))
+        wxRemoveFile(cacheFile);
+
+    return false;
 }
 
 DarksDialog::~DarksDialog(void)
@@ -49,6 +49,9 @@ private:
     wxSpinCtrl *m_pNumDefExposures;
     wxRadioButton *m_rbModifyDarkLib;
     wxRadioButton *m_rbNewDarkLib;
+    wxCheckBox *m_cbDarkModel;
+    wxCheckBox *m_cbSigmaClip;
+    bool m_canModifyDarkLib;
     wxTextCtrl *m_pNotes;
     wxGauge *m_pProgress;
     wxButton *m_pStartBtn;
@@ -59,9 +62,12 @@ private:
     void OnStart(wxCommandEvent& evt);
     void OnStop(wxCommandEvent& evt);
     void OnReset(wxCommandEvent& evt);
+    void OnDarkModelChecked(wxCommandEvent& evt);
+    void UpdateBuildOptions();
     void SaveProfileInfo();
     void ShowStatus(const wxString msg, bool appending);
     bool CreateMasterDarkFrame(usImage& dark, int expTime, int frameCount);
+    bool BuildDarkModel(int biasExpTime, int minExpTime, int maxExpTime, int frameCount);
 
 public:
     DarksDialog(wxWindow *parent, bool darkLibrary);
@@ -1287,7 +1287,7 @@ static void save_image(JObj& response, const json_value *params)
 {
     VERIFY_GUIDER(response);
 
-    if (!pFrame->pGuider->CurrentImage()->ImageData)
+    if (!pFrame->pGuider->CurrentImage()->HasPixels())
     {
         response << jrpc_error(2, "no image available");
         return;
@@ -1433,7 +1433,7 @@ static void get_star_image(JObj& response, const json_value *params)
     const usImage *img = guider->CurrentImage();
     const PHD_Point& star = guider->CurrentPosition();
 
-    if (guider->GetState() < GUIDER_STATE::STATE_SELECTED || !img->ImageData || !star.IsValid())
+    if (guider->GetState() < GUIDER_STATE::STATE_SELECTED || !img->HasPixels() || !star.IsValid())
     {
         response << jrpc_error(2, "no star selected");
         return;
@@ -1450,10 +1450,12 @@ static void get_star_image(JObj& response, const json_value *params)
         rect.Intersect(img->Subframe);
 
     B64Encode enc;
+    std::vector<unsigned short> row(rect.GetWidth());
     for (int y = rect.GetTop(); y <= rect.GetBottom(); y++)
     {
-        const unsigned short *p = img->ImageData + y * img->Size.GetWidth() + rect.GetLeft();
-        enc.append(p, rect.GetWidth() * sizeof(unsigned short));
+        for (int x = 0; x < rect.GetWidth(); x++)
+            row[x] = img->PixelValue(rect.GetLeft() + x, y);
+        enc.append(&row[0], rect.GetWidth() * sizeof(unsigned short));
     }
 
     PHD_Point pos(star);
@@ -1648,7 +1650,7 @@ static void get_camera_binning(JObj& response, const json_value *params)
 {
     if (pCamera && pCamera->Connected)
     {
-        int binning = pCamera->Binning;
+        int binning = pCamera->EffectiveBinning();
         response << jrpc_result(binning);
     }
     else
@@ -1659,7 +1661,7 @@ static void get_camera_frame_size(JObj& response, const json_value *params)
 {
     if (pCamera && pCamera->Connected)
     {
-        response << jrpc_result(pCamera->FullSize);
+        response << jrpc_result(pCamera->FrameSize());
     }
     else
         response << jrpc_error(1, "camera not connected");
@@ -2000,6 +2002,12 @@ static void get_calibration_data(JObj& response, const json_value *params)
             << NV("yRate", m->yRate() * 1000.0, 3)
             << NV("yParity", parity_str(m->DecParity()))
             << NV("declination", degrees(m->GetCalibrationDeclination()));
+
+        if (m->CalibrationRefinementEnabled())
+        {
+            rslt << NV("raRefinementConfidence", m->CalibrationRefinementConfidence(GUIDE_RA), 2)
+                << NV("decRefinementConfidence", m->CalibrationRefinementConfidence(GUIDE_DEC), 2);
+        }
     }
 
     response << jrpc_result(rslt);
@@ -1122,7 +1122,7 @@ bool GearDialog::DoConnectCamera(bool autoReconnecting)
                 m_camChanged = true;
 
                 // Can't use standard checks because we don't want to consider sensor-size
-                if (wxFileExists(darkName) || wxFileExists(bpmName))
+                if (wxFileExists(darkName) || wxFileExists(MyFrame::DarkModelFileName(currProfileId)) || wxFileExists(bpmName))
                 {
                     Debug.Write("DoConnectCamera: displaying camera-change warning\n");
 
@@ -1135,6 +1135,7 @@ bool GearDialog::DoConnectCamera(bool autoReconnecting)
                     }
                     else
                     {
+                        m_pCamera->StopStreaming();
                         m_pCamera->Disconnect();
                         SetMatchingSelection(m_pCameras, m_lastCamera);
                         wxCommandEvent dummy;
@@ -1248,6 +1249,7 @@ void GearDialog::OnButtonDisconnectCamera(wxCommandEvent& event)
             throw THROW_INFO("OnButtonDisconnectCamera: called when not connected");
         }
 
+        m_pCamera->StopStreaming();
         m_pCamera->Disconnect();
 
         if (m_pScope && m_pScope->RequiresCamera() && m_pScope->IsConnected())
@@ -2053,6 +2055,7 @@ void GearDialog::Shutdown(bool forced)
     if (!forced && m_pCamera && m_pCamera->Connected)
     {
         Debug.AddLine("Shutdown: disconnect camera");
+        m_pCamera->StopStreaming();
         m_pCamera->Disconnect();
     }
 
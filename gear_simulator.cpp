@@ -559,7 +559,7 @@ struct SimCamState
 #endif
 
     void Initialize();
-    void FillImage(usImage& img, const wxRect& subframe, int exptime, int gain, int offset);
+    void FillImage(usImage& img, const std::vector<wxRect>& windows, int exptime, int gain, int offset);
 };
 
 void SimCamState::Initialize()
@@ -972,7 +972,7 @@ void SimCamState::ReadDisplacements(double& incX, double& incY)
 }
 #endif
 
-void SimCamState::FillImage(usImage& img, const wxRect& subframe, int exptime, int gain, int offset)
+void SimCamState::FillImage(usImage& img, const std::vector<wxRect>& windows, int exptime, int gain, int offset)
 {
     unsigned int const nr_stars = stars.size();
 
@@ -1141,7 +1141,7 @@ void SimCamState::FillImage(usImage& img, const wxRect& subframe, int exptime, i
     }
 #endif // STEPGUIDER_SIMULATOR
 
-    // render each star
+    // render each star, into each of the windows being read out
     if (!pCamera->ShutterClosed)
     {
         for (unsigned int i = 0; i < nr_stars; i++)
@@ -1151,7 +1151,8 @@ void SimCamState::FillImage(usImage& img, const wxRect& subframe, int exptime, i
             double noise = (double)(rand() % (gain * 100));
             double inten = star + dark + noise;
 
-            render_star(img, pCamera->Binning, subframe, cc[i], inten);
+            for (const wxRect& subframe : windows)
+                render_star(img, pCamera->Binning, subframe, cc[i], inten);
         }
 
 #ifndef SIM_FILE_DISPLACEMENTS
@@ -1168,13 +1169,17 @@ void SimCamState::FillImage(usImage& img, const wxRect& subframe, int exptime, i
             double noise = (double)(rand() % (gain * 100));
             inten = star + dark + noise;
 
-            render_comet(img, pCamera->Binning, subframe, wxRealPoint(cx, cy), inten);
+            for (const wxRect& subframe : windows)
+                render_comet(img, pCamera->Binning, subframe, wxRealPoint(cx, cy), inten);
         }
 #endif
     }
 
     if (SimCamParams::clouds_opacity > 0)
-        render_clouds(img, subframe, exptime, gain, offset);
+    {
+        for (const wxRect& subframe : windows)
+            render_clouds(img, subframe, exptime, gain, offset);
+    }
 
     // render hot pixels
     for (unsigned int i = 0; i < hotpx.size(); i++)
@@ -1182,8 +1187,11 @@ void SimCamState::FillImage(usImage& img, const wxRect& subframe, int exptime, i
         wxPoint p(hotpx[i]);
         p.x /= pCamera->Binning;
         p.y /= pCamera->Binning;
-        if (subframe.Contains(p))
-            set_pixel(img, p.x, p.y, (unsigned short)-1);
+        for (const wxRect& subframe : windows)
+        {
+            if (subframe.Contains(p))
+                set_pixel(img, p.x, p.y, (unsigned short)-1);
+        }
     }
 }
 
@@ -1206,8 +1214,18 @@ public:
     bool     ST4HasNonGuiMove() override { return true; }
     bool     ST4SynchronousOnly() override;
     bool     ST4PulseGuideScope(int direction, int duration) override;
+    bool     ST4CanPulseConcurrently() override { return true; }
+    bool     ST4PulseGuideScopeConcurrently(int raDirection, int raDuration, int decDirection, int decDuration) override;
+    bool     OnStartStreaming(int exposureMs, const wxRect& subframe) override;
+    bool     CaptureStreamFrame(usImage& img) override;
     PierSide SideOfPier() const;
     void     FlipPierSide();
+private:
+    bool     ApplyGuidePulse(int direction, int duration);
+    bool     RenderImage(int duration, usImage& img, int options, const wxRect& subframe);
+    int      m_streamExposure;
+    wxRect   m_streamSubframe;
+    wxMutex  m_simLock;     // the stream thread renders while guide pulses move the simulated mount
 };
 
 CameraSimulator::CameraSimulator()
@@ -1221,6 +1239,10 @@ CameraSimulator::CameraSimulator()
     PropertyDialogType = PROPDLG_WHEN_CONNECTED;
     MaxBinning = 3;
     HasCooler = true;
+#if SIMMODE == 3
+    HasStreaming = true;
+#endif
+    m_streamExposure = 0;
 }
 
 wxByte CameraSimulator::BitsPerPixel()
@@ -1265,6 +1287,7 @@ bool CameraSimulator::Connect(const wxString& camId)
 
 bool CameraSimulator::Disconnect()
 {
+    StopStreaming();
     Connected = false;
     return false;
 }
@@ -1357,6 +1380,36 @@ bool CameraSimulator::Capture(int duration, usImage& img, int options, const wxR
 
 #else
 
+    if (RenderImage(duration, img, options, subframe))
+        return true;
+
+#endif // SIMMODE == 1
+
+    unsigned int tot_dur = duration + SimCamParams::frame_download_ms;
+    long elapsed = watchdog.Time();
+    if (elapsed < tot_dur)
+    {
+        if (WorkerThread::MilliSleep(tot_dur - elapsed, WorkerThread::INT_ANY))
+            return true;
+        if (watchdog.Expired())
+        {
+            DisconnectWithAlert(CAPT_FAIL_TIMEOUT);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+
+#if SIMMODE == 3
+bool CameraSimulator::RenderImage(int duration, usImage& img, int options, const wxRect& subframeArg)
+{
+    wxMutexLocker lck(m_simLock);
+
+    wxRect subframe(subframeArg);
+
     int width = sim.width / Binning;
     int height = sim.height / Binning;
     FullSize = wxSize(width, height);
@@ -1380,41 +1433,79 @@ bool CameraSimulator::Capture(int duration, usImage& img, int options, const wxR
     if (usingSubframe)
         img.Clear();
 
-    fill_noise(img, subframe, exptime, gain, offset);
+    // like a camera with multi-window readout, only render the requested windows
+    std::vector<wxRect> windows;
+    if (usingSubframe)
+    {
+        for (const wxRect& roi : img.Rois)
+        {
+            wxRect r(roi);
+            r.Intersect(subframe);
+            if (!r.IsEmpty())
+                windows.push_back(r);
+        }
+    }
+    if (windows.empty())
+        windows.push_back(subframe);
 
-    sim.FillImage(img, subframe, exptime, gain, offset);
+    for (const wxRect& r : windows)
+        fill_noise(img, r, exptime, gain, offset);
+
+    sim.FillImage(img, windows, exptime, gain, offset);
 
     if (usingSubframe)
         img.Subframe = subframe;
 
     if (options & CAPTURE_SUBTRACT_DARK) SubtractDark(img);
 
-#endif // SIMMODE == 1
-
-    unsigned int tot_dur = duration + SimCamParams::frame_download_ms;
-    long elapsed = watchdog.Time();
-    if (elapsed < tot_dur)
-    {
-        if (WorkerThread::MilliSleep(tot_dur - elapsed, WorkerThread::INT_ANY))
-            return true;
-        if (watchdog.Expired())
-        {
-            DisconnectWithAlert(CAPT_FAIL_TIMEOUT);
-            return true;
-        }
-    }
+    return false;
+}
+#endif // SIMMODE == 3
 
+bool CameraSimulator::OnStartStreaming(int exposureMs, const wxRect& subframe)
+{
+#if SIMMODE == 3
+    m_streamExposure = exposureMs;
+    m_streamSubframe = subframe;
     return false;
+#else
+    return true; // streaming is only simulated for generated images
+#endif
 }
 
+bool CameraSimulator::CaptureStreamFrame(usImage& img)
+{
+#if SIMMODE == 3
+    // like Capture, render at the end of the exposure so that guide pulses made
+    // while the frame was being exposed show up in the image
+    wxStopWatch swatch;
 
+    if (StreamMilliSleep(m_streamExposure))
+        return true;
 
-bool CameraSimulator::ST4PulseGuideScope(int direction, int duration)
+    if (RenderImage(m_streamExposure, img, 0, m_streamSubframe))
+        return true;
+
+    // frames are read out while the next one is being exposed, so a stream
+    // only pays a fraction of the frame download time
+    long remaining = (long) SimCamParams::frame_download_ms / 4 - (swatch.Time() - m_streamExposure);
+    if (remaining > 0 && StreamMilliSleep(remaining))
+        return true;
+
+    return false;
+#else
+    return true;
+#endif
+}
+
+bool CameraSimulator::ApplyGuidePulse(int direction, int duration)
 {
     // Following must take into account how the render_star function works.  Render_star uses camera binning explicitly, so
     // relying only on image scale in computing d creates distances that are too small by a factor of <binning>
     double d = SimCamParams::guide_rate * Binning * duration / (1000.0 * SimCamParams::image_scale);
 
+    wxMutexLocker lck(m_simLock);
+
     // simulate RA motion scaling according to declination
     if (direction == WEST || direction == EAST)
     {
@@ -1444,10 +1535,26 @@ bool CameraSimulator::ST4PulseGuideScope(int direction, int duration)
     case SOUTH:   sim.dec_ofs.incr(-d); break;
     default: return true;
     }
+    return false;
+}
+
+bool CameraSimulator::ST4PulseGuideScope(int direction, int duration)
+{
+    if (ApplyGuidePulse(direction, duration))
+        return true;
     WorkerThread::MilliSleep(duration, WorkerThread::INT_ANY);
     return false;
 }
 
+bool CameraSimulator::ST4PulseGuideScopeConcurrently(int raDirection, int raDuration, int decDirection, int decDuration)
+{
+    // both axes move at the same time, so the pulse completes when the longer of the two ends
+    if (ApplyGuidePulse(raDirection, raDuration) || ApplyGuidePulse(decDirection, decDuration))
+        return true;
+    WorkerThread::MilliSleep(wxMax(raDuration, decDuration), WorkerThread::INT_ANY);
+    return false;
+}
+
 bool CameraSimulator::SetCoolerOn(bool on)
 {
     if (on)
@@ -75,7 +75,7 @@ double GuideAlgorithm::SmartDefaultMinMove()
         double focalLength = pFrame->GetFocalLength();
         if (focalLength != 0)
         {
-            return GuideAlgorithm::SmartDefaultMinMove(focalLength, pCamera->GetCameraPixelSize(), pCamera->Binning);
+            return GuideAlgorithm::SmartDefaultMinMove(focalLength, pCamera->GetCameraPixelSize(), pCamera->EffectiveBinning());
         }
         else
             return 0.2;
@@ -125,6 +125,10 @@ void GuideAlgorithm::DirectMoveApplied(double amt)
 {
 }
 
+void GuideAlgorithm::GuideMoveApplied(double amt)
+{
+}
+
 void GuideAlgorithm::GuidingDisabled()
 {
     // By default, guide star deflections will be accumulated even with guiding disabled - algo can override if this is a problem
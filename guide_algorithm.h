@@ -47,9 +47,11 @@
  *
  * It provides a method:
  *
- * double result(double input)
+ * double result(double input, const std::chrono::steady_clock::time_point& sampleTime)
  *
- * that returns the result of whatever processing it does on input.
+ * that returns the result of whatever processing it does on input. sampleTime
+ * is the monotonic time at which input was measured, normally the midpoint of
+ * the exposure, for algorithms that model the error over time.
  *
  * Optionally, the guide algorithm can implement
  *
@@ -75,6 +77,8 @@ protected:
     Mount *m_pMount;
     GuideAxis m_guideAxis;
 
+    // the time at which the correction is sent, the offline replay of guide logs runs it on recorded time
+    virtual std::chrono::steady_clock::time_point Now() const { return std::chrono::steady_clock::now(); }
 
 public:
     GuideAlgorithm(Mount *pMount, GuideAxis axis) : m_pMount(pMount), m_guideAxis(axis) {};
@@ -82,7 +86,7 @@ public:
     virtual GUIDE_ALGORITHM Algorithm() const = 0;
 
     virtual void reset() = 0;
-    virtual double result(double input) = 0;
+    virtual double result(double input, const std::chrono::steady_clock::time_point& sampleTime) = 0;
     virtual double deduceResult() { return 0.0; }
 
     virtual void GuidingStarted();
@@ -92,6 +96,9 @@ public:
     virtual void GuidingDithered(double amt);
     virtual void GuidingDitherSettleDone(bool success);
     virtual void DirectMoveApplied(double amt);
+    // the distance the mount actually moved for the most recent result() or deduceResult(),
+    // which differs from the result when the move was limited or not made at all
+    virtual void GuideMoveApplied(double amt);
     virtual void GuidingEnabled();
     virtual void GuidingDisabled();
 
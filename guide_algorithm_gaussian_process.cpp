@@ -46,6 +46,7 @@
 #include "gaussian_process_guider.h"
 
 #include <ctime>
+#include <wx/tokenzr.h>
 
 #include "math_tools.h"
 #include "gaussian_process.h"
@@ -70,8 +71,11 @@ static const int    DefaultNumPointsForApproximation        = 100; // number of
 static const double DefaultPredictionGain                  = 0.5; // amount of GP prediction to blend in
 
 static const double DefaultNoresetMaxPctPeriod = 40.; // max percent of worm period elapsed to skip resetting the model when guiding is stopped and resumed
+static const double DefaultWarmStartWeight = 0.5; // initial weight of the gear error model saved in an earlier session
+static const int    WarmStartModelBins = 64; // number of phase bins of the saved gear error model
 
 static const bool   DefaultComputePeriod                 = true;
+static const bool   DefaultOptimizeHyperparameters       = false;
 
 static void MakeBold(wxControl *ctrl)
 {
@@ -294,6 +298,7 @@ class GuideAlgorithmGaussianProcess::GuideAlgorithmGaussianProcessDialogPane : p
     wxSpinCtrlDouble *m_pPKPeriodLength;
     wxSpinCtrl *m_pPredictionGain;
     wxCheckBox       *m_checkboxComputePeriod;
+    wxCheckBox       *m_checkboxOptimizeHyperparameters;
     wxSpinCtrlDouble *m_retainModelPct;
     wxButton         *m_btnExpertOptions;
 
@@ -334,11 +339,16 @@ public:
         m_checkboxComputePeriod = new wxCheckBox(pParent, wxID_ANY, _("Auto-adjust period"));
         m_checkboxComputePeriod->SetToolTip(wxString::Format(_("Auto-adjust the period length based on identified repetitive errors. Default = %s"),
             DefaultComputePeriod ? _("On") : _("Off")));
+        m_checkboxOptimizeHyperparameters = new wxCheckBox(pParent, wxID_ANY, _("Auto-adjust kernels"));
+        m_checkboxOptimizeHyperparameters->SetToolTip(wxString::Format(_("Auto-adjust the length scales and signal variances of the expert options "
+            "to the guiding data, within a range around the configured values. Default = %s"),
+            DefaultOptimizeHyperparameters ? _("On") : _("Off")));
 
         DoAdd(_("Period Length"), m_pPKPeriodLength,
             wxString::Format(_("The period length (in seconds) of the strongest periodic error component.  Default = %.2f"),
             DefaultPeriodLengthPerKer));
         DoAdd(m_checkboxComputePeriod);
+        DoAdd(m_checkboxOptimizeHyperparameters);
 
         width = StringWidth(_T("888"));
         m_retainModelPct = pFrame->MakeSpinCtrlDouble(pParent, wxID_ANY, wxEmptyString, wxDefaultPosition,
@@ -378,6 +388,8 @@ public:
         m_pPKPeriodLength->Enable(!pFrame->pGuider || !pFrame->pGuider->IsCalibratingOrGuiding());
         m_checkboxComputePeriod->SetValue(m_pGuideAlgorithm->GetBoolComputePeriod());
         m_checkboxComputePeriod->Enable(!pFrame->pGuider || !pFrame->pGuider->IsCalibratingOrGuiding());
+        m_checkboxOptimizeHyperparameters->SetValue(m_pGuideAlgorithm->GetBoolOptimizeHyperparameters());
+        m_checkboxOptimizeHyperparameters->Enable(!pFrame->pGuider || !pFrame->pGuider->IsCalibratingOrGuiding());
         m_retainModelPct->SetValue(GetRetainModelPct(m_pGuideAlgorithm));
 
         m_pGuideAlgorithm->m_expertDialog->LoadExpertValues(m_pGuideAlgorithm, hyperparameters);
@@ -400,6 +412,9 @@ public:
         if (pFrame->pGuider->IsGuiding() && m_pGuideAlgorithm->GetBoolComputePeriod() != m_checkboxComputePeriod->GetValue())
             pFrame->NotifyGuidingParam(m_pGuideAlgorithm->GetAxis() + " PPEC Adjust Period Length", m_checkboxComputePeriod->GetValue());
         m_pGuideAlgorithm->SetBoolComputePeriod(m_checkboxComputePeriod->GetValue());
+        if (pFrame->pGuider->IsGuiding() && m_pGuideAlgorithm->GetBoolOptimizeHyperparameters() != m_checkboxOptimizeHyperparameters->GetValue())
+            pFrame->NotifyGuidingParam(m_pGuideAlgorithm->GetAxis() + " PPEC Adjust Kernels", m_checkboxOptimizeHyperparameters->GetValue());
+        m_pGuideAlgorithm->SetBoolOptimizeHyperparameters(m_checkboxOptimizeHyperparameters->GetValue());
 
         SetRetainModelPct(m_pGuideAlgorithm, m_retainModelPct->GetValue());
     }
@@ -442,6 +457,7 @@ GuideAlgorithmGaussianProcess::GuideAlgorithmGaussianProcess(Mount *pMount, Guid
 
     // create instance of the worker
     GPG = new GaussianProcessGuider(parameters);
+    GPG->SetAsyncUpdates(true); // keep the model refits off the guide loop
 
     wxString configPath = GetConfigPath();
 
@@ -476,6 +492,9 @@ GuideAlgorithmGaussianProcess::GuideAlgorithmGaussianProcess(Mount *pMount, Guid
 
     bool compute_period = pConfig->Profile.GetBoolean(configPath + "/gp_compute_period", DefaultComputePeriod);
     SetBoolComputePeriod(compute_period);
+
+    bool optimize_hyperparameters = pConfig->Profile.GetBoolean(configPath + "/gp_optimize_hyperparameters", DefaultOptimizeHyperparameters);
+    SetBoolOptimizeHyperparameters(optimize_hyperparameters);
     m_expertDialog = NULL;
     block_updates_ = !(m_pMount->GetGuidingEnabled());
     guiding_ra_ = math_tools::NaN;
@@ -849,6 +868,13 @@ bool GuideAlgorithmGaussianProcess::SetBoolComputePeriod(bool active)
     return true;
 }
 
+bool GuideAlgorithmGaussianProcess::SetBoolOptimizeHyperparameters(bool active)
+{
+    GPG->SetBoolOptimizeHyperparameters(active);
+    pConfig->Profile.SetBoolean(GetConfigPath() + "/gp_optimize_hyperparameters", active);
+    return true;
+}
+
 double GuideAlgorithmGaussianProcess::GetControlGain() const
 {
     return GPG->GetControlGain();
@@ -889,6 +915,11 @@ bool GuideAlgorithmGaussianProcess::GetBoolComputePeriod() const
     return GPG->GetBoolComputePeriod();
 }
 
+bool GuideAlgorithmGaussianProcess::GetBoolOptimizeHyperparameters() const
+{
+    return GPG->GetBoolOptimizeHyperparameters();
+}
+
 bool GuideAlgorithmGaussianProcess::GetDarkTracking() const
 {
     return dark_tracking_mode_;
@@ -916,6 +947,7 @@ wxString GuideAlgorithmGaussianProcess::GetSettingsSummary() const
       "\tPeriod length periodic kernel = %.3f\n"
       "\tFFT called after = %.3f worm cycles\n"
       "\tAuto-adjust period length = %s\n"
+      "\tAuto-adjust kernels = %s\n"
     ;
 
     std::vector<double> hyperparameters = GetGPHyperparameters();
@@ -934,7 +966,8 @@ wxString GuideAlgorithmGaussianProcess::GetSettingsSummary() const
         hyperparameters[SE1KSignalVariance],
         hyperparameters[PKPeriodLength],
         GetPeriodLengthsPeriodEstimation(),
-        GetBoolComputePeriod() ? "On" : "Off");
+        GetBoolComputePeriod() ? "On" : "Off",
+        GetBoolOptimizeHyperparameters() ? "On" : "Off");
 }
 
 GUIDE_ALGORITHM GuideAlgorithmGaussianProcess::Algorithm() const
@@ -942,7 +975,7 @@ GUIDE_ALGORITHM GuideAlgorithmGaussianProcess::Algorithm() const
     return GUIDE_ALGORITHM_GAUSSIAN_PROCESS;
 }
 
-double GuideAlgorithmGaussianProcess::result(double input)
+double GuideAlgorithmGaussianProcess::result(double input, const std::chrono::steady_clock::time_point& sampleTime)
 {
     if (block_updates_)
         return(0);
@@ -952,9 +985,11 @@ double GuideAlgorithmGaussianProcess::result(double input)
         return deduceResult();
     }
 
-    // the third parameter of result() is a floating-point in seconds, while RequestedExposureDuration() returns milliseconds
+    // the third parameter of result() is a floating-point in seconds, while RequestedExposureDuration() returns milliseconds.
+    // The measurement is time-stamped with the sample time so the prediction runs from the actual exposure midpoint.
     const Star& star = pFrame->pGuider->PrimaryStar();
-    double control_signal = GPG->result(input, star.SNR, (double) pFrame->RequestedExposureDuration() / 1000.0);
+    double control_signal = GPG->result(input, star.SNR, (double) pFrame->RequestedExposureDuration() / 1000.0,
+                                        -1.0, sampleTime);
 
     Debug.Write(wxString::Format("PPEC: input: %.2f, control: %.2f, exposure: %d\n",
         input, control_signal, pFrame->RequestedExposureDuration()));
@@ -998,6 +1033,22 @@ static PierSide CurrentPierSide()
     return pPointingSource ? pPointingSource->SideOfPier() : PIER_SIDE_UNKNOWN;
 }
 
+// hour angle in hours, or NaN if the pointing source cannot tell
+static double CurrentHourAngle()
+{
+    if (pPointingSource)
+    {
+        double ra, dec, st;
+        bool err = pPointingSource->GetCoordinates(&ra, &dec, &st);
+        if (!err && !math_tools::isNaN(st))
+        {
+            return norm(st - ra, -12., 12.);
+        }
+    }
+
+    return math_tools::NaN;
+}
+
 inline static wxString FormatRA(double ra)
 {
     return math_tools::isNaN(ra) ? _T("unknown") : wxString::Format("%.4f hr", ra);
@@ -1008,7 +1059,7 @@ void GuideAlgorithmGaussianProcess::GuidingStarted()
     bool need_reset = true;
     double ra_offset;    // RA delta in SI seconds
 
-    auto now = std::chrono::system_clock::now();
+    auto now = std::chrono::steady_clock::now();
 
     double prev_ra = guiding_ra_;
     guiding_ra_ = CurrentRA();
@@ -1066,6 +1117,7 @@ void GuideAlgorithmGaussianProcess::GuidingStarted()
     if (need_reset)
     {
         reset();
+        RestoreWarmStartModel();
     }
     else
     {
@@ -1082,7 +1134,120 @@ void GuideAlgorithmGaussianProcess::GuidingStopped()
     double period_length = GPG->GetGPHyperparameters()[PKPeriodLength];
     pConfig->Profile.SetDouble(GetConfigPath() + "/gp_period_per_kern", period_length);
 
-    guiding_stopped_time_ = std::chrono::system_clock::now();
+    SaveWarmStartModel();
+
+    guiding_stopped_time_ = std::chrono::steady_clock::now();
+}
+
+void GuideAlgorithmGaussianProcess::SaveWarmStartModel()
+{
+    wxString configPath = GetConfigPath();
+
+    // the learned kernels do not depend on the worm phase
+    if (GPG->GetBoolOptimizeHyperparameters())
+    {
+        std::vector<double> hyperparameters = GPG->GetGPHyperparameters();
+        wxString hyperparameters_str;
+        for (int i = 0; i < PKPeriodLength; i++)
+        {
+            hyperparameters_str += wxString::Format(i == 0 ? "%g" : ",%g", hyperparameters[i]);
+        }
+        pConfig->Profile.SetString(configPath + "/warm_start_hyperparameters", hyperparameters_str);
+    }
+
+    double period_length;
+    std::vector<double> bins;
+
+    // The worm turns with the RA axis, so the hour angle tells the worm phase of the
+    // model in the next session. Keep the model of an earlier session if there is no
+    // hour angle or if this session was too short for a reliable model.
+    double hour_angle = CurrentHourAngle();
+    PierSide pier_side = CurrentPierSide();
+    if (math_tools::isNaN(hour_angle) || pier_side == PIER_SIDE_UNKNOWN ||
+        GPG->GetPhaseModel(WarmStartModelBins, &period_length, &bins))
+    {
+        return;
+    }
+
+    wxString bins_str;
+    for (size_t i = 0; i < bins.size(); i++)
+    {
+        bins_str += wxString::Format(i == 0 ? "%.3f" : ",%.3f", bins[i]);
+    }
+
+    pConfig->Profile.SetString(configPath + "/warm_start_bins", bins_str);
+    pConfig->Profile.SetDouble(configPath + "/warm_start_period", period_length);
+    pConfig->Profile.SetDouble(configPath + "/warm_start_hour_angle", hour_angle);
+    pConfig->Profile.SetInt(configPath + "/warm_start_pier_side", pier_side);
+
+    Debug.Write(wxString::Format("PPEC: saved gear error model, period %.1fs, HA %.4f hr, pier %s\n",
+                                 period_length, hour_angle, Mount::PierSideStr(pier_side)));
+}
+
+void GuideAlgorithmGaussianProcess::RestoreWarmStartModel()
+{
+    wxString configPath = GetConfigPath();
+
+    if (GPG->GetBoolOptimizeHyperparameters())
+    {
+        std::vector<double> hyperparameters(NumParameters);
+        wxStringTokenizer hyp_tok(pConfig->Profile.GetString(configPath + "/warm_start_hyperparameters", wxEmptyString), ",");
+        int count = 0;
+        while (hyp_tok.HasMoreTokens() && count < PKPeriodLength && hyp_tok.GetNextToken().ToDouble(&hyperparameters[count]))
+        {
+            count++;
+        }
+        hyperparameters[PKPeriodLength] = GPG->GetGPHyperparameters()[PKPeriodLength];
+
+        if (count == PKPeriodLength && !hyp_tok.HasMoreTokens() && !GPG->SetLearnedHyperparameters(hyperparameters))
+        {
+            hyperparameters = GPG->GetGPHyperparameters(); // limited to the range around the configured values
+            Debug.Write(wxString::Format("PPEC: restored learned kernels, SE0 %.2f/%.2f, PK %.2f/%.2f, SE1 %.2f/%.2f\n",
+                                         hyperparameters[SE0KLengthScale], hyperparameters[SE0KSignalVariance],
+                                         hyperparameters[PKLengthScale], hyperparameters[PKSignalVariance],
+                                         hyperparameters[SE1KLengthScale], hyperparameters[SE1KSignalVariance]));
+        }
+    }
+
+    double weight = pConfig->Profile.GetDouble(configPath + "/warm_start_weight", DefaultWarmStartWeight);
+    double period_length = pConfig->Profile.GetDouble(configPath + "/warm_start_period", 0.0);
+    double saved_hour_angle = pConfig->Profile.GetDouble(configPath + "/warm_start_hour_angle", math_tools::NaN);
+    PierSide saved_side = static_cast<PierSide>(pConfig->Profile.GetInt(configPath + "/warm_start_pier_side", PIER_SIDE_UNKNOWN));
+
+    std::vector<double> bins;
+    wxStringTokenizer tok(pConfig->Profile.GetString(configPath + "/warm_start_bins", wxEmptyString), ",");
+    while (tok.HasMoreTokens())
+    {
+        double val;
+        if (!tok.GetNextToken().ToDouble(&val))
+        {
+            bins.clear();
+            break;
+        }
+        bins.push_back(val);
+    }
+
+    double hour_angle = CurrentHourAngle();
+
+    // the worm phase is only known for the same side of pier
+    if (weight <= 0.0 || period_length <= 0.0 || bins.size() < 2 || math_tools::isNaN(hour_angle) ||
+        math_tools::isNaN(saved_hour_angle) || saved_side == PIER_SIDE_UNKNOWN || saved_side != guiding_pier_side_)
+    {
+        Debug.Write("PPEC: no gear error model from an earlier session\n");
+        return;
+    }
+
+    const double SECONDS_PER_HOUR = 60. * 60.;
+    const double SI_SECONDS_PER_SIDEREAL_SEC = 0.9973;
+
+    // gear time advances with the hour angle of the RA axis
+    double phase_offset = norm(hour_angle - saved_hour_angle, -12., 12.) * SECONDS_PER_HOUR * SI_SECONDS_PER_SIDEREAL_SEC;
+
+    Debug.Write(wxString::Format("PPEC: restored gear error model, period %.1fs, HA %.4f hr, saved HA %.4f hr, "
+                                 "gear time offset %+.1fs, weight %.2f\n",
+                                 period_length, hour_angle, saved_hour_angle, phase_offset, weight));
+
+    GPG->SetPriorModel(period_length, bins, phase_offset, weight);
 }
 
 void GuideAlgorithmGaussianProcess::GuidingPaused()
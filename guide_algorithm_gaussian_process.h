@@ -123,7 +123,21 @@ private:
     bool block_updates_;             // Don't update GP if guiding is disabled
     double guiding_ra_;              // allow resuming guiding after guiding stopped if there is no change in RA
     PierSide guiding_pier_side_;
-    std::chrono::system_clock::time_point guiding_stopped_time_; // time guiding stopped
+    std::chrono::steady_clock::time_point guiding_stopped_time_; // time guiding stopped
+
+    /**
+     * Saves the learned gear error, folded over one worm period, together with
+     * the hour angle and side of pier, so that the next session can start with it.
+     * With the kernel optimization, the learned kernel hyperparameters are saved too.
+     */
+    void SaveWarmStartModel();
+
+    /**
+     * Restores the saved gear error model as a prior for the GP after a reset if
+     * the worm phase can be recovered from the hour angle, and the learned kernel
+     * hyperparameters as the start of the kernel optimization.
+     */
+    void RestoreWarmStartModel();
 
 protected:
     double GetControlGain() const;
@@ -144,6 +158,9 @@ protected:
     bool GetBoolComputePeriod() const;
     bool SetBoolComputePeriod(bool);
 
+    bool GetBoolOptimizeHyperparameters() const;
+    bool SetBoolOptimizeHyperparameters(bool);
+
     std::vector<double> GetGPHyperparameters() const;
     bool SetGPHyperparameters(const std::vector<double>& hyperparameters);
 
@@ -167,7 +184,7 @@ public:
      * is calculated to compensate the gear error and 4. the controller is
      * calculated, consisting of feedback and prediction parts.
      */
-    double result(double input) override;
+    double result(double input, const std::chrono::steady_clock::time_point& sampleTime) override;
 
     /**
      * This method provides predictive control if no measurement could be made.
@@ -75,7 +75,7 @@ void GuideAlgorithmHysteresis::reset(void)
     m_lastMove = 0;
 }
 
-double GuideAlgorithmHysteresis::result(double input)
+double GuideAlgorithmHysteresis::result(double input, const std::chrono::steady_clock::time_point& sampleTime)
 {
     double dReturn = (1.0 - m_hysteresis) * input + m_hysteresis * m_lastMove;
 
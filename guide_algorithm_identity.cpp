@@ -59,7 +59,7 @@ void GuideAlgorithmIdentity::reset(void)
 }
 
 // the default algorithm simply returns its input
-double GuideAlgorithmIdentity::result(double input)
+double GuideAlgorithmIdentity::result(double input, const std::chrono::steady_clock::time_point& sampleTime)
 {
     double dReturn = input;
 
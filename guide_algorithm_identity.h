@@ -60,7 +60,7 @@ public:
     GUIDE_ALGORITHM Algorithm() const override;
 
     void reset() override;
-    double result(double input) override;
+    double result(double input, const std::chrono::steady_clock::time_point& sampleTime) override;
     ConfigDialogPane *GetConfigDialogPane(wxWindow *pParent) override;
     wxString GetSettingsSummary() const override { return "\n"; }
     wxString GetGuideAlgorithmClassName() const override { return "Identity"; }
@@ -0,0 +1,669 @@
+/*
+*  guide_algorithm_kalman.cpp
+*  PHD2 Guiding
+*
+*  Copyright (c) 2026 openphdguiding.org
+*  All rights reserved.
+*
+*  This source code is distributed under the following "BSD" license
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*    Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+*    Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the
+*     documentation and/or other materials provided with the distribution.
+*    Neither the name of openphdguiding.org nor the names of its
+*     contributors may be used to endorse or promote products derived from
+*     this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#include "phd.h"
+
+static const double DefaultMinMove = 0.15;
+static const double DefaultAggressiveness = 90.0;
+static const double DefaultMeasurementNoise = 0.3;   // pixels, typical seeing + centroid noise
+static const double DefaultProcessNoise = 0.001;     // pixels^2/s^3
+static const bool DefaultAccelModel = false;
+
+static const unsigned int MinPointsForPrediction = 4; // velocity estimate needs a few frames to settle
+static const double MaxHorizon = 10.0;                // seconds, limit on the latency we compensate for
+static const double MaxDeduceHorizon = 120.0;         // seconds, limit on dead reckoning
+static const double OutlierSigmas = 5.0;
+static const double InnovationWeight = 0.05;          // of the newest deviation in the recent mean square deviation
+static const double MaxFading = 10.0;                 // limit on the inflation of the predicted covariance
+
+GuideAlgorithmKalman::GuideAlgorithmKalman(Mount *pMount, GuideAxis axis)
+    : GuideAlgorithm(pMount, axis),
+      m_accelModel(DefaultAccelModel),
+      m_states(2)
+{
+    double minMove = pConfig->Profile.GetDouble(GetConfigPath() + "/minMove", DefaultMinMove);
+    SetMinMove(minMove);
+
+    double aggr = pConfig->Profile.GetDouble(GetConfigPath() + "/Aggressiveness", DefaultAggressiveness);
+    SetAggressiveness(aggr);
+
+    double measNoise = pConfig->Profile.GetDouble(GetConfigPath() + "/MeasurementNoise", DefaultMeasurementNoise);
+    SetMeasurementNoise(measNoise);
+
+    double procNoise = pConfig->Profile.GetDouble(GetConfigPath() + "/ProcessNoise", DefaultProcessNoise);
+    SetProcessNoise(procNoise);
+
+    bool accel = pConfig->Profile.GetBoolean(GetConfigPath() + "/AccelerationModel", DefaultAccelModel);
+    SetAccelerationModel(accel);
+
+    reset();
+}
+
+GuideAlgorithmKalman::~GuideAlgorithmKalman()
+{
+}
+
+GUIDE_ALGORITHM GuideAlgorithmKalman::Algorithm() const
+{
+    return GUIDE_ALGORITHM_KALMAN;
+}
+
+void GuideAlgorithmKalman::reset()
+{
+    m_initialized = false;
+    m_outlier = false;
+    m_count = 0;
+    m_sumCorr = 0.0;
+    m_lastSampleTime = std::chrono::steady_clock::time_point();
+}
+
+void GuideAlgorithmKalman::InitFilter(double position)
+{
+    m_states = m_accelModel ? 3 : 2;
+
+    for (int i = 0; i < MAX_STATES; i++)
+    {
+        m_x[i] = 0.0;
+        for (int j = 0; j < MAX_STATES; j++)
+            m_P[i][j] = 0.0;
+    }
+
+    m_x[0] = position;
+    m_P[0][0] = m_measurementNoise * m_measurementNoise;
+    m_P[1][1] = 1.0;    // (px/s)^2, the drift rate is unknown at the start
+    m_P[2][2] = 0.01;   // (px/s^2)^2
+
+    m_innovationVar = m_P[0][0] + m_measurementNoise * m_measurementNoise;
+
+    m_initialized = true;
+}
+
+void GuideAlgorithmKalman::Predict(double dt)
+{
+    const int n = m_states;
+
+    double F[MAX_STATES][MAX_STATES] = {
+        { 1.0, dt, dt * dt / 2.0 },
+        { 0.0, 1.0, dt },
+        { 0.0, 0.0, 1.0 },
+    };
+
+    // discretized process noise for white acceleration (constant velocity model)
+    // or white jerk (constant acceleration model)
+    double Q[MAX_STATES][MAX_STATES] = { };
+    if (n == 2)
+    {
+        double q = m_processNoise;
+        Q[0][0] = dt * dt * dt / 3.0 * q;
+        Q[0][1] = Q[1][0] = dt * dt / 2.0 * q;
+        Q[1][1] = dt * q;
+    }
+    else
+    {
+        // jerk is much smaller than acceleration for any mount drift, so scale the
+        // same user setting down rather than asking for another parameter
+        double q = m_processNoise * 0.01;
+        double dt2 = dt * dt, dt3 = dt2 * dt, dt4 = dt3 * dt, dt5 = dt4 * dt;
+        Q[0][0] = dt5 / 20.0 * q;
+        Q[0][1] = Q[1][0] = dt4 / 8.0 * q;
+        Q[0][2] = Q[2][0] = dt3 / 6.0 * q;
+        Q[1][1] = dt3 / 3.0 * q;
+        Q[1][2] = Q[2][1] = dt2 / 2.0 * q;
+        Q[2][2] = dt * q;
+    }
+
+    double x[MAX_STATES] = { };
+    for (int i = 0; i < n; i++)
+        for (int j = 0; j < n; j++)
+            x[i] += F[i][j] * m_x[j];
+
+    double FP[MAX_STATES][MAX_STATES] = { };
+    for (int i = 0; i < n; i++)
+        for (int j = 0; j < n; j++)
+            for (int k = 0; k < n; k++)
+                FP[i][j] += F[i][k] * m_P[k][j];
+
+    for (int i = 0; i < n; i++)
+    {
+        m_x[i] = x[i];
+        for (int j = 0; j < n; j++)
+        {
+            double p = Q[i][j];
+            for (int k = 0; k < n; k++)
+                p += FP[i][k] * F[j][k];
+            m_P[i][j] = p;
+        }
+    }
+}
+
+// When the star has recently deviated from the prediction by more than the filter expects, the
+// drift is changing faster than the process noise setting allows for (wind, a fast periodic
+// error). Inflate the predicted covariance to match, so the filter follows instead of lagging
+void GuideAlgorithmKalman::Fade()
+{
+    double S = m_P[0][0] + m_measurementNoise * m_measurementNoise;
+    if (m_innovationVar <= S)
+        return;
+
+    double fading = wxMin(m_innovationVar / S, MaxFading);
+    for (int i = 0; i < m_states; i++)
+        for (int j = 0; j < m_states; j++)
+            m_P[i][j] *= fading;
+}
+
+// returns the deviation of a position measurement from the prediction in units of its standard
+// deviation, which is at least the recent RMS deviation in case the noise settings are too low
+double GuideAlgorithmKalman::Innovation(double position) const
+{
+    return (position - m_x[0]) / sqrt(wxMax(m_P[0][0] + m_measurementNoise * m_measurementNoise, m_innovationVar));
+}
+
+// incorporates a position measurement
+void GuideAlgorithmKalman::Update(double position)
+{
+    const int n = m_states;
+
+    double S = m_P[0][0] + m_measurementNoise * m_measurementNoise;
+    double innovation = position - m_x[0];
+
+    double K[MAX_STATES];
+    for (int i = 0; i < n; i++)
+        K[i] = m_P[i][0] / S;
+
+    for (int i = 0; i < n; i++)
+        m_x[i] += K[i] * innovation;
+
+    double P0[MAX_STATES];
+    for (int j = 0; j < n; j++)
+        P0[j] = m_P[0][j];
+
+    for (int i = 0; i < n; i++)
+        for (int j = 0; j < n; j++)
+            m_P[i][j] -= K[i] * P0[j];
+}
+
+double GuideAlgorithmKalman::Forecast(double horizon) const
+{
+    double pos = m_x[0] + m_x[1] * horizon;
+    if (m_states == 3)
+        pos += m_x[2] * horizon * horizon / 2.0;
+    return pos;
+}
+
+// returns the correction needed to cancel the predicted uncorrected position
+double GuideAlgorithmKalman::CorrectionFor(double predicted)
+{
+    double dReturn = (predicted - m_sumCorr) * m_aggressiveness / 100.0;
+
+    if (fabs(dReturn) < m_minMove)
+        dReturn = 0.0;
+
+    return dReturn;
+}
+
+double GuideAlgorithmKalman::result(double input, const std::chrono::steady_clock::time_point& sampleTime)
+{
+    // The filter tracks the star position as it would be without guiding, so add back
+    // all the corrections that the mount has carried out
+    double position = input + m_sumCorr;
+
+    if (!m_initialized)
+    {
+        InitFilter(position);
+    }
+    else
+    {
+        double dt = std::chrono::duration<double>(sampleTime - m_lastSampleTime).count();
+        Predict(wxMax(dt, 0.001));
+
+        Fade();
+
+        double sigmas = Innovation(position);
+
+        if (fabs(sigmas) > OutlierSigmas && fabs(input) > 4.0 * m_minMove)
+        {
+            if (!m_outlier)
+            {
+                // a single deflection (a gust, a seeing spike, a bad centroid) is usually gone on
+                // the next frame, so limit its weight and start over only if the next one confirms it
+                Debug.Write(wxString::Format("GuideAlgorithmKalman: limiting outlier deflection %.2f (%.1f sigma)\n",
+                    input, sigmas));
+                m_outlier = true;
+                Update(m_x[0] + (position - m_x[0]) * OutlierSigmas / fabs(sigmas));
+            }
+            else
+            {
+                Debug.Write(wxString::Format("GuideAlgorithmKalman: history cleared, outlier deflection %.2f (%.1f sigma)\n",
+                    input, sigmas));
+                reset();
+                position = input;
+                InitFilter(position);
+            }
+        }
+        else
+        {
+            m_outlier = false;
+            double innovation = position - m_x[0];
+            m_innovationVar += InnovationWeight * (innovation * innovation - m_innovationVar);
+            Update(position);
+        }
+    }
+
+    m_lastSampleTime = sampleTime;
+    ++m_count;
+
+    // The correction takes effect when the pulse is sent, which is now, not when the
+    // frame was exposed. Forecast the position across the capture-to-pulse latency.
+    double horizon = std::chrono::duration<double>(Now() - sampleTime).count();
+    horizon = wxMax(0.0, wxMin(horizon, MaxHorizon));
+
+    double dReturn;
+    if (m_count < MinPointsForPrediction)
+    {
+        // don't fall behind while the velocity estimate settles
+        dReturn = CorrectionFor(position);
+    }
+    else
+    {
+        dReturn = CorrectionFor(Forecast(horizon));
+    }
+
+    Debug.Write(wxString::Format("GuideAlgorithmKalman::result() returns %.2f from input %.2f, pos = %.2f, vel = %.4f, latency = %.2f\n",
+        dReturn, input, m_x[0], m_x[1], horizon));
+
+    return dReturn;
+}
+
+double GuideAlgorithmKalman::deduceResult()
+{
+    if (!m_initialized || m_count < MinPointsForPrediction)
+        return 0.0;
+
+    double horizon = std::chrono::duration<double>(Now() - m_lastSampleTime).count();
+    if (horizon > MaxDeduceHorizon)
+        return 0.0;
+
+    double dReturn = CorrectionFor(Forecast(horizon));
+
+    Debug.Write(wxString::Format("GuideAlgorithmKalman::deduceResult() returns %.2f, horizon = %.1f\n", dReturn, horizon));
+
+    return dReturn;
+}
+
+void GuideAlgorithmKalman::DirectMoveApplied(double amt)
+{
+    // a direct move corrects the star position just like a guide pulse
+    m_sumCorr += amt;
+}
+
+void GuideAlgorithmKalman::GuideMoveApplied(double amt)
+{
+    m_sumCorr += amt;
+}
+
+bool GuideAlgorithmKalman::SetMinMove(double minMove)
+{
+    bool bError = false;
+
+    try
+    {
+        if (minMove < 0)
+        {
+            throw ERROR_INFO("invalid minMove");
+        }
+
+        m_minMove = minMove;
+    }
+    catch (const wxString& Msg)
+    {
+        POSSIBLY_UNUSED(Msg);
+        bError = true;
+        m_minMove = DefaultMinMove;
+    }
+
+    pConfig->Profile.SetDouble(GetConfigPath() + "/minMove", m_minMove);
+
+    return bError;
+}
+
+bool GuideAlgorithmKalman::SetAggressiveness(double aggressiveness)
+{
+    bool bError = false;
+
+    try
+    {
+        if (aggressiveness < 0.0 || aggressiveness > 100.0)
+        {
+            throw ERROR_INFO("invalid aggressiveness");
+        }
+
+        m_aggressiveness = aggressiveness;
+    }
+    catch (const wxString& Msg)
+    {
+        POSSIBLY_UNUSED(Msg);
+        bError = true;
+        m_aggressiveness = DefaultAggressiveness;
+    }
+
+    pConfig->Profile.SetDouble(GetConfigPath() + "/Aggressiveness", m_aggressiveness);
+
+    return bError;
+}
+
+bool GuideAlgorithmKalman::SetMeasurementNoise(double noise)
+{
+    bool bError = false;
+
+    try
+    {
+        if (noise <= 0.0)
+        {
+            throw ERROR_INFO("invalid measurement noise");
+        }
+
+        m_measurementNoise = noise;
+    }
+    catch (const wxString& Msg)
+    {
+        POSSIBLY_UNUSED(Msg);
+        bError = true;
+        m_measurementNoise = DefaultMeasurementNoise;
+    }
+
+    pConfig->Profile.SetDouble(GetConfigPath() + "/MeasurementNoise", m_measurementNoise);
+
+    return bError;
+}
+
+bool GuideAlgorithmKalman::SetProcessNoise(double noise)
+{
+    bool bError = false;
+
+    try
+    {
+        if (noise <= 0.0)
+        {
+            throw ERROR_INFO("invalid process noise");
+        }
+
+        m_processNoise = noise;
+    }
+    catch (const wxString& Msg)
+    {
+        POSSIBLY_UNUSED(Msg);
+        bError = true;
+        m_processNoise = DefaultProcessNoise;
+    }
+
+    pConfig->Profile.SetDouble(GetConfigPath() + "/ProcessNoise", m_processNoise);
+
+    return bError;
+}
+
+void GuideAlgorithmKalman::SetAccelerationModel(bool enable)
+{
+    if (enable != m_accelModel)
+        reset();
+
+    m_accelModel = enable;
+    pConfig->Profile.SetBoolean(GetConfigPath() + "/AccelerationModel", m_accelModel);
+}
+
+void GuideAlgorithmKalman::GetParamNames(wxArrayString& names) const
+{
+    names.push_back("minMove");
+    names.push_back("aggressiveness");
+    names.push_back("measurementNoise");
+    names.push_back("processNoise");
+    names.push_back("accelerationModel");
+}
+
+bool GuideAlgorithmKalman::GetParam(const wxString& name, double *val) const
+{
+    bool ok = true;
+
+    if (name == "minMove")
+        *val = GetMinMove();
+    else if (name == "aggressiveness")
+        *val = GetAggressiveness();
+    else if (name == "measurementNoise")
+        *val = GetMeasurementNoise();
+    else if (name == "processNoise")
+        *val = GetProcessNoise();
+    else if (name == "accelerationModel")
+        *val = GetAccelerationModel() ? 1.0 : 0.0;
+    else
+        ok = false;
+
+    return ok;
+}
+
+bool GuideAlgorithmKalman::SetParam(const wxString& name, double val)
+{
+    bool err = false;
+
+    if (name == "minMove")
+        err = SetMinMove(val);
+    else if (name == "aggressiveness")
+        err = SetAggressiveness(val);
+    else if (name == "measurementNoise")
+        err = SetMeasurementNoise(val);
+    else if (name == "processNoise")
+        err = SetProcessNoise(val);
+    else if (name == "accelerationModel")
+        SetAccelerationModel(val != 0.0);
+    else
+        err = true;
+
+    return !err;
+}
+
+wxString GuideAlgorithmKalman::GetSettingsSummary() const
+{
+    // return a loggable summary of current mount settings
+    return wxString::Format("Model = %s, Aggressiveness = %.3f, Minimum move = %.3f, Measurement noise = %.3f, Process noise = %.4f\n",
+        GetAccelerationModel() ? "constant acceleration" : "constant velocity",
+        GetAggressiveness(),
+        GetMinMove(),
+        GetMeasurementNoise(),
+        GetProcessNoise()
+        );
+}
+
+ConfigDialogPane *GuideAlgorithmKalman::GetConfigDialogPane(wxWindow *pParent)
+{
+    return new GuideAlgorithmKalmanConfigDialogPane(pParent, this);
+}
+
+GuideAlgorithmKalman::
+GuideAlgorithmKalmanConfigDialogPane::
+GuideAlgorithmKalmanConfigDialogPane(wxWindow *pParent, GuideAlgorithmKalman *pGuideAlgorithm)
+    : ConfigDialogPane(_("Kalman Guide Algorithm"), pParent)
+{
+    int width;
+
+    m_pGuideAlgorithm = pGuideAlgorithm;
+
+    width = StringWidth(_T("000.00"));
+    m_pAggressiveness = pFrame->MakeSpinCtrl(pParent, wxID_ANY, _T(" "), wxDefaultPosition,
+        wxSize(width, -1), wxSP_ARROW_KEYS, 0.0, 100.0, 0.0, _T("Aggressiveness"));
+
+    DoAdd(_("Aggressiveness"), m_pAggressiveness,
+        wxString::Format(_("What percentage of the computed correction should be applied? Default = %.f%%"), DefaultAggressiveness));
+
+    width = StringWidth(_T("000.00"));
+    m_pMinMove = pFrame->MakeSpinCtrlDouble(pParent, wxID_ANY, _T(" "), wxDefaultPosition,
+        wxSize(width, -1), wxSP_ARROW_KEYS, 0.0, 20.0, 0.0, 0.01, _T("MinMove"));
+    m_pMinMove->SetDigits(2);
+
+    DoAdd(_("Minimum Move (pixels)"), m_pMinMove,
+        wxString::Format(_("How many (fractional) pixels must the star move to trigger a guide pulse? \n"
+        "If camera is binned, this is a fraction of the binned pixel size. Default = %.2f"), DefaultMinMove));
+
+    width = StringWidth(_T("000.00"));
+    m_pMeasurementNoise = pFrame->MakeSpinCtrlDouble(pParent, wxID_ANY, _T(" "), wxDefaultPosition,
+        wxSize(width, -1), wxSP_ARROW_KEYS, 0.01, 10.0, 0.3, 0.05, _T("MeasurementNoise"));
+    m_pMeasurementNoise->SetDigits(2);
+
+    DoAdd(_("Measurement noise (pixels)"), m_pMeasurementNoise,
+        wxString::Format(_("Expected frame-to-frame scatter of the star position from seeing and centroid noise. "
+        "Larger values smooth more but respond more slowly. Default = %.2f"), DefaultMeasurementNoise));
+
+    width = StringWidth(_T("0.0000"));
+    m_pProcessNoise = pFrame->MakeSpinCtrlDouble(pParent, wxID_ANY, _T(" "), wxDefaultPosition,
+        wxSize(width, -1), wxSP_ARROW_KEYS, 0.0001, 1.0, 0.001, 0.0001, _T("ProcessNoise"));
+    m_pProcessNoise->SetDigits(4);
+
+    DoAdd(_("Drift variability"), m_pProcessNoise,
+        wxString::Format(_("How quickly the mount drift rate is expected to change. Larger values follow changes in "
+        "the drift (such as periodic error) faster but pass more seeing noise. Default = %.4f"), DefaultProcessNoise));
+
+    m_pAccelModel = new wxCheckBox(pParent, wxID_ANY, _("Model acceleration"));
+    DoAdd(m_pAccelModel, _("Track changes in the drift rate (constant acceleration model) in addition to the drift rate itself. "
+        "May help mounts with large, fast periodic error, but is more sensitive to seeing."));
+}
+
+GuideAlgorithmKalman::
+GuideAlgorithmKalmanConfigDialogPane::
+~GuideAlgorithmKalmanConfigDialogPane()
+{
+}
+
+void GuideAlgorithmKalman::
+GuideAlgorithmKalmanConfigDialogPane::
+LoadValues()
+{
+    m_pAggressiveness->SetValue(m_pGuideAlgorithm->GetAggressiveness());
+    m_pMinMove->SetValue(m_pGuideAlgorithm->GetMinMove());
+    m_pMeasurementNoise->SetValue(m_pGuideAlgorithm->GetMeasurementNoise());
+    m_pProcessNoise->SetValue(m_pGuideAlgorithm->GetProcessNoise());
+    m_pAccelModel->SetValue(m_pGuideAlgorithm->GetAccelerationModel());
+}
+
+void GuideAlgorithmKalman::
+GuideAlgorithmKalmanConfigDialogPane::
+UnloadValues()
+{
+    m_pGuideAlgorithm->SetAggressiveness(m_pAggressiveness->GetValue());
+    m_pGuideAlgorithm->SetMinMove(m_pMinMove->GetValue());
+    m_pGuideAlgorithm->SetMeasurementNoise(m_pMeasurementNoise->GetValue());
+    m_pGuideAlgorithm->SetProcessNoise(m_pProcessNoise->GetValue());
+    m_pGuideAlgorithm->SetAccelerationModel(m_pAccelModel->GetValue());
+}
+
+void GuideAlgorithmKalman::
+GuideAlgorithmKalmanConfigDialogPane::OnImageScaleChange()
+{
+    GuideAlgorithm::AdjustMinMoveSpinCtrl(m_pMinMove);
+}
+
+void GuideAlgorithmKalman::
+GuideAlgorithmKalmanConfigDialogPane::EnableDecControls(bool enable)
+{
+    m_pAggressiveness->Enable(enable);
+    m_pMinMove->Enable(enable);
+    m_pMeasurementNoise->Enable(enable);
+    m_pProcessNoise->Enable(enable);
+    m_pAccelModel->Enable(enable);
+}
+
+GraphControlPane *GuideAlgorithmKalman::GetGraphControlPane(wxWindow *pParent, const wxString& label)
+{
+    return new GuideAlgorithmKalmanGraphControlPane(pParent, this, label);
+}
+
+GuideAlgorithmKalman::
+GuideAlgorithmKalmanGraphControlPane::
+GuideAlgorithmKalmanGraphControlPane(wxWindow *pParent, GuideAlgorithmKalman *pGuideAlgorithm, const wxString& label)
+    : GraphControlPane(pParent, label)
+{
+    int width;
+
+    m_pGuideAlgorithm = pGuideAlgorithm;
+
+    width = StringWidth(_T("000.00"));
+    m_pAggressiveness = pFrame->MakeSpinCtrl(this, wxID_ANY, wxEmptyString, wxDefaultPosition,
+        wxSize(width, -1), wxSP_ARROW_KEYS, 0.0, 100.0, 0.0, _T("Aggressiveness"));
+    m_pAggressiveness->SetToolTip(wxString::Format(_("What percentage of the computed correction should be applied? Default = %.f%%"), DefaultAggressiveness));
+    m_pAggressiveness->Bind(wxEVT_COMMAND_SPINCTRL_UPDATED, &GuideAlgorithmKalman::GuideAlgorithmKalmanGraphControlPane::OnAggrSpinCtrl, this);
+    DoAdd(m_pAggressiveness, _("Agg"));
+
+    width = StringWidth(_T("000.00"));
+    m_pMinMove = pFrame->MakeSpinCtrlDouble(this, wxID_ANY, wxEmptyString, wxDefaultPosition,
+        wxSize(width, -1), wxSP_ARROW_KEYS, 0.0, 20.0, 0.0, 0.01, _T("MinMove"));
+    m_pMinMove->SetDigits(2);
+    m_pMinMove->SetToolTip(wxString::Format(_("How many (fractional) pixels must the star move to trigger a guide pulse? \n"
+        "If camera is binned, this is a fraction of the binned pixel size. Default = %.2f"), DefaultMinMove));
+    m_pMinMove->Bind(wxEVT_COMMAND_SPINCTRLDOUBLE_UPDATED, &GuideAlgorithmKalman::GuideAlgorithmKalmanGraphControlPane::OnMinMoveSpinCtrlDouble, this);
+    DoAdd(m_pMinMove, _("MnMo"));
+
+    m_pAggressiveness->SetValue(m_pGuideAlgorithm->GetAggressiveness());
+    m_pMinMove->SetValue(m_pGuideAlgorithm->GetMinMove());
+
+    if (TheScope() && pGuideAlgorithm->GetAxis() == "DEC")
+    {
+        DEC_GUIDE_MODE currDecGuideMode = TheScope()->GetDecGuideMode();
+        m_pAggressiveness->Enable(currDecGuideMode != DEC_NONE);
+        m_pMinMove->Enable(currDecGuideMode != DEC_NONE);
+    }
+}
+
+GuideAlgorithmKalman::
+GuideAlgorithmKalmanGraphControlPane::
+~GuideAlgorithmKalmanGraphControlPane()
+{
+}
+
+void GuideAlgorithmKalman::
+GuideAlgorithmKalmanGraphControlPane::EnableDecControls(bool enable)
+{
+    m_pAggressiveness->Enable(enable);
+    m_pMinMove->Enable(enable);
+}
+
+void GuideAlgorithmKalman::
+GuideAlgorithmKalmanGraphControlPane::
+OnAggrSpinCtrl(wxSpinEvent& evt)
+{
+    m_pGuideAlgorithm->SetAggressiveness(m_pAggressiveness->GetValue());
+    pFrame->NotifyGuidingParam(m_pGuideAlgorithm->GetAxis() + " Kalman aggressiveness", m_pAggressiveness->GetValue());
+}
+
+void GuideAlgorithmKalman::
+GuideAlgorithmKalmanGraphControlPane::
+OnMinMoveSpinCtrlDouble(wxSpinDoubleEvent& evt)
+{
+    m_pGuideAlgorithm->SetMinMove(m_pMinMove->GetValue());
+    pFrame->NotifyGuidingParam(m_pGuideAlgorithm->GetAxis() + " Kalman minimum move", m_pMinMove->GetValue());
+}
@@ -0,0 +1,163 @@
+/*
+*  guide_algorithm_kalman.h
+*  PHD2 Guiding
+*
+*  Copyright (c) 2026 openphdguiding.org
+*  All rights reserved.
+*
+*  This source code is distributed under the following "BSD" license
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*    Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+*    Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the
+*     documentation and/or other materials provided with the distribution.
+*    Neither the name of openphdguiding.org nor the names of its
+*     contributors may be used to endorse or promote products derived from
+*     this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#ifndef GUIDE_ALGORITHM_KALMAN_H_INCLUDED
+#define GUIDE_ALGORITHM_KALMAN_H_INCLUDED
+
+// Predictive guide algorithm that tracks the uncorrected star position with a
+// constant-velocity (or constant-acceleration) Kalman filter and issues the
+// correction for the moment the guide pulse is sent rather than for the moment
+// the frame was exposed, compensating for the capture-to-pulse latency.
+class GuideAlgorithmKalman : public GuideAlgorithm
+{
+    enum { MAX_STATES = 3 };
+
+    double m_minMove;
+    double m_aggressiveness;    // percent
+    double m_measurementNoise;  // pixels
+    double m_processNoise;
+    bool m_accelModel;
+
+    // filter state: position, velocity [, acceleration] of the uncorrected star position
+    int m_states;
+    double m_x[MAX_STATES];
+    double m_P[MAX_STATES][MAX_STATES];
+    bool m_initialized;
+    bool m_outlier;             // the previous measurement was an outlier
+    double m_innovationVar;     // pixels^2, recent mean square deviation of the measurements from the prediction
+    unsigned int m_count;
+    std::chrono::steady_clock::time_point m_lastSampleTime;
+    double m_sumCorr;           // sum of all corrections carried out by the mount
+
+protected:
+    class GuideAlgorithmKalmanConfigDialogPane : public ConfigDialogPane
+    {
+        GuideAlgorithmKalman *m_pGuideAlgorithm;
+        wxSpinCtrl *m_pAggressiveness;
+        wxSpinCtrlDouble *m_pMinMove;
+        wxSpinCtrlDouble *m_pMeasurementNoise;
+        wxSpinCtrlDouble *m_pProcessNoise;
+        wxCheckBox *m_pAccelModel;
+
+    public:
+        GuideAlgorithmKalmanConfigDialogPane(wxWindow *pParent, GuideAlgorithmKalman *pGuideAlgorithm);
+        ~GuideAlgorithmKalmanConfigDialogPane();
+
+        void LoadValues() override;
+        void UnloadValues() override;
+        void OnImageScaleChange() override;
+        void EnableDecControls(bool enable) override;
+    };
+
+    class GuideAlgorithmKalmanGraphControlPane : public GraphControlPane
+    {
+    public:
+        GuideAlgorithmKalmanGraphControlPane(wxWindow *pParent, GuideAlgorithmKalman *pGuideAlgorithm, const wxString& label);
+        ~GuideAlgorithmKalmanGraphControlPane();
+        void EnableDecControls(bool enable) override;
+
+    private:
+        GuideAlgorithmKalman *m_pGuideAlgorithm;
+        wxSpinCtrl *m_pAggressiveness;
+        wxSpinCtrlDouble *m_pMinMove;
+        void OnAggrSpinCtrl(wxSpinEvent& evt);
+        void OnMinMoveSpinCtrlDouble(wxSpinDoubleEvent& evt);
+    };
+
+    double GetAggressiveness() const;
+    bool SetAggressiveness(double aggressiveness);
+    double GetMeasurementNoise() const;
+    bool SetMeasurementNoise(double noise);
+    double GetProcessNoise() const;
+    bool SetProcessNoise(double noise);
+    bool GetAccelerationModel() const;
+    void SetAccelerationModel(bool enable);
+
+    friend class GuideAlgorithmKalmanConfigDialogPane;
+
+private:
+    void InitFilter(double position);
+    void Predict(double dt);
+    void Fade();
+    double Innovation(double position) const;
+    void Update(double position);
+    double Forecast(double horizon) const;
+    double CorrectionFor(double predicted);
+
+public:
+    GuideAlgorithmKalman(Mount *pMount, GuideAxis axis);
+    ~GuideAlgorithmKalman();
+    GUIDE_ALGORITHM Algorithm() const override;
+
+    void reset() override;
+    double result(double input, const std::chrono::steady_clock::time_point& sampleTime) override;
+    double deduceResult() override;
+    void DirectMoveApplied(double amt) override;
+    void GuideMoveApplied(double amt) override;
+    ConfigDialogPane *GetConfigDialogPane(wxWindow *pParent) override;
+    GraphControlPane *GetGraphControlPane(wxWindow *pParent, const wxString& label) override;
+    wxString GetSettingsSummary() const override;
+    wxString GetGuideAlgorithmClassName() const override { return "Kalman"; }
+    void GetParamNames(wxArrayString& names) const override;
+    bool GetParam(const wxString& name, double *val) const override;
+    bool SetParam(const wxString& name, double val) override;
+    double GetMinMove() const override;
+    bool SetMinMove(double minMove) override;
+};
+
+inline double GuideAlgorithmKalman::GetMinMove() const
+{
+    return m_minMove;
+}
+
+inline double GuideAlgorithmKalman::GetAggressiveness() const
+{
+    return m_aggressiveness;
+}
+
+inline double GuideAlgorithmKalman::GetMeasurementNoise() const
+{
+    return m_measurementNoise;
+}
+
+inline double GuideAlgorithmKalman::GetProcessNoise() const
+{
+    return m_processNoise;
+}
+
+inline bool GuideAlgorithmKalman::GetAccelerationModel() const
+{
+    return m_accelModel;
+}
+
+#endif /* GUIDE_ALGORITHM_KALMAN_H_INCLUDED */
@@ -79,7 +79,7 @@ void GuideAlgorithmLowpass::reset(void)
 
 }
 
-double GuideAlgorithmLowpass::result(double input)
+double GuideAlgorithmLowpass::result(double input, const std::chrono::steady_clock::time_point& sampleTime)
 {
     // Manual trimming of window (instead of auto-size) is done for full backward compatibility with original algo
     m_axisStats.AddGuideInfo(m_timeBase++, input, 0);
@@ -51,7 +51,6 @@ GuideAlgorithmLowpass2::GuideAlgorithmLowpass2(Mount *pMount, GuideAxis axis)
     double aggr = pConfig->Profile.GetDouble(GetConfigPath() + "/Aggressiveness", DefaultAggressiveness);
     SetAggressiveness(aggr);
     m_axisStats = WindowedAxisStats(HISTORY_SIZE);          // Auto-windowed
-    m_timeBase = 0;
 
     reset();
 }
@@ -69,13 +68,28 @@ GUIDE_ALGORITHM GuideAlgorithmLowpass2::Algorithm() const
 void GuideAlgorithmLowpass2::reset(void)
 {
     m_axisStats.ClearAll();
-    m_timeBase = 0;
+    m_timeBase = std::chrono::steady_clock::time_point();
     m_rejects = 0;
 }
 
-double GuideAlgorithmLowpass2::result(double input)
+double GuideAlgorithmLowpass2::result(double input, const std::chrono::steady_clock::time_point& sampleTime)
 {
-    m_axisStats.AddGuideInfo(m_timeBase++, input, 0);              // AxisStats instance is auto-windowed
+    // Fit against the actual sample times (seconds) so that dropped or irregularly spaced
+    // frames do not distort the slope
+    if (m_timeBase == std::chrono::steady_clock::time_point())
+        m_timeBase = sampleTime;
+    double t = std::chrono::duration<double>(sampleTime - m_timeBase).count();
+    unsigned int prevpts = m_axisStats.GetCount();
+    if (prevpts > 0)
+    {
+        // A sample no later than the previous one (a replayed frame, clock granularity) would
+        // leave no interval to fit against. Place it one mean sample interval after the previous
+        // sample, or one unit while that is unknown, which is the frame-indexed fit
+        double last = m_axisStats.GetLastEntry().DeltaTime;
+        if (!(t > last))
+            t = last + (prevpts > 1 ? (last - m_axisStats.GetEntry(0).DeltaTime) / (prevpts - 1) : 1.0);
+    }
+    m_axisStats.AddGuideInfo(t, input, 0);                          // AxisStats instance is auto-windowed
     unsigned int numpts = m_axisStats.GetCount();
     double dReturn;
     double attenuation = m_aggressiveness / 100.;
@@ -96,7 +110,10 @@ double GuideAlgorithmLowpass2::result(double input)
         {
             double intcpt;
             m_axisStats.GetLinearFitResults(&newSlope, &intcpt);
-            dReturn = newSlope * (double)numpts * attenuation;
+            // scale the slope by the mean sample interval, equivalent to fitting against the
+            // sample index when frames arrive at a steady cadence
+            double interval = (t - m_axisStats.GetEntry(0).DeltaTime) / (numpts - 1);
+            dReturn = newSlope * interval * (double)numpts * attenuation;
             // Don't return a result that will push the star further in the wrong direction
             if (input * dReturn < 0)
                 dReturn = 0;
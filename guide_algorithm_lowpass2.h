@@ -49,7 +49,7 @@ class GuideAlgorithmLowpass2 : public GuideAlgorithm
     double m_minMove;
     int m_rejects;
     WindowedAxisStats m_axisStats;
-    int m_timeBase;
+    std::chrono::steady_clock::time_point m_timeBase;   // sample time of the first point since reset
 
 protected:
     class GuideAlgorithmLowpass2ConfigDialogPane : public ConfigDialogPane
@@ -93,7 +93,7 @@ public:
     GUIDE_ALGORITHM Algorithm() const override;
 
     void reset() override;
-    double result(double input) override;
+    double result(double input, const std::chrono::steady_clock::time_point& sampleTime) override;
     ConfigDialogPane *GetConfigDialogPane(wxWindow *pParent) override;
     GraphControlPane *GetGraphControlPane(wxWindow *pParent, const wxString& label) override;
     wxString GetSettingsSummary() const override;
@@ -93,7 +93,7 @@ static int sign(double x)
     return iReturn;
 }
 
-double GuideAlgorithmResistSwitch::result(double input)
+double GuideAlgorithmResistSwitch::result(double input, const std::chrono::steady_clock::time_point& sampleTime)
 {
     double rslt = input;
 
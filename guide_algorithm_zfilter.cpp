@@ -35,6 +35,7 @@
 #include "phd.h"
 static const double DefaultMinMove = 0.1;
 static const double DefaultExpFactor = 2.0;
+static const int DefaultOrder = 4;
 
 GuideAlgorithmZFilter::GuideAlgorithmZFilter(Mount *pMount, GuideAxis axis)
     : GuideAlgorithm(pMount, axis),
@@ -42,7 +43,9 @@ GuideAlgorithmZFilter::GuideAlgorithmZFilter(Mount *pMount, GuideAxis axis)
 {
     m_expFactor = DefaultExpFactor;
     m_design = BESSEL;
-    m_order = 4;
+    m_order = DefaultOrder;
+    int order = pConfig->Profile.GetInt(GetConfigPath() + "/order", DefaultOrder);
+    SetOrder(order);
     double minMove = pConfig->Profile.GetDouble(GetConfigPath() + "/minMove", DefaultMinMove);
     SetMinMove(minMove);
     double expFactor = pConfig->Profile.GetDouble(GetConfigPath() + "/expFactor", DefaultExpFactor);
@@ -63,36 +66,17 @@ GUIDE_ALGORITHM GuideAlgorithmZFilter::Algorithm() const
 
 void GuideAlgorithmZFilter::reset()
 {
-    m_xv.clear();
-    m_yv.clear();
-    m_xv.insert(m_xv.begin(), m_xcoeff.size(), 0.0);
-    m_yv.insert(m_yv.begin(), m_ycoeff.size(), 0.0);
+    m_filter.Reset();
     m_sumCorr = 0.0;
 }
 
-double GuideAlgorithmZFilter::result(double input)
+double GuideAlgorithmZFilter::result(double input, const std::chrono::steady_clock::time_point& sampleTime)
 {
     double dReturn=0;
 
-//    Digital filter designed by mkfilter/mkshape/gencode   A.J. Fisher
-    double gain = m_gain;
-
-// Shift readings and results
-    m_xv.insert(m_xv.begin(), (input + m_sumCorr) / gain); // Add total guide output to input to get uncorrected waveform
-    m_xv.pop_back();
-    m_yv.insert(m_yv.begin(), 0.0);
-    m_yv.pop_back();
-
-// Calculate filtered value
-    for (int i = 0; i < m_xcoeff.size(); i++)
-    {
-        m_yv.at(0) += m_xv.at(i) * m_xcoeff.at(i);
-    }
-    for (int i = 1; i < m_ycoeff.size(); i++)
-    {
-        m_yv.at(0) += m_yv.at(i) * m_ycoeff.at(i);
-    }
-    dReturn = m_yv.at(0) -  m_sumCorr; // Return the difference from the uncorrected waveform
+//    Digital filter designed by mkfilter/mkshape/gencode   A.J. Fisher, run as cascaded second-order sections
+    double filtered = m_filter.Step(input + m_sumCorr); // Add total guide output to input to get uncorrected waveform
+    dReturn = filtered - m_sumCorr; // Return the difference from the uncorrected waveform
 
     if (fabs(dReturn) < m_minMove)
     {
@@ -100,15 +84,6 @@ double GuideAlgorithmZFilter::result(double input)
     }
     m_sumCorr += dReturn;
 
-/*    wxString msg = "GuideAlgorithmZFilter::m_xv ";
-    for (int i = 0; i<m_xcoeff.size(); i++)
-        msg.Append(wxString::Format("%s%.4lg", i ? "," : "", m_xv.at(i)));
-    Debug.Write(wxString::Format("%s\n",msg));
-    msg = "GuideAlgorithmZFilter::m_yv ";
-    for (int i = 0; i<m_ycoeff.size(); i++)
-        msg.Append(wxString::Format("%s%.4lg", i ? "," : "", m_yv.at(i)));
-    Debug.Write(wxString::Format("%s\n", msg));
-    */
     Debug.Write(wxString::Format("GuideAlgorithmZFilter::Result() returns %.2f, input %.2f, m_sumCorr=%.2lg\n", dReturn, input, m_sumCorr));
 
     return dReturn;
@@ -122,7 +97,7 @@ bool GuideAlgorithmZFilter::BuildFilter()
     {
         Debug.Write(wxString::Format("GuideAlgorithmZFilter::order=%d, expFactor=%lf\n",
             m_order, m_expFactor));
-        if (m_order < 1)
+        if (m_order < 1 || m_order > ZFilterFactory::MaxOrder)
         {
             throw ERROR_INFO("invalid order");
         }
@@ -134,29 +109,20 @@ bool GuideAlgorithmZFilter::BuildFilter()
         double corner = m_expFactor * 4.0;
         FILTER_DESIGN design = (corner < 6.0) ? BUTTERWORTH : m_design;
 
-        m_xcoeff.clear();
-        m_ycoeff.clear();
+        ZFilterFactory *pFactory = new ZFilterFactory(design, m_order, corner);
         delete m_pFactory;
-        m_pFactory = new ZFilterFactory(design, m_order, corner);
+        m_pFactory = pFactory;
         m_order = m_pFactory->order();
-        m_gain = m_pFactory->gain();
-        m_xcoeff = m_pFactory->xcoeffs;
-        m_ycoeff = m_pFactory->ycoeffs;
-
-        Debug.Write(wxString::Format("GuideAlgorithmZFilter::type=%s order=%d, corner=%lf, gain=%lg\n",
-            m_pFactory->getname(), m_order, m_pFactory->corner(), m_gain));
-        wxString msg = wxString::Format("GuideAlgorithmZFilter::m_xcoeffs:");
-        for (int it = 0; it < m_xcoeff.size(); it++)
-        {
-            msg.Append(wxString::Format("%s%.3lg", it ? "," : "", m_xcoeff.at(it)));
-        }
-        Debug.Write(wxString::Format("%s\n", msg));
-        msg = wxString::Format("GuideAlgorithmZFilter::m_ycoeffs:");
-        for (int it = 1; it < m_ycoeff.size(); it++)
+        m_filter.Init(m_pFactory->sections);
+
+        Debug.Write(wxString::Format("GuideAlgorithmZFilter::type=%s order=%d, corner=%lf, sections=%d\n",
+            m_pFactory->getname(), m_order, m_pFactory->corner(), (int) m_pFactory->sections.size()));
+        for (size_t it = 0; it < m_pFactory->sections.size(); it++)
         {
-            msg.Append(wxString::Format("%s%.3lg", it ? "," : "", m_ycoeff.at(it)));
+            const ZFilterSection& s = m_pFactory->sections[it];
+            Debug.Write(wxString::Format("GuideAlgorithmZFilter::section %d: b=%.4lg,%.4lg,%.4lg a=%.4lg,%.4lg\n",
+                (int) it, s.b0, s.b1, s.b2, s.a1, s.a2));
         }
-        Debug.Write(wxString::Format("%s\n", msg));
         reset();
     }
     catch (const wxString& Msg)
@@ -221,10 +187,38 @@ bool GuideAlgorithmZFilter::SetExpFactor(double expFactor)
     return bError;
 }
 
+bool GuideAlgorithmZFilter::SetOrder(int order)
+{
+    bool bError = false;
+
+    try
+    {
+        if (order < 1 || order > ZFilterFactory::MaxOrder)
+        {
+            throw ERROR_INFO("invalid order");
+        }
+
+        m_order = order;
+
+    }
+    catch (const wxString& Msg)
+    {
+        POSSIBLY_UNUSED(Msg);
+        bError = true;
+        m_order = DefaultOrder;
+    }
+
+    pConfig->Profile.SetInt(GetConfigPath() + "/order", m_order);
+    BuildFilter();
+
+    return bError;
+}
+
 void GuideAlgorithmZFilter::GetParamNames(wxArrayString& names) const
 {
     names.push_back("minMove");
     names.push_back("expFactor");
+    names.push_back("order");
 }
 
 bool GuideAlgorithmZFilter::GetParam(const wxString& name, double *val) const
@@ -235,6 +229,8 @@ bool GuideAlgorithmZFilter::GetParam(const wxString& name, double *val) const
         *val = GetMinMove();
     else if (name == "expFactor")
         *val = GetExpFactor();
+    else if (name == "order")
+        *val = GetOrder();
     else
         ok = false;
 
@@ -249,6 +245,8 @@ bool GuideAlgorithmZFilter::SetParam(const wxString& name, double val)
         err = SetMinMove(val);
     else if (name == "expFactor")
         err = SetExpFactor(val);
+    else if (name == "order")
+        err = SetOrder((int) floor(val + 0.5));
     else
         err = true;
 
@@ -283,6 +281,14 @@ GuideAlgorithmZFilter::
     DoAdd(_("Exposure Factor"), m_pExpFactor,
         wxString::Format(_("Multiplied by exposure time gives the equivalent exposure time after filtering. "
         "Default = %.1f"), DefaultExpFactor));
+
+    width = StringWidth(_T("00"));
+    m_pOrder = pFrame->MakeSpinCtrl(pParent, wxID_ANY, _T(" "), wxDefaultPosition,
+        wxSize(width, -1), wxSP_ARROW_KEYS, 1, ZFilterFactory::MaxOrder, DefaultOrder, _T("Order"));
+
+    DoAdd(_("Filter Order"), m_pOrder,
+        wxString::Format(_("Order of the low-pass filter. Higher orders cut off more sharply but respond more slowly. "
+        "Default = %d"), DefaultOrder));
     width = StringWidth(_T("000.00"));
     m_pMinMove = pFrame->MakeSpinCtrlDouble(pParent, wxID_ANY, _T(" "), wxDefaultPosition,
         wxSize(width, -1), wxSP_ARROW_KEYS, 0.0, 20.0, 0.0, 0.05, _T("MinMove"));
@@ -306,6 +312,7 @@ void GuideAlgorithmZFilter::
 {
     m_pMinMove->SetValue(m_pGuideAlgorithm->GetMinMove());
     m_pExpFactor->SetValue(m_pGuideAlgorithm->GetExpFactor());
+    m_pOrder->SetValue(m_pGuideAlgorithm->GetOrder());
 }
 
 void GuideAlgorithmZFilter::
@@ -314,6 +321,7 @@ void GuideAlgorithmZFilter::
 {
     m_pGuideAlgorithm->SetMinMove(m_pMinMove->GetValue());
     m_pGuideAlgorithm->SetExpFactor(m_pExpFactor->GetValue());
+    m_pGuideAlgorithm->SetOrder(m_pOrder->GetValue());
 }
 
 void GuideAlgorithmZFilter::
@@ -326,6 +334,7 @@ void GuideAlgorithmZFilter::
 GuideAlgorithmZFilterConfigDialogPane::EnableDecControls(bool enable)
 {
     m_pExpFactor->Enable(enable);
+    m_pOrder->Enable(enable);
     m_pMinMove->Enable(enable);
 }
 
@@ -40,10 +40,8 @@
 class GuideAlgorithmZFilter : public GuideAlgorithm
 {
     FILTER_DESIGN m_design;
-    std::vector<double> m_xv, m_yv;  // Historical values up to m_order
-    std::vector<double> m_xcoeff, m_ycoeff;
+    ZFilterCascade m_filter;
     int m_order;
-    double m_gain;
     double m_minMove;
     double m_sumCorr; // Sum of all corrections issued
     double m_expFactor;
@@ -54,6 +52,7 @@ protected:
     {
         GuideAlgorithmZFilter *m_pGuideAlgorithm;
         wxSpinCtrlDouble *m_pExpFactor;
+        wxSpinCtrl *m_pOrder;
         wxSpinCtrlDouble *m_pMinMove;
 
     public:
@@ -87,6 +86,8 @@ protected:
     bool SetMinMove(double minMove) override;
     double GetExpFactor() const;
     bool SetExpFactor(double expfactor);
+    int GetOrder() const;
+    bool SetOrder(int order);
 
     friend class GuideAlgorithmZFilterConfigDialogPane;
 
@@ -96,7 +97,7 @@ public:
     GUIDE_ALGORITHM Algorithm() const override;
 
     void reset() override;
-    double result(double input) override;
+    double result(double input, const std::chrono::steady_clock::time_point& sampleTime) override;
     ConfigDialogPane *GetConfigDialogPane(wxWindow *pParent) override;
     GraphControlPane *GetGraphControlPane(wxWindow *pParent, const wxString& label) override;
     wxString GetSettingsSummary() const override;
@@ -116,4 +117,9 @@ inline double GuideAlgorithmZFilter::GetExpFactor() const
     return m_expFactor;
 }
 
+inline int GuideAlgorithmZFilter::GetOrder() const
+{
+    return m_order;
+}
+
 #endif /* GUIDE_ALGORITHM_ZFILTER_H_INCLUDED */
@@ -50,6 +50,7 @@ enum GUIDE_ALGORITHM
     GUIDE_ALGORITHM_RESIST_SWITCH,
     GUIDE_ALGORITHM_GAUSSIAN_PROCESS,
     GUIDE_ALGORITHM_ZFILTER,
+    GUIDE_ALGORITHM_KALMAN,
 };
 
 #include "guide_algorithm.h"
@@ -60,5 +61,6 @@ enum GUIDE_ALGORITHM
 #include "guide_algorithm_resistswitch.h"
 #include "guide_algorithm_gaussian_process.h"
 #include "guide_algorithm_zfilter.h"
+#include "guide_algorithm_kalman.h"
 
 #endif /* GUIDE_ALGORITHMS_H_INCLUDED */
@@ -168,6 +168,7 @@ Guider::Guider(wxWindow *parent, int xSize, int ySize) :
     m_ignoreLostStarLooping = false;
     m_forceFullFrame = false;
     m_measurementMode = false;
+    m_pulseOverlapEnabled = false;
     m_searchRegion = 0;
     m_pCurrentImage = new usImage(); // so we always have one
 
@@ -206,6 +207,9 @@ void Guider::LoadProfileSettings()
     bool enableFastRecenter = pConfig->Profile.GetBoolean("/guider/FastRecenter", true);
     EnableFastRecenter(enableFastRecenter);
 
+    bool enablePulseOverlap = pConfig->Profile.GetBoolean("/guider/PulseOverlap", false);
+    EnablePulseOverlap(enablePulseOverlap);
+
     bool scaleImage = pConfig->Profile.GetBoolean("/guider/ScaleImage", DefaultScaleImage);
     SetScaleImage(scaleImage);
 
@@ -230,7 +234,7 @@ void Guider::LoadProfileSettings()
     LoadBookmarks(&m_bookmarks);
 
     // clear the display
-    if (m_pCurrentImage->ImageData)
+    if (m_pCurrentImage->HasPixels())
     {
         delete m_displayedImage;
         m_displayedImage = new wxImage(XWinSize, YWinSize, true);
@@ -394,6 +398,25 @@ void Guider::EnableFastRecenter(bool enable)
     pConfig->Profile.SetInt("/guider/FastRecenter", m_fastRecenterEnabled);
 }
 
+void Guider::EnablePulseOverlap(bool enable)
+{
+    m_pulseOverlapEnabled = enable;
+    pConfig->Profile.SetBoolean("/guider/PulseOverlap", m_pulseOverlapEnabled);
+}
+
+void Guider::ScheduleGuideMove(const GuiderOffset& ofs, unsigned int moveOptions)
+{
+    // When pulse overlap is enabled, mount moves go to the secondary worker thread so
+    // the next exposure can start on the primary thread while the pulse is still in
+    // progress. The mount compensates for the part of the pulse that the exposure did
+    // not see when it processes the next guide step. AO moves are fast enough that
+    // there is nothing to gain, and bumps already run on the secondary thread.
+    if (m_pulseOverlapEnabled && !pMount->IsStepGuider())
+        pFrame->ScheduleSecondaryMove(pMount, ofs, moveOptions);
+    else
+        pFrame->SchedulePrimaryMove(pMount, ofs, moveOptions);
+}
+
 void Guider::SetPolarAlignCircle(const PHD_Point& pt, double radius)
 {
     m_polarAlignCircleRadius = radius;
@@ -437,7 +460,7 @@ bool Guider::PaintHelper(wxAutoBufferedPaintDCBase& dc, wxMemoryDC& memDC)
         GUIDER_STATE state = GetState();
         GetSize(&XWinSize, &YWinSize);
 
-        if (m_pCurrentImage->ImageData)
+        if (m_pCurrentImage->HasPixels())
         {
             int blevel = m_pCurrentImage->FiltMin;
             int wlevel = m_pCurrentImage->FiltMax;
@@ -1278,7 +1301,8 @@ void Guider::UpdateGuideState(usImage *pImage, bool bStopping)
             throw THROW_INFO("Stopped Guiding");
         }
 
-        assert(!pMount || !pMount->IsBusy());
+        // with pulse overlap the previous guide step may still be in progress
+        assert(!pMount || !pMount->IsBusy() || m_pulseOverlapEnabled);
 
         // shift lock position
         if (LockPosShiftEnabled() && IsGuiding())
@@ -1295,6 +1319,9 @@ void Guider::UpdateGuideState(usImage *pImage, bool bStopping)
         GuiderOffset ofs;
         FrameDroppedInfo info;
 
+        ofs.exposureStart = pImage->ImgStartSteady;
+        ofs.exposureDuration = pImage->ExposureSpan();
+
         if (UpdateCurrentPosition(pImage, &ofs, &info))           // true means error
         {
             info.frameNumber = pImage->FrameNum;
@@ -1333,7 +1360,7 @@ void Guider::UpdateGuideState(usImage *pImage, bool bStopping)
 
                     // allow guide algorithms to attempt dead reckoning
                     static GuiderOffset ZERO_OFS;
-                    pFrame->SchedulePrimaryMove(pMount, ZERO_OFS, MOVEOPTS_DEDUCED_MOVE);
+                    ScheduleGuideMove(ZERO_OFS, MOVEOPTS_DEDUCED_MOVE);
 
                     wxColor prevColor = GetBackgroundColour();
                     SetBackgroundColour(wxColour(64,0,0));
@@ -1372,7 +1399,7 @@ void Guider::UpdateGuideState(usImage *pImage, bool bStopping)
             {
                 // allow guide algorithms to attempt dead reckoning
                 static GuiderOffset ZERO_OFS;
-                pFrame->SchedulePrimaryMove(pMount, ZERO_OFS, MOVEOPTS_DEDUCED_MOVE);
+                ScheduleGuideMove(ZERO_OFS, MOVEOPTS_DEDUCED_MOVE);
             }
 
             statusMessage = _("Paused") + (GetPauseType() == PAUSE_FULL ? _("/full") : _("/looping"));
@@ -1493,7 +1520,7 @@ void Guider::UpdateGuideState(usImage *pImage, bool bStopping)
 
                     ofs.mountOfs.SetXY(step.X * m_ditherRecenterDir.x, step.Y * m_ditherRecenterDir.y);
                     pMount->TransformMountCoordinatesToCameraCoordinates(ofs.mountOfs, ofs.cameraOfs);
-                    pFrame->SchedulePrimaryMove(pMount, ofs, MOVEOPTS_RECOVERY_MOVE);
+                    ScheduleGuideMove(ofs, MOVEOPTS_RECOVERY_MOVE);
                     // let guide algorithms know about the direct move
                     pMount->NotifyDirectMove(ofs.mountOfs);
                 }
@@ -1505,7 +1532,7 @@ void Guider::UpdateGuideState(usImage *pImage, bool bStopping)
                 {
                     // ordinary guide step
                     s_deflectionLogger.Log(CurrentPosition());
-                    pFrame->SchedulePrimaryMove(pMount, ofs, MOVEOPTS_GUIDE_STEP);
+                    ScheduleGuideMove(ofs, MOVEOPTS_GUIDE_STEP);
                 }
                 break;
 
@@ -1687,7 +1714,7 @@ void Guider::GuiderConfigDialogPane::LayoutControls(Guider *pGuider, BrainCtrlId
     wxStaticBoxSizer *pStarTrack = new wxStaticBoxSizer(wxVERTICAL, m_pParent, _("Guide star tracking"));
     wxStaticBoxSizer *pCalib = new wxStaticBoxSizer(wxVERTICAL, m_pParent, _("Calibration"));
     wxStaticBoxSizer *pShared = new wxStaticBoxSizer(wxVERTICAL, m_pParent, _("Shared Parameters"));
-    wxFlexGridSizer *pCalibSizer = new wxFlexGridSizer(3, 2, 10, 10);
+    wxFlexGridSizer *pCalibSizer = new wxFlexGridSizer(4, 2, 10, 10);
     wxFlexGridSizer *pSharedSizer = new wxFlexGridSizer(2, 2, 10, 10);
 
     pStarTrack->Add(GetSizerCtrl(CtrlMap, AD_szStarTracking), def_flags);
@@ -1699,12 +1726,14 @@ void Guider::GuiderConfigDialogPane::LayoutControls(Guider *pGuider, BrainCtrlId
     pCalibSizer->Add(GetSingleCtrl(CtrlMap, AD_cbAssumeOrthogonal), wxSizerFlags(0).Border(wxLEFT, 90));
     CondAddCtrl(pCalibSizer, CtrlMap, AD_cbClearCalibration);
     CondAddCtrl(pCalibSizer, CtrlMap, AD_cbUseDecComp, wxSizerFlags(0).Border(wxLEFT, 90));
+    CondAddCtrl(pCalibSizer, CtrlMap, AD_cbRefineCalibration);
     pCalib->Add(pCalibSizer, def_flags);
     pCalib->Layout();
 
     // Minor ordering to have "no-mount" condition look ok
     pSharedSizer->Add(GetSingleCtrl(CtrlMap, AD_cbScaleImages));
     pSharedSizer->Add(GetSingleCtrl(CtrlMap, AD_cbFastRecenter), wxSizerFlags(0).Border(wxLEFT, 35));
+    pSharedSizer->Add(GetSingleCtrl(CtrlMap, AD_cbPulseOverlap));
     CondAddCtrl(pSharedSizer, CtrlMap, AD_cbReverseDecOnFlip);
     CondAddCtrl(pSharedSizer, CtrlMap, AD_cbEnableGuiding, wxSizerFlags(0).Border(wxLEFT, 35));
     CondAddCtrl(pSharedSizer, CtrlMap, AD_cbSlewDetection);
@@ -1735,17 +1764,24 @@ ConfigDialogCtrlSet(pParent, pAdvancedDialog, CtrlMap)
 
     m_pEnableFastRecenter = new wxCheckBox(GetParentWindow(AD_cbFastRecenter), wxID_ANY, _("Fast recenter after calibration or dither"));
     AddCtrl(CtrlMap, AD_cbFastRecenter, m_pEnableFastRecenter, _("Speed up calibration and dithering by using larger guide pulses to return the star to the center position. Un-check to use the old, slower method of recentering after calibration or dither."));
+
+    m_pEnablePulseOverlap = new wxCheckBox(GetParentWindow(AD_cbPulseOverlap), wxID_ANY, _("Expose during guide pulses"));
+    AddCtrl(CtrlMap, AD_cbPulseOverlap, m_pEnablePulseOverlap, _("Start the next exposure while the guide pulse is still in progress. "
+        "The part of the pulse that happens during the exposure is taken into account when computing the next correction. "
+        "Useful with long guide pulses on slow mounts. Has no effect for ST4 guiding through the camera or for AO guiding."));
 }
 
 void GuiderConfigDialogCtrlSet::LoadValues()
 {
     m_pEnableFastRecenter->SetValue(m_pGuider->IsFastRecenterEnabled());
+    m_pEnablePulseOverlap->SetValue(m_pGuider->IsPulseOverlapEnabled());
     m_pScaleImage->SetValue(m_pGuider->GetScaleImage());
 }
 
 void GuiderConfigDialogCtrlSet::UnloadValues()
 {
     m_pGuider->EnableFastRecenter(m_pEnableFastRecenter->GetValue());
+    m_pGuider->EnablePulseOverlap(m_pEnablePulseOverlap->GetValue());
     m_pGuider->SetScaleImage(m_pScaleImage->GetValue());
 }
 
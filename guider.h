@@ -119,6 +119,7 @@ class GuiderConfigDialogCtrlSet : public ConfigDialogCtrlSet
 {
     Guider *m_pGuider;
     wxCheckBox *m_pEnableFastRecenter;
+    wxCheckBox *m_pEnablePulseOverlap;
     wxCheckBox *m_pScaleImage;
 
 public:
@@ -133,6 +134,14 @@ struct GuiderOffset
 {
     PHD_Point cameraOfs;
     PHD_Point mountOfs;
+    PHD_Point lockPos;      // lock position the camera offset was measured from, if any
+    // exposure window of the frame the offset was measured on (steady clock), used to
+    // time-stamp guide algorithm inputs and to account for guide pulses that were still
+    // in progress during the exposure
+    std::chrono::steady_clock::time_point exposureStart;
+    int exposureDuration;
+
+    GuiderOffset() : exposureDuration(0) { }
 };
 
 class Guider : public wxWindow
@@ -162,6 +171,7 @@ class Guider : public wxWindow
     bool m_lockPosIsSticky;
     bool m_ignoreLostStarLooping;
     bool m_fastRecenterEnabled;
+    bool m_pulseOverlapEnabled;
     LockPosShiftParams m_lockPosShift;
     bool m_measurementMode;
     double m_minStarHFD;
@@ -305,6 +315,8 @@ public:
 
     virtual const PHD_Point& CurrentPosition() const = 0;
     virtual wxRect GetBoundingBox() const = 0;
+    // disjoint windows within GetBoundingBox() to read out instead of all of it, or none
+    virtual void GetSearchWindows(std::vector<wxRect> *windows) const { windows->clear(); }
     virtual int GetMaxMovePixels() const = 0;
 
     virtual const Star& PrimaryStar() const = 0;
@@ -322,8 +334,12 @@ public:
     bool IsFastRecenterEnabled() const;
     void EnableFastRecenter(bool enable);
 
+    bool IsPulseOverlapEnabled() const;
+    void EnablePulseOverlap(bool enable);
+
 private:
     void UpdateLockPosShiftCameraCoords();
+    void ScheduleGuideMove(const GuiderOffset& ofs, unsigned int moveOptions);
     DECLARE_EVENT_TABLE()
 };
 
@@ -382,6 +398,11 @@ inline bool Guider::IsFastRecenterEnabled() const
     return m_fastRecenterEnabled;
 }
 
+inline bool Guider::IsPulseOverlapEnabled() const
+{
+    return m_pulseOverlapEnabled;
+}
+
 inline double Guider::GetPolarAlignCircleCorrection() const
 {
     return m_polarAlignCircleCorrection;
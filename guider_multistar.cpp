@@ -59,12 +59,11 @@ class MassChecker
         double mass;
     };
 
-    std::deque<Entry> m_data;
+    RingBuffer<Entry> m_data;
+    OrderStats m_masses; // the masses in m_data, sorted for the median
     double m_highMass;   // high-water mark
     double m_lowMass;    // low-water mark
     unsigned long m_timeWindow;
-    double *m_tmp;
-    size_t m_tmpSize;
     int m_exposure;
     bool m_isAutoExposure;
 
@@ -73,19 +72,12 @@ public:
     MassChecker()
         : m_highMass(0.),
           m_lowMass(9e99),
-          m_tmp(0),
-          m_tmpSize(0),
           m_exposure(0),
           m_isAutoExposure(false)
     {
         SetTimeWindow(DefaultTimeWindowMs);
     }
 
-    ~MassChecker()
-    {
-        delete[] m_tmp;
-    }
-
     void SetTimeWindow(unsigned int milliseconds)
     {
         // an abrupt change in mass will affect the median after approx m_timeWindow/2
@@ -121,12 +113,16 @@ public:
         wxLongLong_t oldest = now - m_timeWindow;
 
         while (m_data.size() > 0 && m_data.front().time < oldest)
+        {
+            m_masses.Remove(m_data.front().mass);
             m_data.pop_front();
+        }
 
         Entry entry;
         entry.time = now;
         entry.mass = AdjustedMass(mass);
         m_data.push_back(entry);
+        m_masses.Insert(entry.mass);
     }
 
     bool CheckMass(double mass, double threshold, double limits[4])
@@ -134,22 +130,8 @@ public:
         if (m_data.size() < 5)
             return false;
 
-        if (m_tmpSize < m_data.size())
-        {
-            delete[] m_tmp;
-            m_tmpSize = m_data.size() + 10;
-            m_tmp = new double[m_tmpSize];
-        }
-
-        std::deque<Entry>::const_iterator it = m_data.begin();
-        std::deque<Entry>::const_iterator end = m_data.end();
-        double *p = &m_tmp[0];
-        for (; it != end; ++it)
-            *p++ = it->mass;
-
-        size_t mid = m_data.size() / 2;
-        std::nth_element(&m_tmp[0], &m_tmp[mid], &m_tmp[m_data.size()]);
-        double med = m_tmp[mid];
+        // upper median for an even count
+        double med = m_masses.GetElement(m_masses.GetCount() / 2);
 
         if (med > m_highMass)
             m_highMass = med;
@@ -184,6 +166,7 @@ public:
     void Reset()
     {
         m_data.clear();
+        m_masses.Clear();
         m_highMass = 0.;
         m_lowMass = 9e99;
     }
@@ -200,6 +183,132 @@ enum {
     MAX_LIST_SIZE = 12
 };
 
+// Predicts where the primary star will be on the next frame and how large a search region
+// is needed to find it there, so that while guiding the search and the subframe can be
+// smaller than the configured search region. The predicted position is the last position
+// plus the star's drift per frame plus the shift expected from the guide moves made since,
+// using the mount calibration. The region covers several sigma of the recent prediction
+// errors, widened by the uncertainty of the moves. It stays at the configured region until
+// enough frames have been tracked, and tracking starts over after a lock position change
+// (dither) or a lost star.
+static const double PredictNSigma = 4.0;
+static const double PredictMoveError = 0.3;     // guide moves are assumed accurate to this fraction
+static const double PredictErrSmoothing = 0.1;
+static const double PredictDriftSmoothing = 0.2;
+
+class SearchRegionPredictor
+{
+    enum { MIN_FRAMES = 5, MARGIN_PX = 3 };
+
+    PHD_Point m_last;           // where the star was last found
+    PHD_Point m_drift;          // star movement per frame not explained by guide moves
+    double m_errVar;            // smoothed variance of the prediction error per axis, px^2
+    int m_frames;               // frames tracked since the last reset
+    unsigned int m_moveCount;   // mount move counts when the star was last found
+    unsigned int m_secondaryMoveCount;
+    double m_pendingMove;       // size of the last measured offset, a bound on the correction that follows it
+
+    // shift expected from the guide moves made since the star was last found, and its variance.
+    // Returns false if no move has been made since.
+    bool MoveShift(PHD_Point *shift, double *var) const
+    {
+        bool moved = false;
+        shift->SetXY(0.0, 0.0);
+
+        PHD_Point s;
+        if (pMount && pMount->LastMoveStarShift(&s) != m_moveCount)
+        {
+            *shift += s;
+            moved = true;
+        }
+        if (pSecondaryMount && pSecondaryMount->LastMoveStarShift(&s) != m_secondaryMoveCount)
+        {
+            *shift += s;
+            moved = true;
+        }
+
+        double const e = PredictMoveError * shift->Distance();
+        *var = e * e;
+
+        return moved;
+    }
+
+public:
+
+    SearchRegionPredictor()
+    {
+        Reset();
+    }
+
+    void Reset()
+    {
+        m_last.Invalidate();
+        m_drift.SetXY(0.0, 0.0);
+        m_errVar = 0.0;
+        m_frames = 0;
+        m_moveCount = 0;
+        m_secondaryMoveCount = 0;
+        m_pendingMove = 0.0;
+    }
+
+    // Returns the search region for the next frame, and updates *center to the predicted
+    // position. Before enough frames have been tracked, this is the full region.
+    int Predict(PHD_Point *center, int maxRegion) const
+    {
+        if (!m_last.IsValid())
+            return maxRegion;
+
+        PHD_Point shift;
+        double moveVar;
+        bool moved = MoveShift(&shift, &moveVar);
+
+        center->SetXY(m_last.X + m_drift.X + shift.X, m_last.Y + m_drift.Y + shift.Y);
+
+        if (m_frames < MIN_FRAMES)
+            return maxRegion;
+
+        double region = PredictNSigma * sqrt(m_errVar + moveVar) + MARGIN_PX;
+
+        // the correction for the last offset may not have been made yet (the next exposure is
+        // requested while the move is pending), so allow for the star not moving or moving by
+        // the whole offset
+        if (!moved)
+            region += m_pendingMove;
+
+        return wxMin(wxMax((int) ceil(region), (int) MIN_SEARCH_REGION), maxRegion);
+    }
+
+    // The star was found at pos. offset is the offset from the lock position that will be
+    // corrected, or 0 if no correction will be made
+    void Update(const PHD_Point& pos, double offset)
+    {
+        if (m_last.IsValid())
+        {
+            PHD_Point shift;
+            double moveVar;
+            MoveShift(&shift, &moveVar);
+
+            double const ex = pos.X - (m_last.X + m_drift.X + shift.X);
+            double const ey = pos.Y - (m_last.Y + m_drift.Y + shift.Y);
+
+            // a plain average over the first frames, then exponential smoothing
+            ++m_frames;
+            double const a = wxMax(PredictErrSmoothing, 1.0 / m_frames);
+            m_errVar += a * ((ex * ex + ey * ey) / 2.0 - m_errVar);
+
+            m_drift.X += PredictDriftSmoothing * (pos.X - m_last.X - shift.X - m_drift.X);
+            m_drift.Y += PredictDriftSmoothing * (pos.Y - m_last.Y - shift.Y - m_drift.Y);
+        }
+
+        m_last = pos;
+
+        PHD_Point s;
+        m_moveCount = pMount ? pMount->LastMoveStarShift(&s) : 0;
+        m_secondaryMoveCount = pSecondaryMount ? pSecondaryMount->LastMoveStarShift(&s) : 0;
+        m_pendingMove = offset;
+    }
+};
+
 BEGIN_EVENT_TABLE(GuiderMultiStar, Guider)
     EVT_PAINT(GuiderMultiStar::OnPaint)
     EVT_LEFT_DOWN(GuiderMultiStar::OnLClick)
@@ -209,6 +318,9 @@ END_EVENT_TABLE()
 GuiderMultiStar::GuiderMultiStar(wxWindow *parent)
     : Guider(parent, XWinSize, YWinSize),
       m_massChecker(new MassChecker()),
+      m_searchPredictor(new SearchRegionPredictor()),
+      m_primaryFrameShift(0., 0.),
+      m_secondarySearchRegion(DEFAULT_SEARCH_REGION),
       m_stabilizing(false), m_multiStarMode(true), m_lastPrimaryDistance(0),
       m_lockPositionMoved(false),
       m_maxStars(DEFAULT_MAX_STAR_COUNT),
@@ -222,6 +334,7 @@ GuiderMultiStar::GuiderMultiStar(wxWindow *parent)
 GuiderMultiStar::~GuiderMultiStar()
 {
     delete m_massChecker;
+    delete m_searchPredictor;
     delete m_primaryDistStats;
 }
 
@@ -282,6 +395,8 @@ void GuiderMultiStar::LoadProfileSettings()
     int searchRegion = pConfig->Profile.GetInt("/guider/onestar/SearchRegion", DEFAULT_SEARCH_REGION);
     SetSearchRegion(searchRegion);
 
+    SetAdaptiveSearchRegion(pConfig->Profile.GetBoolean("/guider/onestar/AdaptiveSearchRegion", true));
+
     SetMultiStarMode(pConfig->Profile.GetBoolean("/guider/multistar/enabled", false));
 }
 
@@ -367,6 +482,23 @@ bool GuiderMultiStar::SetSearchRegion(int searchRegion)
     return bError;
 }
 
+void GuiderMultiStar::SetAdaptiveSearchRegion(bool enable)
+{
+    m_adaptiveSearchRegion = enable;
+    m_searchPredictor->Reset();
+    pConfig->Profile.SetBoolean("/guider/onestar/AdaptiveSearchRegion", enable);
+}
+
+// Search region for the primary star on the next frame. *center is the position to search
+// around; with an adaptive search region it is moved to the predicted position.
+int GuiderMultiStar::PredictedSearchRegion(PHD_Point *center) const
+{
+    if (!m_adaptiveSearchRegion || GetState() != STATE_GUIDING)
+        return m_searchRegion;
+
+    return m_searchPredictor->Predict(center, m_searchRegion);
+}
+
 bool GuiderMultiStar::SetCurrentPosition(const usImage *pImage, const PHD_Point& position)
 {
     bool bError = true;
@@ -394,6 +526,7 @@ bool GuiderMultiStar::SetCurrentPosition(const usImage *pImage, const PHD_Point&
         }
 
         m_massChecker->Reset();
+        m_searchPredictor->Reset();
         bError = !m_primaryStar.Find(pImage, m_searchRegion, x, y, pFrame->GetStarFindMode(),
                               GetMinStarHFD(), GetMaxStarHFD(), pCamera->GetSaturationADU(), Star::FIND_LOGGING_VERBOSE);
     }
@@ -454,7 +587,7 @@ bool GuiderMultiStar::AutoSelect(const wxRect& roi)
 
     try
     {
-        if (!image || !image->ImageData)
+        if (!image || !image->HasPixels())
         {
             throw ERROR_INFO("No Current Image");
         }
@@ -520,7 +653,7 @@ bool GuiderMultiStar::AutoSelect(const wxRect& roi)
         error = true;
     }
 
-    if (image && image->ImageData)
+    if (image && image->HasPixels())
     {
         if (error)
             Debug.Write("GuiderMultiStar::AutoSelect failed.\n");
@@ -539,14 +672,16 @@ inline static wxRect SubframeRect(const PHD_Point& pos, int halfwidth)
                   2 * halfwidth + 1);
 }
 
-wxRect GuiderMultiStar::GetBoundingBox() const
+// the subframe around the primary star
+wxRect GuiderMultiStar::PrimaryBoundingBox() const
 {
-    enum { SUBFRAME_BOUNDARY_PX = 0 };
+    enum { SUBFRAME_BOUNDARY_PX = 0, SUBFRAME_MIN_HALFWIDTH = 12 };
 
     GUIDER_STATE state = GetState();
 
     bool subframe;
     PHD_Point pos;
+    int halfwidth = m_searchRegion;
 
     switch (state) {
     case STATE_SELECTED:
@@ -564,6 +699,18 @@ wxRect GuiderMultiStar::GetBoundingBox() const
             pos = CurrentPosition();
         else
             pos = LockPosition();
+
+        // With an adaptive search region the subframe only needs to cover the predicted search
+        // region, plus the background annulus Star::Find measures around the star. The size is
+        // rounded up so that it does not change on every frame.
+        PHD_Point center(CurrentPosition());
+        int region = PredictedSearchRegion(&center);
+        if (region < m_searchRegion)
+        {
+            int reach = (int) ceil(wxMax(fabs(center.X - pos.X), fabs(center.Y - pos.Y)));
+            halfwidth = wxMax(region + reach, (int) SUBFRAME_MIN_HALFWIDTH);
+            halfwidth = wxMin((halfwidth + 3) & ~3, m_searchRegion);
+        }
         break;
     }
     default:
@@ -577,8 +724,8 @@ wxRect GuiderMultiStar::GetBoundingBox() const
 
     if (subframe)
     {
-        wxRect box(SubframeRect(pos, m_searchRegion + SUBFRAME_BOUNDARY_PX));
-        box.Intersect(wxRect(pCamera->FullSize));
+        wxRect box(SubframeRect(pos, halfwidth + SUBFRAME_BOUNDARY_PX));
+        box.Intersect(wxRect(pCamera->FrameSize()));
         return box;
     }
     else
@@ -587,9 +734,93 @@ wxRect GuiderMultiStar::GetBoundingBox() const
     }
 }
 
+// When guiding on multiple stars with subframes, a window around each secondary star that
+// will be measured is read out along with the primary star's subframe; otherwise the secondary
+// stars fall outside the subframe. Windows that overlap are merged so that they are disjoint.
+void GuiderMultiStar::GetSearchWindows(std::vector<wxRect> *windows) const
+{
+    windows->clear();
+
+    wxRect primary(PrimaryBoundingBox());
+    if (primary.IsEmpty() || !m_multiStarMode || GetState() != STATE_GUIDING || m_guideStars.size() < 2)
+        return;
+
+    windows->push_back(primary);
+
+    // The secondary stars are searched for where the primary star's movement on the frame takes
+    // them. Center the windows on the movement predicted for the primary star; the actual
+    // movement can differ by up to the primary's search region. Around that, the windows cover
+    // the secondary star's search region and the background annulus.
+    PHD_Point center(m_primaryStar);
+    int region = PredictedSearchRegion(&center);
+    PHD_Point shift(center.X - m_primaryStar.X, center.Y - m_primaryStar.Y);
+
+    wxRect frame(pCamera->FrameSize());
+    unsigned int used = 1;
+    for (auto pGS = m_guideStars.begin() + 1; pGS != m_guideStars.end() && used < m_maxStars; ++pGS)
+    {
+        PHD_Point pos;
+        int halfwidth;
+        if (pGS->wasLost)
+        {
+            pos = m_primaryStar + pGS->offsetFromPrimary + shift;
+            halfwidth = region + m_searchRegion + Star::BACKGROUND_RADIUS;
+        }
+        else
+        {
+            pos.SetXY(pGS->X + shift.X, pGS->Y + shift.Y);
+            halfwidth = 2 * region + Star::BACKGROUND_RADIUS;
+            ++used;
+        }
+
+        wxRect box(SubframeRect(pos, halfwidth));
+        box.Intersect(frame);
+        if (!box.IsEmpty())
+            windows->push_back(box);
+    }
+
+    bool merged;
+    do
+    {
+        merged = false;
+        for (size_t i = 0; i < windows->size() && !merged; i++)
+        {
+            for (size_t j = i + 1; j < windows->size(); j++)
+            {
+                if ((*windows)[i].Intersects((*windows)[j]))
+                {
+                    (*windows)[i].Union((*windows)[j]);
+                    windows->erase(windows->begin() + j);
+                    merged = true;
+                    break;
+                }
+            }
+        }
+    } while (merged);
+
+    // a single window is just a subframe
+    if (windows->size() < 2)
+        windows->clear();
+}
+
+wxRect GuiderMultiStar::GetBoundingBox() const
+{
+    std::vector<wxRect> windows;
+    GetSearchWindows(&windows);
+
+    if (windows.empty())
+        return PrimaryBoundingBox();
+
+    wxRect box(windows[0]);
+    for (size_t i = 1; i < windows.size(); i++)
+        box.Union(windows[i]);
+    return box;
+}
+
 void GuiderMultiStar::InvalidateCurrentPosition(bool fullReset)
 {
     m_primaryStar.Invalidate();
+    m_searchPredictor->Reset();
 
     if (fullReset)
     {
@@ -802,8 +1033,9 @@ bool GuiderMultiStar::RefineOffset(const usImage *pImage, GuiderOffset *pOffset)
                             GetMinStarHFD(), GetMaxStarHFD(), pCamera->GetSaturationADU(), Star::FIND_LOGGING_MINIMAL);
                     }
                     else
-                        // Look for it where we last found it
-                        found = pGS->Find(pImage, m_searchRegion, pGS->X, pGS->Y, pFrame->GetStarFindMode(),
+                        // Look for it where we last found it, moved along with the primary star
+                        found = pGS->Find(pImage, m_secondarySearchRegion, pGS->X + m_primaryFrameShift.X,
+                            pGS->Y + m_primaryFrameShift.Y, pFrame->GetStarFindMode(),
                             GetMinStarHFD(), GetMaxStarHFD(), pCamera->GetSaturationADU(), Star::FIND_LOGGING_MINIMAL);
                     if (found)
                     {
@@ -930,8 +1162,23 @@ bool GuiderMultiStar::UpdateCurrentPosition(const usImage *pImage, GuiderOffset
     {
         Star newStar(m_primaryStar);
 
-        if (!newStar.Find(pImage, m_searchRegion, pFrame->GetStarFindMode(), GetMinStarHFD(),
-            GetMaxStarHFD(), pCamera->GetSaturationADU(), Star::FIND_LOGGING_VERBOSE))
+        // while guiding, search around the position the star is predicted to have moved to
+        PHD_Point center(m_primaryStar);
+        int region = PredictedSearchRegion(&center);
+
+        bool found = newStar.Find(pImage, region, center.X, center.Y, pFrame->GetStarFindMode(), GetMinStarHFD(),
+            GetMaxStarHFD(), pCamera->GetSaturationADU(), Star::FIND_LOGGING_VERBOSE);
+
+        if (!found && region < m_searchRegion)
+        {
+            Debug.Write(wxString::Format("UpdateCurrentPosition: star not found in predicted region %d at (%.1f,%.1f), "
+                "search full region\n", region, center.X, center.Y));
+            region = m_searchRegion;
+            found = newStar.Find(pImage, region, m_primaryStar.X, m_primaryStar.Y, pFrame->GetStarFindMode(), GetMinStarHFD(),
+                GetMaxStarHFD(), pCamera->GetSaturationADU(), Star::FIND_LOGGING_VERBOSE);
+        }
+
+        if (!found)
         {
             errorInfo->starError = newStar.GetError();
             errorInfo->starMass = 0.0;
@@ -1009,6 +1256,10 @@ bool GuiderMultiStar::UpdateCurrentPosition(const usImage *pImage, GuiderOffset
 
         ImageLogger::LogImage(pImage, distance);
 
+        // secondary stars are searched for where the primary star's movement takes them
+        m_primaryFrameShift.SetXY(newStar.X - m_primaryStar.X, newStar.Y - m_primaryStar.Y);
+        m_secondarySearchRegion = region;
+
         // update the star position, mass, etc.
         m_primaryStar = newStar;
         m_massChecker->AppendData(newStar.Mass);
@@ -1016,6 +1267,7 @@ bool GuiderMultiStar::UpdateCurrentPosition(const usImage *pImage, GuiderOffset
         if (lockPos.IsValid())
         {
             ofs->cameraOfs = m_primaryStar - lockPos;
+            ofs->lockPos = lockPos;
             if (m_multiStarMode && m_guideStars.size() > 1)
             {
                 if (RefineOffset(pImage, ofs))
@@ -1030,6 +1282,14 @@ bool GuiderMultiStar::UpdateCurrentPosition(const usImage *pImage, GuiderOffset
             UpdateCurrentDistance(distance, distanceRA);
         }
 
+        if (m_adaptiveSearchRegion && GetState() == STATE_GUIDING)
+        {
+            bool correcting = lockPos.IsValid() && pMount && pMount->GetGuidingEnabled();
+            m_searchPredictor->Update(m_primaryStar, correcting ? ofs->cameraOfs.Distance() : 0.);
+        }
+        else
+            m_searchPredictor->Reset();
+
         pFrame->pProfile->UpdateData(pImage, m_primaryStar.X, m_primaryStar.Y);
 
         pFrame->AdjustAutoExposure(m_primaryStar.SNR);
@@ -1040,6 +1300,7 @@ bool GuiderMultiStar::UpdateCurrentPosition(const usImage *pImage, GuiderOffset
     {
         POSSIBLY_UNUSED(Msg);
         bError = true;
+        m_searchPredictor->Reset(); // search the full region next time
         pFrame->ResetAutoExposure(); // use max exposure duration
     }
 
@@ -1050,6 +1311,9 @@ bool GuiderMultiStar::SetLockPosition(const PHD_Point& position)
 {
     if (!Guider::SetLockPosition(position))
     {
+        // the star is about to be moved to the new lock position (dither)
+        m_searchPredictor->Reset();
+
         if (m_multiStarMode)
         {
             m_lockPositionMoved = true;
@@ -1283,13 +1547,12 @@ void GuiderMultiStar::SaveStarFITS()
         start_x = pImage->Size.GetWidth() - 60;
     if ((start_y + 60) > pImage->Size.GetHeight())
         start_y = pImage->Size.GetHeight() - 60;
-    int x,y, width;
-    width = pImage->Size.GetWidth();
+    int x,y;
     unsigned short *usptr = tmpimg.ImageData;
     for (y = 0; y < 60; y++)
     {
         for (x = 0; x < 60; x++, usptr++)
-            *usptr = *(pImage->ImageData + (y + start_y)*width + (x + start_x));
+            *usptr = pImage->PixelValue(x + start_x, y + start_y);
     }
 
     imgLogDirectory = Debug.GetLogDir() + PATHSEPSTR + "PHD2_Stars";
@@ -1312,8 +1575,8 @@ void GuiderMultiStar::SaveStarFITS()
         hdr.write("DATE", wxDateTime::UNow(), wxDateTime::UTC, "file creation time, UTC");
         hdr.write("DATE-OBS", pImage->ImgStartTime, wxDateTime::UTC, "image capture start time, UTC");
         hdr.write("EXPOSURE", (float) pImage->ImgExpDur / 1000.0f, "Exposure time [s]");
-        hdr.write("XBINNING", (unsigned int) pCamera->Binning, "Camera X binning");
-        hdr.write("YBINNING", (unsigned int) pCamera->Binning, "Camera Y binning");
+        hdr.write("XBINNING", (unsigned int) pCamera->EffectiveBinning(), "Camera X binning");
+        hdr.write("YBINNING", (unsigned int) pCamera->EffectiveBinning(), "Camera Y binning");
         hdr.write("XORGSUB", start_x, "Subframe x position in binned pixels");
         hdr.write("YORGSUB", start_y, "Subframe y position in binned pixels");
 
@@ -1330,7 +1593,8 @@ void GuiderMultiStar::SaveStarFITS()
 wxString GuiderMultiStar::GetSettingsSummary() const
 {
     // return a loggable summary of guider configs
-    wxString s = wxString::Format(_T("Search region = %d px, Star mass tolerance "), GetSearchRegion());
+    wxString s = wxString::Format(_T("Search region = %d px%s, Star mass tolerance "), GetSearchRegion(),
+        m_adaptiveSearchRegion ? " (adaptive)" : "");
 
     if (GetMassChangeThresholdEnabled())
         s += wxString::Format(_T("= %.1f%%"), GetMassChangeThreshold() * 100.0);
@@ -1378,6 +1642,10 @@ GuiderMultiStarConfigDialogCtrlSet::GuiderMultiStarConfigDialogCtrlSet(wxWindow
         wxSize(width, -1), wxSP_ARROW_KEYS, MIN_SEARCH_REGION, MAX_SEARCH_REGION, DEFAULT_SEARCH_REGION, _T("Search"));
     wxSizer *pSearchRegion = MakeLabeledControl(AD_szStarTracking, _("Search region (pixels)"), m_pSearchRegion,
         _("How many pixels (up/down/left/right) do we examine to find the star? Default = 15"));
+    m_pAdaptiveSearchRegion = new wxCheckBox(GetParentWindow(AD_szStarTracking), wxID_ANY, _("Adaptive search region"));
+    m_pAdaptiveSearchRegion->SetToolTip(_("Check to let PHD2 search a smaller region, and download a smaller subframe, "
+        "around where the star is predicted to be while guiding. The region grows back to the search region "
+        "after a dither or a lost star."));
 
     wxStaticBoxSizer *pStarMass = new wxStaticBoxSizer(wxHORIZONTAL, GetParentWindow(AD_szStarTracking), _("Star Mass Detection"));
     m_pEnableStarMassChangeThresh = new wxCheckBox(GetParentWindow(AD_szStarTracking), STAR_MASS_ENABLE, _("Enable"));
@@ -1449,6 +1717,7 @@ GuiderMultiStarConfigDialogCtrlSet::GuiderMultiStarConfigDialogCtrlSet(wxWindow
     pTrackingParams->Add(m_pUseMultiStars, wxSizerFlags(0).Border(wxLEFT, 75));
     pTrackingParams->Add(m_pBeepForLostStarCtrl, wxSizerFlags().Border(wxTOP, 3));
     pTrackingParams->Add(dsamp, wxSizerFlags().Border(wxTOP, 3).Right());
+    pTrackingParams->Add(m_pAdaptiveSearchRegion, wxSizerFlags().Border(wxTOP, 3));
 
     AddGroup(CtrlMap, AD_szStarTracking, pTrackingParams);
 }
@@ -1465,6 +1734,7 @@ void GuiderMultiStarConfigDialogCtrlSet::LoadValues()
     m_pMassChangeThreshold->Enable(starMassEnabled);
     m_pMassChangeThreshold->SetValue(100.0 * m_pGuiderMultiStar->GetMassChangeThreshold());
     m_pSearchRegion->SetValue(m_pGuiderMultiStar->GetSearchRegion());
+    m_pAdaptiveSearchRegion->SetValue(m_pGuiderMultiStar->GetAdaptiveSearchRegion());
     m_MinHFD->SetValue(m_pGuiderMultiStar->GetMinStarHFD());
     m_MinSNR->SetValue(m_pGuiderMultiStar->GetAFMinStarSNR());
     m_MaxHFD->SetValue(m_pGuiderMultiStar->GetMaxStarHFD());
@@ -1479,6 +1749,8 @@ void GuiderMultiStarConfigDialogCtrlSet::UnloadValues()
     m_pGuiderMultiStar->SetMassChangeThresholdEnabled(m_pEnableStarMassChangeThresh->GetValue());
     m_pGuiderMultiStar->SetMassChangeThreshold(m_pMassChangeThreshold->GetValue() / 100.0);
     m_pGuiderMultiStar->SetSearchRegion(m_pSearchRegion->GetValue());
+    if (m_pAdaptiveSearchRegion->GetValue() != m_pGuiderMultiStar->GetAdaptiveSearchRegion())
+        m_pGuiderMultiStar->SetAdaptiveSearchRegion(m_pAdaptiveSearchRegion->GetValue());
     double min_hfd = m_MinHFD->GetValue();
     m_pGuiderMultiStar->SetMinStarHFD(min_hfd);
     m_pGuiderMultiStar->SetMaxStarHFD(wxMax(m_MaxHFD->GetValue(), min_hfd + 2.0));
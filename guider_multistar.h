@@ -45,6 +45,7 @@
 #define GUIDER_MULTISTAR_H_INCLUDED
 
 class MassChecker;
+class SearchRegionPredictor;
 class GuiderMultiStar;
 class GuiderConfigDialogCtrlSet;
 
@@ -56,6 +57,7 @@ public:
 
     GuiderMultiStar *m_pGuiderMultiStar;
     wxSpinCtrl *m_pSearchRegion;
+    wxCheckBox *m_pAdaptiveSearchRegion;
     wxCheckBox *m_pEnableStarMassChangeThresh;
     wxSpinCtrlDouble *m_pMassChangeThreshold;
     wxSpinCtrlDouble *m_MinHFD;
@@ -77,6 +79,9 @@ class GuiderMultiStar : public Guider
     std::vector<GuideStar> m_guideStars;
     DescriptiveStats *m_primaryDistStats;
     MassChecker *m_massChecker;
+    SearchRegionPredictor *m_searchPredictor;
+    PHD_Point m_primaryFrameShift;      // primary star movement on the current frame
+    int m_secondarySearchRegion;        // search region for secondary stars on the current frame
     double m_lastPrimaryDistance;
     bool m_multiStarMode;
     bool m_stabilizing;
@@ -91,6 +96,7 @@ class GuiderMultiStar : public Guider
     double m_tolerateJumpsThreshold;
     unsigned int m_maxStars;
     double m_stabilitySigmaX;
+    bool m_adaptiveSearchRegion;
 
 public:
     class GuiderMultiStarConfigDialogPane : public GuiderConfigDialogPane
@@ -112,6 +118,8 @@ public:
     bool SetMassChangeThreshold(double starMassChangeThreshold);
     bool SetTolerateJumps(bool enable, double threshold);
     bool SetSearchRegion(int searchRegion);
+    bool GetAdaptiveSearchRegion() const;
+    void SetAdaptiveSearchRegion(bool enable);
     bool RefineOffset(const usImage *pImage, GuiderOffset* pOffset);
 
     friend class GuiderMultiStarConfigDialogPane;
@@ -128,6 +136,7 @@ public:
     bool AutoSelect(const wxRect& roi) override;
     const PHD_Point& CurrentPosition() const override;
     wxRect GetBoundingBox() const override;
+    void GetSearchWindows(std::vector<wxRect> *windows) const override;
     int GetMaxMovePixels() const override;
     const Star& PrimaryStar() const override;
     bool GetMultiStarMode() const override;
@@ -148,6 +157,9 @@ private:
     bool UpdateCurrentPosition(const usImage *pImage, GuiderOffset *ofs, FrameDroppedInfo *errorInfo) final;
     bool SetCurrentPosition(const usImage *pImage, const PHD_Point& position) final;
 
+    int PredictedSearchRegion(PHD_Point *center) const;
+    wxRect PrimaryBoundingBox() const;
+
     void OnLClick(wxMouseEvent& evt);
 
     void SaveStarFITS();
@@ -167,6 +179,12 @@ GuiderMultiStar::PrimaryStar() const
     return m_primaryStar;
 }
 
+inline bool
+GuiderMultiStar::GetAdaptiveSearchRegion() const
+{
+    return m_adaptiveSearchRegion;
+}
+
 inline bool
 GuiderMultiStar::GetMultiStarMode() const
 {
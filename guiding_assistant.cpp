@@ -65,6 +65,11 @@ struct GADetails
     wxString DecCorrectedRMS;
     wxString RecRAMinMove;
     wxString RecDecMinMove;
+    wxString RAPeriodicError;
+    wxString DecPeriodicError;
+    wxString SeeingBandwidth;
+    wxString SpectralExposure;
+    wxString SpectralAggressiveness;
     std::vector<double> BLTNorthMoves;
     std::vector<double> BLTSouthMoves;
     int BLTMsmtPulse;
@@ -174,6 +179,7 @@ struct GuidingAsstWin : public wxDialog
     wxGrid *m_statusgrid;
     wxGrid *m_displacementgrid;
     wxGrid *m_othergrid;
+    wxGrid *m_spectrumgrid;
     wxFlexGridSizer *m_recommendgrid;
     wxBoxSizer *m_vSizer;
     wxStaticBoxSizer *m_recommend_group;
@@ -200,6 +206,11 @@ struct GuidingAsstWin : public wxDialog
     wxGridCellCoords m_pae_loc;
     wxGridCellCoords m_ra_peak_drift_loc;
     wxGridCellCoords m_backlash_loc;
+    wxGridCellCoords m_ra_pe_loc;
+    wxGridCellCoords m_dec_pe_loc;
+    wxGridCellCoords m_seeing_bw_loc;
+    wxGridCellCoords m_spectral_exp_loc;
+    wxGridCellCoords m_aggressiveness_loc;
     wxButton *m_raMinMoveButton;
     wxButton *m_decMinMoveButton;
     wxButton *m_decBacklashButton;
@@ -228,9 +239,18 @@ struct GuidingAsstWin : public wxDialog
     DescriptiveStats m_hpfRAStats;
     DescriptiveStats m_lpfRAStats;
     DescriptiveStats m_hpfDecStats;
-    AxisStats m_decAxisStats;
-    AxisStats m_raAxisStats;
+    DescriptiveStats m_decStats;    // raw Dec positions, for the peak deflection and overall sigma
+    LinearFitStats m_decDriftStats; // Dec drift over the whole run
+    WindowedAxisStats m_decWindowStats;     // Dec positions of the most recent measurement window, for the seeing estimate
+    double m_decWindowEnd;          // end time of the last window evaluated
+    double m_decBestEstimate;       // smallest Dec sigma of the windows evaluated so far
+    double m_decBestSlope;
+    double m_decBestRSquared;
+    DescriptiveStats m_raStats;     // raw RA positions, only the peak deflection is needed
     long m_axisTimebase;
+    SpectrumEstimator m_raSpectrum;
+    SpectrumEstimator m_decSpectrum;
+    double m_firstTime;
     HighPassFilter m_raHPF;
     LowPassFilter m_raLPF;
     HighPassFilter m_decHPF;
@@ -288,6 +308,7 @@ struct GuidingAsstWin : public wxDialog
                         double asVal, const wxString& units1, const wxString& units2,
                         const wxString& extraInfo = wxEmptyString);
     void UpdateInfo(const GuideStepInfo& info);
+    void UpdateSpectralAnalysis(double samplePeriod);
     void DisplayStaticResults(const GADetails& details);
     void FillInstructions(DialogState eState);
     void MakeRecommendations();
@@ -300,9 +321,13 @@ struct GuidingAsstWin : public wxDialog
     void LoadGAResults(const wxString& TimeStamp, GADetails* Details);
     void SaveGAResults(const wxString* AllRecommendations);
     int GetGAHistoryCount();
+    void UpdateDecWindow(double DeltaTime, double DecPos);
+    void EvaluateDecWindow();
     void GetMinMoveRecs(double& RecRA, double& RecDec);
     bool LikelyBacklash(const CalibrationDetails& calDetails);
     const int MAX_GA_HISTORY = 3;
+    const int MEASUREMENT_WINDOW_SIZE = 120;     // seconds
+    const int WINDOW_ADJUSTMENT = MEASUREMENT_WINDOW_SIZE / 2;
 };
 
 static void HighlightCell(wxGrid *pGrid, wxGridCellCoords where)
@@ -351,11 +376,13 @@ GuidingAsstWin::GuidingAsstWin()
     // m_vSizer has {instructions, vResultsSizer, m_gaStatus, btnSizer}
     // vResultsSizer has {hTopSizer, hBottomSizer}
     // hTopSizer has {status_group, displacement_group}
-    // hBottomSizer has {other_group, m_recommendation_group}
+    // hBottomSizer has {vBottomLeftSizer, m_recommendation_group}
+    // vBottomLeftSizer has {other_group, spectrum_group}
     m_vSizer = new wxBoxSizer(wxVERTICAL);
     wxBoxSizer* vResultsSizer = new wxBoxSizer(wxVERTICAL);
     wxBoxSizer* hTopSizer = new wxBoxSizer(wxHORIZONTAL);       // Measurement status and high-frequency results
     wxBoxSizer* hBottomSizer = new wxBoxSizer(wxHORIZONTAL);             // Low-frequency results and recommendations
+    wxBoxSizer* vBottomLeftSizer = new wxBoxSizer(wxVERTICAL);          // Low-frequency and spectral results
 
     m_instructions = new wxStaticText(this, wxID_ANY, wxEmptyString, wxDefaultPosition, wxSize(700, 50), wxALIGN_LEFT | wxST_NO_AUTORESIZE);
     MakeBold(m_instructions);
@@ -484,9 +511,48 @@ GuidingAsstWin::GuidingAsstWin()
     m_othergrid->AutoSizeRows();
 
     other_group->Add(m_othergrid);
-    hBottomSizer->Add(other_group, wxSizerFlags(0).Border(wxALL, 8));
+    vBottomLeftSizer->Add(other_group, wxSizerFlags(0).Border(wxALL, 8));
     // End of peak and drift group
 
+    // Start of frequency analysis group
+    wxStaticBoxSizer *spectrum_group = new wxStaticBoxSizer(wxVERTICAL, this, _("Frequency Analysis"));
+    m_spectrumgrid = new wxGrid(this, wxID_ANY);
+    m_spectrumgrid->CreateGrid(5, 2);
+    m_spectrumgrid->GetGridWindow()->Bind(wxEVT_MOTION, &GuidingAsstWin::OnMouseMove, this, wxID_ANY, wxID_ANY, new GridTooltipInfo(m_spectrumgrid, 4));
+    m_spectrumgrid->SetRowLabelSize(1);
+    m_spectrumgrid->SetColLabelSize(1);
+    m_spectrumgrid->EnableEditing(false);
+    m_spectrumgrid->SetDefaultColSize(minLeftCol);
+
+    row = 0;
+    col = 0;
+    m_spectrumgrid->SetCellValue(row, col++, w.Wrap(_("Right ascension Periodic Error")));
+    m_ra_pe_loc.Set(row, col++);
+
+    StartRow(row, col);
+    m_spectrumgrid->SetCellValue(row, col++, w.Wrap(_("Declination Periodic Error")));
+    m_dec_pe_loc.Set(row, col++);
+
+    StartRow(row, col);
+    m_spectrumgrid->SetCellValue(row, col++, w.Wrap(_("Seeing-limited above")));
+    m_seeing_bw_loc.Set(row, col++);
+
+    StartRow(row, col);
+    m_spectrumgrid->SetCellValue(row, col++, w.Wrap(_("Longest useful exposure")));
+    m_spectral_exp_loc.Set(row, col++);
+
+    StartRow(row, col);
+    m_spectrumgrid->SetCellValue(row, col++, w.Wrap(_("Aggressiveness")));
+    m_aggressiveness_loc.Set(row, col++);
+
+    m_spectrumgrid->AutoSizeColumn(0);
+    m_spectrumgrid->AutoSizeRows();
+
+    spectrum_group->Add(m_spectrumgrid);
+    vBottomLeftSizer->Add(spectrum_group, wxSizerFlags(0).Border(wxALL, 8));
+    hBottomSizer->Add(vBottomLeftSizer);
+    // End of frequency analysis group
+
     // Start of Recommendations group - just a place-holder for layout, populated in MakeRecommendations
     m_recommend_group = new wxStaticBoxSizer(wxVERTICAL, this, _("Recommendations"));
     m_recommendgrid = new wxFlexGridSizer(2, 0, 0);
@@ -605,8 +671,16 @@ void GuidingAsstWin::StatsReset()
     m_hpfRAStats.ClearAll();
     m_lpfRAStats.ClearAll();
     m_hpfDecStats.ClearAll();
-    m_decAxisStats.ClearAll();
-    m_raAxisStats.ClearAll();
+    m_decStats.ClearAll();
+    m_decDriftStats.ClearAll();
+    m_decWindowStats.ClearAll();
+    m_decWindowEnd = 0;
+    m_decBestEstimate = 1000;
+    m_decBestSlope = 0;
+    m_decBestRSquared = 0;
+    m_raStats.ClearAll();
+    m_raSpectrum.ClearAll();
+    m_decSpectrum.ClearAll();
 }
 
 static bool GetGridToolTip(int gridNum, const wxGridCellCoords& coords, wxString *s)
@@ -646,6 +720,13 @@ static bool GetGridToolTip(int gridNum, const wxGridCellCoords& coords, wxString
         case 307: *s = _("Estimated declination backlash if test was completed. Results are time to clear backlash (ms) and corresponding gear angle (arc-sec). Uncertainty estimate is one unit of standard deviation"); break;
         case 308: *s = _("Estimate of polar alignment error. If the scope declination is unknown, the value displayed is a lower bound and the actual error may be larger."); break;
 
+        // frequency analysis grid
+        case 400: *s = _("Strongest periodic motion in right ascension, usually worm gear periodic error. Shown as the period and the amplitude of the equivalent sine wave."); break;
+        case 401: *s = _("Strongest periodic motion in declination, if any. Shown as the period and the amplitude of the equivalent sine wave."); break;
+        case 402: *s = _("Star motion faster than this is dominated by seeing rather than by the mount; guiding cannot correct it."); break;
+        case 403: *s = _("Longest exposure time that still samples the correctable mount motion at least four times per cycle."); break;
+        case 404: *s = _("Share of the star motion that is slow enough to correct. A low value means seeing dominates and the guide algorithm should be less aggressive."); break;
+
         default: return false;
     }
 
@@ -945,6 +1026,12 @@ void GuidingAsstWin::LogResults()
         m_othergrid->GetCellValue(m_pae_loc));
     GuideLog.NotifyGAResult(str);
     Debug.Write(str);
+    str = wxString::Format("RA Periodic Error=%s, Dec Periodic Error=%s, Seeing-limited above=%s, Longest useful Exp=%s, Aggressiveness=%s\n",
+        m_spectrumgrid->GetCellValue(m_ra_pe_loc), m_spectrumgrid->GetCellValue(m_dec_pe_loc),
+        m_spectrumgrid->GetCellValue(m_seeing_bw_loc), m_spectrumgrid->GetCellValue(m_spectral_exp_loc),
+        m_spectrumgrid->GetCellValue(m_aggressiveness_loc));
+    GuideLog.NotifyGAResult(str);
+    Debug.Write(str);
 }
 
 // Get info regarding any saved GA sessions that include a BLT
@@ -1017,6 +1104,11 @@ void GuidingAsstWin::SaveGAResults(const wxString* AllRecommendations)
     pConfig->Profile.SetString(prefix + "/dec_drift_rate", m_othergrid->GetCellValue(m_dec_drift_loc));
     pConfig->Profile.SetString(prefix + "/dec_peak", m_othergrid->GetCellValue(m_dec_peak_loc));
     pConfig->Profile.SetString(prefix + "/pa_error", m_othergrid->GetCellValue(m_pae_loc));
+    pConfig->Profile.SetString(prefix + "/ra_periodic_error", m_spectrumgrid->GetCellValue(m_ra_pe_loc));
+    pConfig->Profile.SetString(prefix + "/dec_periodic_error", m_spectrumgrid->GetCellValue(m_dec_pe_loc));
+    pConfig->Profile.SetString(prefix + "/seeing_bandwidth", m_spectrumgrid->GetCellValue(m_seeing_bw_loc));
+    pConfig->Profile.SetString(prefix + "/spectral_exposure", m_spectrumgrid->GetCellValue(m_spectral_exp_loc));
+    pConfig->Profile.SetString(prefix + "/spectral_aggressiveness", m_spectrumgrid->GetCellValue(m_aggressiveness_loc));
     pConfig->Profile.SetString(prefix + "/dec_corrected_rms", std::to_string(decCorrectedRMS));
     pConfig->Profile.SetString(prefix + "/backlash_info", m_othergrid->GetCellValue(m_backlash_loc));
     pConfig->Profile.SetString(prefix + "/dec_lf_drift_rate", std::to_string(decDriftPerMin));
@@ -1074,6 +1166,11 @@ void GuidingAsstWin::LoadGAResults(const wxString& TimeStamp, GADetails* Details
     Details->DecDriftRate = pConfig->Profile.GetString(prefix + "/dec_drift_rate", wxEmptyString);
     Details->DecPeak = pConfig->Profile.GetString(prefix + "/dec_peak", wxEmptyString);
     Details->PAError = pConfig->Profile.GetString(prefix + "/pa_error", wxEmptyString);
+    Details->RAPeriodicError = pConfig->Profile.GetString(prefix + "/ra_periodic_error", wxEmptyString);
+    Details->DecPeriodicError = pConfig->Profile.GetString(prefix + "/dec_periodic_error", wxEmptyString);
+    Details->SeeingBandwidth = pConfig->Profile.GetString(prefix + "/seeing_bandwidth", wxEmptyString);
+    Details->SpectralExposure = pConfig->Profile.GetString(prefix + "/spectral_exposure", wxEmptyString);
+    Details->SpectralAggressiveness = pConfig->Profile.GetString(prefix + "/spectral_aggressiveness", wxEmptyString);
     Details->DecCorrectedRMS = pConfig->Profile.GetString(prefix + "/dec_corrected_rms", wxEmptyString);
     Details->BackLashInfo = pConfig->Profile.GetString(prefix + "/backlash_info", wxEmptyString);
     Details->Dec_LF_DriftRate = pConfig->Profile.GetString(prefix + "/dec_lf_drift_rate", wxEmptyString);
@@ -1110,83 +1207,82 @@ void GuidingAsstWin::LoadGAResults(const wxString& TimeStamp, GADetails* Details
 // Compute a drift-corrected value for Dec RMS and use that as a seeing estimate.  For long GA runs, compute values for overlapping
 // 2-minute intervals and use the smallest result
 // Perform suitable sanity checks, revert to default "smart" recommendations if things look wonky
+// Add a Dec position to the window used for the seeing estimate.  Windows of 2 minutes elapsed time, each starting 1 minute
+// after the previous one, are evaluated as they complete, so only the current window is kept however long the GA runs.
+// A run of up to 1.2 windows is evaluated as a whole, so the window isn't trimmed before that
+void GuidingAsstWin::UpdateDecWindow(double DeltaTime, double DecPos)
+{
+    m_decWindowStats.AddGuideInfo(DeltaTime, DecPos, 0);
+    if (DeltaTime > 1.2 * MEASUREMENT_WINDOW_SIZE)
+    {
+        while (m_decWindowStats.GetCount() > 2 && DeltaTime - m_decWindowStats.GetEntry(1).DeltaTime >= MEASUREMENT_WINDOW_SIZE)
+            m_decWindowStats.RemoveOldestEntry();
+    }
+    if (DeltaTime - m_decWindowStats.GetEntry(0).DeltaTime >= MEASUREMENT_WINDOW_SIZE && DeltaTime - m_decWindowEnd >= WINDOW_ADJUSTMENT)
+        EvaluateDecWindow();
+}
+
+// Keep track of the minimum Dec sigma over the windows
+void GuidingAsstWin::EvaluateDecWindow()
+{
+    double tStart = m_decWindowStats.GetEntry(0).DeltaTime;
+    double tEnd = m_decWindowStats.GetLastEntry().DeltaTime;
+    if (m_decWindowStats.GetCount() > 1)
+    {
+        double slope;
+        double intcpt;
+        double correctedRMS;
+        double simpleSigma = m_decWindowStats.GetSigma();
+        double rSquared = m_decWindowStats.GetLinearFitResults(&slope, &intcpt, &correctedRMS);
+        // If there is little drift relative to the random movements, the drift-correction is irrelevant and can actually degrade the result.  So don't use the drift-corrected
+        // RMS unless it's smaller than the simple sigma
+        if (correctedRMS < simpleSigma)
+        {
+            if (correctedRMS < m_decBestEstimate)            // Keep track of the smallest value seen
+            {
+                m_decBestEstimate = correctedRMS;
+                m_decBestRSquared = rSquared;
+                m_decBestSlope = slope;
+            }
+        }
+        else
+            m_decBestEstimate = wxMin(m_decBestEstimate, simpleSigma);
+        Debug.Write(wxString::Format("GA long series, window start=%0.0f, window end=%0.0f, Uncorrected RMS=%0.3f, Drift=%0.3f, Corrected RMS=%0.3f, R-sq=%0.3f\n",
+            tStart, tEnd, simpleSigma, slope * 60, correctedRMS, rSquared));
+    }
+    m_decWindowEnd = tEnd;
+}
+
 void GuidingAsstWin::GetMinMoveRecs(double& RecRA, double&RecDec)
 {
-    AxisStats decVals;
     double bestEstimate = 1000;
     double slope = 0;
     double intcpt = 0;
     double rSquared = 0;
-    double selRSquared = 0;
-    double selSlope = 0;
     double correctedRMS;
-    const int MEASUREMENT_WINDOW_SIZE = 120;     // seconds
-    const int WINDOW_ADJUSTMENT = MEASUREMENT_WINDOW_SIZE / 2;
 
-    int lastInx = m_decAxisStats.GetCount() - 1;
     double pxscale = pFrame->GetCameraPixelScale();
-    StarDisplacement val = m_decAxisStats.GetEntry(0);
-    double tStart = val.DeltaTime;
     double multiplier_ra;                                           // 65% of Dec recommendation, but 100% for encoder mounts
     double multiplier_dec = (pxscale < 1.5) ? 1.28 : 1.65;          // 20% or 10% activity target based on normal distribution
     double minMoveFloor = 0.1;
 
     try
     {
-        if (m_decAxisStats.GetLastEntry().DeltaTime - tStart > 1.2 * MEASUREMENT_WINDOW_SIZE)           //Long GA run, more than 2.4 minutes
+        if (m_decWindowStats.GetLastEntry().DeltaTime > 1.2 * MEASUREMENT_WINDOW_SIZE)           //Long GA run, more than 2.4 minutes
         {
-            bool done = false;
-            int inx = 0;
-            while (!done)
-            {
-                val = m_decAxisStats.GetEntry(inx);
-                decVals.AddGuideInfo(val.DeltaTime, val.StarPos, 0);
-                // Compute the minimum sigma for sliding, overlapping 2-min elapsed time intervals. Include the final interval if it's >= 1.6 minutes
-                if (val.DeltaTime - tStart >= MEASUREMENT_WINDOW_SIZE || (inx == lastInx && val.DeltaTime - tStart >= 0.8 * MEASUREMENT_WINDOW_SIZE))
-                {
-                    if (decVals.GetCount() > 1)
-                    {
-                        double simpleSigma = decVals.GetSigma();
-                        rSquared = decVals.GetLinearFitResults(&slope, &intcpt, &correctedRMS);
-                        // If there is little drift relative to the random movements, the drift-correction is irrelevant and can actually degrade the result.  So don't use the drift-corrected
-                        // RMS unless it's smaller than the simple sigma
-                        if (correctedRMS < simpleSigma)
-                        {
-                            if (correctedRMS < bestEstimate)            // Keep track of the smallest value seen
-                            {
-                                bestEstimate = correctedRMS;
-                                selRSquared = rSquared;
-                                selSlope = slope;
-                            }
-                        }
-                        else
-                            bestEstimate = wxMin(bestEstimate, simpleSigma);
-                        Debug.Write(wxString::Format("GA long series, window start=%0.0f, window end=%0.0f, Uncorrected RMS=%0.3f, Drift=%0.3f, Corrected RMS=%0.3f, R-sq=%0.3f\n",
-                            tStart, val.DeltaTime, simpleSigma, slope * 60, correctedRMS, rSquared));
-                    }
-                    // Move the start of the next window earlier by 1 minute
-                    double targetTime = val.DeltaTime - WINDOW_ADJUSTMENT;
-                    while (m_decAxisStats.GetEntry(inx).DeltaTime > targetTime)
-                        inx--;
-                    tStart = m_decAxisStats.GetEntry(inx).DeltaTime;
-
-                    decVals.ClearAll();
-                }
-                else
-                {
-                    inx++;
-                }
-                done = (inx > lastInx);
-            }
+            // The windows were evaluated as they completed, finish with the samples since the last one
+            if (m_decWindowStats.GetLastEntry().DeltaTime > m_decWindowEnd)
+                EvaluateDecWindow();
+            bestEstimate = m_decBestEstimate;
             Debug.Write(wxString::Format("Full uncorrected RMS=%0.3fpx, Selected Dec drift=%0.3f px/min, Best seeing estimate=%0.3fpx, R-sq=%0.3f\n",
-                m_decAxisStats.GetSigma(), selSlope * 60, bestEstimate, selRSquared));
+                m_decStats.GetSigma(), m_decBestSlope * 60, bestEstimate, m_decBestRSquared));
         }
-        else         // Normal GA run of <= 2.4 minutes, just use the entire interval for stats
+        else         // Normal GA run of <= 2.4 minutes, the window holds the entire interval so just use it for stats
         {
-            if (m_decAxisStats.GetCount() > 1)
+            if (m_decWindowStats.GetCount() > 1)
             {
-                double simpleSigma = m_decAxisStats.GetSigma();
-                rSquared = m_decAxisStats.GetLinearFitResults(&slope, &intcpt, &correctedRMS);
+                double simpleSigma = m_decWindowStats.GetSigma();
+                rSquared = m_decWindowStats.GetLinearFitResults(&slope, &intcpt, &correctedRMS);
                 // If there is little drift relative to the random movements, the drift-correction is irrelevant and can actually degrade the result.  So don't use the drift-corrected
                 // RMS unless it's smaller than the simple sigma
                 if (correctedRMS < simpleSigma)
@@ -1219,7 +1315,7 @@ void GuidingAsstWin::GetMinMoveRecs(double& RecRA, double&RecDec)
         else
         {
             // Just reiterate the estimates made in the new-profile-wiz
-            RecDec = GuideAlgorithm::SmartDefaultMinMove(pFrame->GetFocalLength(), pCamera->GetCameraPixelSize(), pCamera->Binning);
+            RecDec = GuideAlgorithm::SmartDefaultMinMove(pFrame->GetFocalLength(), pCamera->GetCameraPixelSize(), pCamera->EffectiveBinning());
             RecRA = wxMax(minMoveFloor, RecDec * multiplier_ra);
             Debug.Write(wxString::Format("GA Min-Move calcs failed sanity-check, DecEst=%0.3f, Dec-HPF-Sigma=%0.3f\n", roundUpEst, m_hpfDecStats.GetSigma()));
             Debug.Write(wxString::Format("GA Min-Move recs reverting to smart defaults, RA=%0.3f, Dec=%0.3f\n", RecRA, RecDec));
@@ -1229,7 +1325,7 @@ void GuidingAsstWin::GetMinMoveRecs(double& RecRA, double&RecDec)
     {
         Debug.Write("Exception thrown in GA min-move calcs: " + msg + "\n");
         // Punt by reiterating estimates made by new-profile-wiz
-        RecDec = GuideAlgorithm::SmartDefaultMinMove(pFrame->GetFocalLength(), pCamera->GetCameraPixelSize(), pCamera->Binning);
+        RecDec = GuideAlgorithm::SmartDefaultMinMove(pFrame->GetFocalLength(), pCamera->GetCameraPixelSize(), pCamera->EffectiveBinning());
         RecRA = RecDec * multiplier_ra / multiplier_dec;
         Debug.Write(wxString::Format("GA Min-Move recs reverting to smart defaults, RA=%0.3f, Dec=%0.3f\n", RecRA, RecDec));
     }
@@ -1337,7 +1433,7 @@ void GuidingAsstWin::MakeRecommendations()
     m_exposure_msg = AddRecommendationMsg(msg);
     Debug.Write(wxString::Format("Recommendation: %s\n", msg));
     // Binning opportunity if image scale is < 0.5
-    if (pxscale <= 0.5 && pCamera->Binning == 1 && pCamera->MaxBinning > 1)
+    if (pxscale <= 0.5 && pCamera->EffectiveBinning() == 1)
     {
         wxString msg = _("Try binning your guide camera");
         allRecommendations += "Bin:" + msg + "\n";
@@ -1580,6 +1676,15 @@ void GuidingAsstWin::OnStart(wxCommandEvent& event)
     m_raHPF = HighPassFilter(hp_cutoff, exposure);
     m_raLPF = LowPassFilter(lp_cutoff, exposure);
     m_decHPF = HighPassFilter(hp_cutoff, exposure);
+    // Spectral segments span about half an hour so several worm cycles fit in each one
+    unsigned int segmentLength = (unsigned int) std::min(2048.0, std::max(128.0, 1800.0 / std::max(exposure, 0.1)));
+    m_raSpectrum = SpectrumEstimator(segmentLength);
+    m_decSpectrum = SpectrumEstimator(segmentLength);
+    m_spectrumgrid->SetCellValue(m_ra_pe_loc, wxEmptyString);
+    m_spectrumgrid->SetCellValue(m_dec_pe_loc, wxEmptyString);
+    m_spectrumgrid->SetCellValue(m_seeing_bw_loc, wxEmptyString);
+    m_spectrumgrid->SetCellValue(m_spectral_exp_loc, wxEmptyString);
+    m_spectrumgrid->SetCellValue(m_aggressiveness_loc, wxEmptyString);
 
     sumSNR = sumMass = 0.0;
 
@@ -1830,6 +1935,11 @@ void GuidingAsstWin::DisplayStaticResults(const GADetails& details)
     m_othergrid->SetCellValue(m_dec_drift_loc, details.DecDriftRate);
     m_othergrid->SetCellValue(m_backlash_loc, details.BackLashInfo);
     m_othergrid->SetCellValue(m_pae_loc, details.PAError);
+    m_spectrumgrid->SetCellValue(m_ra_pe_loc, details.RAPeriodicError);
+    m_spectrumgrid->SetCellValue(m_dec_pe_loc, details.DecPeriodicError);
+    m_spectrumgrid->SetCellValue(m_seeing_bw_loc, details.SeeingBandwidth);
+    m_spectrumgrid->SetCellValue(m_spectral_exp_loc, details.SpectralExposure);
+    m_spectrumgrid->SetCellValue(m_aggressiveness_loc, details.SpectralAggressiveness);
 
     if (details.Recommendations.size() > 0)
         DisplayStaticRecommendations(details);
@@ -1857,15 +1967,21 @@ void GuidingAsstWin::UpdateInfo(const GuideStepInfo& info)
         prevRAlpf = newRAlpf;
     m_lpfRAStats.AddValue(newRAlpf);
     m_hpfDecStats.AddValue(m_decHPF.AddValue(dec));
-    if (m_decAxisStats.GetCount() == 0)
+    if (m_decStats.GetCount() == 0)
         m_axisTimebase = wxGetCurrentTime();
-    m_decAxisStats.AddGuideInfo(wxGetCurrentTime() - m_axisTimebase, dec, 0);
-    m_raAxisStats.AddGuideInfo(wxGetCurrentTime() - m_axisTimebase, ra, 0);
+    double decTime = wxGetCurrentTime() - m_axisTimebase;
+    m_decStats.AddValue(dec);
+    m_decDriftStats.AddValues(decTime, dec);
+    UpdateDecWindow(decTime, dec);
+    m_raStats.AddValue(ra);
+    bool newSpectrum = m_raSpectrum.AddValue(ra);
+    newSpectrum = m_decSpectrum.AddValue(dec) || newSpectrum;
 
     // Compute the maximum interval RA movement rate using low-passed-filtered data
     if (m_lpfRAStats.GetCount() == 1)
     {
         m_startPos = info.mountOffset;
+        m_firstTime = info.time;
         maxRateRA = 0.0;
     }
     else
@@ -1919,7 +2035,7 @@ void GuidingAsstWin::UpdateInfo(const GuideStepInfo& info)
         // polar alignment error from Barrett:
         // http://celestialwonders.com/articles/polaralignment/PolarAlignmentAccuracy.pdf
         double intcpt;
-        m_decAxisStats.GetLinearFitResults(&decDriftPerMin, &intcpt);
+        m_decDriftStats.GetLinearFitResults(&decDriftPerMin, &intcpt);
         decDriftPerMin = 60.0 * decDriftPerMin;
         alignmentError = 3.8197 * fabs(decDriftPerMin) * pxscale / cosdec;
 
@@ -1928,9 +2044,9 @@ void GuidingAsstWin::UpdateInfo(const GuideStepInfo& info)
         FillResultCell(m_displacementgrid, m_dec_rms_loc, decrms, decrms * pxscale, PX, ARCSEC);
         FillResultCell(m_displacementgrid, m_total_rms_loc, combined, combined * pxscale, PX, ARCSEC);
         FillResultCell(m_othergrid, m_ra_peak_loc,
-            m_raAxisStats.GetMaxDelta(), m_raAxisStats.GetMaxDelta() * pxscale, PX, ARCSEC);
+            m_raStats.GetMaxDelta(), m_raStats.GetMaxDelta() * pxscale, PX, ARCSEC);
         FillResultCell(m_othergrid, m_dec_peak_loc,
-            m_decAxisStats.GetMaxDelta(), m_decAxisStats.GetMaxDelta() * pxscale, PX, ARCSEC);
+            m_decStats.GetMaxDelta(), m_decStats.GetMaxDelta() * pxscale, PX, ARCSEC);
         double raPkPk = m_lpfRAStats.GetMaximum() - m_lpfRAStats.GetMinimum();
         FillResultCell(m_othergrid, m_ra_peakpeak_loc, raPkPk, raPkPk * pxscale, PX, ARCSEC);
         double raDriftRate = (ra - m_startPos.X) / m_elapsedSecs * 60.0;            // Raw max-min, can't smooth this one reliably
@@ -1940,8 +2056,70 @@ void GuidingAsstWin::UpdateInfo(const GuideStepInfo& info)
             wxString::Format("%6.1f %s ", 1.3 * rarms / maxRateRA, SEC));              // Will get revised when min-move is computed
         FillResultCell(m_othergrid, m_dec_drift_loc, decDriftPerMin, decDriftPerMin * pxscale, PXPERMIN, ARCSECPERMIN);
         m_othergrid->SetCellValue(m_pae_loc, wxString::Format("%s %.1f %s", declination == UNKNOWN_DECLINATION ? "> " : "", alignmentError, ARCMIN));
+
+        if (newSpectrum && info.time > m_firstTime)
+            UpdateSpectralAnalysis((info.time - m_firstTime) / (n - 1));
+    }
+
+}
+
+// Interpret the running RA and Dec power spectra: periodic error, the frequency above which seeing dominates, and the exposure
+// time and aggressiveness that suit the correctable part of the motion
+void GuidingAsstWin::UpdateSpectralAnalysis(double samplePeriod)
+{
+    // Shortest period searched for periodic error, seconds
+    const double MIN_PE_PERIOD = 30.0;
+    // Density above the seeing floor that marks motion the mount could correct
+    const double CORNER_FACTOR = 2.0;
+
+    wxString SEC(_("s"));
+    wxString PX(_("px"));
+    wxString ARCSEC(_("arc-sec"));
+    wxString HZ(_("Hz"));
+    double pxscale = pFrame->GetCameraPixelScale();
+    unsigned int segLen = m_raSpectrum.GetSegmentLength();
+    double binHz = 1.0 / (segLen * samplePeriod);
+
+    // At least two cycles must fit in the samples behind the estimate
+    unsigned int spanned = std::min(m_raSpectrum.GetCount(), segLen);
+    unsigned int firstBin = std::max(2u, (2 * segLen + spanned - 1) / spanned);
+    unsigned int lastBin = (unsigned int) (segLen * samplePeriod / MIN_PE_PERIOD);
+
+    SpectrumEstimator *spectra[] = { &m_raSpectrum, &m_decSpectrum };
+    wxGridCellCoords peLocs[] = { m_ra_pe_loc, m_dec_pe_loc };
+    for (int axis = 0; axis < 2; axis++)
+    {
+        double freq, amplitude;
+        if (spectra[axis]->FindPeak(firstBin, lastBin, &freq, &amplitude))
+        {
+            m_spectrumgrid->SetCellValue(peLocs[axis], wxString::Format("%.0f %s, %.2f %s (%.2f %s)",
+                samplePeriod / freq, SEC, amplitude, PX, amplitude * pxscale, ARCSEC));
+        }
+        else
+            m_spectrumgrid->SetCellValue(peLocs[axis], _("None found"));
     }
 
+    unsigned int raCorner = m_raSpectrum.GetCornerBin(CORNER_FACTOR);
+    unsigned int decCorner = m_decSpectrum.GetCornerBin(CORNER_FACTOR);
+    double cornerHz = std::max(raCorner, decCorner) * binHz;
+    m_spectrumgrid->SetCellValue(m_seeing_bw_loc, wxString::Format("%.3f %s (%.0f %s)", cornerHz, HZ, 1.0 / cornerHz, SEC));
+
+    // Sample the correctable band at least 4 times per cycle, rounded down to the nearest 0.5 sec
+    double exposure = std::min(std::max(floor(2.0 / (4.0 * cornerHz)) * 0.5, 1.0), 10.0);
+    m_spectrumgrid->SetCellValue(m_spectral_exp_loc, wxString::Format("%.1f %s", exposure, SEC));
+
+    // Aggressiveness follows the share of the variance that lies below the corner, in 5% steps
+    double aggr[2];
+    unsigned int corners[] = { raCorner, decCorner };
+    for (int axis = 0; axis < 2; axis++)
+    {
+        unsigned int nyquistBin = spectra[axis]->GetBinCount() - 1;
+        double correctable = spectra[axis]->GetBandVariance(1, corners[axis] - 1);
+        double seeing = spectra[axis]->GetBandVariance(corners[axis], nyquistBin);
+        double share = correctable + seeing > 0.0 ? correctable / (correctable + seeing) : 1.0;
+        aggr[axis] = std::min(std::max(round(share * 20.0) * 5.0, 30.0), 100.0);
+    }
+    m_spectrumgrid->SetCellValue(m_aggressiveness_loc, wxString::Format(_("RA %.0f%%, Dec %.0f%%"), aggr[0], aggr[1]));
 }
 
 wxWindow *GuidingAssistant::CreateDialogBox()
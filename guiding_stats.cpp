@@ -36,6 +36,7 @@
 #include "phd.h"
 #include <math.h>
 #include <algorithm>
+#include <limits>
 #include "guiding_stats.h"
 
 // Descriptive stats and axial stats classes
@@ -183,6 +184,58 @@ double DescriptiveStats::GetMaxDelta()
         return 0.;
 }
 
+// LinearFitStats does a least-squares line fit on-the-fly, without retaining the values.  The sums of the products of deltas
+// from the means are updated with the same Knuth/Welford recurrence as the variance in DescriptiveStats
+LinearFitStats::LinearFitStats()
+{
+    ClearAll();
+}
+
+void LinearFitStats::AddValues(double X, double Y)
+{
+    count++;
+    double dx = X - meanX;
+    double dy = Y - meanY;
+    meanX += dx / count;
+    meanY += dy / count;
+    sumDXSq += dx * (X - meanX);
+    sumDXDY += dx * (Y - meanY);
+    sumDYSq += dy * (Y - meanY);
+}
+
+void LinearFitStats::ClearAll()
+{
+    count = 0;
+    meanX = 0.;
+    meanY = 0.;
+    sumDXSq = 0.;
+    sumDXDY = 0.;
+    sumDYSq = 0.;
+}
+
+unsigned int LinearFitStats::GetCount() const
+{
+    return count;
+}
+
+double LinearFitStats::GetLinearFitResults(double *Slope, double *Intercept) const
+{
+    if (count <= 1 || sumDXSq <= 0.)
+    {
+        *Slope = 0.;
+        *Intercept = count > 0 ? meanY : 0.;
+        return 0.;
+    }
+
+    double slope = sumDXDY / sumDXSq;
+    *Slope = slope;
+    *Intercept = meanY - slope * meanX;
+
+    if (sumDYSq <= 0.)
+        return 0.;
+    return (sumDXDY * sumDXDY) / (sumDXSq * sumDYSq);
+}
+
 // Applies a high-pass filter to a stream of data, one sample point at a time.  Samples are not retained, client can use DescriptiveStats or AxisStats
 // on the filtered data values
 HighPassFilter::HighPassFilter(double CutoffPeriod, double SamplePeriod)
@@ -257,6 +310,108 @@ void LowPassFilter::Reset()
     lpfResult = 0.;
 }
 
+// OrderStats keeps the values of a dataset sorted, so that order statistics of a windowed dataset
+// can be read without copying and sorting the window each time
+void OrderStats::Insert(double Val)
+{
+    sorted.insert(std::upper_bound(sorted.begin(), sorted.end(), Val), Val);
+}
+
+bool OrderStats::Remove(double Val)
+{
+    auto pos = std::lower_bound(sorted.begin(), sorted.end(), Val);
+    if (pos == sorted.end() || *pos != Val)
+        return false;
+    sorted.erase(pos);
+    return true;
+}
+
+void OrderStats::Clear()
+{
+    sorted.clear();
+}
+
+unsigned int OrderStats::GetCount() const
+{
+    return sorted.size();
+}
+
+double OrderStats::GetElement(unsigned int Rank) const
+{
+    return sorted[Rank];
+}
+
+double OrderStats::GetMinimum() const
+{
+    return sorted.empty() ? 0. : sorted.front();
+}
+
+double OrderStats::GetMaximum() const
+{
+    return sorted.empty() ? 0. : sorted.back();
+}
+
+double OrderStats::GetMedian() const
+{
+    size_t sz = sorted.size();
+
+    if (sz == 0)
+        return 0.;
+
+    size_t ctr = sz / 2;
+    if (sz % 2 == 1)
+        return sorted[ctr];
+    else
+        return (sorted[ctr] + sorted[ctr - 1]) / 2.0;     // even number of entries => take average of two entries adjacent to center
+}
+
+// The absolute deviations from the median form two sorted sequences, the values below the median read
+// backwards and the values above it read forwards, so the k-th smallest deviation is found by a binary
+// search for the split between the two instead of sorting all deviations
+double OrderStats::GetMAD() const
+{
+    size_t sz = sorted.size();
+
+    if (sz == 0)
+        return 0.;
+
+    double med = GetMedian();
+    size_t split = std::lower_bound(sorted.begin(), sorted.end(), med) - sorted.begin();
+    size_t numBelow = split;
+    size_t numAbove = sz - split;
+    auto below = [&](size_t i) { return med - sorted[split - 1 - i]; };
+    auto above = [&](size_t j) { return sorted[split + j] - med; };
+
+    auto kthDeviation = [&](size_t k)
+    {
+        // take i deviations from below and k + 1 - i from above
+        size_t lo = k + 1 > numAbove ? k + 1 - numAbove : 0;
+        size_t hi = std::min(k + 1, numBelow);
+        while (lo < hi)
+        {
+            size_t i = (lo + hi) / 2;
+            size_t j = k + 1 - i;
+            if (j > 0 && below(i) < above(j - 1))
+                lo = i + 1;
+            else
+                hi = i;
+        }
+        size_t j = k + 1 - lo;
+        double rslt = 0.;
+        if (lo > 0)
+            rslt = below(lo - 1);
+        if (j > 0)
+            rslt = std::max(rslt, above(j - 1));
+        return rslt;
+    };
+
+    size_t ctr = sz / 2;
+    if (sz % 2 == 1)
+        return kthDeviation(ctr);
+    else
+        return (kthDeviation(ctr) + kthDeviation(ctr - 1)) / 2.0;
+}
+
 // AxisStats, WindowedAxisStats, and the StarDisplacement classes can be
 // used to collect and evaluate typical guiding data.  Windowed datasets
 // will be automatically trimmed if AutoWindowSize > 0 or can be manually
@@ -284,22 +439,75 @@ void AxisStats::ClearAll()
 {
     InitializeScalars();
     guidingEntries.clear();
+    sortedPositions.Clear();
+    deltaMaxima.clear();
 }
 
 void AxisStats::InitializeScalars()
 {
     axisMoves = 0;
     axisReversals = 0;
+    firstSeq = 0;
+    xOrigin = 0.;
     sumY = 0.;
     sumYSq = 0.;
     sumX = 0.;
     sumXY = 0.;
     sumXSq = 0.;
+    removalsSinceResum = 0;
     prevPosition = 0.;
     prevMove = 0.;
-    minDisplacement = std::numeric_limits<double>::max();
-    maxDisplacement = std::numeric_limits<double>::min();
-    maxDelta = 0.;
+}
+
+// Recompute the running sums from the entries, relative to the oldest entry's time
+void AxisStats::RecomputeSums()
+{
+    sumX = sumY = sumXY = sumXSq = sumYSq = 0.;
+    removalsSinceResum = 0;
+
+    if (guidingEntries.empty())
+        return;
+
+    xOrigin = guidingEntries.front().DeltaTime;
+    for (size_t inx = 0; inx < guidingEntries.size(); inx++)
+    {
+        double x = guidingEntries[inx].DeltaTime - xOrigin;
+        double y = guidingEntries[inx].StarPos;
+        sumX += x;
+        sumY += y;
+        sumXY += x * y;
+        sumXSq += x * x;
+        sumYSq += y * y;
+    }
+}
+
+// Remove the oldest entry and update the stats accordingly.  Caller should insure count > 0
+void AxisStats::RemoveFront()
+{
+    const StarDisplacement& target = guidingEntries.front();
+    double x = target.DeltaTime - xOrigin;
+    double val = target.StarPos;
+    sumY -= val;
+    sumYSq -= val * val;
+    sumX -= x;
+    sumXSq -= x * x;
+    sumXY -= x * val;
+    if (target.Reversal)
+        axisReversals--;
+    if (target.Guided)
+        axisMoves--;
+    sortedPositions.Remove(val);
+
+    // the delta between the removed entry and the next one leaves the window
+    while (!deltaMaxima.empty() && deltaMaxima.front().seq <= firstSeq + 1)
+        deltaMaxima.pop_front();
+
+    guidingEntries.pop_front();
+    ++firstSeq;
+
+    // each recomputation costs <n> operations, so doing it every <n> removals keeps removals O(1) on average
+    if (++removalsSinceResum >= guidingEntries.size())
+        RecomputeSums();
 }
 
 // Return number of guide steps where GuideAmount was non-zero
@@ -328,12 +536,15 @@ void AxisStats::AddGuideInfo(double DeltaT, double StarPos, double GuideAmt)
 {
     StarDisplacement starInfo(DeltaT, StarPos);
 
-    minDisplacement = std::min(StarPos, minDisplacement);
-    maxDisplacement = std::max(StarPos, maxDisplacement);
+    if (guidingEntries.empty())
+        xOrigin = DeltaT;
+    double x = DeltaT - xOrigin;
+
+    sortedPositions.Insert(StarPos);
 
-    sumX += DeltaT;
-    sumXY += DeltaT * StarPos;
-    sumXSq += DeltaT * DeltaT;
+    sumX += x;
+    sumXY += x * StarPos;
+    sumXSq += x * x;
     sumYSq += StarPos * StarPos;
     sumY += StarPos;
 
@@ -351,12 +562,13 @@ void AxisStats::AddGuideInfo(double DeltaT, double StarPos, double GuideAmt)
 
     if (guidingEntries.size() > 1)
     {
-        double newDelta = fabs(starInfo.StarPos - prevPosition);
-        if (newDelta >= maxDelta)
-        {
-            maxDelta = newDelta;
-            maxDeltaInx = guidingEntries.size();      // where the entry is going to go - furthest down in list among equals
-        }
+        // keep only the deltas that can still become the maximum, the furthest down in list among equals
+        DeltaEntry entry;
+        entry.seq = firstSeq + guidingEntries.size();
+        entry.delta = fabs(starInfo.StarPos - prevPosition);
+        while (!deltaMaxima.empty() && deltaMaxima.back().delta <= entry.delta)
+            deltaMaxima.pop_back();
+        deltaMaxima.push_back(entry);
     }
 
     guidingEntries.push_back(starInfo);
@@ -379,8 +591,8 @@ double AxisStats::GetMaxDelta() const
 {
     size_t sz = guidingEntries.size();
 
-    if (sz > 1)
-        return maxDelta;
+    if (sz > 1 && !deltaMaxima.empty())
+        return deltaMaxima.front().delta;
     else
         return 0.;
 }
@@ -468,58 +680,26 @@ double AxisStats::GetPopulationSigma() const
 // Return median guidestar displacement. Caller should insure count > 0
 double AxisStats::GetMedian() const
 {
-    size_t sz = guidingEntries.size();
-
-    if (sz > 1)
-    {
-        double rslt = 0.;
-
-        // Need a copy of guidingEntries to do a sort
-        std::vector <double> sortedEntries;
+    return sortedPositions.GetMedian();
+}
 
-        for (auto pGS = guidingEntries.begin(); pGS != guidingEntries.end(); ++pGS)
-        {
-            sortedEntries.push_back(pGS->StarPos);
-        }
-        std::sort(sortedEntries.begin(), sortedEntries.end());
-        size_t ctr = sortedEntries.size() / 2;
-        if (sortedEntries.size() % 2 == 1)
-        {
-            rslt = sortedEntries[ctr];
-        }
-        else
-        {
-            // even number of entries => take average of two entires adjacent to center
-            rslt = (sortedEntries[ctr] + sortedEntries[ctr - 1]) / 2.0;
-        }
-        return rslt;
-    }
-    else if (sz == 1)
-        return guidingEntries[0].StarPos;
-    else
-        return 0.;
+// Return median absolute deviation of the guidestar displacements from their median, a robust measure of spread.
+// Caller should insure count > 0
+double AxisStats::GetMAD() const
+{
+    return sortedPositions.GetMAD();
 }
 
 // Return the minimum (signed) guidestar displacement. Caller should insure count > 0
 double AxisStats::GetMinDisplacement() const
 {
-    size_t sz = guidingEntries.size();
-
-    if (sz > 0)
-        return minDisplacement;
-    else
-        return 0.;
+    return sortedPositions.GetMinimum();
 }
 
 // Return the maximum (signed) guidestar displacement. Caller should insure count > 0
 double AxisStats::GetMaxDisplacement() const
 {
-    size_t sz = guidingEntries.size();
-
-    if (sz > 0)
-        return maxDisplacement;
-    else
-        return 0.;
+    return sortedPositions.GetMaximum();
 }
 
 // Return linear fit results for dataset, windowed or not.  This is inexpensive unless Sigma is needed
@@ -544,7 +724,7 @@ double AxisStats::GetLinearFitResults(double *Slope, double *Intercept, double *
 
     double slope = ((numVals * sumXY) - (sumX * sumY)) / ((numVals * sumXSq) - (sumX * sumX));
     //double constrainedSlope = sumXY / sumXSq;          // Possible future use, slope value if intercept is constrained to be zero
-    double intcpt = (sumY - (slope * sumX)) / numVals;
+    double intcpt = (sumY - (slope * sumX)) / numVals - slope * xOrigin;     // the sums are relative to xOrigin
 
     if (Sigma)
     {
@@ -581,7 +761,7 @@ double AxisStats::GetLinearFitResults(double *Slope, double *Intercept, double *
 WindowedAxisStats::WindowedAxisStats(int AutoWindowSize) : AxisStats()
 {
     autoWindowing = AutoWindowSize > 0;
-    windowSize = AutoWindowSize;
+    windowSize = autoWindowing ? AutoWindowSize : 0;
 }
 
 WindowedAxisStats::~WindowedAxisStats()
@@ -617,82 +797,237 @@ bool WindowedAxisStats::ChangeWindowSize(unsigned int NewSize)
     return success;
 }
 
-// Private function to re-compute min, max, and maxDelta values when a guide
-// entry is going to be removed.  With an auto-windowed instance of
-// AxisStats, an entry removal can happen for every addition, so we avoid
-// iterating through the entire collection unless it's required because of
-// the entry that's being aged out.  This function must be called before
-// entry[0] (the oldest) is actually removed.
-void WindowedAxisStats::AdjustMinMaxValues()
+// Remove oldest entry in the list, update stats accordingly.
+void WindowedAxisStats::RemoveOldestEntry()
 {
-    StarDisplacement target = guidingEntries.front();           // Entry that's about to be removed
-    bool recalNeeded = false;
-    double prev = target.StarPos;
+    if (guidingEntries.size() > 0)
+        RemoveFront();
+}
 
-    if (guidingEntries.size() > 1)
+// DeltaT should be a small number, on the order of a guide exposure time, not a full time-of-day
+void WindowedAxisStats::AddGuideInfo(double DeltaT, double StarPos, double GuideAmt)
+{
+    AxisStats::AddGuideInfo(DeltaT, StarPos, GuideAmt);
+
+    if (autoWindowing && guidingEntries.size() > windowSize)
+    {
+        RemoveOldestEntry();
+    }
+}
+
+// Segment length is rounded up to a power of 2 for the FFT
+SpectrumEstimator::SpectrumEstimator(unsigned int SegmentLength)
+{
+    segmentLength = 16;
+    while (segmentLength < SegmentLength)
+        segmentLength *= 2;
+    samples.resize(segmentLength);
+    work.resize(segmentLength);
+    psd.resize(segmentLength / 2 + 1);
+    ClearAll();
+}
+
+void SpectrumEstimator::ClearAll()
+{
+    std::fill(samples.begin(), samples.end(), 0.);
+    std::fill(psd.begin(), psd.end(), 0.);
+    nextInx = 0;
+    count = 0;
+    sinceUpdate = 0;
+    segments = 0;
+    estimateLength = 0;
+    valid = false;
+}
+
+bool SpectrumEstimator::AddValue(double Val)
+{
+    // Provisional estimates start after a few cycles of the shortest periods and are refreshed often
+    const unsigned int minProvisional = 32;
+    const unsigned int provisionalStep = std::max(8u, segmentLength / 32);
+
+    samples[nextInx] = Val;
+    nextInx = (nextInx + 1) & (segmentLength - 1);
+    count++;
+    sinceUpdate++;
+
+    if (count >= segmentLength)
     {
-        // Minimize recalculations
-        recalNeeded = target.StarPos == maxDisplacement || target.StarPos == minDisplacement || maxDeltaInx == 0;
-        if (recalNeeded)
+        if (count == segmentLength || sinceUpdate >= segmentLength / 2)
         {
-            minDisplacement = std::numeric_limits<double>::max();
-            maxDisplacement = std::numeric_limits<double>::min();
-            maxDelta = 0.;
+            ProcessSegment(segmentLength, false);
+            return true;
         }
     }
+    else if (count >= minProvisional && sinceUpdate >= provisionalStep)
+    {
+        ProcessSegment(count, true);
+        return true;
+    }
+    return false;
+}
 
-    if (recalNeeded)
+// Periodogram of the most recent Length samples, zero-padded to the segment length
+void SpectrumEstimator::ProcessSegment(unsigned int Length, bool Provisional)
+{
+    unsigned int first = (nextInx + segmentLength - Length) & (segmentLength - 1);
+    double sumX = 0., sumY = 0., sumXY = 0., sumXSq = 0.;
+    for (unsigned int i = 0; i < Length; i++)
     {
-        for (auto pGS = guidingEntries.begin() + 1; pGS != guidingEntries.end(); ++pGS)  // Dont start at zero, that will be removed
+        double y = samples[(first + i) & (segmentLength - 1)];
+        sumX += i;
+        sumY += y;
+        sumXY += i * y;
+        sumXSq += (double) i * i;
+    }
+    // Remove the linear trend, drift would otherwise leak into all the low frequency bins
+    double slope = (Length * sumXY - sumX * sumY) / (Length * sumXSq - sumX * sumX);
+    double intcpt = (sumY - slope * sumX) / Length;
+
+    double sumWSq = 0.;
+    for (unsigned int i = 0; i < Length; i++)
+    {
+        double w = 0.5 - 0.5 * cos(2.0 * M_PI * i / Length);
+        double y = samples[(first + i) & (segmentLength - 1)] - (intcpt + slope * i);
+        work[i] = std::complex<double>(w * y, 0.);
+        sumWSq += w * w;
+    }
+    for (unsigned int i = Length; i < segmentLength; i++)
+        work[i] = 0.;
+
+    Transform();
+
+    double weight = 1.0;
+    if (!Provisional)
+    {
+        segments++;
+        weight = 1.0 / std::min(segments, (unsigned int) maxAveraged);
+    }
+    unsigned int nyquist = segmentLength / 2;
+    for (unsigned int k = 0; k <= nyquist; k++)
+    {
+        double p = std::norm(work[k]) / sumWSq;
+        if (k != 0 && k != nyquist)
+            p *= 2.0;                                           // one-sided
+        psd[k] += weight * (p - psd[k]);
+    }
+    sinceUpdate = 0;
+    estimateLength = Length;
+    valid = true;
+}
+
+// In-place iterative radix-2 FFT of the work buffer
+void SpectrumEstimator::Transform()
+{
+    unsigned int n = segmentLength;
+    for (unsigned int i = 1, j = 0; i < n; i++)
+    {
+        unsigned int bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        if (i < j)
+            std::swap(work[i], work[j]);
+    }
+    for (unsigned int len = 2; len <= n; len <<= 1)
+    {
+        std::complex<double> step = std::polar(1.0, -2.0 * M_PI / len);
+        for (unsigned int i = 0; i < n; i += len)
         {
-            StarDisplacement entry = *pGS;
-            minDisplacement = std::min(minDisplacement, entry.StarPos);
-            maxDisplacement = std::max(maxDisplacement, entry.StarPos);
-            if (pGS - guidingEntries.begin() > 1)
+            std::complex<double> w(1.0, 0.);
+            for (unsigned int k = 0; k < len / 2; k++)
             {
-                if (fabs(entry.StarPos - prev) > maxDelta)
-                {
-                    maxDelta = fabs(entry.StarPos - prev);
-                    maxDeltaInx = pGS - guidingEntries.begin();
-                }
+                std::complex<double> u = work[i + k];
+                std::complex<double> v = work[i + k + len / 2] * w;
+                work[i + k] = u + v;
+                work[i + k + len / 2] = u - v;
+                w *= step;
             }
-            prev = entry.StarPos;
         }
     }
 }
 
-// Remove oldest entry in the list, update stats accordingly.
-void WindowedAxisStats::RemoveOldestEntry()
+double SpectrumEstimator::GetPower(unsigned int Bin) const
 {
-    size_t sz = guidingEntries.size();
+    return Bin < psd.size() ? psd[Bin] : 0.;
+}
 
-    if (sz > 0)
+double SpectrumEstimator::GetBandVariance(unsigned int FirstBin, unsigned int LastBin) const
+{
+    double sum = 0.;
+    for (unsigned int k = FirstBin; k <= LastBin && k < psd.size(); k++)
+        sum += psd[k];
+    return sum / segmentLength;
+}
+
+double SpectrumEstimator::GetNoiseFloor(unsigned int FirstBin) const
+{
+    if (FirstBin >= psd.size())
+        return 0.;
+    std::vector<double> upper(psd.begin() + FirstBin, psd.end());
+    std::nth_element(upper.begin(), upper.begin() + upper.size() / 2, upper.end());
+    return upper[upper.size() / 2];
+}
+
+bool SpectrumEstimator::FindPeak(unsigned int FirstBin, unsigned int LastBin, double *Frequency, double *Amplitude) const
+{
+    // The mean density across a peak must stand this far above the median density for the peak to be reported. A single
+    // periodogram, provisional or the first full segment, scatters much more than an average of several and is looked at
+    // after every few samples, so it needs a much larger margin
+    double minContrast = segments > 1 ? 3.0 + 6.0 / std::min(segments, (unsigned int) maxAveraged) : 18.0;
+
+    FirstBin = std::max(FirstBin, 1u);
+    LastBin = std::min(LastBin, (unsigned int) psd.size() - 2);
+    if (!valid || FirstBin > LastBin)
+        return false;
+
+    unsigned int peak = FirstBin;
+    for (unsigned int k = FirstBin + 1; k <= LastBin; k++)
     {
-        StarDisplacement target = guidingEntries.front();
-        double val = target.StarPos;
-        double deltaT = target.DeltaTime;
-        sumY -= val;
-        sumYSq -= val * val;
-        sumX -= deltaT;
-        sumXSq -= deltaT * deltaT;
-        sumXY -= deltaT * val;
-        if (target.Reversal)
-            axisReversals--;
-        if (target.Guided)
-            axisMoves--;
-        AdjustMinMaxValues();                   // Will process list only if required
-        guidingEntries.pop_front();
-        maxDeltaInx--;
+        if (psd[k] > psd[peak])
+            peak = k;
     }
+    // Reject the edges of the search range, the power there may belong to a peak outside it
+    if (psd[peak] <= psd[peak - 1] || psd[peak] <= psd[peak + 1])
+        return false;
+    // The Hann main lobe spans 2 bins either side, more for a zero-padded provisional estimate. Averaging across it keeps
+    // single noisy bins from passing as peaks
+    unsigned int halfWidth = std::max(2u, (2 * segmentLength + estimateLength - 1) / estimateLength);
+    // Near the Nyquist frequency the lobe folds back onto itself and its average is not reliable
+    if (peak + halfWidth > psd.size() - 1)
+        return false;
+    unsigned int lo = peak > halfWidth ? peak - halfWidth : 1;
+    unsigned int hi = std::min(peak + halfWidth, (unsigned int) psd.size() - 1);
+    double lobeVariance = GetBandVariance(lo, hi);
+    if (lobeVariance * segmentLength / (hi - lo + 1) < minContrast * GetNoiseFloor(FirstBin))
+        return false;
+
+    // Parabolic interpolation on the log density, close to exact for the Gaussian-like Hann main lobe
+    double a = log(std::max(psd[peak - 1], 1e-30));
+    double b = log(psd[peak]);
+    double c = log(std::max(psd[peak + 1], 1e-30));
+    double offset = 0.5 * (a - c) / (a - 2.0 * b + c);
+    *Frequency = (peak + offset) / segmentLength;
+
+    *Amplitude = sqrt(2.0 * lobeVariance);
+    return true;
 }
 
-// DeltaT should be a small number, on the order of a guide exposure time, not a full time-of-day
-void WindowedAxisStats::AddGuideInfo(double DeltaT, double StarPos, double GuideAmt)
+unsigned int SpectrumEstimator::GetCornerBin(double Factor) const
 {
-    AxisStats::AddGuideInfo(DeltaT, StarPos, GuideAmt);
-
-    if (autoWindowing && guidingEntries.size() > windowSize)
+    unsigned int nyquist = psd.size() - 1;
+    double floor = GetBandVariance(nyquist / 2, nyquist) * segmentLength / (nyquist - nyquist / 2 + 1);
+    unsigned int corner = nyquist;
+    // Walk down from the Nyquist frequency while the density, averaged over half an octave around each bin, stays near the floor
+    while (corner > 1)
     {
-        RemoveOldestEntry();
+        unsigned int k = corner - 1;
+        unsigned int halfWidth = std::max(2u, k / 4);
+        unsigned int first = k > halfWidth ? k - halfWidth : 1;
+        unsigned int last = std::min(nyquist, k + halfWidth);
+        double smoothed = GetBandVariance(first, last) * segmentLength / (last - first + 1);
+        if (smoothed > Factor * floor)
+            break;
+        corner = k;
     }
+    return corner;
 }
@@ -35,7 +35,8 @@
 
 #ifndef _GUIDING_STATS_H
 #define _GUIDING_STATS_H
-#include <deque>
+#include <complex>
+#include <vector>
 
 // DescriptiveStats is used for basic statistics.  Max, min, sigma and variance are computed on-the-fly as values are added to a dataset
 // Applicable to any double values, no semantic assumptions made.  Does not retain a list of values
@@ -69,6 +70,27 @@ public:
     double GetMaxDelta();               // Returns max of absolute delta(new - previous) values
 };
 
+// LinearFitStats fits a straight line to a stream of (x, y) values.  The fit is updated on-the-fly as values are added, like
+// DescriptiveStats, and no list of values is retained, so it can follow an entire run, e.g. the Dec drift during a long GA session
+class LinearFitStats
+{
+private:
+    unsigned int count;
+    double meanX;
+    double meanY;
+    double sumDXSq;                     // sums of products of deltas from the means
+    double sumDXDY;
+    double sumDYSq;
+
+public:
+    LinearFitStats();
+    void AddValues(double X, double Y); // Add an (x, y) pair to the dataset
+    void ClearAll();
+    unsigned int GetCount() const;
+    // Slope and intercept of the least-squares line, same as AxisStats::GetLinearFitResults.  Returns R-Squared
+    double GetLinearFitResults(double *Slope, double *Intercept) const;
+};
+
 // High and Low pass filters can be used to filter a stream of data elements that can then be added to DescriptiveStats or AxisStats
 // A low-pass filter will attenuate (dampen) high-frequency elements, a high-pass filter will do the opposite
 // Examples: use a low-pass filter to emphasize low-frequency data fluctuations such as a slow linear drift
@@ -105,6 +127,77 @@ public:
     void Reset();
 };
 
+// Circular buffer with contiguous storage.  Entries are appended at the back and removed from the front without
+// moving the others, and the capacity doubles when the buffer is full, so both operations are O(1)
+template <typename T>
+class RingBuffer
+{
+    std::vector<T> buffer;
+    size_t head = 0;                                            // index of the oldest entry in buffer
+    size_t count = 0;
+
+public:
+    void push_back(const T& val)
+    {
+        if (count == buffer.size())
+        {
+            std::vector<T> larger;
+            larger.reserve(buffer.size() > 8 ? 2 * buffer.size() : 16);
+            for (size_t i = 0; i < count; i++)
+                larger.push_back((*this)[i]);
+            larger.resize(larger.capacity(), val);
+            buffer.swap(larger);
+            head = 0;
+        }
+        size_t inx = head + count;
+        if (inx >= buffer.size())
+            inx -= buffer.size();
+        buffer[inx] = val;
+        ++count;
+    }
+    void pop_front()
+    {
+        if (++head == buffer.size())
+            head = 0;
+        --count;
+    }
+    void pop_back() { --count; }
+    void clear() { head = 0; count = 0; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const T& operator[](size_t inx) const
+    {
+        inx += head;
+        return buffer[inx < buffer.size() ? inx : inx - buffer.size()];
+    }
+    T& operator[](size_t inx)
+    {
+        inx += head;
+        return buffer[inx < buffer.size() ? inx : inx - buffer.size()];
+    }
+    const T& front() const { return (*this)[0]; }
+    const T& back() const { return (*this)[count - 1]; }
+};
+
+// OrderStats keeps a sorted copy of the values in a (windowed) dataset for order statistics.  Inserting or removing a value
+// is a binary search plus a move of the values after it, which for the window sizes used in guiding is cheaper than a heap or a tree.
+// Minimum, maximum, median and any other element by rank are then O(1) and the median absolute deviation is O(log n)
+class OrderStats
+{
+    std::vector<double> sorted;
+
+public:
+    void Insert(double Val);
+    bool Remove(double Val);            // Remove one instance of a value previously inserted, false if not found
+    void Clear();
+    unsigned int GetCount() const;
+    double GetElement(unsigned int Rank) const;     // The value with the given rank (0 = minimum). Caller should insure Rank < count
+    double GetMinimum() const;
+    double GetMaximum() const;
+    double GetMedian() const;           // Average of the two center values for an even count
+    double GetMAD() const;              // Median absolute deviation from the median
+};
+
 // Support structure for use with AxisStats to keep a queue of guide star displacements and relative time values
 // Timestamps are intended to be incremental, i.e seconds since start of guiding, and are used only for linear fit operations
 struct StarDisplacement
@@ -120,26 +213,36 @@ struct StarDisplacement
 // AxisStats and the StarDisplacement class can be used to collect and evaluate typical guiding data.  Datasets can be windowed or not.
 // Windowing means the data collection is limited to the most recent <n> entries.
 // Windowed datasets will be automatically trimmed if AutoWindowSize > 0 or can be manually trimmed by client using RemoveOldestEntry()
+// All stats are maintained incrementally, so adding or removing an entry and querying the stats do not iterate over the dataset
 class AxisStats
 {
+    struct DeltaEntry
+    {
+        unsigned long seq;                                      // sequence number of the newer of the two entries
+        double delta;
+    };
+
 protected:
-    std::deque <StarDisplacement> guidingEntries;               // queue of elements in dataset
+    RingBuffer<StarDisplacement> guidingEntries;               // queue of elements in dataset
+    OrderStats sortedPositions;                                 // star positions in dataset, for median, min and max
+    RingBuffer<DeltaEntry> deltaMaxima;                         // decreasing maxima of the incremental star deltas, front is the max
+    unsigned long firstSeq;                                     // sequence number of guidingEntries[0]
     unsigned int axisMoves;                                     // number of times in window when guide pulse was non-zero
     unsigned int axisReversals;                                 // number of times in window when guide pulse caused a direction reversal
     double prevMove;                                            // value of guide pulse in next-to-last entry
     double prevPosition;                                        // value of guide star location in next-to-last entry
-    // Variables used to compute stats in windowed AxisStats
+    // Running sums for mean, variance and linear fit. The x values are taken relative to xOrigin, which follows the window,
+    // and the sums are recomputed after every <n> removals so that rounding errors cannot accumulate
+    double xOrigin;                                             // DeltaTime the x values are relative to
     double sumX;                                                // Sum of the x values (deltaT values)
     double sumY;                                                // Sum of the y values (star position)
     double sumXY;                                               // Sum of (x * y)
     double sumXSq;                                              // Sum of (x squared)
     double sumYSq;                                              // Sum of (y squared)
-    // Variables needed for windowed or non-windowed versions
-    double maxDisplacement;                                     // maximum star position value in current dataset
-    double minDisplacement;                                     // minimum star position value in current dataset
-    double maxDelta;                                            // maximum absolute delta of incremental star deltas
-    int maxDeltaInx;
+    unsigned int removalsSinceResum;
     void InitializeScalars();
+    void RecomputeSums();
+    void RemoveFront();
 
 public:
     // Constructor for 3 types of instance: non-windowed, windowed with automatic trimming of size, windowed but with client controlling actual window size
@@ -173,6 +276,7 @@ public:
     double GetSigma() const;
     double GetPopulationSigma() const;
     double GetMedian() const;
+    double GetMAD() const;
     double GetMaxDelta() const;
     // Count of moves or reversals in current dataset
     unsigned int GetMoveCount() const;
@@ -191,8 +295,7 @@ public:
 class WindowedAxisStats : public AxisStats
 {
     bool autoWindowing = false;
-    int windowSize = 0;
-    void AdjustMinMaxValues();
+    unsigned int windowSize = 0;
 
 public:
     WindowedAxisStats() {};
@@ -205,4 +308,50 @@ public:
     void AddGuideInfo(double DeltaT, double StarPos, double GuideAmt);
 };
 
+// SpectrumEstimator computes a running power spectral density for a stream of evenly spaced samples using Welch's method.
+// Only the most recent segment of samples is retained, in a fixed ring buffer.  Every half segment the newest segment is detrended,
+// Hann-windowed and transformed, and its periodogram is folded into an average that favors the last few segments.  Until the first
+// full segment is available, a provisional estimate is made from all the samples so far.  Memory and cost per sample are independent
+// of the length of the run.  Frequencies are in cycles per sample: bin k is at k / GetSegmentLength()
+class SpectrumEstimator
+{
+    unsigned int segmentLength = 0;             // always a power of 2
+    std::vector<double> samples;                // ring buffer of the last segmentLength values
+    unsigned int nextInx = 0;
+    unsigned int count = 0;
+    unsigned int sinceUpdate = 0;
+    unsigned int segments = 0;                  // number of full segments folded into the estimate
+    unsigned int estimateLength = 0;            // samples behind the latest periodogram
+    static const unsigned int maxAveraged = 8;  // later segments are weighted exponentially
+    bool valid = false;
+    std::vector<std::complex<double>> work;
+    std::vector<double> psd;                    // one-sided, segmentLength / 2 + 1 bins
+
+    void ProcessSegment(unsigned int Length, bool Provisional);
+    void Transform();
+
+public:
+    SpectrumEstimator() : SpectrumEstimator(1024) {};
+    SpectrumEstimator(unsigned int SegmentLength);
+
+    bool AddValue(double Val);          // Add a sample; returns true if the estimate was updated
+    void ClearAll();
+    unsigned int GetSegmentLength() const { return segmentLength; }
+    unsigned int GetCount() const { return count; }
+    unsigned int GetSegmentCount() const { return segments; }
+    bool HasEstimate() const { return valid; }
+    unsigned int GetBinCount() const { return psd.size(); }
+    double GetPower(unsigned int Bin) const;    // Density in units^2 per cycle-per-sample
+    // Variance contributed by bins FirstBin through LastBin
+    double GetBandVariance(unsigned int FirstBin, unsigned int LastBin) const;
+    // Median density from FirstBin up to the Nyquist frequency, a robust estimate of a white noise floor
+    double GetNoiseFloor(unsigned int FirstBin) const;
+    // Strongest peak between the bins that stands well above the noise floor. Frequency is interpolated between bins,
+    // amplitude is that of the equivalent sine wave
+    bool FindPeak(unsigned int FirstBin, unsigned int LastBin, double *Frequency, double *Amplitude) const;
+    // Lowest bin above which the density, smoothed over half an octave, stays within Factor times the mean density of the
+    // upper half of the band
+    unsigned int GetCornerBin(double Factor) const;
+};
+
 #endif
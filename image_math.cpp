@@ -40,6 +40,7 @@
 #include <wx/tokenzr.h>
 
 #include <algorithm>
+#include <limits>
 
 int dbl_sort_func (double *first, double *second)
 {
@@ -79,6 +80,8 @@ double CalcSlope(const ArrayOfDbl& y)
 bool QuickLRecon(usImage& img)
 {
     // Does a simple debayer of luminance data only -- sliding 2x2 window
+    img.Widen();
+
     usImage tmp;
     if (tmp.Init(img.Size))
     {
@@ -87,61 +90,61 @@ bool QuickLRecon(usImage& img)
     }
 
     int const W = img.Size.GetWidth();
-    int RX, RY, RW, RH;
-    if (img.Subframe.IsEmpty())
-    {
-        RX = RY = 0;
-        RW = img.Size.GetWidth();
-        RH = img.Size.GetHeight();
-    }
-    else
-    {
-        RX = img.Subframe.GetX();
-        RY = img.Subframe.GetY();
-        RW = img.Subframe.GetWidth();
-        RH = img.Subframe.GetHeight();
-        tmp.Clear();
-    }
 
-#define IX(x_, y_) ((RY + (y_)) * W + RX + (x_))
+    if (!img.Subframe.IsEmpty())
+        tmp.Clear();
 
-    unsigned short *d;
-    unsigned int t;
+    // the subframe, or each of the windows read out within it
+    std::vector<wxRect> rects;
+    img.ValidRects(&rects);
 
-    for (int y = 0; y <= RH - 2; y++)
+    for (const wxRect& rect : rects)
     {
-        d = &tmp.ImageData[IX(0, y)];
+        int const RX = rect.GetX();
+        int const RY = rect.GetY();
+        int const RW = rect.GetWidth();
+        int const RH = rect.GetHeight();
 
-        for (int x = 0; x <= RW - 2; x++)
+#define IX(x_, y_) ((RY + (y_)) * W + RX + (x_))
+
+        unsigned short *d;
+        unsigned int t;
+
+        for (int y = 0; y <= RH - 2; y++)
         {
-            t  = img.ImageData[IX(x    , y    )];
-            t += img.ImageData[IX(x + 1, y    )];
-            t += img.ImageData[IX(x    , y + 1)];
-            t += img.ImageData[IX(x + 1, y + 1)];
-            *d++ = (unsigned short)(t >> 2);
-        }
+            d = &tmp.ImageData[IX(0, y)];
 
-        // last col
-        t  = img.ImageData[IX(RW - 1, y    )];
-        t += img.ImageData[IX(RW - 1, y + 1)];
-        *d = (unsigned short)(t >> 1);
-    }
+            for (int x = 0; x <= RW - 2; x++)
+            {
+                t  = img.ImageData[IX(x    , y    )];
+                t += img.ImageData[IX(x + 1, y    )];
+                t += img.ImageData[IX(x    , y + 1)];
+                t += img.ImageData[IX(x + 1, y + 1)];
+                *d++ = (unsigned short)(t >> 2);
+            }
 
-    // last row
+            // last col
+            t  = img.ImageData[IX(RW - 1, y    )];
+            t += img.ImageData[IX(RW - 1, y + 1)];
+            *d = (unsigned short)(t >> 1);
+        }
 
-    d = &tmp.ImageData[IX(0, RH - 1)];
+        // last row
 
-    for (int x = 0; x <= RW - 2; x++)
-    {
-        t  = img.ImageData[IX(x    , RH - 1)];
-        t += img.ImageData[IX(x + 1, RH - 1)];
-        *d++ = (unsigned short)(t >> 1);
-    }
+        d = &tmp.ImageData[IX(0, RH - 1)];
+
+        for (int x = 0; x <= RW - 2; x++)
+        {
+            t  = img.ImageData[IX(x    , RH - 1)];
+            t += img.ImageData[IX(x + 1, RH - 1)];
+            *d++ = (unsigned short)(t >> 1);
+        }
 
-    // bottom-right pixel
-    *d = img.ImageData[IX(RW - 1, RH - 1)];
+        // bottom-right pixel
+        *d = img.ImageData[IX(RW - 1, RH - 1)];
 
 #undef IX
+    }
 
     img.SwapImageData(tmp);
     return false;
@@ -149,6 +152,8 @@ bool QuickLRecon(usImage& img)
 
 bool Median3(usImage& img)
 {
+    img.Widen();
+
     usImage tmp;
 
     if (tmp.Init(img.Size))
@@ -164,7 +169,11 @@ bool Median3(usImage& img)
     else
     {
         tmp.Clear();
-        Median3(tmp.ImageData, img.ImageData, img.Size, img.Subframe);
+
+        std::vector<wxRect> rects;
+        img.ValidRects(&rects);
+        for (const wxRect& rect : rects)
+            Median3(tmp.ImageData, img.ImageData, img.Size, rect);
     }
 
     img.SwapImageData(tmp);
@@ -320,7 +329,8 @@ inline static unsigned short median3(const unsigned short l[3])
     return l0;
 }
 
-void Median3(unsigned short *dst, const unsigned short *src, const wxSize& size, const wxRect& rect)
+template<typename T>
+static void median3_filter(unsigned short *dst, const T *src, const wxSize& size, const wxRect& rect)
 {
     int const W = size.GetWidth();
     int const RX = rect.GetX();
@@ -431,6 +441,16 @@ void Median3(unsigned short *dst, const unsigned short *src, const wxSize& size,
 #undef IX
 }
 
+void Median3(unsigned short *dst, const unsigned short *src, const wxSize& size, const wxRect& rect)
+{
+    median3_filter(dst, src, size, rect);
+}
+
+void Median3(unsigned short *dst, const unsigned char *src, const wxSize& size, const wxRect& rect)
+{
+    median3_filter(dst, src, size, rect);
+}
+
 static unsigned short MedianBorderingPixels(const usImage& img, int x, int y)
 {
     unsigned short array[8];
@@ -534,9 +554,11 @@ static unsigned short MedianBorderingPixels(const usImage& img, int x, int y)
 bool SquarePixels(usImage& img, float xsize, float ysize)
 {
     // Stretches one dimension to square up pixels
-    if (!img.ImageData)
+    if (!img.HasPixels())
         return true;
 
+    img.Widen();
+
     if (xsize <= ysize)
         return false;
 
@@ -572,49 +594,170 @@ bool SquarePixels(usImage& img, float xsize, float ysize)
     return false;
 }
 
-// Dark subtraction algorithm:
-//     Pedestal = max(median(dark_frame) - median(light_frame), 0) - handles overall gain/gradient differences
-//     Dark_corrected(i) = min(max(light(i) + pedestal - dark(i), 0), 65335)
-bool Subtract(usImage& light, const usImage& dark)
+// Bin one output row from F consecutive source rows. The factor is a template parameter so
+// the inner loops are unrolled and the average's division becomes a multiplication,
+// leaving simple loops over the row that the compiler can vectorize.
+template<int F>
+static void bin_row(unsigned short *dst, const unsigned short *src, int srcStride, int width,
+                    unsigned int *acc, bool average)
 {
-    if (!light.ImageData || !dark.ImageData)
+    for (int x = 0; x < width; x++)
+        acc[x] = 0;
+
+    for (int j = 0; j < F; j++)
+    {
+        const unsigned short *row = src + j * srcStride;
+        for (int x = 0; x < width; x++)
+        {
+            unsigned int s = 0;
+            for (int k = 0; k < F; k++)
+                s += row[x * F + k];
+            acc[x] += s;
+        }
+    }
+
+    if (average)
+    {
+        for (int x = 0; x < width; x++)
+            dst[x] = (unsigned short) ((acc[x] + F * F / 2) / (F * F));
+    }
+    else
+    {
+        for (int x = 0; x < width; x++)
+            dst[x] = (unsigned short) std::min(acc[x], 65535U);
+    }
+}
+
+// Software binning: combine each factor x factor block of src into one pixel of dst, as
+// the sum (clipped at 65535) or the average of the block. Only the blocks lying entirely
+// within the source subframe are binned; dst.Subframe is set to the binned subframe.
+// Image attributes are copied, with BitsPerPixel widened for summed pixels. 8-bit source
+// pixels are widened in place.
+bool BinPixels(usImage& dst, usImage& src, int factor, bool average)
+{
+    if (!src.HasPixels() || factor < 2 || factor > 4)
         return true;
-    if (light.Size != dark.Size)
+
+    src.Widen();
+
+    if (dst.Init(src.Size.GetWidth() / factor, src.Size.GetHeight() / factor))
         return true;
 
-    unsigned int left, top, width, height;
-    unsigned short median_light, median_dark;
-    median_light = light.MedianADU;    // median of frame or subframe
+    wxRect srcRect = src.Subframe.IsEmpty() ? wxRect(src.Size) : src.Subframe;
+    int x0 = (srcRect.GetLeft() + factor - 1) / factor;
+    int y0 = (srcRect.GetTop() + factor - 1) / factor;
+    int x1 = std::min((srcRect.GetRight() + 1) / factor, dst.Size.GetWidth());
+    int y1 = std::min((srcRect.GetBottom() + 1) / factor, dst.Size.GetHeight());
 
-    if (!light.Subframe.IsEmpty())
+    if (src.Subframe.IsEmpty())
+        dst.Subframe = wxRect();
+    else
+    {
+        dst.Clear();
+        dst.Subframe = wxRect(x0, y0, std::max(x1 - x0, 0), std::max(y1 - y0, 0));
+    }
+
+    int width = x1 - x0;
+    if (width > 0)
     {
-        left = light.Subframe.GetLeft();
-        width = light.Subframe.GetWidth();
-        top = light.Subframe.GetTop();
-        height = light.Subframe.GetHeight();
-
-        // compute the dark's median ADU within the subframe region
-        unsigned int pixcnt = width * height;
-        unsigned short *tmp = new unsigned short[pixcnt];
-        const unsigned short *src = dark.ImageData + left + top * light.Size.GetWidth();
-        unsigned short *dst = tmp;
-        for (int y = 0; y < height; y++)
+        std::vector<unsigned int> acc(width);
+        int stride = src.Size.GetWidth();
+
+        for (int y = y0; y < y1; y++)
         {
-            memcpy(dst, src, width * sizeof(unsigned short));
-            src += light.Size.GetWidth();
-            dst += width;
+            const unsigned short *s = src.ImageData + (y * factor) * stride + x0 * factor;
+            unsigned short *d = dst.ImageData + y * dst.Size.GetWidth() + x0;
+            switch (factor)
+            {
+            case 2: bin_row<2>(d, s, stride, width, &acc[0], average); break;
+            case 3: bin_row<3>(d, s, stride, width, &acc[0], average); break;
+            case 4: bin_row<4>(d, s, stride, width, &acc[0], average); break;
+            }
         }
-        std::nth_element(tmp, tmp + pixcnt / 2, tmp + pixcnt);
-        median_dark = tmp[pixcnt / 2];
-        delete[] tmp;
     }
-    else
+
+    dst.ImgStartTime = src.ImgStartTime;
+    dst.ImgStartSteady = src.ImgStartSteady;
+    dst.ImgExpDur = src.ImgExpDur;
+    dst.ImgStackCnt = src.ImgStackCnt;
+    dst.ImgSpanDur = src.ImgSpanDur;
+    dst.FrameNum = src.FrameNum;
+    dst.Pedestal = average ? src.Pedestal : (unsigned short) std::min(src.Pedestal * factor * factor, 65535);
+    // a sum of factor^2 pixels needs up to 2 (2x2) or 4 (3x3, 4x4) more bits
+    dst.BitsPerPixel = average ? src.BitsPerPixel : (wxByte) std::min(src.BitsPerPixel + (factor == 2 ? 2 : 4), 16);
+
+    return false;
+}
+
+// Median ADU of a dark frame within a subframe region, or the pre-computed full frame
+// median ADU if the subframe is empty
+unsigned short DarkMedian(const usImage& dark, const wxRect& subframe)
+{
+    if (subframe.IsEmpty() || !dark.ImageData || !wxRect(dark.Size).Contains(subframe))
+        return dark.MedianADU;
+
+    unsigned int left = subframe.GetLeft();
+    unsigned int width = subframe.GetWidth();
+    unsigned int top = subframe.GetTop();
+    unsigned int height = subframe.GetHeight();
+
+    unsigned int pixcnt = width * height;
+    unsigned short *tmp = new unsigned short[pixcnt];
+    const unsigned short *src = dark.ImageData + left + top * dark.Size.GetWidth();
+    unsigned short *dst = tmp;
+    for (int y = 0; y < height; y++)
+    {
+        memcpy(dst, src, width * sizeof(unsigned short));
+        src += dark.Size.GetWidth();
+        dst += width;
+    }
+    std::nth_element(tmp, tmp + pixcnt / 2, tmp + pixcnt);
+    unsigned short median = tmp[pixcnt / 2];
+    delete[] tmp;
+
+    return median;
+}
+
+bool Subtract(usImage& light, const usImage& dark)
+{
+    return Subtract(light, dark, DarkMedian(dark, light.Subframe));
+}
+
+// light pixels are clipped to the range of their type, so 8-bit frames stay 8-bit
+template<typename T>
+static void subtract_dark(T *pl0, const unsigned short *pd0, unsigned int stride, unsigned int width, unsigned int height,
+                          unsigned short pedestal)
+{
+    int const maxval = std::numeric_limits<T>::max();
+
+    for (unsigned int r = 0; r < height; r++, pl0 += stride, pd0 += stride)
     {
-        left = top = 0;
-        width = light.Size.GetWidth();
-        height = light.Size.GetHeight();
-        median_dark = dark.MedianADU; // use the pre-computed full frame median ADU
+        T *const endl = pl0 + width;
+        T *pl;
+        const unsigned short *pd;
+        for (pl = pl0, pd = pd0; pl < endl; pl++, pd++)
+        {
+            int newval = (int) *pl + pedestal - (int) *pd;
+            if (newval < 0) newval = 0; // hot pixel in dark frame isn't present in light frame
+            else if (newval > maxval) newval = maxval;
+            *pl = (T) newval;
+        }
     }
+}
+
+// Dark subtraction algorithm:
+//     Pedestal = max(median(dark_frame) - median(light_frame), 0) - handles overall gain/gradient differences
+//     Dark_corrected(i) = min(max(light(i) + pedestal - dark(i), 0), 65335)
+// median_dark is the dark's median ADU over the light's subframe, see DarkMedian()
+bool Subtract(usImage& light, const usImage& dark, unsigned short median_dark)
+{
+    if (!light.HasPixels() || !dark.ImageData)
+        return true;
+    if (light.Size != dark.Size)
+        return true;
+
+    unsigned short median_light;
+    median_light = light.MedianADU;    // median of frame or subframe
 
     if (median_dark > median_light)
     {
@@ -622,22 +765,74 @@ bool Subtract(usImage& light, const usImage& dark)
         light.Pedestal = median_dark - median_light;   // Needed for saturation detection in find-star
     }
 
-    unsigned short *pl0 = &light.Pixel(left, top);
-    const unsigned short *pd0 = &dark.Pixel(left, top);
-    for (unsigned int r = 0; r < height;
-         r++, pl0 += light.Size.GetWidth(), pd0 += light.Size.GetWidth())
+    // the frame, the subframe, or each of the windows read out within it
+    std::vector<wxRect> rects;
+    light.ValidRects(&rects);
+
+    for (const wxRect& r : rects)
     {
-        unsigned short *const endl = pl0 + width;
-        unsigned short *pl;
-        const unsigned short *pd;
-        for (pl = pl0, pd = pd0; pl < endl; pl++, pd++)
+        unsigned int const idx = r.GetTop() * light.Size.GetWidth() + r.GetLeft();
+        if (light.Packed8)
+            subtract_dark(light.ImageData8 + idx, dark.ImageData + idx, light.Size.GetWidth(), r.GetWidth(), r.GetHeight(), light.Pedestal);
+        else
+            subtract_dark(light.ImageData + idx, dark.ImageData + idx, light.Size.GetWidth(), r.GetWidth(), r.GetHeight(), light.Pedestal);
+    }
+
+    return false;
+}
+
+template<typename T>
+static void subtract_model(T *data, const usImage& light, const DarkModel& model, unsigned int left, unsigned int top,
+                           unsigned int width, unsigned int height)
+{
+    float const t = (float) light.ImgExpDur;
+    float const pedestal = (float) light.Pedestal;
+    float const maxval = (float) std::numeric_limits<T>::max();
+
+    for (unsigned int r = 0; r < height; r++)
+    {
+        unsigned int const idx = (top + r) * light.Size.GetWidth() + left;
+        T *pl = data + idx;
+        const unsigned short *po = &model.Offset[idx];
+        const float *ps = &model.Slope[idx];
+
+        // branch-free so the compiler can vectorize the row
+        for (unsigned int i = 0; i < width; i++)
         {
-            int newval = (int) *pl + light.Pedestal - (int) *pd;
-            if (newval < 0) newval = 0; // hot pixel in dark frame isn't present in light frame
-            else if (newval > 65535) newval = 65535;
-            *pl = (unsigned short) newval;
+            float dark = std::min(std::max((float) po[i] + ps[i] * t, 0.f), 65535.f);
+            float newval = (float) pl[i] + pedestal - (float)(int)(dark + 0.5f);
+            newval = std::min(std::max(newval, 0.f), maxval);
+            pl[i] = (T) newval;
         }
     }
+}
+
+// Dark subtraction with the dark for the light's exposure synthesized from a dark model,
+// same algorithm as Subtract(). median_dark is the synthesized dark's median over the
+// light's subframe, see DarkModel::Median()
+bool Subtract(usImage& light, const DarkModel& model, unsigned short median_dark)
+{
+    if (!light.HasPixels() || model.Offset.empty())
+        return true;
+    if (light.Size != model.Size)
+        return true;
+
+    if (median_dark > light.MedianADU)
+    {
+        // dark was brighter than light
+        light.Pedestal = median_dark - light.MedianADU;   // Needed for saturation detection in find-star
+    }
+
+    std::vector<wxRect> rects;
+    light.ValidRects(&rects);
+
+    for (const wxRect& r : rects)
+    {
+        if (light.Packed8)
+            subtract_model(light.ImageData8, light, model, r.GetLeft(), r.GetTop(), r.GetWidth(), r.GetHeight());
+        else
+            subtract_model(light.ImageData, light, model, r.GetLeft(), r.GetTop(), r.GetWidth(), r.GetHeight());
+    }
 
     return false;
 }
@@ -842,7 +1037,9 @@ struct BadPx
     bool operator<(const BadPx& rhs) const { return v < rhs.v; }
 };
 
-typedef std::set<BadPx> BadPxSet;
+// candidate defects sorted by increasing deviation; the pixels selected by a threshold
+// are the tail of the list starting at the first pixel whose deviation reaches it
+typedef std::vector<BadPx> BadPxList;
 
 struct DefectMapBuilderImpl
 {
@@ -851,20 +1048,28 @@ struct DefectMapBuilderImpl
     wxArrayString mapInfo;
     int aggrCold;
     int aggrHot;
-    BadPxSet coldPx;
-    BadPxSet hotPx;
-    BadPxSet::const_iterator coldPxThresh;
-    BadPxSet::const_iterator hotPxThresh;
+    BadPxList coldPx;
+    BadPxList hotPx;
+    unsigned int coldPxThresh;      // index of the first selected pixel
+    unsigned int hotPxThresh;
     unsigned int coldPxSelected;
     unsigned int hotPxSelected;
     bool threshValid;
+    unsigned int mapColdPxThresh;   // thresholds of the last defect map built
+    unsigned int mapHotPxThresh;
 
     DefectMapBuilderImpl()
         :
         darks(0),
         aggrCold(100),
         aggrHot(100),
-        threshValid(false)
+        coldPxThresh(0),
+        hotPxThresh(0),
+        coldPxSelected(0),
+        hotPxSelected(0),
+        threshValid(false),
+        mapColdPxThresh(0),
+        mapHotPxThresh(0)
     { }
 };
 
@@ -919,15 +1124,20 @@ void DefectMapBuilder::Init(DefectMapDarks& darks)
             int v = val - filt;
             if (v > thresh)
             {
-                m_impl->hotPx.insert(BadPx(x, y, v));
+                m_impl->hotPx.push_back(BadPx(x, y, v));
             }
             else if (-v > thresh)
             {
-                m_impl->coldPx.insert(BadPx(x, y, -v));
+                m_impl->coldPx.push_back(BadPx(x, y, -v));
             }
         }
     }
 
+    // sort once; every threshold after this is a binary search
+    std::stable_sort(m_impl->coldPx.begin(), m_impl->coldPx.end());
+    std::stable_sort(m_impl->hotPx.begin(), m_impl->hotPx.end());
+    m_impl->threshValid = false;
+
     Debug.Write(wxString::Format("DefectMapBuilder: Loaded %d cold %d hot\n", m_impl->coldPx.size(), m_impl->hotPx.size()));
 }
 
@@ -957,11 +1167,11 @@ static void FindThresh(DefectMapBuilderImpl *impl)
     Debug.Write(wxString::Format("DefectMap: find thresholds aggr:(%d,%d) sigma:(%.1f,%.1f) px:(%+d,%+d)\n",
                                  impl->aggrCold, impl->aggrHot, multCold, multHot, -coldThresh, hotThresh));
 
-    impl->coldPxThresh = impl->coldPx.lower_bound(BadPx(0, 0, coldThresh));
-    impl->hotPxThresh = impl->hotPx.lower_bound(BadPx(0, 0, hotThresh));
+    impl->coldPxThresh = std::lower_bound(impl->coldPx.begin(), impl->coldPx.end(), BadPx(0, 0, coldThresh)) - impl->coldPx.begin();
+    impl->hotPxThresh = std::lower_bound(impl->hotPx.begin(), impl->hotPx.end(), BadPx(0, 0, hotThresh)) - impl->hotPx.begin();
 
-    impl->coldPxSelected = std::distance(impl->coldPxThresh, impl->coldPx.end());
-    impl->hotPxSelected = std::distance(impl->hotPxThresh, impl->hotPx.end());
+    impl->coldPxSelected = impl->coldPx.size() - impl->coldPxThresh;
+    impl->hotPxSelected = impl->hotPx.size() - impl->hotPxThresh;
 
     Debug.Write(wxString::Format("DefectMap: find thresholds found (%d,%d)\n", impl->coldPxSelected, impl->hotPxSelected));
 
@@ -980,10 +1190,12 @@ int DefectMapBuilder::GetHotPixelCnt() const
     return m_impl->hotPxSelected;
 }
 
-inline static unsigned int emit_defects(DefectMap& defectMap, BadPxSet::const_iterator p0, BadPxSet::const_iterator p1, double stdev, int sign, bool verbose)
+// append the pixels selected by thresh by decreasing deviation, so that a change of the
+// threshold only adds or removes pixels at the end of the segment
+inline static unsigned int emit_defects(DefectMap& defectMap, const BadPxList& px, unsigned int thresh, double stdev, int sign, bool verbose)
 {
     unsigned int cnt = 0;
-    for (BadPxSet::const_iterator it = p0; it != p1; ++it, ++cnt)
+    for (BadPxList::const_reverse_iterator it = px.rbegin(); it != px.rend() - thresh; ++it, ++cnt)
     {
         if (verbose)
         {
@@ -1028,12 +1240,67 @@ void DefectMapBuilder::BuildDefectMap(DefectMap& defectMap, bool verbose) const
     FindThresh(m_impl);
 
     defectMap.clear();
-    unsigned int nr_cold = emit_defects(defectMap, m_impl->coldPxThresh, m_impl->coldPx.end(), stats.stdev, -1, verbose);
-    unsigned int nr_hot = emit_defects(defectMap, m_impl->hotPxThresh, m_impl->hotPx.end(), stats.stdev, +1, verbose);
+    defectMap.reserve(m_impl->coldPxSelected + m_impl->hotPxSelected);
+    // the hot pixels go first, so that UpdateDefectMap only has to move the (usually fewer) cold pixels
+    unsigned int nr_hot = emit_defects(defectMap, m_impl->hotPx, m_impl->hotPxThresh, stats.stdev, +1, verbose);
+    unsigned int nr_cold = emit_defects(defectMap, m_impl->coldPx, m_impl->coldPxThresh, stats.stdev, -1, verbose);
+
+    m_impl->mapColdPxThresh = m_impl->coldPxThresh;
+    m_impl->mapHotPxThresh = m_impl->hotPxThresh;
 
     if (verbose) Debug.Write(wxString::Format("New defect map created, count=%d (cold=%d, hot=%d)\n", defectMap.size(), nr_cold, nr_hot));
 }
 
+// Write entries [k0, k1) of a segment of the defect map starting at dst. Entry k of a
+// segment is the pixel with the k-th largest deviation, see emit_defects.
+static void fill_defects(DefectMap::iterator dst, const BadPxList& px, unsigned int k0, unsigned int k1)
+{
+    for (unsigned int k = k0; k < k1; k++)
+    {
+        const BadPx& p = px[px.size() - 1 - k];
+        dst[k] = wxPoint(p.x, p.y);
+    }
+}
+
+void DefectMapBuilder::UpdateDefectMap(DefectMap& defectMap) const
+{
+    FindThresh(m_impl);
+
+    // the map must be the one produced by the last BuildDefectMap or UpdateDefectMap
+    unsigned int mapCold = m_impl->coldPx.size() - m_impl->mapColdPxThresh;
+    unsigned int mapHot = m_impl->hotPx.size() - m_impl->mapHotPxThresh;
+    if (defectMap.size() != mapCold + mapHot)
+    {
+        BuildDefectMap(defectMap, false);
+        return;
+    }
+
+    // The map holds the selected hot pixels followed by the selected cold pixels, each by
+    // decreasing deviation. Only the pixels between the old and new thresholds are written,
+    // and the cold pixels are moved once if the number of hot pixels changed.
+    unsigned int newHot = m_impl->hotPxSelected;
+    unsigned int newCold = m_impl->coldPxSelected;
+    unsigned int keptCold = std::min(mapCold, newCold);
+
+    if (newHot + newCold > defectMap.size())
+        defectMap.resize(newHot + newCold);
+
+    DefectMap::iterator oldColdPos = defectMap.begin() + mapHot;
+    DefectMap::iterator newColdPos = defectMap.begin() + newHot;
+    if (newHot > mapHot)
+        std::move_backward(oldColdPos, oldColdPos + keptCold, newColdPos + keptCold);
+    else if (newHot < mapHot)
+        std::move(oldColdPos, oldColdPos + keptCold, newColdPos);
+
+    fill_defects(defectMap.begin(), m_impl->hotPx, mapHot, newHot);
+    fill_defects(newColdPos, m_impl->coldPx, mapCold, newCold);
+
+    defectMap.resize(newHot + newCold);
+
+    m_impl->mapColdPxThresh = m_impl->coldPxThresh;
+    m_impl->mapHotPxThresh = m_impl->hotPxThresh;
+}
+
 const wxArrayString& DefectMapBuilder::GetMapInfo() const
 {
     return m_impl->mapInfo;
@@ -1042,9 +1309,11 @@ const wxArrayString& DefectMapBuilder::GetMapInfo() const
 bool RemoveDefects(usImage& light, const DefectMap& defectMap)
 {
     // Check to make sure the light frame is valid
-    if (!light.ImageData)
+    if (!light.HasPixels())
         return true;
 
+    light.Widen();
+
     if (!light.Subframe.IsEmpty())
     {
         // Step over each defect and replace the light value
@@ -1052,8 +1321,8 @@ bool RemoveDefects(usImage& light, const DefectMap& defectMap)
         for (DefectMap::const_iterator it = defectMap.begin(); it != defectMap.end(); ++it)
         {
             const wxPoint& pt = *it;
-            // Check to see if we are within the subframe before correcting the defect
-            if (light.Subframe.Contains(pt))
+            // Check to see if we are within the subframe (or one of its windows) before correcting the defect
+            if (light.ValidRectAt(pt).Contains(pt))
             {
                 light.Pixel(pt.x, pt.y) = MedianBorderingPixels(light, pt.x, pt.y);
             }
@@ -55,10 +55,15 @@ public:
 
 extern bool QuickLRecon(usImage& img);
 extern void Median3(unsigned short *dst, const unsigned short *src, const wxSize& size, const wxRect& rect);
+extern void Median3(unsigned short *dst, const unsigned char *src, const wxSize& size, const wxRect& rect);
 extern bool Median3(usImage& img);
 extern bool SquarePixels(usImage& img, float xsize, float ysize);
+extern bool BinPixels(usImage& dst, usImage& src, int factor, bool average);
 extern int dbl_sort_func(double *first, double *second);
+extern unsigned short DarkMedian(const usImage& dark, const wxRect& subframe);
 extern bool Subtract(usImage& light, const usImage& dark);
+extern bool Subtract(usImage& light, const usImage& dark, unsigned short darkMedian);
+extern bool Subtract(usImage& light, const DarkModel& model, unsigned short darkMedian);
 extern double CalcSlope(const ArrayOfDbl& y);
 extern bool RemoveDefects(usImage& light, const DefectMap& defectMap);
 
@@ -97,6 +102,9 @@ public:
     int GetColdPixelCnt() const;
     int GetHotPixelCnt() const;
     void BuildDefectMap(DefectMap& defectMap, bool verbose) const;
+    // bring a map made by BuildDefectMap up to date with the current aggressiveness,
+    // touching only the pixels whose selection changed
+    void UpdateDefectMap(DefectMap& defectMap) const;
     const wxArrayString& GetMapInfo() const;
 };
 
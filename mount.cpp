@@ -155,6 +155,8 @@ static GUIDE_ALGORITHM GuideAlgorithmFromName(const wxString& s)
         return GUIDE_ALGORITHM_GAUSSIAN_PROCESS;
     if (s.StartsWith(_("ZFilter")))
         return GUIDE_ALGORITHM_ZFILTER;
+    if (s == _("Kalman"))
+        return GUIDE_ALGORITHM_KALMAN;
     return GUIDE_ALGORITHM_NONE;
 }
 
@@ -179,6 +181,8 @@ static wxString GuideAlgorithmName(int algo)
         return wxTRANSLATE("Predictive PEC");
     case GUIDE_ALGORITHM_ZFILTER:
         return wxTRANSLATE("ZFilter");
+    case GUIDE_ALGORITHM_KALMAN:
+        return wxTRANSLATE("Kalman");
     }
 }
 
@@ -211,6 +215,7 @@ void Mount::MountConfigDialogPane::LayoutControls(wxPanel *pParent, BrainCtrlIdM
             GUIDE_ALGORITHM_RESIST_SWITCH,
             GUIDE_ALGORITHM_GAUSSIAN_PROCESS,
             GUIDE_ALGORITHM_ZFILTER,
+            GUIDE_ALGORITHM_KALMAN,
         };
         static GUIDE_ALGORITHM const DEC_ALGORITHMS[] =
         {
@@ -219,6 +224,7 @@ void Mount::MountConfigDialogPane::LayoutControls(wxPanel *pParent, BrainCtrlIdM
             GUIDE_ALGORITHM_LOWPASS2,
             GUIDE_ALGORITHM_RESIST_SWITCH,
             GUIDE_ALGORITHM_ZFILTER,
+            GUIDE_ALGORITHM_KALMAN,
         };
         static GUIDE_ALGORITHM const AO_ALGORITHMS[] =
         {
@@ -226,6 +232,7 @@ void Mount::MountConfigDialogPane::LayoutControls(wxPanel *pParent, BrainCtrlIdM
             GUIDE_ALGORITHM_LOWPASS,
             GUIDE_ALGORITHM_LOWPASS2,
             GUIDE_ALGORITHM_ZFILTER,
+            GUIDE_ALGORITHM_KALMAN,
         };
 
         wxArrayString xAlgorithms;
@@ -722,6 +729,9 @@ bool Mount::CreateGuideAlgorithm(int guideAlgorithm, Mount *mount, GuideAxis axi
             case GUIDE_ALGORITHM_ZFILTER:
                 *ppAlgorithm = new GuideAlgorithmZFilter(mount, axis);
                 break;
+            case GUIDE_ALGORITHM_KALMAN:
+                *ppAlgorithm = new GuideAlgorithmKalman(mount, axis);
+                break;
 
             default:
                 throw ERROR_INFO("invalid guideAlgorithm");
@@ -844,8 +854,13 @@ Mount::Mount()
     m_guidingEnabled = true;
 
     m_backlashComp = nullptr;
+    m_lastMoveOfs.SetXY(0.0, 0.0);
+    m_moveCount = 0;
     m_lastStep.mount = this;
     m_lastStep.frameNumber = -1; // invalidate
+    m_refinerResult = REFINER_NONE;
+    m_calRefined = false;
+    m_refinerDecDir = NONE;
 
     ClearCalibration();
 
@@ -941,6 +956,8 @@ bool Mount::FlipCalibration()
 
 void Mount::LogGuideStepInfo()
 {
+    ApplyCalibrationRefinement();
+
     if (m_lastStep.frameNumber < 0)
         return;
 
@@ -968,6 +985,9 @@ Mount::MOVE_RESULT Mount::MoveOffset(GuiderOffset *ofs, unsigned int moveOptions
 
         if (moveOptions & MOVEOPT_ALGO_DEDUCE)
         {
+            // no star position to go with the move
+            RestartCalibrationRefinement();
+
             xDistance = m_pXGuideAlgorithm ? m_pXGuideAlgorithm->deduceResult() : 0.0;
             yDistance = m_pYGuideAlgorithm ? m_pYGuideAlgorithm->deduceResult() : 0.0;
             if (xDistance == 0.0 && yDistance == 0.0)
@@ -995,21 +1015,54 @@ Mount::MOVE_RESULT Mount::MoveOffset(GuiderOffset *ofs, unsigned int moveOptions
             Debug.Write(wxString::Format("Moving (%.2f, %.2f) raw xDistance=%.2f yDistance=%.2f\n",
                 ofs->cameraOfs.X, ofs->cameraOfs.Y, xDistance, yDistance));
 
+            if (moveOptions & MOVEOPT_ALGO_RESULT)
+            {
+                // The star position is averaged over the exposure, so any part of the earlier
+                // moves that completed after the exposure started is not (fully) reflected in
+                // the measured offset. Remove it so it is not corrected a second time.
+                double unseen[2], lastSeen[2];
+                UnobservedMoveDistance(*ofs, unseen, lastSeen);
+                double xUnseen = unseen[GUIDE_RA];
+                double yUnseen = unseen[GUIDE_DEC];
+
+                if (CalibrationRefinementEnabled())
+                {
+                    RefineCalibration(*ofs, lastSeen[GUIDE_RA], lastSeen[GUIDE_DEC]);
+                }
+
+                if (xUnseen != 0.0 || yUnseen != 0.0)
+                {
+                    xDistance -= xUnseen;
+                    yDistance -= yUnseen;
+
+                    Debug.Write(wxString::Format("Move overlapped exposure: unseen x=%.2f y=%.2f, adjusted xDistance=%.2f yDistance=%.2f\n",
+                        xUnseen, yUnseen, xDistance, yDistance));
+                }
+            }
+
             // Let BLC track the raw offsets in Dec
             if (m_backlashComp)
                 m_backlashComp->TrackBLCResults(moveOptions, yDistance);
 
             if (moveOptions & MOVEOPT_ALGO_RESULT)
             {
+                // The offset was measured at the middle of the exposure. Fall back to the
+                // current time if the exposure time is not known.
+                std::chrono::steady_clock::time_point sampleTime;
+                if (ofs->exposureStart != std::chrono::steady_clock::time_point())
+                    sampleTime = ofs->exposureStart + std::chrono::milliseconds(ofs->exposureDuration) / 2;
+                else
+                    sampleTime = std::chrono::steady_clock::now();
+
                 // Feed the raw distances to the guide algorithms
                 if (m_pXGuideAlgorithm)
                 {
-                    xDistance = m_pXGuideAlgorithm->result(xDistance);
+                    xDistance = m_pXGuideAlgorithm->result(xDistance, sampleTime);
                 }
 
                 if (m_pYGuideAlgorithm)
                 {
-                    yDistance = m_pYGuideAlgorithm->result(yDistance);
+                    yDistance = m_pYGuideAlgorithm->result(yDistance, sampleTime);
                 }
             }
         }
@@ -1020,17 +1073,76 @@ Mount::MOVE_RESULT Mount::MoveOffset(GuiderOffset *ofs, unsigned int moveOptions
 
         int requestedXAmount = ROUND(fabs(xDistance / m_xRate));
         MoveResultInfo xMoveResult;
-        result = MoveAxis(xDirection, requestedXAmount, moveOptions, &xMoveResult);
-
         MoveResultInfo yMoveResult;
-        if (result != MOVE_ERROR_SLEWING && result != MOVE_ERROR_AO_LIMIT_REACHED)
+
+        std::chrono::steady_clock::time_point xStart, xEnd, yStart, yEnd;
+
+        if (CanMoveAxesConcurrently())
         {
+            // both axes are moved together, so the Dec amount (including backlash comp) is needed up front
             int requestedYAmount = ROUND(fabs(yDistance / m_cal.yRate));
 
             if (m_backlashComp)
                 m_backlashComp->ApplyBacklashComp(moveOptions, yDistance, &requestedYAmount);
 
-            result = MoveAxis(yDirection, requestedYAmount, moveOptions, &yMoveResult);
+            xStart = yStart = std::chrono::steady_clock::now();
+
+            result = MoveAxes(xDirection, requestedXAmount, yDirection, requestedYAmount, moveOptions, &xMoveResult, &yMoveResult);
+
+            // only scopes move concurrently, so the amounts are pulse durations in ms
+            xEnd = xStart + std::chrono::milliseconds(xMoveResult.amountMoved);
+            yEnd = yStart + std::chrono::milliseconds(yMoveResult.amountMoved);
+        }
+        else
+        {
+            xStart = std::chrono::steady_clock::now();
+
+            result = MoveAxis(xDirection, requestedXAmount, moveOptions, &xMoveResult);
+
+            yStart = xEnd = std::chrono::steady_clock::now();
+
+            if (result != MOVE_ERROR_SLEWING && result != MOVE_ERROR_AO_LIMIT_REACHED)
+            {
+                int requestedYAmount = ROUND(fabs(yDistance / m_cal.yRate));
+
+                if (m_backlashComp)
+                    m_backlashComp->ApplyBacklashComp(moveOptions, yDistance, &requestedYAmount);
+
+                result = MoveAxis(yDirection, requestedYAmount, moveOptions, &yMoveResult);
+            }
+
+            yEnd = std::chrono::steady_clock::now();
+        }
+
+        MoveRecord move;
+        move.axis[GUIDE_RA] = MakeAxisMove(xStart, xEnd, xDistance, xMoveResult.amountMoved, m_xRate);
+        move.axis[GUIDE_DEC] = MakeAxisMove(yStart, yEnd, yDistance, yMoveResult.amountMoved, m_cal.yRate);
+        RecordMove(move);
+
+        if (moveOptions & (MOVEOPT_ALGO_RESULT | MOVEOPT_ALGO_DEDUCE))
+        {
+            // Dec guide mode, duration limits and disabled guiding can keep the mount from
+            // carrying out the algorithm result in full
+            if (m_pXGuideAlgorithm)
+                m_pXGuideAlgorithm->GuideMoveApplied(move.axis[GUIDE_RA].distance);
+            if (m_pYGuideAlgorithm)
+                m_pYGuideAlgorithm->GuideMoveApplied(move.axis[GUIDE_DEC].distance);
+        }
+
+        // streamed frames exposed while the mount was moving do not show where the star ended up
+        if (pCamera && (xMoveResult.amountMoved > 0 || yMoveResult.amountMoved > 0))
+            pCamera->DiscardStreamFramesBefore(std::chrono::steady_clock::now());
+
+        if (CalibrationRefinementEnabled())
+        {
+            if (result == MOVE_OK)
+            {
+                // backlash compensation does not move the star, so leave it out of the pulse
+                int yGuideAmount = wxMin(yMoveResult.amountMoved, ROUND(fabs(yDistance / m_cal.yRate)));
+                RefinerAddPulses(xDirection, xMoveResult.amountMoved, yDirection, yGuideAmount);
+            }
+            else
+                RestartCalibrationRefinement();
         }
 
         // Record the info about the guide step. The info will be picked up back in the main UI thread.
@@ -1070,6 +1182,279 @@ Mount::MOVE_RESULT Mount::MoveOffset(GuiderOffset *ofs, unsigned int moveOptions
     return result;
 }
 
+// Fraction of a move that shows up in a star position measured on an exposure. The
+// move is assumed to progress at a constant rate from moveStart to moveEnd, and the
+// measured position is the average position over the exposure. Times are in ms.
+static double ObservedMoveFraction(double moveStart, double moveEnd, double expStart, double expEnd)
+{
+    if (expEnd <= expStart)
+        return moveEnd <= expStart ? 1.0 : 0.0;
+
+    // integral over time of the completed fraction of the move, from moveStart to t
+    auto completed = [moveStart, moveEnd](double t) -> double {
+        if (t <= moveStart)
+            return 0.0;
+        if (t >= moveEnd)
+            return (moveEnd - moveStart) / 2.0 + (t - moveEnd);
+        return (t - moveStart) * (t - moveStart) / (2.0 * (moveEnd - moveStart));
+    };
+
+    double fraction = (completed(expEnd) - completed(expStart)) / (expEnd - expStart);
+
+    return wxMax(0.0, wxMin(1.0, fraction));
+}
+
+Mount::AxisMove Mount::MakeAxisMove(const std::chrono::steady_clock::time_point& start,
+                                    const std::chrono::steady_clock::time_point& end, double distance, int amountMoved, double rate)
+{
+    AxisMove rec;
+
+    rec.start = start;
+    rec.end = end;
+
+    // the amount moved may include backlash compensation, which does not move the star
+    double moved = wxMin(fabs(distance), amountMoved * fabs(rate));
+    rec.distance = distance < 0.0 ? -moved : moved;
+
+    return rec;
+}
+
+// Queue a move until the guide frames show all of it, and publish its star shift
+void Mount::RecordMove(const MoveRecord& move)
+{
+    wxMutexLocker lck(m_lastMoveLock);
+
+    if (move.axis[GUIDE_RA].distance != 0.0 || move.axis[GUIDE_DEC].distance != 0.0)
+    {
+        // a frame that could still show the oldest moves is long overdue
+        if (m_outstandingMoves.size() >= MaxOutstandingMoves)
+            m_outstandingMoves.pop_front();
+        m_outstandingMoves.push_back(move);
+    }
+
+    m_lastMoveOfs.SetXY(move.axis[GUIDE_RA].distance, move.axis[GUIDE_DEC].distance);
+    ++m_moveCount;
+}
+
+unsigned int Mount::LastMoveStarShift(PHD_Point *shift)
+{
+    PHD_Point mountOfs;
+    unsigned int moveCount;
+    {
+        wxMutexLocker lck(m_lastMoveLock);
+        mountOfs = m_lastMoveOfs;
+        moveCount = m_moveCount;
+    }
+
+    PHD_Point cameraOfs;
+
+    // a move toward the lock position moves the star by the opposite of the offset it corrects
+    if (IsCalibrated() && (mountOfs.X != 0.0 || mountOfs.Y != 0.0) &&
+        !TransformMountCoordinatesToCameraCoordinates(mountOfs, cameraOfs, false))
+    {
+        shift->SetXY(-cameraOfs.X, -cameraOfs.Y);
+    }
+    else
+        shift->SetXY(0.0, 0.0);
+
+    return moveCount;
+}
+
+// Matches an offset measured on the given exposure to the outstanding moves. Returns, per
+// axis, the part of the outstanding moves that is not reflected in the offset and the
+// fraction of the most recent move that is. Moves the exposure shows in full are dropped;
+// the others stay queued for the following frames.
+void Mount::UnobservedMoveDistance(const GuiderOffset& ofs, double unseen[2], double lastSeen[2])
+{
+    unseen[GUIDE_RA] = unseen[GUIDE_DEC] = 0.0;
+    lastSeen[GUIDE_RA] = lastSeen[GUIDE_DEC] = 1.0;
+
+    wxMutexLocker lck(m_lastMoveLock);
+
+    // without the exposure timing, assume the offset reflects all earlier moves
+    if (ofs.exposureStart == std::chrono::steady_clock::time_point())
+    {
+        m_outstandingMoves.clear();
+        return;
+    }
+
+    auto it = m_outstandingMoves.begin();
+    while (it != m_outstandingMoves.end())
+    {
+        bool newest = std::next(it) == m_outstandingMoves.end();
+        bool pending = false;
+
+        for (int axis = GUIDE_RA; axis <= GUIDE_DEC; axis++)
+        {
+            const AxisMove& rec = it->axis[axis];
+            if (rec.distance == 0.0)
+                continue;
+
+            double moveStart = std::chrono::duration<double, std::milli>(rec.start - ofs.exposureStart).count();
+            double moveEnd = std::chrono::duration<double, std::milli>(rec.end - ofs.exposureStart).count();
+
+            double seen = ObservedMoveFraction(moveStart, moveEnd, 0.0, (double) ofs.exposureDuration);
+
+            unseen[axis] += (1.0 - seen) * rec.distance;
+            if (newest)
+                lastSeen[axis] = seen;
+
+            // later frames see the rest of a move that was not over before the exposure started
+            if (moveEnd > 0.0)
+                pending = true;
+        }
+
+        if (pending)
+            ++it;
+        else
+            it = m_outstandingMoves.erase(it);
+    }
+}
+
+// Feed the star position measured on a guide frame to the calibration refiner; runs on the
+// worker thread. The fractions of the previous pulses that completed during the exposure are
+// passed along with the position. The resulting estimate is left for the main thread, see
+// ApplyCalibrationRefinement()
+void Mount::RefineCalibration(const GuiderOffset& ofs, double raSeen, double decSeen)
+{
+    if (!IsCalibrated())
+        return;
+
+    wxMutexLocker lck(m_calRefinerLock);
+
+    if (!m_calRefiner.IsInitialized())
+    {
+        CalibrationEstimate cal = { m_xRate, m_cal.yRate, m_cal.xAngle, m_cal.yAngle };
+        m_calRefiner.Reset(cal);
+        m_refinerDecDir = NONE;
+    }
+
+    // track the star position rather than the offset so that dithers and other lock
+    // position changes do not interrupt the refinement
+    PHD_Point starPos;
+    if (ofs.lockPos.IsValid() && ofs.cameraOfs.IsValid())
+        starPos = ofs.lockPos + ofs.cameraOfs;
+
+    bool updated = m_calRefiner.AddPosition(starPos, raSeen, decSeen);
+
+    if (m_calRefiner.Diverged())
+    {
+        Debug.Write(wxString::Format("Calibration refinement diverged after %u samples\n", m_calRefiner.SampleCount()));
+
+        CalibrationEstimate prior = m_calRefiner.Prior();
+        m_calRefiner.Reset(prior);
+        m_refinerResult = REFINER_DIVERGED;
+    }
+    else if (updated && m_refinerResult != REFINER_DIVERGED)
+        m_refinerResult = REFINER_UPDATED;
+}
+
+// Take over the estimate of the calibration refiner once it is a confident improvement, or
+// revert to the calibration it started from if it diverged. Called in the main thread, which
+// owns the calibration
+void Mount::ApplyCalibrationRefinement()
+{
+    wxMutexLocker lck(m_calRefinerLock);
+
+    REFINER_RESULT result = m_refinerResult;
+    m_refinerResult = REFINER_NONE;
+
+    if (result == REFINER_NONE || !IsCalibrated())
+        return;
+
+    if (result == REFINER_DIVERGED)
+    {
+        const CalibrationEstimate& est = m_calRefiner.Prior();
+
+        Debug.Write(wxString::Format("Calibration refinement reverting to xAngle=%.1f xRate=%.3f yAngle=%.1f yRate=%.3f\n",
+            degrees(est.xAngle), est.xRate * 1000.0, degrees(est.yAngle), est.yRate * 1000.0));
+
+        ApplyCalibrationEstimate(est);
+        m_calRefined = false;
+        return;
+    }
+
+    CalibrationEstimate est;
+    m_calRefiner.GetEstimate(&est);
+
+    CalibrationEstimate cal = { m_xRate, m_cal.yRate, m_cal.xAngle, m_cal.yAngle };
+    bool refineRA = m_calRefiner.IsImprovement(GUIDE_RA, cal.xRate, cal.xAngle);
+    bool refineDec = m_calRefiner.IsImprovement(GUIDE_DEC, cal.yRate, cal.yAngle);
+
+    if (!refineRA && !refineDec)
+        return;
+
+    if (refineRA)
+    {
+        cal.xRate = est.xRate;
+        cal.xAngle = est.xAngle;
+    }
+    if (refineDec)
+    {
+        cal.yRate = est.yRate;
+        cal.yAngle = est.yAngle;
+    }
+
+    Debug.Write(wxString::Format("Calibration refined after %u samples: xAngle %.1f -> %.1f xRate %.3f -> %.3f (conf %.2f), "
+        "yAngle %.1f -> %.1f yRate %.3f -> %.3f (conf %.2f)\n", m_calRefiner.SampleCount(),
+        degrees(m_cal.xAngle), degrees(cal.xAngle), m_xRate * 1000.0, cal.xRate * 1000.0, m_calRefiner.Confidence(GUIDE_RA),
+        degrees(m_cal.yAngle), degrees(cal.yAngle), m_cal.yRate * 1000.0, cal.yRate * 1000.0, m_calRefiner.Confidence(GUIDE_DEC)));
+
+    ApplyCalibrationEstimate(cal);
+    m_calRefined = true;
+}
+
+// Feed the guide pulses of a move to the calibration refiner; amounts are the part of
+// the pulses that moved the star
+void Mount::RefinerAddPulses(GUIDE_DIRECTION xDirection, int xAmount, GUIDE_DIRECTION yDirection, int yAmount)
+{
+    wxMutexLocker lck(m_calRefinerLock);
+
+    if (yAmount > 0)
+    {
+        // without backlash compensation the first pulse after a Dec reversal moves the
+        // star by less than its length
+        bool decReversed = m_refinerDecDir != NONE && yDirection != m_refinerDecDir;
+        m_refinerDecDir = yDirection;
+
+        if (decReversed && !(m_backlashComp && m_backlashComp->IsEnabled()))
+        {
+            m_calRefiner.Restart();
+            return;
+        }
+    }
+
+    // positive pulses correct a positive offset, see MoveOffset
+    m_calRefiner.AddPulses(xDirection == LEFT ? xAmount : -xAmount, yDirection == DOWN ? yAmount : -yAmount);
+}
+
+// Keep the refined estimate but drop the measurement history
+void Mount::RestartCalibrationRefinement()
+{
+    wxMutexLocker lck(m_calRefinerLock);
+    m_calRefiner.Restart();
+}
+
+// Start the refinement over from the current calibration, along with dropping any estimate not
+// yet applied
+void Mount::InvalidateCalibrationRefinement()
+{
+    wxMutexLocker lck(m_calRefinerLock);
+    m_calRefiner.Invalidate();
+    m_refinerResult = REFINER_NONE;
+}
+
+// Guide with the given rates and angles; the RA rate is for the current declination
+void Mount::ApplyCalibrationEstimate(const CalibrationEstimate& est)
+{
+    m_cal.xRate *= est.xRate / m_xRate;
+    m_xRate = est.xRate;
+    m_cal.yRate = est.yRate;
+    m_cal.xAngle = norm_angle(est.xAngle);
+    m_cal.yAngle = norm_angle(est.yAngle);
+    m_yAngleError = norm_angle(m_cal.xAngle - m_cal.yAngle + M_PI / 2.);
+}
+
 /*
  * The transform code has proven really tricky to get right.  For future generations
  * (and for me the next time I try to work on it), I'm going to put some notes here.
@@ -1228,6 +1613,20 @@ bool Mount::DecCompensationEnabled() const
     return false;
 }
 
+bool Mount::CalibrationRefinementEnabled() const
+{
+    return false;
+}
+
+double Mount::CalibrationRefinementConfidence(GuideAxis axis) const
+{
+    if (!CalibrationRefinementEnabled())
+        return 0.0;
+
+    wxMutexLocker lck(m_calRefinerLock);
+    return m_calRefiner.Confidence(axis);
+}
+
 /*
  * Adjust the calibration data for the scope's current coordinates.
  *
@@ -1241,7 +1640,7 @@ void Mount::AdjustCalibrationForScopePointing()
     double newDeclination = pPointingSource->GetDeclinationRadians();
     PierSide newPierSide = pPointingSource->SideOfPier();
     double newRotatorAngle = Rotator::RotatorPosition();
-    unsigned short binning = pCamera->Binning;
+    unsigned short binning = pCamera->EffectiveBinning();
 
     Debug.AddLine(wxString::Format("AdjustCalibrationForScopePointing (%s): current dec=%s pierSide=%d, cal dec=%s pierSide=%d rotAngle=%s bin=%hu",
         GetMountClassName(), DeclinationStr(newDeclination), newPierSide, DeclinationStr(m_cal.declination), m_cal.pierSide,
@@ -1388,6 +1787,9 @@ void Mount::AdjustCalibrationForScopePointing()
         Debug.Write(wxString::Format("No dec comp, asserted base xRate %.3f\n", m_cal.xRate * 1000.0));
         m_xRate = m_cal.xRate;
     }
+
+    // refinement starts over from the adjusted calibration
+    InvalidateCalibrationRefinement();
 }
 
 void Mount::IncrementRequestCount()
@@ -1416,6 +1818,22 @@ bool Mount::SynchronousOnly()
     return false;
 }
 
+bool Mount::CanMoveAxesConcurrently()
+{
+    return false;
+}
+
+Mount::MOVE_RESULT Mount::MoveAxes(GUIDE_DIRECTION xDirection, int xAmount, GUIDE_DIRECTION yDirection, int yAmount,
+                                   unsigned int moveOptions, MoveResultInfo *xMoveResult, MoveResultInfo *yMoveResult)
+{
+    MOVE_RESULT result = MoveAxis(xDirection, xAmount, moveOptions, xMoveResult);
+
+    if (result != MOVE_ERROR_SLEWING && result != MOVE_ERROR_AO_LIMIT_REACHED)
+        result = MoveAxis(yDirection, yAmount, moveOptions, yMoveResult);
+
+    return result;
+}
+
 bool Mount::HasSetupDialog() const
 {
     return false;
@@ -1506,6 +1924,8 @@ bool Mount::IsCalibrated() const
 void Mount::ClearCalibration()
 {
     m_calibrated = false;
+    InvalidateCalibrationRefinement();
+    m_calRefined = false;
     if (pFrame)
         pFrame->UpdateStatusBarCalibrationStatus();
 }
@@ -1541,6 +1961,8 @@ void Mount::SetCalibration(const Calibration& cal)
         GetMountClassName(), degrees(m_cal.xAngle), degrees(m_yAngleError)));
 
     m_calibrated = true;
+    InvalidateCalibrationRefinement();
+    m_calRefined = false;
 
     if (pFrame)
         pFrame->UpdateStatusBarCalibrationStatus();
@@ -1633,6 +2055,8 @@ void Mount::NotifyGuidingStarted()
 {
     Debug.Write("Mount: notify guiding started\n");
 
+    InvalidateCalibrationRefinement();
+
     if (m_pXGuideAlgorithm)
         m_pXGuideAlgorithm->GuidingStarted();
 
@@ -1644,6 +2068,14 @@ void Mount::NotifyGuidingStopped()
 {
     Debug.Write("Mount: notify guiding stopped\n");
 
+    if (m_calRefined && IsCalibrated())
+    {
+        // keep the refined calibration for the next guiding session
+        Debug.Write("Mount: saving refined calibration\n");
+        Calibration cal(m_cal);
+        SetCalibration(cal);
+    }
+
     if (m_pXGuideAlgorithm)
         m_pXGuideAlgorithm->GuidingStopped();
 
@@ -39,6 +39,9 @@
 #include "guide_algorithms.h"
 #include "image_math.h"
 #include "messagebox_proxy.h"
+#include "calibration_refiner.h"
+
+#include <deque>
 
 class BacklashComp;
 struct GuiderOffset;
@@ -174,6 +177,56 @@ class Mount : public wxMessageBoxProxy
     double m_xRate;         // rate adjusted for declination
     double m_yAngleError;
 
+    // timing of a move on each axis, used to account for moves that were still in
+    // progress while later guide frames were being exposed
+    struct AxisMove
+    {
+        std::chrono::steady_clock::time_point start;
+        std::chrono::steady_clock::time_point end;
+        double distance;    // signed distance moved, in mount coordinates (pixels)
+        AxisMove() : distance(0.) { }
+    };
+    struct MoveRecord
+    {
+        AxisMove axis[2];   // indexed by GuideAxis
+    };
+    enum { MaxOutstandingMoves = 8 };
+
+    // moves not yet fully seen on a guide frame, oldest first, and the star shift of the
+    // most recent move, in mount coordinates. Published by the worker thread; the main
+    // thread reads the shift in LastMoveStarShift()
+    wxMutex m_lastMoveLock;
+    std::deque<MoveRecord> m_outstandingMoves;
+    PHD_Point m_lastMoveOfs;
+    unsigned int m_moveCount;  // number of moves recorded
+
+    static AxisMove MakeAxisMove(const std::chrono::steady_clock::time_point& start,
+                                 const std::chrono::steady_clock::time_point& end, double distance, int amountMoved, double rate);
+    void RecordMove(const MoveRecord& move);
+    void UnobservedMoveDistance(const GuiderOffset& ofs, double unseen[2], double lastSeen[2]);
+
+    // refines the calibration from the guide pulses and the star response while guiding. The
+    // refiner is updated by the worker thread, which leaves its result for the main thread
+    // to apply; m_calRefinerLock guards the refiner and the pending result
+    enum REFINER_RESULT
+    {
+        REFINER_NONE,
+        REFINER_UPDATED,            // the estimate changed, apply it if it is an improvement
+        REFINER_DIVERGED,           // go back to the calibration the refinement started from
+    };
+    mutable wxMutex m_calRefinerLock;
+    CalibrationRefiner m_calRefiner;
+    REFINER_RESULT m_refinerResult;
+    bool m_calRefined;              // calibration changed by the refiner since it was last set
+    GUIDE_DIRECTION m_refinerDecDir; // direction of the last Dec pulse fed to the refiner
+
+    void RefineCalibration(const GuiderOffset& ofs, double raSeen, double decSeen);
+    void RefinerAddPulses(GUIDE_DIRECTION xDirection, int xAmount, GUIDE_DIRECTION yDirection, int yAmount);
+    void RestartCalibrationRefinement();
+    void InvalidateCalibrationRefinement();
+    void ApplyCalibrationRefinement();
+    void ApplyCalibrationEstimate(const CalibrationEstimate& est);
+
 protected:
     bool m_guidingEnabled;
 
@@ -280,12 +333,19 @@ public:
 
     void LogGuideStepInfo();
 
+    // shift of the guide star on the camera expected from the most recent move; returns a
+    // count that changes with every move so callers can tell whether a move was made
+    unsigned int LastMoveStarShift(PHD_Point *shift);
+
     GraphControlPane *GetXGuideAlgorithmControlPane(wxWindow *pParent);
     GraphControlPane *GetYGuideAlgorithmControlPane(wxWindow *pParent);
     virtual GraphControlPane *GetGraphControlPane(wxWindow *pParent, const wxString& label);
 
     virtual bool DecCompensationEnabled() const;
     virtual void AdjustCalibrationForScopePointing();
+    virtual bool CalibrationRefinementEnabled() const;
+    // confidence (0..1) of the refined calibration of an axis, 0 when refinement is off
+    double CalibrationRefinementConfidence(GuideAxis axis) const;
 
     // untranslated strings for logging
     static wxString DeclinationStr(double dec, const wxString& numFormatStr = "%.1f");
@@ -341,6 +401,12 @@ public:
 
     virtual bool HasNonGuiMove();
     virtual bool SynchronousOnly();
+    // true if the mount can move both axes at the same time (e.g. simultaneous RA and Dec ST-4 pulses)
+    virtual bool CanMoveAxesConcurrently();
+    // move both axes, completing when the longer of the two moves has completed. The
+    // default implementation moves the axes one after the other.
+    virtual MOVE_RESULT MoveAxes(GUIDE_DIRECTION xDirection, int xAmount, GUIDE_DIRECTION yDirection, int yAmount,
+                                 unsigned int moveOptions, MoveResultInfo *xMoveResult, MoveResultInfo *yMoveResult);
     virtual bool HasSetupDialog() const;
     virtual void SetupDialog();
 
@@ -1696,6 +1696,14 @@ void MyFrame::ScheduleExposure()
 
     usImage *img = new usImage();
 
+    // the windows to read out within the subframe, see usImage::Rois
+    if (!m_singleExposure.enabled && !subframe.IsEmpty())
+    {
+        pGuider->GetSearchWindows(&img->Rois);
+        if (!img->Rois.empty())
+            Debug.Write(wxString::Format("ScheduleExposure: %u windows\n", (unsigned int) img->Rois.size()));
+    }
+
     wxCriticalSectionLocker lock(m_CSpWorkerThread);
 
     if (m_pPrimaryWorkerThread) // can be null when app is shutting down (unlikely but possible)
@@ -1799,7 +1807,7 @@ bool MyFrame::StartSingleExposure(int duration, const wxRect& subframe)
     m_singleExposure.duration = duration;
     m_singleExposure.subframe = subframe;
     if (!m_singleExposure.subframe.IsEmpty())
-        m_singleExposure.subframe.Intersect(wxRect(pCamera->FullSize));
+        m_singleExposure.subframe.Intersect(wxRect(pCamera->FrameSize()));
 
     StartCapturing();
 
@@ -2311,7 +2319,7 @@ void MyFrame::LoadCalibration()
     }
 }
 
-static bool save_multi_darks(const ExposureImgMap& darks, const wxString& fname, const wxString& note)
+static bool save_multi_darks(GuideCamera *camera, const wxString& fname, const wxString& note)
 {
     bool bError = false;
 
@@ -2324,9 +2332,27 @@ static bool save_multi_darks(const ExposureImgMap& darks, const wxString& fname,
         if (status)
             throw ERROR_INFO("fits_create_file failed");
 
-        for (ExposureImgMap::const_iterator it = darks.begin(); it != darks.end(); ++it)
+        std::vector<int> exposures;
+        camera->GetDarkExposures(&exposures);
+
+        for (auto expdur : exposures)
         {
-            const usImage *const img = it->second;
+            // darks that are already in the library are read back one at a time
+            usImage libDark;
+            const usImage *img;
+            ExposureImgMap::const_iterator pos = camera->Darks.find(expdur);
+            if (pos != camera->Darks.end())
+                img = pos->second;
+            else
+            {
+                if (camera->DarkLib.ReadDark(expdur, libDark))
+                {
+                    PHD_fits_close_file(fptr);
+                    throw ERROR_INFO("error reading dark from dark library");
+                }
+                img = &libDark;
+            }
+
             long fsize[] = {
                 (long)img->Size.GetWidth(),
                 (long)img->Size.GetHeight(),
@@ -2494,10 +2520,21 @@ wxString MyFrame::DarkLibFileName(int profileId)
         wxString::Format("PHD2_dark_lib%s_%d.fit", inst > 1 ? wxString::Format("_%d", inst) : "", profileId);
 }
 
+wxString MyFrame::DarkModelFileName(int profileId)
+{
+    int inst = wxGetApp().GetInstanceNumber();
+    return MyFrame::GetDarksDir() + PATHSEPSTR +
+        wxString::Format("PHD2_dark_model%s_%d.fit", inst > 1 ? wxString::Format("_%d", inst) : "", profileId);
+}
+
 bool MyFrame::DarkLibExists(int profileId, bool showAlert)
 {
+    // the dark library is either a library of dark frames or a dark-current model
+    wxString fileName = MyFrame::DarkModelFileName(profileId);
+    if (!wxFileExists(fileName))
+        fileName = MyFrame::DarkLibFileName(profileId);
+
     bool bOk = false;
-    wxString fileName = MyFrame::DarkLibFileName(profileId);
 
     if (wxFileExists(fileName))
     {
@@ -2607,7 +2644,30 @@ bool MyFrame::LoadDarkLibrary()
         return false;
     }
 
-    if (load_multi_darks(pCamera, filename))
+    wxString modelFile = MyFrame::DarkModelFileName(pConfig->GetCurrentProfileId());
+    bool err;
+
+    if (wxFileExists(modelFile))
+    {
+        filename = modelFile;
+        DarkModel *model = DarkModel::Load(modelFile);
+        if (model)
+            pCamera->SetDarkModel(model);
+        err = model == nullptr;
+    }
+    else
+    {
+        // the library is memory-mapped from its cache file; if the cache cannot be
+        // built or opened, fall back to loading all the darks into memory
+        err = pCamera->OpenDarkLibrary(filename);
+        if (err)
+        {
+            Debug.Write("could not open dark library cache, loading darks into memory\n");
+            err = load_multi_darks(pCamera, filename);
+        }
+    }
+
+    if (err)
     {
         Debug.Write(wxString::Format("failed to load dark frames from %s\n", filename));
         StatusMsg(_("Darks not loaded"));
@@ -2628,10 +2688,20 @@ void MyFrame::SaveDarkLibrary(const wxString& note)
 
     Debug.Write("saving dark library\n");
 
-    if (save_multi_darks(pCamera->Darks, filename, note))
+    if (save_multi_darks(pCamera, filename, note))
     {
         Alert(wxString::Format(_("Error saving darks FITS file %s"), filename));
     }
+    else
+    {
+        // a library of dark frames replaces a dark-current model
+        wxString modelFile = MyFrame::DarkModelFileName(pConfig->GetCurrentProfileId());
+        if (wxFileExists(modelFile))
+        {
+            Debug.Write(wxString::Format("Removing dark model file: %s\n", modelFile));
+            wxRemoveFile(modelFile);
+        }
+    }
 }
 
 // Delete both the dark library file and any defect map file for this profile
@@ -2645,6 +2715,20 @@ void MyFrame::DeleteDarkLibraryFiles(int profileId)
         wxRemoveFile(filename);
     }
 
+    wxString cacheFile = DarkLibraryFile::CacheFileName(filename);
+    if (wxFileExists(cacheFile))
+    {
+        Debug.Write(wxString::Format("Removing dark library cache file: %s\n", cacheFile));
+        wxRemoveFile(cacheFile);
+    }
+
+    wxString modelFile = MyFrame::DarkModelFileName(profileId);
+    if (wxFileExists(modelFile))
+    {
+        Debug.Write(wxString::Format("Removing dark model file: %s\n", modelFile));
+        wxRemoveFile(modelFile);
+    }
+
     DefectMap::DeleteDefectMap(profileId);
 }
 
@@ -2741,7 +2825,7 @@ double MyFrame::GetCameraPixelScale() const
     if (!pCamera || pCamera->GetCameraPixelSize() == 0.0 || m_focalLength == 0)
         return 1.0;
 
-    return GetPixelScale(pCamera->GetCameraPixelSize(), m_focalLength, pCamera->Binning);
+    return GetPixelScale(pCamera->GetCameraPixelSize(), m_focalLength, pCamera->EffectiveBinning());
 }
 
 wxString MyFrame::PixelScaleSummary() const
@@ -2760,7 +2844,7 @@ wxString MyFrame::PixelScaleSummary() const
         focalLengthStr = wxString::Format("%d mm", m_focalLength);
 
     return wxString::Format("Pixel scale = %s, Binning = %hu, Focal length = %s",
-        scaleStr, pCamera->Binning, focalLengthStr);
+        scaleStr, pCamera->EffectiveBinning(), focalLengthStr);
 }
 
 bool MyFrame::GetBeepForLostStar()
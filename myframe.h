@@ -383,6 +383,7 @@ public:
     void SaveDarkLibrary(const wxString& note);
     static void DeleteDarkLibraryFiles(int profileID);
     static wxString DarkLibFileName(int profileId);
+    static wxString DarkModelFileName(int profileId);
     void SetDarkMenuState();
     bool LoadDarkHandler(bool checkIt);         // Use to also set menu item states
     void LoadDefectMapHandler(bool checkIt);
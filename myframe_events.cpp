@@ -351,7 +351,7 @@ void MyFrame::OnOverlaySlitCoords(wxCommandEvent& evt)
 
 void MyFrame::OnSave(wxCommandEvent& WXUNUSED(event))
 {
-    if (!pGuider->CurrentImage()->ImageData)
+    if (!pGuider->CurrentImage()->HasPixels())
         return;
 
     wxString fname = wxFileSelector( _("Save FITS Image"), (const wxChar *)NULL,
@@ -405,6 +405,9 @@ void MyFrame::FinishStop(void)
 {
     assert(!CaptureActive);
     m_singleExposure.enabled = false;
+    // do not leave the camera streaming frames nobody will consume
+    if (pCamera)
+        pCamera->StopStreaming();
     EvtServer.NotifyLoopingStopped();
     // when looping resumes, start with at least one full frame. This enables applications
     // controlling PHD to auto-select a new star if the star is lost while looping was stopped.
@@ -427,7 +430,7 @@ static void SuppressRawModeWarning(long)
 
 static void WarnRawImageMode(void)
 {
-    if (pCamera->FullSize != pCamera->DarkFrameSize())
+    if (pCamera->FrameSize() != pCamera->DarkFrameSize())
     {
         pFrame->SuppressableAlert(RawModeWarningKey(), _("For refining the Bad-pixel Map PHD2 is now displaying raw camera data frames, which are a different size from ordinary guide frames for this camera."),
             SuppressRawModeWarning, 0);
@@ -467,6 +470,9 @@ void MyFrame::OnExposeComplete(usImage *pNewFrame, bool err)
 
             delete pNewFrame;
 
+            if (pCamera)
+                pCamera->StopStreaming();
+
             bool stopping = !m_continueCapturing;
             StopCapturing();
             if (pGuider->IsCalibratingOrGuiding())
@@ -676,7 +682,7 @@ bool MyFrame::LoadDarkHandler(bool checkIt)
     }
     else
     {
-        if (!pCamera->CurrentDarkFrame)
+        if (!pCamera->HaveDarks())
         {
             m_useDarksMenuItem->Check(false);      // shouldn't have gotten here
             return false;
@@ -709,7 +715,7 @@ void MyFrame::LoadDefectMapHandler(bool checkIt)
         DefectMap *defectMap = DefectMap::LoadDefectMap(pConfig->GetCurrentProfileId());
         if (defectMap)
         {
-            if (pCamera->CurrentDarkFrame)
+            if (pCamera->HaveDarks())
                 LoadDarkHandler(false);
             pCamera->SetDefectMap(defectMap);
             m_useDarksMenuItem->Check(false);
@@ -961,7 +967,7 @@ static void SuppressDarksAlert(long)
 
 static void ValidateDarksLoaded(void)
 {
-    if (!pCamera->CurrentDarkFrame && !pCamera->CurrentDefectMap)
+    if (!pCamera->HaveDarks() && !pCamera->CurrentDefectMap)
     {
         pFrame->SuppressableAlert(DarksWarningEnabledKey(),
             _("For best results, use a Dark Library or a Bad-pixel Map "
@@ -72,10 +72,12 @@
 #include <wx/thread.h>
 #include <wx/utils.h>
 
+#include <chrono>
 #include <functional>
 #include <map>
 #include <math.h>
 #include <stdarg.h>
+#include <vector>
 
 #define APPNAME _T("PHD2 Guiding")
 #define PHDVERSION _T("2.6.12")
@@ -171,6 +173,8 @@ WX_DEFINE_ARRAY_DOUBLE(double, ArrayOfDbl);
 #include "parallelports.h"
 #include "onboard_st4.h"
 #include "cameras.h"
+#include "camera_stream.h"
+#include "dark_library.h"
 #include "camera.h"
 #include "mount.h"
 #include "scopes.h"
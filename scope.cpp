@@ -111,6 +111,9 @@ Scope::Scope()
     val = pConfig->Profile.GetBoolean(prefix + "/UseDecComp", true);
     EnableDecCompensation(val);
 
+    val = pConfig->Profile.GetBoolean(prefix + "/RefineCalibration", false);
+    EnableCalibrationRefinement(val);
+
     m_hasHPEncoders = pConfig->Profile.GetBoolean("/scope/HiResEncoders", false);
 
     m_backlashComp = new BacklashComp(this);
@@ -676,91 +679,98 @@ void Scope::AlertLimitReached(int duration, GuideAxis axis)
     }
 }
 
-Mount::MOVE_RESULT Scope::MoveAxis(GUIDE_DIRECTION direction, int duration, unsigned int moveOptions, MoveResultInfo *moveResult)
+// Apply the Dec guide mode and the max duration limits to a guide step (or deduced step) move
+int Scope::LimitMoveDuration(GUIDE_DIRECTION direction, int duration, unsigned int moveOptions, bool *limitReached)
 {
-    MOVE_RESULT result = MOVE_OK;
-    bool limitReached = false;
+    *limitReached = false;
 
-    try
+    if ((moveOptions & (MOVEOPT_ALGO_RESULT | MOVEOPT_ALGO_DEDUCE)) == 0)
+        return duration;
+
+    switch (direction)
     {
-        Debug.Write(wxString::Format("MoveAxis(%s, %d, %s)\n", DirectionChar(direction), duration, DumpMoveOptionBits(moveOptions)));
+        case NORTH:
+        case SOUTH:
 
-        if (!m_guidingEnabled && (moveOptions & MOVEOPT_MANUAL) == 0)
-        {
-            throw THROW_INFO("Guiding disabled");
-        }
+            // Enforce dec guide mode and max duration
+            if ((m_decGuideMode == DEC_NONE) ||
+                (direction == SOUTH && m_decGuideMode == DEC_NORTH) ||
+                (direction == NORTH && m_decGuideMode == DEC_SOUTH))
+            {
+                duration = 0;
+                Debug.Write("duration set to 0 by GuideMode\n");
+            }
 
-        // Compute the actual guide durations
+            if (duration > m_maxDecDuration)
+            {
+                duration = m_maxDecDuration;
+                Debug.Write(wxString::Format("duration set to %d by maxDecDuration\n", duration));
+                *limitReached = true;
+            }
 
-        switch (direction)
-        {
-            case NORTH:
-            case SOUTH:
+            if (*limitReached && direction == m_decLimitReachedDirection)
+            {
+                if (++m_decLimitReachedCount >= LIMIT_REACHED_WARN_COUNT)
+                    AlertLimitReached(duration, GUIDE_DEC);
+            }
+            else
+                m_decLimitReachedCount = 0;
 
-                // Enforce dec guide mode and max duration for guide step (or deduced step) moves
-                if (moveOptions & (MOVEOPT_ALGO_RESULT | MOVEOPT_ALGO_DEDUCE))
-                {
-                    if ((m_decGuideMode == DEC_NONE) ||
-                        (direction == SOUTH && m_decGuideMode == DEC_NORTH) ||
-                        (direction == NORTH && m_decGuideMode == DEC_SOUTH))
-                    {
-                        duration = 0;
-                        Debug.Write("duration set to 0 by GuideMode\n");
-                    }
+            if (*limitReached)
+                m_decLimitReachedDirection = direction;
+            else
+                m_decLimitReachedDirection = NONE;
+            break;
 
-                    if (duration > m_maxDecDuration)
-                    {
-                        duration = m_maxDecDuration;
-                        Debug.Write(wxString::Format("duration set to %d by maxDecDuration\n", duration));
-                        limitReached = true;
-                    }
+        case EAST:
+        case WEST:
 
-                    if (limitReached && direction == m_decLimitReachedDirection)
-                    {
-                        if (++m_decLimitReachedCount >= LIMIT_REACHED_WARN_COUNT)
-                            AlertLimitReached(duration, GUIDE_DEC);
-                    }
-                    else
-                        m_decLimitReachedCount = 0;
+            // Enforce max duration
+            if (duration > m_maxRaDuration)
+            {
+                duration = m_maxRaDuration;
+                Debug.Write(wxString::Format("duration set to %d by maxRaDuration\n", duration));
+                *limitReached = true;
+            }
 
-                    if (limitReached)
-                        m_decLimitReachedDirection = direction;
-                    else
-                        m_decLimitReachedDirection = NONE;
-                }
-                break;
-            case EAST:
-            case WEST:
+            if (*limitReached && direction == m_raLimitReachedDirection)
+            {
+                if (++m_raLimitReachedCount >= LIMIT_REACHED_WARN_COUNT)
+                    AlertLimitReached(duration, GUIDE_RA);
+            }
+            else
+                m_raLimitReachedCount = 0;
 
-                // Enforce max duration for guide step (or deduced step) moves
-                if (moveOptions & (MOVEOPT_ALGO_RESULT | MOVEOPT_ALGO_DEDUCE))
-                {
-                    if (duration > m_maxRaDuration)
-                    {
-                        duration = m_maxRaDuration;
-                        Debug.Write(wxString::Format("duration set to %d by maxRaDuration\n", duration));
-                        limitReached = true;
-                    }
+            if (*limitReached)
+                m_raLimitReachedDirection = direction;
+            else
+                m_raLimitReachedDirection = NONE;
+            break;
 
-                    if (limitReached && direction == m_raLimitReachedDirection)
-                    {
-                        if (++m_raLimitReachedCount >= LIMIT_REACHED_WARN_COUNT)
-                            AlertLimitReached(duration, GUIDE_RA);
-                    }
-                    else
-                        m_raLimitReachedCount = 0;
+        case NONE:
+            break;
+    }
 
-                    if (limitReached)
-                        m_raLimitReachedDirection = direction;
-                    else
-                        m_raLimitReachedDirection = NONE;
-                }
-                break;
+    return duration;
+}
 
-            case NONE:
-                break;
+Mount::MOVE_RESULT Scope::MoveAxis(GUIDE_DIRECTION direction, int duration, unsigned int moveOptions, MoveResultInfo *moveResult)
+{
+    MOVE_RESULT result = MOVE_OK;
+    bool limitReached = false;
+
+    try
+    {
+        Debug.Write(wxString::Format("MoveAxis(%s, %d, %s)\n", DirectionChar(direction), duration, DumpMoveOptionBits(moveOptions)));
+
+        if (!m_guidingEnabled && (moveOptions & MOVEOPT_MANUAL) == 0)
+        {
+            throw THROW_INFO("Guiding disabled");
         }
 
+        // Compute the actual guide duration
+        duration = LimitMoveDuration(direction, duration, moveOptions, &limitReached);
+
         // Actually do the guide
         if (duration > 0)
         {
@@ -790,6 +800,82 @@ Mount::MOVE_RESULT Scope::MoveAxis(GUIDE_DIRECTION direction, int duration, unsi
     return result;
 }
 
+bool Scope::CanMoveAxesConcurrently()
+{
+    return CanGuideConcurrently();
+}
+
+Mount::MOVE_RESULT Scope::MoveAxes(GUIDE_DIRECTION raDirection, int raDuration, GUIDE_DIRECTION decDirection, int decDuration,
+                                   unsigned int moveOptions, MoveResultInfo *raMoveResult, MoveResultInfo *decMoveResult)
+{
+    MOVE_RESULT result = MOVE_OK;
+    bool raLimitReached = false;
+    bool decLimitReached = false;
+
+    try
+    {
+        Debug.Write(wxString::Format("MoveAxes(%s, %d, %s, %d, %s)\n", DirectionChar(raDirection), raDuration,
+            DirectionChar(decDirection), decDuration, DumpMoveOptionBits(moveOptions)));
+
+        if (!m_guidingEnabled && (moveOptions & MOVEOPT_MANUAL) == 0)
+        {
+            throw THROW_INFO("Guiding disabled");
+        }
+
+        raDuration = LimitMoveDuration(raDirection, raDuration, moveOptions, &raLimitReached);
+        decDuration = LimitMoveDuration(decDirection, decDuration, moveOptions, &decLimitReached);
+
+        if (raDuration > 0 && decDuration > 0)
+            result = GuideConcurrently(raDirection, raDuration, decDirection, decDuration);
+        else if (raDuration > 0)
+            result = Guide(raDirection, raDuration);
+        else if (decDuration > 0)
+            result = Guide(decDirection, decDuration);
+
+        if (result != MOVE_OK)
+        {
+            throw ERROR_INFO("guide failed");
+        }
+    }
+    catch (const wxString& Msg)
+    {
+        POSSIBLY_UNUSED(Msg);
+        if (result == MOVE_OK)
+            result = MOVE_ERROR;
+        raDuration = 0;
+        decDuration = 0;
+    }
+
+    Debug.Write(wxString::Format("MoveAxes returns status %d, amounts %d, %d\n", result, raDuration, decDuration));
+
+    if (raMoveResult)
+    {
+        raMoveResult->amountMoved = raDuration;
+        raMoveResult->limited = raLimitReached;
+    }
+
+    if (decMoveResult)
+    {
+        decMoveResult->amountMoved = decDuration;
+        decMoveResult->limited = decLimitReached;
+    }
+
+    return result;
+}
+
+bool Scope::CanGuideConcurrently()
+{
+    return false;
+}
+
+Mount::MOVE_RESULT Scope::GuideConcurrently(GUIDE_DIRECTION raDirection, int raDurationMs, GUIDE_DIRECTION decDirection, int decDurationMs)
+{
+    MOVE_RESULT result = Guide(raDirection, raDurationMs);
+    if (result == MOVE_OK)
+        result = Guide(decDirection, decDurationMs);
+    return result;
+}
+
 static wxString CalibrationWarningKey(CalibrationIssueType etype)
 {
     wxString qual;
@@ -966,14 +1052,14 @@ void Scope::CheckCalibrationDuration(int currDuration)
     CalibrationDetails calDetails;
     LoadCalibrationDetails(&calDetails);
 
-    bool binningChange = pCamera->Binning != calDetails.origBinning;
+    bool binningChange = pCamera->EffectiveBinning() != calDetails.origBinning;
 
     // if binning changed, may need to update the calibration distance
     if (binningChange)
     {
         int prevDistance = GetCalibrationDistance();
         int newDistance = CalstepDialog::GetCalibrationDistance(pFrame->GetFocalLength(), pCamera->GetCameraPixelSize(),
-            pCamera->Binning);
+            pCamera->EffectiveBinning());
 
         if (newDistance != prevDistance)
         {
@@ -1001,7 +1087,7 @@ void Scope::CheckCalibrationDuration(int currDuration)
 
     int rslt;
     CalstepDialog::GetCalibrationStepSize(pFrame->GetFocalLength(), pCamera->GetCameraPixelSize(),
-        pCamera->Binning, currSpdX, CalstepDialog::DEFAULT_STEPS, 0.0, GetCalibrationDistance(), 0, &rslt);
+        pCamera->EffectiveBinning(), currSpdX, CalstepDialog::DEFAULT_STEPS, 0.0, GetCalibrationDistance(), 0, &rslt);
 
     wxString why = binningChange ? " binning " : " mount guide speed ";
     Debug.Write(wxString::Format("CalDuration adjusted at start of calibration from %d to %d because of %s change\n",
@@ -1116,6 +1202,13 @@ void Scope::EnableDecCompensation(bool enable)
     pConfig->Profile.SetBoolean(prefix + "/UseDecComp", enable);
 }
 
+void Scope::EnableCalibrationRefinement(bool enable)
+{
+    m_refineCalibration = enable;
+    wxString prefix = "/" + GetMountClassName();
+    pConfig->Profile.SetBoolean(prefix + "/RefineCalibration", enable);
+}
+
 int Scope::CalibrationTotDistance()
 {
     return GetCalibrationDistance();
@@ -1678,11 +1771,11 @@ bool Scope::UpdateCalibrationState(const PHD_Point& currentLocation)
                 cal.declination = pPointingSource->GetDeclinationRadians();
                 cal.pierSide = pPointingSource->SideOfPier();
                 cal.rotatorAngle = Rotator::RotatorPosition();
-                cal.binning = pCamera->Binning;
+                cal.binning = pCamera->EffectiveBinning();
                 SetCalibration(cal);
                 m_calibrationDetails.raStepCount = m_raSteps;
                 m_calibrationDetails.decStepCount = m_decSteps;
-                SetCalibrationDetails(m_calibrationDetails, m_calibration.xAngle, m_calibration.yAngle, pCamera->Binning);
+                SetCalibrationDetails(m_calibrationDetails, m_calibration.xAngle, m_calibration.yAngle, pCamera->EffectiveBinning());
                 if (SANITY_CHECKING_ACTIVE)
                     SanityCheckCalibration(m_prevCalibration, m_prevCalibrationDetails);  // method gets "new" info itself
                 pFrame->StatusMsg(_("Calibration complete"));
@@ -1857,9 +1950,9 @@ wxString Scope::GetSettingsSummary() const
 wxString Scope::CalibrationSettingsSummary() const
 {
     return wxString::Format("Calibration Step = %d ms, Calibration Distance = %d px, "
-                            "Assume orthogonal axes = %s\n",
+                            "Assume orthogonal axes = %s, Refine calibration = %s\n",
                             GetCalibrationDuration(), GetCalibrationDistance(),
-                            IsAssumeOrthogonal() ? "yes" : "no") +
+                            IsAssumeOrthogonal() ? "yes" : "no", CalibrationRefinementEnabled() ? "yes" : "no") +
             GuideSpeedSummary();
 }
 
@@ -1998,6 +2091,12 @@ ScopeConfigDialogCtrlSet::ScopeConfigDialogCtrlSet(wxWindow *pParent, Scope *pSc
             AddCtrl(CtrlMap, AD_cbUseDecComp, m_pUseDecComp,
                 _("Automatically adjust RA guide rate based on scope declination"));
 
+            m_pRefineCalibration = new wxCheckBox(GetParentWindow(AD_cbRefineCalibration), wxID_ANY, _("Refine calibration while guiding"));
+            m_pRefineCalibration->Enable(enableCtrls);
+            AddCtrl(CtrlMap, AD_cbRefineCalibration, m_pRefineCalibration,
+                _("Continuously refine the calibration rates and angles from the star response to guide pulses and dithers. "
+                  "Confident changes are applied and saved when guiding stops."));
+
             width = StringWidth(_T("00000"));
             m_pMaxRaDuration = pFrame->MakeSpinCtrl(GetParentWindow(AD_szMaxRAAmt), wxID_ANY, wxEmptyString,
                 wxDefaultPosition, wxSize(width, -1), wxSP_ARROW_KEYS, MAX_DURATION_MIN, MAX_DURATION_MAX, 150,
@@ -2056,6 +2155,7 @@ void ScopeConfigDialogCtrlSet::LoadValues()
         Mount::MountConfigDialogPane* pCurrMountPane = pFrame->pAdvancedDialog->GetCurrentMountPane();
         pCurrMountPane->EnableDecControls(whichDecMode != DEC_NONE);
         m_pUseDecComp->SetValue(m_pScope->DecCompensationEnabled());
+        m_pRefineCalibration->SetValue(m_pScope->CalibrationRefinementEnabled());
         m_origBLCEnabled = m_pScope->m_backlashComp->IsEnabled();
         if (whichDecMode == DEC_AUTO)
         {
@@ -2116,6 +2216,7 @@ void ScopeConfigDialogCtrlSet::UnloadValues()
     if (!usingAO)
     {
         m_pScope->EnableDecCompensation(m_pUseDecComp->GetValue());
+        m_pScope->EnableCalibrationRefinement(m_pRefineCalibration->GetValue());
         m_pScope->SetMaxRaDuration(m_pMaxRaDuration->GetValue());
         if (!m_pScope->m_backlashComp->IsEnabled())                       // handled above
             m_pScope->SetMaxDecDuration(m_pMaxDecDuration->GetValue());
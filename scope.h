@@ -63,6 +63,7 @@ class ScopeConfigDialogCtrlSet : public MountConfigDialogCtrlSet
     wxSpinCtrlDouble *m_pBacklashFloor;
     wxSpinCtrlDouble *m_pBacklashCeiling;
     wxCheckBox *m_pUseDecComp;
+    wxCheckBox *m_pRefineCalibration;
     int m_calibrationDistance;
     bool m_origBLCEnabled;
 
@@ -133,6 +134,7 @@ class Scope : public Mount
     CalibrationIssueType m_lastCalibrationIssue;
 
     bool m_useDecCompensation;
+    bool m_refineCalibration;
     bool m_hasHPEncoders;
 
     enum CALIBRATION_STATE
@@ -235,6 +237,8 @@ public:
     static const double DEFAULT_MOUNT_GUIDE_SPEED;              // Presumptive mount guide speed if no usable mount connection
     void EnableDecCompensation(bool enable);
     bool DecCompensationEnabled() const override;
+    void EnableCalibrationRefinement(bool enable);
+    bool CalibrationRefinementEnabled() const override;
 
     virtual bool RequiresCamera();
     virtual bool RequiresStepGuider();
@@ -267,6 +271,8 @@ public:
     virtual bool PreparePositionInteractive();
     virtual bool CanPulseGuide();
 
+    bool CanMoveAxesConcurrently() override;
+
     void StartDecDrift() override;
     void EndDecDrift() override;
     bool IsDecDrifting() const override;
@@ -276,6 +282,9 @@ private:
     // by a subclass
     MOVE_RESULT MoveAxis(GUIDE_DIRECTION direction, int durationMs, unsigned int moveOptions, MoveResultInfo *moveResultInfo) final;
     MOVE_RESULT MoveAxis(GUIDE_DIRECTION direction, int duration, unsigned int moveOptions) final;
+    MOVE_RESULT MoveAxes(GUIDE_DIRECTION raDirection, int raDurationMs, GUIDE_DIRECTION decDirection, int decDurationMs,
+                         unsigned int moveOptions, MoveResultInfo *raMoveResult, MoveResultInfo *decMoveResult) final;
+    int LimitMoveDuration(GUIDE_DIRECTION direction, int duration, unsigned int moveOptions, bool *limitReached);
     int CalibrationMoveSize() override;
     void CheckCalibrationDuration(int currDuration);
     int CalibrationTotDistance() override;
@@ -289,6 +298,12 @@ private:
 // these MUST be supplied by a subclass
 private:
     virtual MOVE_RESULT Guide(GUIDE_DIRECTION direction, int durationMs) = 0;
+
+// these CAN be supplied by a subclass that is able to pulse RA and Dec at the same time
+private:
+    virtual bool CanGuideConcurrently();
+    // start both pulses together and return when the longer one has completed
+    virtual MOVE_RESULT GuideConcurrently(GUIDE_DIRECTION raDirection, int raDurationMs, GUIDE_DIRECTION decDirection, int decDurationMs);
 };
 
 inline bool Scope::IsStopGuidingWhenSlewingEnabled() const
@@ -306,6 +321,11 @@ inline bool Scope::DecCompensationEnabled() const
     return m_useDecCompensation;
 }
 
+inline bool Scope::CalibrationRefinementEnabled() const
+{
+    return m_refineCalibration;
+}
+
 inline int Scope::GetCalibrationDuration() const
 {
     return m_calibrationDuration;
@@ -85,8 +85,7 @@ class ScopeINDI : public Scope, public INDI::BaseClient
 
         wxMutex sync_lock;
         wxCondition sync_cond;
-        bool guide_active;
-        GuideAxis guide_active_axis;
+        bool guide_active[2]; // indexed by GuideAxis
 
         long     INDIport;
         wxString INDIhost;
@@ -99,6 +98,8 @@ class ScopeINDI : public Scope, public INDI::BaseClient
         bool     ConnectToDriver(RunInBg *ctx);
         void     ClearStatus();
         void     CheckState();
+        void     SendGuidePulse(GUIDE_DIRECTION direction, int duration);
+        MOVE_RESULT WaitForGuidePulses();
 
     protected:
         void newDevice(INDI::BaseDevice dp) override;
@@ -119,6 +120,12 @@ class ScopeINDI : public Scope, public INDI::BaseClient
         void     SetupDialog() override;
 
         MOVE_RESULT Guide(GUIDE_DIRECTION direction, int duration) override;
+        bool CanGuideConcurrently() override
+        {
+            // the NS and EW timed guide properties are independent, so both axes can be pulsed at once
+            return (pulseGuideNS_prop && pulseGuideEW_prop);
+        }
+        MOVE_RESULT GuideConcurrently(GUIDE_DIRECTION raDirection, int raDuration, GUIDE_DIRECTION decDirection, int decDuration) override;
         bool HasNonGuiMove() override;
 
         bool   CanPulseGuide() override
@@ -187,7 +194,7 @@ void ScopeINDI::ClearStatus()
     // reset connection status
     m_ready = false;
     eod_coord = false;
-    guide_active = false;
+    guide_active[GUIDE_RA] = guide_active[GUIDE_DEC] = false;
     sync_cond.Broadcast(); // just in case worker thread was blocked waiting for guide pulse to complete
 }
 
@@ -446,19 +453,17 @@ void ScopeINDI::updateProperty(INDI::Property property)
             if (nvp == pulseGuideEW_prop || nvp == pulseGuideNS_prop)
             {
                 bool notify = false;
+                GuideAxis axis = nvp == pulseGuideEW_prop ? GUIDE_RA : GUIDE_DEC;
                 {
                     wxMutexLocker lck(sync_lock);
-                    if (guide_active && nvp->s != IPS_BUSY &&
-                            ((guide_active_axis == GUIDE_RA && nvp == pulseGuideEW_prop) || (guide_active_axis == GUIDE_DEC
-                                    && nvp == pulseGuideNS_prop)))
+                    if (guide_active[axis] && nvp->s != IPS_BUSY)
                     {
-                        guide_active = false;
+                        guide_active[axis] = false;
                         notify = true;
                     }
-                    else if (!guide_active && nvp->s == IPS_BUSY)
+                    else if (!guide_active[axis] && nvp->s == IPS_BUSY)
                     {
-                        guide_active = true;
-                        guide_active_axis = nvp == pulseGuideEW_prop ? GUIDE_RA : GUIDE_DEC;
+                        guide_active[axis] = true;
                     }
                 }
                 if (notify)
@@ -596,6 +601,101 @@ void ScopeINDI::newProperty(INDI::Property property)
     CheckState();
 }
 
+void ScopeINDI::SendGuidePulse(GUIDE_DIRECTION direction, int duration)
+{
+    // despite what is said in INDI standard properties description, every telescope driver expect the guided time in msec.
+    switch (direction)
+    {
+        case EAST:
+            pulseE_prop->value = duration;
+            pulseW_prop->value = 0;
+            sendNewNumber(pulseGuideEW_prop);
+            break;
+        case WEST:
+            pulseE_prop->value = 0;
+            pulseW_prop->value = duration;
+            sendNewNumber(pulseGuideEW_prop);
+            break;
+        case NORTH:
+            pulseN_prop->value = duration;
+            pulseS_prop->value = 0;
+            sendNewNumber(pulseGuideNS_prop);
+            break;
+        case SOUTH:
+            pulseN_prop->value = 0;
+            pulseS_prop->value = duration;
+            sendNewNumber(pulseGuideNS_prop);
+            break;
+        default:
+            break;
+    }
+}
+
+Mount::MOVE_RESULT ScopeINDI::WaitForGuidePulses()
+{
+    if (INDIConfig::Verbose())
+        Debug.Write("INDI Mount: wait for move complete\n");
+
+    {
+        // lock scope
+        wxMutexLocker lck(sync_lock);
+        while (guide_active[GUIDE_RA] || guide_active[GUIDE_DEC])
+        {
+            sync_cond.WaitTimeout(100);
+            if (WorkerThread::InterruptRequested())
+            {
+                Debug.Write("interrupt requested\n");
+                return MOVE_ERROR;
+            }
+        }
+    } // lock scope
+
+    if (INDIConfig::Verbose())
+        Debug.Write("INDI Mount: move completed\n");
+
+    return MOVE_OK;
+}
+
+Mount::MOVE_RESULT ScopeINDI::GuideConcurrently(GUIDE_DIRECTION raDirection, int raDuration, GUIDE_DIRECTION decDirection, int decDuration)
+{
+    if (!pulseGuideNS_prop || !pulseGuideEW_prop)
+    {
+        Debug.Write(wxString::Format("INDI Mount: pulse guide properties unavailable!\n"));
+        return MOVE_ERROR;
+    }
+
+    if (INDIConfig::Verbose())
+        Debug.Write(wxString::Format("INDI Mount: concurrent timed pulses RA dir %d dur %d ms, Dec dir %d dur %d ms\n",
+                                     raDirection, raDuration, decDirection, decDuration));
+
+    if ((raDirection != EAST && raDirection != WEST) || (decDirection != NORTH && decDirection != SOUTH))
+    {
+        Debug.Write("INDI Mount error ScopeINDI::GuideConcurrently invalid direction\n");
+        return MOVE_ERROR;
+    }
+
+    // set guide active on both axes before initiating the pulses
+
+    {
+        wxMutexLocker lck(sync_lock);
+
+        if (guide_active[GUIDE_RA] || guide_active[GUIDE_DEC])
+        {
+            Debug.Write("Cannot guide with guide pulse in progress!\n");
+            return MOVE_ERROR;
+        }
+
+        guide_active[GUIDE_RA] = true;
+        guide_active[GUIDE_DEC] = true;
+
+    } // lock scope
+
+    SendGuidePulse(raDirection, raDuration);
+    SendGuidePulse(decDirection, decDuration);
+
+    return WaitForGuidePulses();
+}
+
 Mount::MOVE_RESULT ScopeINDI::Guide(GUIDE_DIRECTION direction, int duration)
 {
     if (pulseGuideNS_prop && pulseGuideEW_prop)
@@ -617,69 +717,25 @@ Mount::MOVE_RESULT ScopeINDI::Guide(GUIDE_DIRECTION direction, int duration)
 
         // set guide active before initiating the pulse
 
+        GuideAxis axis = direction == EAST || direction == WEST ? GUIDE_RA : GUIDE_DEC;
+
         {
             wxMutexLocker lck(sync_lock);
 
-            if (guide_active)
+            if (guide_active[GUIDE_RA] || guide_active[GUIDE_DEC])
             {
                 // todo: try to abort it?
                 Debug.Write("Cannot guide with guide pulse in progress!\n");
                 return MOVE_ERROR;
             }
 
-            guide_active = true;
-            guide_active_axis = direction == EAST || direction == WEST ? GUIDE_RA : GUIDE_DEC;
+            guide_active[axis] = true;
 
         } // lock scope
 
-        // despite what is said in INDI standard properties description, every telescope driver expect the guided time in msec.
-        switch (direction)
-        {
-            case EAST:
-                pulseE_prop->value = duration;
-                pulseW_prop->value = 0;
-                sendNewNumber(pulseGuideEW_prop);
-                break;
-            case WEST:
-                pulseE_prop->value = 0;
-                pulseW_prop->value = duration;
-                sendNewNumber(pulseGuideEW_prop);
-                break;
-            case NORTH:
-                pulseN_prop->value = duration;
-                pulseS_prop->value = 0;
-                sendNewNumber(pulseGuideNS_prop);
-                break;
-            case SOUTH:
-                pulseN_prop->value = 0;
-                pulseS_prop->value = duration;
-                sendNewNumber(pulseGuideNS_prop);
-                break;
-            default:
-                break;
-        }
-
-        if (INDIConfig::Verbose())
-            Debug.Write("INDI Mount: wait for move complete\n");
+        SendGuidePulse(direction, duration);
 
-        {
-            // lock scope
-            wxMutexLocker lck(sync_lock);
-            while (guide_active)
-            {
-                sync_cond.WaitTimeout(100);
-                if (WorkerThread::InterruptRequested())
-                {
-                    Debug.Write("interrupt requested\n");
-                    return MOVE_ERROR;
-                }
-            }
-        } // lock scope
-
-        if (INDIConfig::Verbose())
-            Debug.Write("INDI Mount: move completed\n");
-
-        return MOVE_OK;
+        return WaitForGuidePulses();
     }
     // guide using motion rate and telescope motion
     // !!! untested as no driver implement TELESCOPE_MOTION_RATE at the moment (INDI 0.9.9) !!!
@@ -124,6 +124,17 @@ static double hfr(std::vector<R2M>& vec, double cx, double cy, double mass)
 }
 
 bool Star::Find(const usImage *pImg, int searchRegion, int base_x, int base_y, FindMode mode, double minHFD, double maxHFD, unsigned short maxADU, StarFindLogType loggingControl)
+{
+    // 8-bit frames are measured in place
+    if (pImg->Packed8)
+        return FindImpl(pImg, pImg->ImageData8, searchRegion, base_x, base_y, mode, minHFD, maxHFD, maxADU, loggingControl);
+    else
+        return FindImpl(pImg, pImg->ImageData, searchRegion, base_x, base_y, mode, minHFD, maxHFD, maxADU, loggingControl);
+}
+
+template<typename T>
+bool Star::FindImpl(const usImage *pImg, const T *imgdata, int searchRegion, int base_x, int base_y, FindMode mode, double minHFD, double maxHFD,
+                    unsigned short maxADU, StarFindLogType loggingControl)
 {
     FindResult Result = STAR_OK;
     double newX = base_x;
@@ -135,22 +146,18 @@ bool Star::Find(const usImage *pImg, int searchRegion, int base_x, int base_y, F
             Debug.Write(wxString::Format("Star::Find(%d, %d, %d, %d, (%d,%d,%d,%d), %.1f, %0.1f, %hu) frame %u\n", searchRegion, base_x, base_y, mode,
             pImg->Subframe.x, pImg->Subframe.y, pImg->Subframe.width, pImg->Subframe.height, minHFD, maxHFD, maxADU, pImg->FrameNum));
 
-        int minx, miny, maxx, maxy;
-
-        if (pImg->Subframe.IsEmpty())
+        // the search is confined to the frame, the subframe, or the window read out around the star
+        wxRect valid(pImg->ValidRectAt(wxPoint(base_x, base_y)));
+        if (valid.IsEmpty())
         {
-            minx = miny = 0;
-            maxx = pImg->Size.GetWidth() - 1;
-            maxy = pImg->Size.GetHeight() - 1;
-        }
-        else
-        {
-            minx = pImg->Subframe.GetLeft();
-            maxx = pImg->Subframe.GetRight();
-            miny = pImg->Subframe.GetTop();
-            maxy = pImg->Subframe.GetBottom();
+            throw ERROR_INFO("coordinates are not in a window");
         }
 
+        int minx = valid.GetLeft();
+        int maxx = valid.GetRight();
+        int miny = valid.GetTop();
+        int maxy = valid.GetBottom();
+
         // search region bounds
         int start_x = wxMax(base_x - searchRegion, minx);
         int end_x   = wxMin(base_x + searchRegion, maxx);
@@ -162,7 +169,6 @@ bool Star::Find(const usImage *pImg, int searchRegion, int base_x, int base_y, F
             throw ERROR_INFO("coordinates are invalid");
         }
 
-        const unsigned short *imgdata = pImg->ImageData;
         int rowsize = pImg->Size.GetWidth();
 
         int peak_x = 0, peak_y = 0;
@@ -231,7 +237,7 @@ bool Star::Find(const usImage *pImg, int searchRegion, int base_x, int base_y, F
 
         // meaure noise in the annulus with inner radius A and outer radius B
         int const A = 7;   // inner radius
-        int const B = 12;  // outer radius
+        int const B = BACKGROUND_RADIUS;  // outer radius
         int const A2 = A * A;
         int const B2 = B * B;
 
@@ -255,7 +261,7 @@ bool Star::Find(const usImage *pImg, int searchRegion, int base_x, int base_y, F
             double q = 0.0;
             nbg = 0;
 
-            const unsigned short *row = imgdata + rowsize * start_y;
+            const T *row = imgdata + rowsize * start_y;
             for (int y = start_y; y <= end_y; y++, row += rowsize)
             {
                 int dy = y - peak_y;
@@ -327,7 +333,7 @@ bool Star::Find(const usImage *pImg, int searchRegion, int base_x, int base_y, F
 
             n = 0;
 
-            const unsigned short *row = imgdata + rowsize * start_y;
+            const T *row = imgdata + rowsize * start_y;
             for (int y = start_y; y <= end_y; y++, row += rowsize)
             {
                 int dy = y - peak_y;
@@ -946,8 +952,11 @@ bool GuideStar::AutoFind(const usImage& image, int extraEdgeAllowance, int searc
         //  first, find the peak pixel overall
         unsigned short maxVal = 0;
         for (unsigned int i = 0; i < image.NPixels; i++)
-        if (image.ImageData[i] > maxVal)
-            maxVal = image.ImageData[i];
+        {
+            unsigned short const val = image.Packed8 ? image.ImageData8[i] : image.ImageData[i];
+            if (val > maxVal)
+                maxVal = val;
+        }
 
         // next see if any of the stars has a flat-top
         bool foundSaturated = false;
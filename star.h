@@ -68,6 +68,10 @@ public:
         FIND_LOGGING_VERBOSE,
     };
 
+    // outer radius of the background annulus that Find measures around the star; the image
+    // data needs to extend this far beyond the search region
+    enum { BACKGROUND_RADIUS = 12 };
+
     double Mass;
     double SNR;
     double HFD;
@@ -91,6 +95,10 @@ public:
 
 private:
     FindResult m_lastFindResult;
+
+    template<typename T>
+    bool FindImpl(const usImage *pImg, const T *imgdata, int searchRegion, int X, int Y, FindMode mode, double min_hfd, double max_hfd,
+        unsigned short saturation, StarFindLogType loggingControl);
 };
 
 inline Star::FindResult Star::GetError() const
@@ -178,7 +178,7 @@ wxCAPTION | wxCLOSE_BOX | wxMINIMIZE_BOX | wxSYSTEM_MENU | wxTAB_TRAVERSAL | wxF
     m_pxScale = pFrame->GetCameraPixelScale();
     // Fullsize is easier but the camera simulator does not set this.
 //    wxSize camsize = pCamera->FullSize;
-    m_camWidth = pCamera->FullSize.GetWidth() == 0 ? xpx: pCamera->FullSize.GetWidth();
+    m_camWidth = pCamera->FrameSize().GetWidth() == 0 ? xpx: pCamera->FrameSize().GetWidth();
 
     m_camAngle = 0.0;
     double camAngle_rad = 0.0;
@@ -321,7 +321,7 @@ void StatsWindow::UpdateScopePointing()
         m_grid2->SetCellValue(row++, col, Mount::DeclinationStrTr(declination, "% .1f" DEGREES_SYMBOL));
         m_grid2->SetCellValue(row++, col, Mount::PierSideStrTr(pierSide));
         m_grid2->SetCellValue(row++, col, RotatorPosStr());
-        m_grid2->SetCellValue(row++, col, pCamera ? wxString::Format("%hu", pCamera->Binning) : _("N/A"));
+        m_grid2->SetCellValue(row++, col, pCamera ? wxString::Format("%hu", pCamera->EffectiveBinning()) : _("N/A"));
         m_grid2->EndBatch();
     }
 }
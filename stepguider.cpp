@@ -749,9 +749,9 @@ bool StepGuider::UpdateCalibrationState(const PHD_Point& currentLocation)
                 m_calibration.pierSide = PIER_SIDE_UNKNOWN;
                 m_calibration.raGuideParity = m_calibration.decGuideParity = GUIDE_PARITY_UNKNOWN;
                 m_calibration.rotatorAngle = Rotator::RotatorPosition();
-                m_calibration.binning = pCamera->Binning;
+                m_calibration.binning = pCamera->EffectiveBinning();
                 SetCalibration(m_calibration);
-                SetCalibrationDetails(m_calibrationDetails, m_calibration.xAngle, m_calibration.yAngle, pCamera->Binning);
+                SetCalibrationDetails(m_calibrationDetails, m_calibration.xAngle, m_calibration.yAngle, pCamera->EffectiveBinning());
                 status0 = _("Calibration complete");
                 GuideLog.CalibrationComplete(this);
                 Debug.Write("Calibration Complete\n");
@@ -1307,7 +1307,7 @@ void StepGuider::AdjustCalibrationForScopePointing()
 {
     // compensate for binning change
 
-    unsigned short binning = pCamera->Binning;
+    unsigned short binning = pCamera->EffectiveBinning();
 
     if (binning == m_calibration.binning)
     {
@@ -68,7 +68,8 @@ class HistogramBuilder {
         }
 
 
-        void scan(const unsigned short *t, int len)
+        template<typename T>
+        void scan(const T *t, int len)
         {
             if (pixCount == 0) {
                 unsigned short v = t[0];
@@ -109,109 +110,225 @@ bool usImage::Init(const wxSize& size)
     Size = size;
     Subframe = wxRect(0, 0, 0, 0);
     MinADU = MaxADU = MedianADU = 0;
+    Packed8 = false;
 
     if (NPixels != prev)
     {
         delete[] ImageData;
+        ImageData = nullptr;
+        delete[] ImageData8;
+        ImageData8 = nullptr;
+    }
 
-        if (NPixels)
+    // an 8-bit frame of the same size may not have had its 16-bit pixels allocated
+    if (NPixels && !ImageData)
+    {
+        ImageData = new unsigned short[NPixels];
+        if (!ImageData)
         {
-            ImageData = new unsigned short[NPixels];
-            if (!ImageData)
-            {
-                NPixels = 0;
-                return true;
-            }
+            NPixels = 0;
+            return true;
         }
-        else
-            ImageData = nullptr;
     }
 
     return false;
 }
 
+bool usImage::Init8(const wxSize& size)
+{
+    // like Init, but only the 8-bit pixels are allocated; Widen() allocates the 16-bit pixels
+    unsigned int prev = NPixels;
+    NPixels = size.GetWidth() * size.GetHeight();
+    Size = size;
+    Subframe = wxRect(0, 0, 0, 0);
+    MinADU = MaxADU = MedianADU = 0;
+
+    if (NPixels != prev)
+    {
+        delete[] ImageData;
+        ImageData = nullptr;
+        delete[] ImageData8;
+        ImageData8 = nullptr;
+    }
+
+    if (NPixels && !ImageData8)
+    {
+        ImageData8 = new unsigned char[NPixels];
+        if (!ImageData8)
+        {
+            NPixels = 0;
+            return true;
+        }
+    }
+    Packed8 = NPixels != 0;
+
+    return false;
+}
+
+void usImage::Widen()
+{
+    if (!Packed8)
+        return;
+
+    if (!ImageData)
+        ImageData = new unsigned short[NPixels];
+
+    // a plain loop over the frame that the compiler vectorizes
+    for (unsigned int i = 0; i < NPixels; i++)
+        ImageData[i] = ImageData8[i];
+    Packed8 = false;
+}
+
 void usImage::SwapImageData(usImage& other)
 {
     unsigned short *t = ImageData;
     ImageData = other.ImageData;
     other.ImageData = t;
+
+    unsigned char *t8 = ImageData8;
+    ImageData8 = other.ImageData8;
+    other.ImageData8 = t8;
+
+    bool p = Packed8;
+    Packed8 = other.Packed8;
+    other.Packed8 = p;
 }
 
-void usImage::CalcStats()
+void usImage::ValidRects(std::vector<wxRect> *rects) const
 {
-    if (!ImageData || !NPixels)
+    rects->clear();
+
+    if (Subframe.IsEmpty())
+    {
+        rects->push_back(wxRect(Size));
         return;
+    }
 
-    MinADU = 65535; MaxADU = 0;
-    FiltMin = 65535; FiltMax = 0;
+    if (HasRois())
+    {
+        for (const wxRect& roi : Rois)
+        {
+            wxRect r(roi);
+            r.Intersect(Subframe);
+            if (!r.IsEmpty())
+                rects->push_back(r);
+        }
+    }
 
-    if (Subframe.IsEmpty())
+    if (rects->empty())
+        rects->push_back(Subframe);
+}
+
+// without windows this is the subframe or the whole frame, whether or not it contains pt
+wxRect usImage::ValidRectAt(const wxPoint& pt) const
+{
+    if (!HasRois())
+        return Subframe.IsEmpty() ? wxRect(Size) : Subframe;
+
+    std::vector<wxRect> rects;
+    ValidRects(&rects);
+    for (const wxRect& r : rects)
+    {
+        if (r.Contains(pt))
+            return r;
+    }
+    return wxRect();
+}
+
+// statistics of the frame or subframe, or of the windows read out, for either pixel type
+template<typename T>
+static void calc_stats(usImage& img, const T *data)
+{
+    img.MinADU = 65535; img.MaxADU = 0;
+    img.FiltMin = 65535; img.FiltMax = 0;
+
+    if (img.Subframe.IsEmpty())
     {
         // full frame, no subframe
 
         HistogramBuilder hb;
-        hb.scan(ImageData, NPixels);
-        MinADU = hb.MinADU;
-        MaxADU = hb.MaxADU;
-        MedianADU = hb.median();
+        hb.scan(data, img.NPixels);
+        img.MinADU = hb.MinADU;
+        img.MaxADU = hb.MaxADU;
+        img.MedianADU = hb.median();
 
-        unsigned short *tmpdata = new unsigned short[NPixels];
+        unsigned short *tmpdata = new unsigned short[img.NPixels];
 
-        Median3(tmpdata, ImageData, Size, wxRect(Size));
+        Median3(tmpdata, data, img.Size, wxRect(img.Size));
 
         const unsigned short *src = tmpdata;
-        for (unsigned int i = 0; i < NPixels; i++)
+        for (unsigned int i = 0; i < img.NPixels; i++)
         {
             unsigned short d = *src++;
-            if (d < FiltMin) FiltMin = d;
-            if (d > FiltMax) FiltMax = d;
+            if (d < img.FiltMin) img.FiltMin = d;
+            if (d > img.FiltMax) img.FiltMax = d;
         }
 
         delete[] tmpdata;
     }
     else
     {
-        // Subframe
+        // Subframe, or the windows within it
 
-        unsigned int pixcnt = Subframe.width * Subframe.height;
-        unsigned short *tmpdata = new unsigned short[pixcnt];
+        std::vector<wxRect> rects;
+        img.ValidRects(&rects);
 
-        unsigned short *dst;
+        unsigned int pixcnt = 0;
+        for (const wxRect& r : rects)
+            pixcnt += r.width * r.height;
+        T *tmpdata = new T[pixcnt];
 
-        dst = tmpdata;
-        for (int y = 0; y < Subframe.height; y++)
+        T *dst = tmpdata;
+        for (const wxRect& r : rects)
         {
-            const unsigned short *src = ImageData + Subframe.x + (Subframe.y + y) * Size.GetWidth();
-            for (int x = 0; x < Subframe.width; x++)
+            for (int y = 0; y < r.height; y++)
             {
-                unsigned short d = *src;
-                *dst++ = *src++;
+                const T *src = data + r.x + (r.y + y) * img.Size.GetWidth();
+                for (int x = 0; x < r.width; x++)
+                    *dst++ = *src++;
             }
         }
 
         HistogramBuilder hb;
         hb.scan(tmpdata, pixcnt);
-        MinADU = hb.MinADU;
-        MaxADU = hb.MaxADU;
-        MedianADU = hb.median();
+        img.MinADU = hb.MinADU;
+        img.MaxADU = hb.MaxADU;
+        img.MedianADU = hb.median();
 
-        dst = new unsigned short[pixcnt];
+        unsigned short *filt = new unsigned short[pixcnt];
 
-        Median3(dst, tmpdata, Subframe.GetSize(), wxRect(Subframe.GetSize()));
+        // each window is filtered on its own, its pixels are contiguous in tmpdata
+        unsigned int ofs = 0;
+        for (const wxRect& r : rects)
+        {
+            Median3(filt + ofs, tmpdata + ofs, r.GetSize(), wxRect(r.GetSize()));
+            ofs += r.width * r.height;
+        }
 
-        const unsigned short *src = dst;
+        const unsigned short *src = filt;
         for (unsigned int i = 0; i < pixcnt; i++)
         {
             unsigned short d = *src++;
-            if (d < FiltMin) FiltMin = d;
-            if (d > FiltMax) FiltMax = d;
+            if (d < img.FiltMin) img.FiltMin = d;
+            if (d > img.FiltMax) img.FiltMax = d;
         }
 
-        delete[] dst;
+        delete[] filt;
         delete[] tmpdata;
     }
 }
 
+void usImage::CalcStats()
+{
+    if (!HasPixels())
+        return;
+
+    if (Packed8)
+        calc_stats(*this, ImageData8);
+    else
+        calc_stats(*this, ImageData);
+}
+
 static unsigned char *buildGammaLookupTable(int blevel, int wlevel, double power)
 {
     unsigned char *result = new unsigned char[0x10000];
@@ -237,6 +354,18 @@ static unsigned char *buildGammaLookupTable(int blevel, int wlevel, double power
     return result;
 }
 
+template<typename T>
+static void apply_lut(unsigned char *ImgPtr, const T *RawPtr, unsigned int npixels, const unsigned char *lutTable)
+{
+    for (unsigned int i = 0; i < npixels; i++, RawPtr++)
+    {
+        unsigned char d = lutTable[*RawPtr];
+        *ImgPtr++ = d;
+        *ImgPtr++ = d;
+        *ImgPtr++ = d;
+    }
+}
+
 bool usImage::CopyToImage(wxImage **rawimg, int blevel, int wlevel, double power)
 {
     wxImage *img = *rawimg;
@@ -247,19 +376,12 @@ bool usImage::CopyToImage(wxImage **rawimg, int blevel, int wlevel, double power
         img = new wxImage(Size.GetWidth(), Size.GetHeight(), false);
     }
 
-    unsigned char *ImgPtr = img->GetData();
-    unsigned short *RawPtr = ImageData;
-
     unsigned char *lutTable = buildGammaLookupTable(blevel, wlevel, power);
 
-    for (unsigned int i = 0; i < NPixels; i++, RawPtr++ )
-    {
-        unsigned short v = *RawPtr;
-        unsigned char d = lutTable[v];
-        *ImgPtr++ = d;
-        *ImgPtr++ = d;
-        *ImgPtr++ = d;
-    }
+    if (Packed8)
+        apply_lut(img->GetData(), ImageData8, NPixels, lutTable);
+    else
+        apply_lut(img->GetData(), ImageData, NPixels, lutTable);
 
     delete[] lutTable;
 
@@ -270,6 +392,7 @@ bool usImage::CopyToImage(wxImage **rawimg, int blevel, int wlevel, double power
 void usImage::InitImgStartTime()
 {
     ImgStartTime = wxDateTime::UNow();
+    ImgStartSteady = std::chrono::steady_clock::now();
 }
 
 bool usImage::Save(const wxString& fname, const wxString& hdrNote) const
@@ -308,7 +431,7 @@ bool usImage::Save(const wxString& fname, const wxString& hdrNote) const
         if (pCamera)
         {
             hdr.write("INSTRUME", pCamera->Name.c_str(), "Instrument name");
-            unsigned int b = pCamera->Binning;
+            unsigned int b = pCamera->EffectiveBinning();
             hdr.write("XBINNING", b, "Camera X Bin");
             hdr.write("YBINNING", b, "Camera Y Bin");
             hdr.write("CCDXBIN", b, "Camera X Bin");
@@ -381,7 +504,10 @@ bool usImage::Save(const wxString& fname, const wxString& hdrNote) const
         }
 
         long fpixel[3] = { 1, 1, 1 };
-        fits_write_pix(fptr, TUSHORT, fpixel, NPixels, ImageData, &status);
+        if (Packed8)
+            fits_write_pix(fptr, TBYTE, fpixel, NPixels, ImageData8, &status);
+        else
+            fits_write_pix(fptr, TUSHORT, fpixel, NPixels, ImageData, &status);
 
         PHD_fits_close_file(fptr);
 
@@ -496,6 +622,13 @@ bool usImage::Load(const wxString& fname)
 
 bool usImage::CopyFrom(const usImage& src)
 {
+    if (src.Packed8)
+    {
+        if (Init8(src.Size))
+            return true;
+        memcpy(ImageData8, src.ImageData8, NPixels);
+        return false;
+    }
     if (Init(src.Size))
         return true;
     memcpy(ImageData, src.ImageData, NPixels * sizeof(unsigned short));
@@ -39,8 +39,13 @@ class usImage
 {
 public:
     unsigned short     *ImageData;      // Pointer to raw data
+    unsigned char      *ImageData8;     // Pixels of a frame delivered in 8-bit mode, see Packed8
     wxSize              Size;           // Dimensions of image
     wxRect              Subframe;       // were the valid data is
+    // Windows within Subframe that were read out, or empty when the whole subframe was.
+    // Set before capture to request the windows; it is not reset by Init() so that the
+    // driver sees it, and it is ignored when the frame was not subframed.
+    std::vector<wxRect> Rois;
     unsigned int        NPixels;
     unsigned short      MinADU;
     unsigned short      MaxADU;
@@ -48,15 +53,23 @@ public:
     unsigned short      FiltMin;
     unsigned short      FiltMax;
     wxDateTime          ImgStartTime;
+    std::chrono::steady_clock::time_point ImgStartSteady; // monotonic capture start time
     int                 ImgExpDur;      // milli-seconds
     int                 ImgStackCnt;
+    int                 ImgSpanDur;     // milli-seconds from the first start to the last end of a stack of sub-exposures
     wxByte              BitsPerPixel;
     unsigned short      Pedestal;
     unsigned int        FrameNum;
+    // True when the pixels are held in ImageData8. ImageData is not allocated until Widen()
+    // is called, and is stale afterwards: code that reads ImageData directly must call Widen()
+    // first. CalcStats, CopyToImage, Save, dark subtraction, PixelValue and Star::Find read
+    // 8-bit pixels in place.
+    bool                Packed8;
 
     usImage()
         :
         ImageData(nullptr),
+        ImageData8(nullptr),
         NPixels(0),
         MinADU(0),
         MaxADU(0),
@@ -65,18 +78,24 @@ public:
         FiltMax(0),
         ImgExpDur(0),
         ImgStackCnt(1),
+        ImgSpanDur(0),
         BitsPerPixel(0),
         Pedestal(0),
-        FrameNum(0)
+        FrameNum(0),
+        Packed8(false)
     {
     }
-    ~usImage() { delete[] ImageData; }
+    ~usImage() { delete[] ImageData; delete[] ImageData8; }
 
     bool                Init(const wxSize& size);
     bool                Init(int width, int height) { return Init(wxSize(width, height)); }
+    bool                Init8(const wxSize& size);  // for drivers delivering 8-bit pixels into ImageData8
+    void                Widen();                    // make ImageData current if the pixels are 8-bit
+    bool                HasPixels() const { return NPixels && (Packed8 ? ImageData8 != nullptr : ImageData != nullptr); }
     void                SwapImageData(usImage& other);
     void                CalcStats();
     void                InitImgStartTime();
+    int                 ExposureSpan() const;
     bool                CopyFrom(const usImage& src);
     bool                CopyToImage(wxImage **img, int blevel, int wlevel, double power);
     bool                CopyFromImage(const wxImage& img);
@@ -85,12 +104,31 @@ public:
     bool                Rotate(double theta, bool mirror=false);
     unsigned short&     Pixel(int x, int y) { return ImageData[y * Size.x + x]; }
     const unsigned short& Pixel(int x, int y) const { return ImageData[y * Size.x + x]; }
+    unsigned short      PixelValue(int x, int y) const;                 // 8-bit or 16-bit pixels
     void                Clear(void);
+    bool                HasRois() const { return !Rois.empty() && !Subframe.IsEmpty(); }
+    void                ValidRects(std::vector<wxRect> *rects) const;   // the windows, the subframe or the whole frame
+    wxRect              ValidRectAt(const wxPoint& pt) const;           // the window containing pt, empty if none
 };
 
+// time covered by the frame: the exposure, or the whole stack for stacked sub-exposures
+inline int usImage::ExposureSpan() const
+{
+    return ImgStackCnt > 1 && ImgSpanDur > 0 ? ImgSpanDur : ImgExpDur;
+}
+
 inline void usImage::Clear(void)
 {
-    memset(ImageData, 0, NPixels * sizeof(unsigned short));
+    if (Packed8)
+        memset(ImageData8, 0, NPixels);
+    else
+        memset(ImageData, 0, NPixels * sizeof(unsigned short));
+}
+
+inline unsigned short usImage::PixelValue(int x, int y) const
+{
+    unsigned int const i = y * Size.x + x;
+    return Packed8 ? ImageData8[i] : ImageData[i];
 }
 
 #endif
@@ -144,6 +144,7 @@ CameraROITest(usImage *img)
     // Overlay a simulated star that wanders around and periodically disappears.
     // This is used for testing new cameras to ensure that they deal properly with
     // dynamically changing subframes.
+    img->Widen();
     static int ddx = 1, ddy = 1;
     static int dx, dy;
     int X = 250 + dx;
@@ -291,6 +292,7 @@ void WorkerThread::EnqueueWorkerThreadAxisMove(Mount *mount, const GUIDE_DIRECTI
 void WorkerThread::HandleMove(MOVE_REQUEST *req)
 {
     Mount::MOVE_RESULT result = Mount::MOVE_OK;
+    wxStopWatch swatch;
 
     try
     {
@@ -356,7 +358,8 @@ void WorkerThread::HandleMove(MOVE_REQUEST *req)
             result = Mount::MOVE_ERROR;
     }
 
-    Debug.Write(wxString::Format("move complete, result=%d\n", result));
+    // for a concurrent RA/Dec move the elapsed time is that of the longer pulse, not the sum
+    Debug.Write(wxString::Format("move complete, result=%d, elapsed=%ld ms\n", result, swatch.Time()));
 
     req->moveResult = result;
 }
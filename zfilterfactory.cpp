@@ -44,6 +44,7 @@ https://www-users.cs.york.ac.uk/~fisher/mkfilter/
 #include <stdio.h>
 #include <math.h>
 #include <string.h>
+#include <algorithm>
 
 #include "zfilterfactory.h"
 
@@ -82,7 +83,7 @@ ZFilterFactory::ZFilterFactory(FILTER_DESIGN f, int o, double p, bool mzt )
         std::complex<double>( -1.36069227838e+00, 1.73350574267e+00),
         std::complex<double>( -8.65756901707e-01, 2.29260483098e+00),
     };
-    if (o <= 0)
+    if (o <= 0 || (f == BESSEL && o > MaxOrder))
     {
         throw ERROR_INFO("invalid filter order");
     }
@@ -102,6 +103,13 @@ ZFilterFactory::ZFilterFactory(FILTER_DESIGN f, int o, double p, bool mzt )
     normalize();
     zplane();
     expandpoly();
+    buildsections();
+
+    // self-test: the cascade must reproduce the frequency response of the design
+    if (sectionerror(64) > 1e-6)
+    {
+        throw ERROR_INFO("filter sections do not match the design");
+    }
 }
 
 void ZFilterFactory::splane() // compute S-plane poles for prototype LP filter
@@ -138,7 +146,7 @@ void ZFilterFactory::splane() // compute S-plane poles for prototype LP filter
         double rip = pow(10.0, -chripple / 10.0);
         double eps = sqrt(rip - 1.0);
         double y = asinh(1.0 / eps) / (double) m_order;
-        for (int i = 0; i < spoles.size(); i++) 
+        for (size_t i = 0; i < spoles.size(); i++) 
         {
             spoles[i].real(spoles[i].real()*sinh(y));
             spoles[i].imag(spoles[i].imag()*cosh(y));
@@ -164,7 +172,7 @@ void ZFilterFactory::prewarp()
 void ZFilterFactory::normalize() /* called for trad, not for -Re or -Pi */
 {
     double w1 = TWOPI * warped_alpha1;
-    for (int i = 0; i < spoles.size(); i++)
+    for (size_t i = 0; i < spoles.size(); i++)
         spoles[i] = spoles[i] * w1;
     szeros.clear();
 }
@@ -173,7 +181,7 @@ void ZFilterFactory::zplane()
 {
 // given S-plane poles & zeros, compute Z-plane poles & zeros
 // using bilinear transform or matched z-transform
-    int i;
+    size_t i;
     zpoles.clear();
     zzeros.clear();
     if(!isMzt)
@@ -217,10 +225,107 @@ void ZFilterFactory::expandpoly() // given Z-plane poles & zeros, compute top &
         ycoeffs.push_back( -(botcoeffs[i].real() / botcoeffs.back().real()) );
 }
 
+void ZFilterFactory::buildsections() // given Z-plane poles & zeros, compute second-order sections
+{
+    std::vector<std::complex<double>> cpoles, czeros;
+    std::vector<double> rpoles, rzeros;
+    size_t i;
+
+    // keep one member of each complex conjugate pair
+    for (i = 0; i < zpoles.size(); i++)
+    {
+        if (zpoles[i].imag() > EPS)
+            cpoles.push_back(zpoles[i]);
+        else if (zpoles[i].imag() >= -EPS)
+            rpoles.push_back(zpoles[i].real());
+    }
+    for (i = 0; i < zzeros.size(); i++)
+    {
+        if (zzeros[i].imag() > EPS)
+            czeros.push_back(zzeros[i]);
+        else if (zzeros[i].imag() >= -EPS)
+            rzeros.push_back(zzeros[i].real());
+    }
+
+    // lowest Q first so the early sections do not overload the later ones
+    std::sort(cpoles.begin(), cpoles.end(),
+        [](const std::complex<double>& a, const std::complex<double>& b) { return std::abs(a) < std::abs(b); });
+
+    sections.clear();
+    auto addsection = [&](double a1, double a2, int npoles)
+    {
+        double b1 = 0.0, b2 = 0.0;
+        if (npoles == 2 && !czeros.empty())
+        {
+            b1 = -2.0 * czeros.back().real();
+            b2 = std::norm(czeros.back());
+            czeros.pop_back();
+        }
+        else
+        {
+            for (int n = 0; n < npoles && !rzeros.empty(); n++)
+            {
+                b2 = -b1 * rzeros.back();
+                b1 -= rzeros.back();
+                rzeros.pop_back();
+            }
+        }
+        double g = (1.0 + a1 + a2) / (1.0 + b1 + b2);   // unity gain at DC
+        ZFilterSection s = { g, g * b1, g * b2, a1, a2 };
+        sections.push_back(s);
+    };
+
+    while (rpoles.size() >= 2)
+    {
+        double p1 = rpoles.back(); rpoles.pop_back();
+        double p2 = rpoles.back(); rpoles.pop_back();
+        addsection(-(p1 + p2), p1 * p2, 2);
+    }
+    if (!rpoles.empty())
+        addsection(-rpoles.back(), 0.0, 1);
+    for (i = 0; i < cpoles.size(); i++)
+        addsection(-2.0 * cpoles[i].real(), std::norm(cpoles[i]), 2);
+}
+
+std::complex<double> ZFilterFactory::response(double freq) const
+{
+    // evaluate the design from its poles and zeros, H = prod(1 - zero/z) / prod(1 - pole/z),
+    // scaled to unity gain at DC like the sections
+    const std::complex<double> z_one(1.0, 0.0);
+    const std::complex<double> zinv = std::polar(1.0, -TWOPI * freq);
+    std::complex<double> top(1.0, 0.0), bot(1.0, 0.0);
+    std::complex<double> top_dc(1.0, 0.0), bot_dc(1.0, 0.0);
+    for (size_t i = 0; i < zzeros.size(); i++)
+    {
+        top *= z_one - zzeros[i] * zinv;
+        top_dc *= z_one - zzeros[i];
+    }
+    for (size_t i = 0; i < zpoles.size(); i++)
+    {
+        bot *= z_one - zpoles[i] * zinv;
+        bot_dc *= z_one - zpoles[i];
+    }
+    return (top / bot) * (bot_dc / top_dc);
+}
+
+double ZFilterFactory::sectionerror(int points) const
+{
+    // largest deviation of the cascaded sections from the design between DC and Nyquist
+    ZFilterCascade cascade;
+    cascade.Init(sections);
+    double maxerr = 0.0;
+    for (int i = 0; i <= points; i++)
+    {
+        double freq = 0.5 * i / points;
+        maxerr = std::max(maxerr, std::abs(cascade.Response(freq) - response(freq)));
+    }
+    return maxerr;
+}
+
 void ZFilterFactory::expand(const std::vector<std::complex<double>>& pz, std::vector<std::complex<double>>& coeffs)
 {
     // compute product of poles or zeros as a polynomial of z 
-    int i;
+    size_t i;
     coeffs.clear();
     coeffs.push_back(1.0);
     for (i = 0; i < pz.size(); i++)
@@ -235,7 +340,7 @@ void ZFilterFactory::expand(const std::vector<std::complex<double>>& pz, std::ve
     {
         if (fabs(coeffs[i].imag()) > EPS)
         {
-            fprintf(stderr, "mkfilter: coeff of z^%d is not real; poles/zeros are not complex conjugates\n", i);
+            fprintf(stderr, "mkfilter: coeff of z^%d is not real; poles/zeros are not complex conjugates\n", (int) i);
             exit(1);
         }
     }
@@ -257,3 +362,41 @@ std::complex<double> ZFilterFactory::eval(const std::vector<std::complex<double>
         sum = (sum * z) + coeffs[i];
     return sum;
 }
+
+void ZFilterCascade::Init(const std::vector<ZFilterSection>& sections)
+{
+    m_sections = sections;
+    m_state.assign(2 * m_sections.size(), 0.0);
+}
+
+void ZFilterCascade::Reset()
+{
+    std::fill(m_state.begin(), m_state.end(), 0.0);
+}
+
+double ZFilterCascade::Step(double input)
+{
+    double x = input;
+    double *state = m_state.data();
+    for (size_t i = 0; i < m_sections.size(); i++, state += 2)
+    {
+        const ZFilterSection& s = m_sections[i];
+        double y = s.b0 * x + state[0];
+        state[0] = s.b1 * x - s.a1 * y + state[1];
+        state[1] = s.b2 * x - s.a2 * y;
+        x = y;
+    }
+    return x;
+}
+
+std::complex<double> ZFilterCascade::Response(double freq) const
+{
+    const std::complex<double> zinv = std::polar(1.0, -2.0 * M_PI * freq);
+    std::complex<double> h(1.0, 0.0);
+    for (size_t i = 0; i < m_sections.size(); i++)
+    {
+        const ZFilterSection& s = m_sections[i];
+        h *= (s.b0 + (s.b1 + s.b2 * zinv) * zinv) / (1.0 + (s.a1 + s.a2 * zinv) * zinv);
+    }
+    return h;
+}
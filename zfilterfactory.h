@@ -46,15 +46,44 @@ enum FILTER_DESIGN
     CHEBYCHEV,
 };
 
+// One second-order section of a cascaded filter, scaled to unity gain at DC
+// H(z) = (b0 + b1.z^-1 + b2.z^-2) / (1 + a1.z^-1 + a2.z^-2)
+struct ZFilterSection
+{
+    double b0, b1, b2;
+    double a1, a2;
+};
+
+// Runs a cascade of second-order sections in transposed direct form II. Each
+// section keeps its two delay values in a buffer sized once by Init(), so
+// Step() neither shifts the history nor allocates.
+class ZFilterCascade
+{
+    std::vector<ZFilterSection> m_sections;
+    std::vector<double> m_state;    // 2 values per section
+
+public:
+    void Init(const std::vector<ZFilterSection>& sections);
+    void Reset();
+    double Step(double input);
+    std::complex<double> Response(double freq) const;   // freq in cycles per sample
+    const std::vector<ZFilterSection>& Sections() const { return m_sections; }
+};
+
 class ZFilterFactory
 {
 public:
+    static const int MaxOrder = 10;     // size of the Bessel pole table
+
     std::vector<double> xcoeffs, ycoeffs;
+    std::vector<ZFilterSection> sections;
     double gain() { return ::hypot(dc_gain.imag(), dc_gain.real()); };
     double corner() { return 1 / raw_alpha1; };
     FILTER_DESIGN design() { return filt; }
     std::string getname() const;
     int order() { return m_order;  };
+    std::complex<double> response(double freq) const;
+    double sectionerror(int points) const;
     ZFilterFactory( FILTER_DESIGN f, int o, double p, bool mzt=false );
 private:
     const double TWOPI = (2.0 * M_PI);
@@ -78,6 +107,7 @@ private:
     void zplane();
     std::complex<double> bilinear(const std::complex<double>&);
     void expandpoly();
+    void buildsections();
     void expand(const std::vector<std::complex<double>>&, std::vector<std::complex<double>>&);
     void multin(const std::complex<double>&, std::vector<std::complex<double>>&);
     std::complex<double> eval(const std::vector<std::complex<double>>& coeffs, const std::complex<double>& z);